@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "BenchmarkBase.hpp"
+#include <memory>
+
+void printMessage(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(stdout, format, args);
+    va_end(args);
+}
+
+void printError(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+int BenchmarkBase::main(int argc, const char **argv)
+{
+    // Get the platform.
+    agpu_platform *platform = nullptr;
+    agpuGetPlatforms(1, &platform, nullptr);
+    if (!platform)
+    {
+        printError("Failed to get AGPU platform\n");
+        return -1;
+    }
+
+    printMessage("Choosen platform: %s\n", agpuGetPlatformName(platform));
+
+    // Open the device
+    agpu_device_open_info openInfo;
+    memset(&openInfo, 0, sizeof(openInfo));
+    openInfo.debug_layer = hasOption(argc, argv, "-debug");
+    if(hasOption(argc, argv, "-headless"))
+        openInfo.window_system_name = "headless";
+
+    device = platform->openDevice(&openInfo);
+    if(!device)
+    {
+        printError("Failed to open the device\n");
+        return -1;
+    }
+
+    // Get the default command queue
+    commandQueue = device->getDefaultCommandQueue();
+
+    // Get the preferred shader language.
+    preferredShaderLanguage = device->getPreferredIntermediateShaderLanguage();
+    if(preferredShaderLanguage == AGPU_SHADER_LANGUAGE_NONE)
+    {
+        preferredShaderLanguage = device->getPreferredHighLevelShaderLanguage();
+        if(preferredShaderLanguage == AGPU_SHADER_LANGUAGE_NONE)
+            preferredShaderLanguage = device->getPreferredShaderLanguage();
+    }
+
+    try
+    {
+        return run(argc, argv);
+    }
+    catch(agpu_exception &e)
+    {
+        printError("Benchmark failed with AGPU error %d\n", (int)e.getErrorCode());
+        return -1;
+    }
+}
+
+size_t BenchmarkBase::parseSizeOption(int argc, const char **argv, const char *name, size_t defaultValue)
+{
+    for(int i = 1; i + 1 < argc; ++i)
+    {
+        if(!strcmp(argv[i], name))
+            return (size_t)strtoull(argv[i + 1], nullptr, 10);
+    }
+
+    return defaultValue;
+}
+
+bool BenchmarkBase::hasOption(int argc, const char **argv, const char *name)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!strcmp(argv[i], name))
+            return true;
+    }
+
+    return false;
+}
+
+void BenchmarkBase::reportResult(const char *name, size_t iterations, double seconds)
+{
+    auto microsecondsPerIteration = iterations > 0 ? seconds * 1e6 / iterations : 0.0;
+    auto iterationsPerSecond = seconds > 0.0 ? iterations / seconds : 0.0;
+    printMessage("%-40s %10zu iterations %12.3f us/iteration %14.1f iterations/s\n", name, iterations, microsecondsPerIteration, iterationsPerSecond);
+}
+
+agpu_shader_ref BenchmarkBase::compileShaderFromSource(agpu_shader_type type, const char *source)
+{
+    agpu_offline_shader_compiler_ref shaderCompiler = device->createOfflineShaderCompiler();
+    shaderCompiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, type, source, (agpu_string_length)strlen(source));
+    try
+    {
+        shaderCompiler->compileShader(AGPU_SHADER_LANGUAGE_DEVICE_SHADER, nullptr);
+    }
+    catch(agpu_exception &e)
+    {
+        auto logLength = shaderCompiler->getCompilationLogLength();
+        std::unique_ptr<char[]> logBuffer(new char[logLength+1]);
+        shaderCompiler->getCompilationLog(logLength+1, logBuffer.get());
+        printError("Shader compilation error:%s\n", logBuffer.get());
+        return nullptr;
+    }
+
+    return shaderCompiler->getResultAsShader();
+}
+
+agpu_framebuffer_ref BenchmarkBase::createOffscreenFramebuffer(agpu_uint width, agpu_uint height, agpu_texture_format format)
+{
+    agpu_texture_description description = {};
+    description.type = AGPU_TEXTURE_2D;
+    description.width = width;
+    description.height = height;
+    description.depth = 1;
+    description.layers = 1;
+    description.miplevels = 1;
+    description.format = format;
+    description.usage_modes = agpu_texture_usage_mode_mask(AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT | AGPU_TEXTURE_USAGE_SAMPLED);
+    description.main_usage_mode = AGPU_TEXTURE_USAGE_SAMPLED;
+    description.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+    description.sample_count = 1;
+
+    auto colorBuffer = device->createTexture(&description);
+    if(!colorBuffer)
+        return nullptr;
+
+    auto colorBufferView = colorBuffer->getOrCreateFullView();
+    return device->createFrameBuffer(width, height, 1, &colorBufferView, nullptr);
+}
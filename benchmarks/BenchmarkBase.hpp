@@ -0,0 +1,73 @@
+#ifndef _BENCHMARK_BASE_HPP_
+#define _BENCHMARK_BASE_HPP_
+
+#include <AGPU/agpu.hpp>
+#include <chrono>
+#include <string>
+
+// Utility functions
+void printMessage(const char *format, ...);
+void printError(const char *format, ...);
+
+/**
+ * Simple wall clock timer used for measuring the benchmarks.
+ */
+class BenchmarkTimer
+{
+public:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    BenchmarkTimer()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        startTime = Clock::now();
+    }
+
+    double elapsedSeconds() const
+    {
+        return std::chrono::duration<double> (Clock::now() - startTime).count();
+    }
+
+private:
+    Clock::time_point startTime;
+};
+
+/**
+ * Base class for the headless benchmarks. The platform is selected through
+ * the usual loader environment variables, such as AGPU_DRIVER_PATH.
+ */
+class BenchmarkBase
+{
+public:
+    int main(int argc, const char **argv);
+
+    virtual int run(int argc, const char **argv) = 0;
+
+    // Command line helpers.
+    static size_t parseSizeOption(int argc, const char **argv, const char *name, size_t defaultValue);
+    static bool hasOption(int argc, const char **argv, const char *name);
+
+    // Prints a result line with the time per iteration and the iteration rate.
+    static void reportResult(const char *name, size_t iterations, double seconds);
+
+    // Resource creation helpers.
+    agpu_shader_ref compileShaderFromSource(agpu_shader_type type, const char *source);
+    agpu_framebuffer_ref createOffscreenFramebuffer(agpu_uint width, agpu_uint height, agpu_texture_format format);
+
+    agpu_device_ref device;
+    agpu_command_queue_ref commandQueue;
+    agpu_shader_language preferredShaderLanguage;
+};
+
+#define BENCHMARK_MAIN(BenchmarkClass) \
+int main(int argc, char *argv[]) \
+{ \
+    BenchmarkClass benchmark; \
+    return benchmark.main(argc, (const char **)argv); \
+}
+
+#endif //_BENCHMARK_BASE_HPP_
@@ -0,0 +1,89 @@
+#include "BenchmarkBase.hpp"
+#include "ImmediateShaderVariants.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+/**
+ * Compiles all the variants of the shaders of the immediate renderer into
+ * Spir-V with a single batch, and reports how the batch scales from one
+ * thread up to the given thread count. Every batch uses different sources,
+ * so that it is never served by the Spir-V cache.
+ */
+class BenchmarkBatchShaderCompilation : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto maxThreadCount = parseSizeOption(argc, argv, "-threads", std::max(std::thread::hardware_concurrency(), 4u));
+
+        agpu_offline_shader_compiler_ref compiler = device->createOfflineShaderCompiler();
+
+        // Warm up the compiler library.
+        if(!compileBatch(compiler, "// Warm up\n", 1, nullptr))
+            return -1;
+
+        double singleThreadSeconds = 0;
+        for(size_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+        {
+            char header[64];
+            snprintf(header, sizeof(header), "// Batch with %d threads\n", int(threadCount));
+
+            size_t jobCount = 0;
+            BenchmarkTimer timer;
+            if(!compileBatch(compiler, header, threadCount, &jobCount))
+                return -1;
+            auto seconds = timer.elapsedSeconds();
+            if(threadCount == 1)
+                singleThreadSeconds = seconds;
+
+            char name[64];
+            snprintf(name, sizeof(name), "shader compilations (%d threads)", int(threadCount));
+            reportResult(name, jobCount, seconds);
+            printMessage("Speedup: %.2fx\n", singleThreadSeconds / seconds);
+        }
+
+        return 0;
+    }
+
+    bool compileBatch(const agpu_offline_shader_compiler_ref &compiler, const char *header, size_t threadCount, size_t *jobCount)
+    {
+        auto variants = makeImmediateShaderVariants(header);
+        std::vector<agpu_offline_shader_compilation_job> jobs(variants.size());
+        for(size_t i = 0; i < variants.size(); ++i)
+        {
+            auto &job = jobs[i];
+            memset(&job, 0, sizeof(job));
+            job.source_language = AGPU_SHADER_LANGUAGE_VGLSL;
+            job.stage = variants[i].type;
+            job.source_text = variants[i].source.c_str();
+            job.source_text_length = (agpu_string_length)variants[i].source.size();
+            job.target_language = AGPU_SHADER_LANGUAGE_SPIR_V;
+        }
+
+        bool succeeded = true;
+        try
+        {
+            compiler->compileShaderBatch(jobs.size(), jobs.data(), agpu_uint(threadCount));
+        }
+        catch(agpu_exception &e)
+        {
+            printError("Failed to compile a batch of immediate renderer shaders\n");
+            succeeded = false;
+        }
+
+        // The compilers of the jobs keep the results and the logs.
+        for(auto &job : jobs)
+        {
+            if(job.compiler)
+                agpuReleaseOfflineShaderCompiler(job.compiler);
+        }
+
+        if(jobCount)
+            *jobCount = jobs.size();
+        return succeeded;
+    }
+};
+
+BENCHMARK_MAIN(BenchmarkBatchShaderCompilation)
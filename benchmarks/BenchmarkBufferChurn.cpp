@@ -0,0 +1,136 @@
+#include "BenchmarkBase.hpp"
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/**
+ * Captures what is written into the standard error, where the drivers report
+ * the errors of the API when they are asked to, such as Mesa with MESA_DEBUG.
+ */
+class StandardErrorCapture
+{
+public:
+    StandardErrorCapture()
+        : file(nullptr), savedDescriptor(-1)
+    {
+#ifndef _WIN32
+        fflush(stderr);
+        file = tmpfile();
+        if(!file)
+            return;
+
+        savedDescriptor = dup(STDERR_FILENO);
+        dup2(fileno(file), STDERR_FILENO);
+#endif
+    }
+
+    ~StandardErrorCapture()
+    {
+        finish();
+        if(file)
+            fclose(file);
+    }
+
+    bool isCapturing() const
+    {
+        return file != nullptr;
+    }
+
+    // Restores the standard error, and returns the captured lines.
+    std::vector<std::string> finish()
+    {
+        std::vector<std::string> lines;
+#ifndef _WIN32
+        if(savedDescriptor < 0)
+            return lines;
+
+        fflush(stderr);
+        dup2(savedDescriptor, STDERR_FILENO);
+        close(savedDescriptor);
+        savedDescriptor = -1;
+
+        rewind(file);
+        char line[1024];
+        while(fgets(line, sizeof(line), file))
+            lines.push_back(line);
+#endif
+        return lines;
+    }
+
+private:
+    FILE *file;
+    int savedDescriptor;
+};
+
+/**
+ * Creates and destroys buffers in a tight loop, with and without initial
+ * data and uploads, so that the names of the destroyed buffers are reused
+ * while the jobs of their previous owners may still be pending. The errors
+ * that are reported by the driver into the standard error are counted. Run
+ * it with MESA_DEBUG=1 on Mesa, where any error means that a buffer name was
+ * deleted before the jobs that use it.
+ */
+class BenchmarkBufferChurn : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto iterationCount = parseSizeOption(argc, argv, "-iterations", 10000);
+        auto bufferSize = parseSizeOption(argc, argv, "-size", 256);
+
+        std::vector<uint8_t> data(bufferSize);
+        for(size_t i = 0; i < bufferSize; ++i)
+            data[i] = uint8_t(i);
+
+        agpu_buffer_description description = {};
+        description.size = agpu_uint(bufferSize);
+        description.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        description.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_UNIFORM_BUFFER);
+        description.main_usage_mode = AGPU_UNIFORM_BUFFER;
+        description.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
+
+        // Warm up.
+        device->createBuffer(&description, &data[0]);
+        device->finishExecution();
+
+        StandardErrorCapture errorCapture;
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < iterationCount; ++i)
+        {
+            device->createBuffer(&description, nullptr);
+
+            auto buffer = device->createBuffer(&description, &data[0]);
+            buffer->uploadBufferData(0, agpu_size(bufferSize), &data[0]);
+        }
+        device->finishExecution();
+        auto seconds = timer.elapsedSeconds();
+        auto errorLines = errorCapture.finish();
+
+        size_t errorCount = 0;
+        for(auto &line : errorLines)
+        {
+            if(strstr(line.c_str(), "error") || strstr(line.c_str(), "GL_INVALID"))
+            {
+                if(errorCount < MaxPrintedErrors)
+                    printError("%s", line.c_str());
+                ++errorCount;
+            }
+        }
+
+        reportResult("buffer churn iterations", iterationCount, seconds);
+        if(errorCapture.isCapturing())
+            printMessage("Driver errors: %zu\n", errorCount);
+        else
+            printMessage("Driver errors: not captured in this platform\n");
+        return errorCount == 0 ? 0 : 1;
+    }
+
+    static constexpr size_t MaxPrintedErrors = 10;
+};
+
+BENCHMARK_MAIN(BenchmarkBufferChurn)
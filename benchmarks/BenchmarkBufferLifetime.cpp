@@ -0,0 +1,66 @@
+#include "BenchmarkBase.hpp"
+#include <vector>
+
+/**
+ * Creates a batch of buffers, fills them with uploads and destroys them. The
+ * time that is spent by the application thread in each phase is reported
+ * separately, and the total includes waiting for the device to finish, so
+ * that the asynchronous work is also accounted for.
+ */
+class BenchmarkBufferLifetime : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto bufferCount = parseSizeOption(argc, argv, "-buffers", 10000);
+        auto bufferSize = parseSizeOption(argc, argv, "-size", 256);
+        auto uploadCount = parseSizeOption(argc, argv, "-uploads", 4);
+
+        std::vector<uint8_t> data(bufferSize);
+        for(size_t i = 0; i < bufferSize; ++i)
+            data[i] = uint8_t(i);
+
+        agpu_buffer_description description = {};
+        description.size = agpu_uint(bufferSize);
+        description.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        description.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_UNIFORM_BUFFER);
+        description.main_usage_mode = AGPU_UNIFORM_BUFFER;
+        description.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
+
+        // Warm up.
+        device->createBuffer(&description, &data[0]);
+        device->finishExecution();
+
+        std::vector<agpu_buffer_ref> buffers;
+        buffers.reserve(bufferCount);
+
+        BenchmarkTimer totalTimer;
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < bufferCount; ++i)
+            buffers.push_back(device->createBuffer(&description, &data[0]));
+        auto creationSeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        for(size_t i = 0; i < uploadCount; ++i)
+        {
+            for(auto &buffer : buffers)
+                buffer->uploadBufferData(0, agpu_size(bufferSize), &data[0]);
+        }
+        auto uploadSeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        buffers.clear();
+        auto destructionSeconds = timer.elapsedSeconds();
+
+        device->finishExecution();
+        auto totalSeconds = totalTimer.elapsedSeconds();
+
+        reportResult("buffer creations", bufferCount, creationSeconds);
+        reportResult("buffer uploads", bufferCount*uploadCount, uploadSeconds);
+        reportResult("buffer destructions", bufferCount, destructionSeconds);
+        reportResult("buffer lifetimes", bufferCount, totalSeconds);
+        return 0;
+    }
+};
+
+BENCHMARK_MAIN(BenchmarkBufferLifetime)
@@ -0,0 +1,80 @@
+#include "BenchmarkBase.hpp"
+#include <AGPU/agpu_direct.hpp>
+
+/**
+ * Measures the overhead per call of the different ways of calling the same
+ * methods: the C ABI through the loader, the agpu.hpp wrappers, and the
+ * direct binding to the implementation interfaces. The called methods do
+ * almost nothing, so the times are dominated by the calling path.
+ */
+class BenchmarkDirectCalls : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto callCount = parseSizeOption(argc, argv, "-calls", 10000000);
+
+        auto pipelineBuilder = device->createPipelineBuilder();
+        auto directDevice = agpu::direct::wrap(device);
+        auto directPipelineBuilder = agpu::direct::wrap(pipelineBuilder);
+
+        // Warm up.
+        benchmarkCalls(callCount / 10, device, pipelineBuilder, directDevice, directPipelineBuilder, false);
+        benchmarkCalls(callCount, device, pipelineBuilder, directDevice, directPipelineBuilder, true);
+
+        printMessage("Checksum: %zu\n", size_t(checksum));
+        return 0;
+    }
+
+    void benchmarkCalls(size_t callCount,
+        const agpu_device_ref &device, const agpu_pipeline_builder_ref &pipelineBuilder,
+        const agpu::device_ref &directDevice, const agpu::pipeline_builder_ref &directPipelineBuilder,
+        bool reportResults)
+    {
+        size_t sum = 0;
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < callCount; ++i)
+            sum += agpuHasTopLeftNdcOrigin(device.get());
+        auto cQuerySeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        for(size_t i = 0; i < callCount; ++i)
+            sum += device->hasTopLeftNdcOrigin();
+        auto wrapperQuerySeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        for(size_t i = 0; i < callCount; ++i)
+            sum += directDevice->hasTopLeftNdcOrigin();
+        auto directQuerySeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        for(size_t i = 0; i < callCount; ++i)
+            sum += agpuSetPrimitiveType(pipelineBuilder.get(), agpu_primitive_topology(AGPU_POINTS + (i & 1)));
+        auto cSetterSeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        for(size_t i = 0; i < callCount; ++i)
+            pipelineBuilder->setPrimitiveType(agpu_primitive_topology(AGPU_POINTS + (i & 1)));
+        auto wrapperSetterSeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        for(size_t i = 0; i < callCount; ++i)
+            agpuThrowIfFailed(directPipelineBuilder->setPrimitiveType(agpu_primitive_topology(AGPU_POINTS + (i & 1))));
+        auto directSetterSeconds = timer.elapsedSeconds();
+
+        checksum += sum;
+        if(!reportResults)
+            return;
+
+        reportResult("C ABI queries", callCount, cQuerySeconds);
+        reportResult("agpu.hpp queries", callCount, wrapperQuerySeconds);
+        reportResult("direct queries", callCount, directQuerySeconds);
+        reportResult("C ABI setters", callCount, cSetterSeconds);
+        reportResult("agpu.hpp setters", callCount, wrapperSetterSeconds);
+        reportResult("direct setters", callCount, directSetterSeconds);
+    }
+
+    volatile size_t checksum = 0;
+};
+
+BENCHMARK_MAIN(BenchmarkDirectCalls)
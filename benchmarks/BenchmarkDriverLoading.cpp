@@ -0,0 +1,66 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <vector>
+
+/**
+ * Measures the startup cost of the loader: the time to the first
+ * agpuGetPlatforms call, the platform queries that are answered by the driver
+ * manifests, and the first device that is opened, which is what loads the
+ * driver of a platform that is described by a manifest. Every measurement is
+ * done once per process, so it has to be run several times. The drivers are
+ * loaded eagerly when the AGPU_IGNORE_DRIVER_MANIFESTS environment variable
+ * is set, for comparison.
+ */
+int main(int argc, const char **argv)
+{
+    BenchmarkTimer totalTimer;
+    BenchmarkTimer timer;
+    agpu_size platformCount = 0;
+    agpuGetPlatforms(0, nullptr, &platformCount);
+    auto getPlatformsSeconds = timer.elapsedSeconds();
+    if(!platformCount)
+    {
+        printError("Failed to get AGPU platform\n");
+        return -1;
+    }
+
+    std::vector<agpu_platform*> platforms(platformCount);
+    agpuGetPlatforms(platformCount, &platforms[0], &platformCount);
+
+    timer.reset();
+    for(auto platform : platforms)
+    {
+        agpuGetPlatformName(platform);
+        agpuIsNativePlatform(platform);
+        agpuPlatformHasRealMultithreading(platform);
+        agpuIsCrossPlatform(platform);
+    }
+    auto platformQueriesSeconds = timer.elapsedSeconds();
+
+    for(auto platform : platforms)
+        printMessage("Platform: %s\n", agpuGetPlatformName(platform));
+
+    // Open the device
+    agpu_device_open_info openInfo;
+    memset(&openInfo, 0, sizeof(openInfo));
+    if(BenchmarkBase::hasOption(argc, argv, "-headless"))
+        openInfo.window_system_name = "headless";
+
+    timer.reset();
+    auto device = agpuOpenDevice(platforms[0], &openInfo);
+    auto openDeviceSeconds = timer.elapsedSeconds();
+    auto totalSeconds = totalTimer.elapsedSeconds();
+    if(!device)
+    {
+        printError("Failed to open the device\n");
+        return -1;
+    }
+
+    BenchmarkBase::reportResult("first agpuGetPlatforms", 1, getPlatformsSeconds);
+    BenchmarkBase::reportResult("platform queries", platformCount, platformQueriesSeconds);
+    BenchmarkBase::reportResult("first device open", 1, openDeviceSeconds);
+    BenchmarkBase::reportResult("time to first device", 1, totalSeconds);
+
+    agpuReleaseDevice(device);
+    return 0;
+}
@@ -0,0 +1,316 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#ifdef AGPU_BENCHMARK_HAS_LIBFFI
+#include <ffi.h>
+#endif
+
+/**
+ * Encoder of the command buffers that are accepted by
+ * agpuExecuteEncodedCommands, like the ones that are built by the bindings.
+ */
+class CommandEncoder
+{
+public:
+    CommandEncoder()
+        : size(0)
+    {
+    }
+
+    void clear()
+    {
+        size = 0;
+    }
+
+    template<typename...Args>
+    void encode(agpu_encoded_command opcode, Args... args)
+    {
+        static constexpr size_t SlotCount = 1 + sizeof...(args);
+        if(size + SlotCount > slots.size())
+            slots.resize(std::max(slots.size()*2, size_t(1024)));
+
+        uint32_t header[2] = {uint32_t(opcode), uint32_t(SlotCount*sizeof(uint64_t))};
+        uint64_t command[SlotCount] = {0, encodeArgument(args)...};
+        memcpy(&command[0], header, sizeof(header));
+        memcpy(&slots[size], command, sizeof(command));
+        size += SlotCount;
+    }
+
+    agpu_pointer getData()
+    {
+        return &slots[0];
+    }
+
+    agpu_size getSize() const
+    {
+        return agpu_size(size*sizeof(uint64_t));
+    }
+
+private:
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint64_t>::type encodeArgument(T value)
+    {
+        return uint64_t(int64_t(value));
+    }
+
+    static uint64_t encodeArgument(float value)
+    {
+        double doubleValue = value;
+        uint64_t result;
+        memcpy(&result, &doubleValue, sizeof(result));
+        return result;
+    }
+
+    template<typename T>
+    static uint64_t encodeArgument(T *pointer)
+    {
+        return uint64_t(uintptr_t(pointer));
+    }
+
+    std::vector<uint64_t> slots;
+    size_t size;
+};
+
+#ifdef AGPU_BENCHMARK_HAS_LIBFFI
+/**
+ * A function of the C API that is called through libffi, which is the kind
+ * of foreign function call that is made by the bindings of the dynamic
+ * languages. Its cost is a lower bound of the cost of theirs.
+ */
+template<typename FT>
+class ForeignFunction;
+
+template<typename...Args>
+class ForeignFunction<agpu_error (Args...)>
+{
+public:
+    ForeignFunction(agpu_error (*function)(Args...))
+        : function(FFI_FN(function))
+    {
+        ffi_type *types[] = {foreignType<Args> ()...};
+        memcpy(argumentTypes, types, sizeof(types));
+        ffi_prep_cif(&cif, FFI_DEFAULT_ABI, sizeof...(Args), &ffi_type_sint32, argumentTypes);
+    }
+
+    agpu_error operator()(Args... args) const
+    {
+        void *values[] = {&args...};
+        ffi_arg result;
+        ffi_call(&cif, function, &result, values);
+        return agpu_error(result);
+    }
+
+private:
+    template<typename T>
+    static ffi_type *foreignType()
+    {
+        if(std::is_pointer<T>::value)
+            return &ffi_type_pointer;
+        if(std::is_floating_point<T>::value)
+            return sizeof(T) == 4 ? &ffi_type_float : &ffi_type_double;
+        if(sizeof(T) == 8)
+            return std::is_unsigned<T>::value ? &ffi_type_uint64 : &ffi_type_sint64;
+        return std::is_unsigned<T>::value ? &ffi_type_uint32 : &ffi_type_sint32;
+    }
+
+    mutable ffi_cif cif;
+    void (*function)();
+    ffi_type *argumentTypes[sizeof...(Args)];
+};
+#endif
+
+/**
+ * Records the same commands through one C API call per command, and through
+ * a single call with a buffer of encoded commands, which is what the bindings
+ * with expensive foreign function calls use. The batched times include the
+ * encoding of the commands, which is done again for every recording, and the
+ * decoded times are measured with a buffer that is encoded once. The state
+ * tracker commands only change its pipeline state, so their times are mostly
+ * the cost of the dispatch or of the decoding. When libffi is available, both
+ * ways are measured again with each C API call made through it, so that they
+ * include the cost of a foreign function transition.
+ */
+class BenchmarkEncodedCommands : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto recordingCount = parseSizeOption(argc, argv, "-recordings", 200);
+        auto drawCount = parseSizeOption(argc, argv, "-draws", 1000);
+
+        commandAllocator = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+        commandList = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr);
+        commandList->close();
+
+        stateTrackerCache = device->createStateTrackerCache(commandQueue);
+        stateTracker = stateTrackerCache->createStateTracker(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+
+        // Warm up.
+        recordCommandListPerCall(drawCount, agpuSetViewport, agpuSetScissor, agpuSetStencilReference, agpuDrawArrays);
+        recordCommandListBatched(drawCount, agpuExecuteEncodedCommands);
+        recordStateTrackerPerCall(drawCount, agpuStateTrackerSetFrontFace, agpuStateTrackerSetCullMode, agpuStateTrackerSetPolygonMode, agpuStateTrackerSetDepthBias);
+        recordStateTrackerBatched(drawCount, agpuStateTrackerExecuteEncodedCommands);
+
+        auto commandCount = recordingCount*drawCount*CommandsPerDraw;
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordCommandListPerCall(drawCount, agpuSetViewport, agpuSetScissor, agpuSetStencilReference, agpuDrawArrays);
+        reportResult("command list per call commands", commandCount, timer.elapsedSeconds());
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordCommandListBatched(drawCount, agpuExecuteEncodedCommands);
+        reportResult("command list batched commands", commandCount, timer.elapsedSeconds());
+
+        // The encoder still has the commands of the last recording.
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            decodeCommandList();
+        reportResult("command list decoded commands", commandCount, timer.elapsedSeconds());
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordStateTrackerPerCall(drawCount, agpuStateTrackerSetFrontFace, agpuStateTrackerSetCullMode, agpuStateTrackerSetPolygonMode, agpuStateTrackerSetDepthBias);
+        reportResult("state tracker per call commands", commandCount, timer.elapsedSeconds());
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordStateTrackerBatched(drawCount, agpuStateTrackerExecuteEncodedCommands);
+        reportResult("state tracker batched commands", commandCount, timer.elapsedSeconds());
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            decodeStateTracker();
+        reportResult("state tracker decoded commands", commandCount, timer.elapsedSeconds());
+
+#ifdef AGPU_BENCHMARK_HAS_LIBFFI
+        ForeignFunction<decltype(agpuSetViewport)> foreignSetViewport(agpuSetViewport);
+        ForeignFunction<decltype(agpuSetScissor)> foreignSetScissor(agpuSetScissor);
+        ForeignFunction<decltype(agpuSetStencilReference)> foreignSetStencilReference(agpuSetStencilReference);
+        ForeignFunction<decltype(agpuDrawArrays)> foreignDrawArrays(agpuDrawArrays);
+        ForeignFunction<decltype(agpuExecuteEncodedCommands)> foreignExecuteEncodedCommands(agpuExecuteEncodedCommands);
+        ForeignFunction<decltype(agpuStateTrackerSetFrontFace)> foreignStateTrackerSetFrontFace(agpuStateTrackerSetFrontFace);
+        ForeignFunction<decltype(agpuStateTrackerSetCullMode)> foreignStateTrackerSetCullMode(agpuStateTrackerSetCullMode);
+        ForeignFunction<decltype(agpuStateTrackerSetPolygonMode)> foreignStateTrackerSetPolygonMode(agpuStateTrackerSetPolygonMode);
+        ForeignFunction<decltype(agpuStateTrackerSetDepthBias)> foreignStateTrackerSetDepthBias(agpuStateTrackerSetDepthBias);
+        ForeignFunction<decltype(agpuStateTrackerExecuteEncodedCommands)> foreignStateTrackerExecuteEncodedCommands(agpuStateTrackerExecuteEncodedCommands);
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordCommandListPerCall(drawCount, foreignSetViewport, foreignSetScissor, foreignSetStencilReference, foreignDrawArrays);
+        reportResult("command list per call libffi commands", commandCount, timer.elapsedSeconds());
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordCommandListBatched(drawCount, foreignExecuteEncodedCommands);
+        reportResult("command list batched libffi commands", commandCount, timer.elapsedSeconds());
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordStateTrackerPerCall(drawCount, foreignStateTrackerSetFrontFace, foreignStateTrackerSetCullMode, foreignStateTrackerSetPolygonMode, foreignStateTrackerSetDepthBias);
+        reportResult("state tracker per call libffi commands", commandCount, timer.elapsedSeconds());
+
+        timer.reset();
+        for(size_t i = 0; i < recordingCount; ++i)
+            recordStateTrackerBatched(drawCount, foreignStateTrackerExecuteEncodedCommands);
+        reportResult("state tracker batched libffi commands", commandCount, timer.elapsedSeconds());
+#endif
+        return 0;
+    }
+
+    static constexpr size_t CommandsPerDraw = 4;
+
+    template<typename SV, typename SS, typename SR, typename DA>
+    void recordCommandListPerCall(size_t drawCount, const SV &setViewport, const SS &setScissor, const SR &setStencilReference, const DA &drawArrays)
+    {
+        commandAllocator->reset();
+        commandList->reset(commandAllocator, nullptr);
+        auto list = commandList.get();
+        for(size_t i = 0; i < drawCount; ++i)
+        {
+            auto offset = agpu_int(i & 63);
+            setViewport(list, offset, offset, 256, 256);
+            setScissor(list, offset, offset, 128, 128);
+            setStencilReference(list, agpu_uint(i & 255));
+            drawArrays(list, 3, 1, 0, 0);
+        }
+        commandList->close();
+    }
+
+    template<typename EF>
+    void recordCommandListBatched(size_t drawCount, const EF &executeEncodedCommands)
+    {
+        commandAllocator->reset();
+        commandList->reset(commandAllocator, nullptr);
+        encoder.clear();
+        for(size_t i = 0; i < drawCount; ++i)
+        {
+            auto offset = agpu_int(i & 63);
+            encoder.encode(AGPU_ENCODED_COMMAND_SET_VIEWPORT, offset, offset, 256, 256);
+            encoder.encode(AGPU_ENCODED_COMMAND_SET_SCISSOR, offset, offset, 128, 128);
+            encoder.encode(AGPU_ENCODED_COMMAND_SET_STENCIL_REFERENCE, agpu_uint(i & 255));
+            encoder.encode(AGPU_ENCODED_COMMAND_DRAW_ARRAYS, 3, 1, 0, 0);
+        }
+        executeEncodedCommands(commandList.get(), encoder.getData(), encoder.getSize());
+        commandList->close();
+    }
+
+    void decodeCommandList()
+    {
+        commandAllocator->reset();
+        commandList->reset(commandAllocator, nullptr);
+        commandList->executeEncodedCommands(encoder.getData(), encoder.getSize());
+        commandList->close();
+    }
+
+    template<typename FF, typename CM, typename PM, typename DB>
+    void recordStateTrackerPerCall(size_t drawCount, const FF &setFrontFace, const CM &setCullMode, const PM &setPolygonMode, const DB &setDepthBias)
+    {
+        stateTracker->beginRecordingCommands();
+        auto tracker = stateTracker.get();
+        for(size_t i = 0; i < drawCount; ++i)
+        {
+            setFrontFace(tracker, (i & 2) ? AGPU_CLOCKWISE : AGPU_COUNTER_CLOCKWISE);
+            setCullMode(tracker, (i & 1) ? AGPU_CULL_MODE_BACK : AGPU_CULL_MODE_NONE);
+            setPolygonMode(tracker, (i & 4) ? AGPU_POLYGON_MODE_LINE : AGPU_POLYGON_MODE_FILL);
+            setDepthBias(tracker, float(i & 7), 0.0f, 1.0f);
+        }
+        stateTracker->endRecordingCommands();
+    }
+
+    template<typename EF>
+    void recordStateTrackerBatched(size_t drawCount, const EF &executeEncodedCommands)
+    {
+        stateTracker->beginRecordingCommands();
+        encoder.clear();
+        for(size_t i = 0; i < drawCount; ++i)
+        {
+            encoder.encode(AGPU_ENCODED_COMMAND_SET_FRONT_FACE, (i & 2) ? AGPU_CLOCKWISE : AGPU_COUNTER_CLOCKWISE);
+            encoder.encode(AGPU_ENCODED_COMMAND_SET_CULL_MODE, (i & 1) ? AGPU_CULL_MODE_BACK : AGPU_CULL_MODE_NONE);
+            encoder.encode(AGPU_ENCODED_COMMAND_SET_POLYGON_MODE, (i & 4) ? AGPU_POLYGON_MODE_LINE : AGPU_POLYGON_MODE_FILL);
+            encoder.encode(AGPU_ENCODED_COMMAND_SET_DEPTH_BIAS, float(i & 7), 0.0f, 1.0f);
+        }
+        executeEncodedCommands(stateTracker.get(), encoder.getData(), encoder.getSize());
+        stateTracker->endRecordingCommands();
+    }
+
+    void decodeStateTracker()
+    {
+        stateTracker->beginRecordingCommands();
+        stateTracker->executeEncodedCommands(encoder.getData(), encoder.getSize());
+        stateTracker->endRecordingCommands();
+    }
+
+    CommandEncoder encoder;
+
+    agpu_command_allocator_ref commandAllocator;
+    agpu_command_list_ref commandList;
+    agpu_state_tracker_cache_ref stateTrackerCache;
+    agpu_state_tracker_ref stateTracker;
+};
+
+BENCHMARK_MAIN(BenchmarkEncodedCommands)
@@ -0,0 +1,153 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <vector>
+
+/**
+ * Renders and presents cleared frames through a headless swap chain, and
+ * reports the frame rate together with the frame pacing statistics. This
+ * requires a driver that supports presenting without a window system, such
+ * as the Vulkan backend with VK_EXT_headless_surface. With -fences, the
+ * reuse of each back buffer is also guarded by a fence that is signalled
+ * every frame, and the time that is spent in signalling is reported.
+ */
+class BenchmarkFramePacing : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto frameCount = parseSizeOption(argc, argv, "-frames", 600);
+        auto framesInFlight = parseSizeOption(argc, argv, "-frames-in-flight", 0);
+        auto width = parseSizeOption(argc, argv, "-width", 640);
+        auto height = parseSizeOption(argc, argv, "-height", 480);
+        useFences = hasOption(argc, argv, "-fences");
+        signalSeconds = 0;
+        fenceWaitSeconds = 0;
+
+        agpu_swap_chain_create_info swapChainCreateInfo;
+        memset(&swapChainCreateInfo, 0, sizeof(swapChainCreateInfo));
+        swapChainCreateInfo.window_system_name = "headless";
+        swapChainCreateInfo.colorbuffer_format = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
+        swapChainCreateInfo.depth_stencil_format = AGPU_TEXTURE_FORMAT_UNKNOWN;
+        swapChainCreateInfo.width = (agpu_uint)width;
+        swapChainCreateInfo.height = (agpu_uint)height;
+        swapChainCreateInfo.buffer_count = 3;
+        swapChainCreateInfo.frames_in_flight = (agpu_uint)framesInFlight;
+
+        swapChain = device->createSwapChain(commandQueue, &swapChainCreateInfo);
+        if(!swapChain)
+        {
+            printError("Failed to create the headless swap chain\n");
+            return -1;
+        }
+
+        // Clear render pass.
+        agpu_renderpass_color_attachment_description colorAttachment = {};
+        colorAttachment.format = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
+        colorAttachment.begin_action = AGPU_ATTACHMENT_CLEAR;
+        colorAttachment.end_action = AGPU_ATTACHMENT_KEEP;
+        colorAttachment.clear_value.g = 0.5f;
+        colorAttachment.clear_value.a = 1.0f;
+        colorAttachment.sample_count = 1;
+
+        agpu_renderpass_description description = {};
+        description.color_attachment_count = 1;
+        description.color_attachments = &colorAttachment;
+        mainRenderPass = device->createRenderPass(&description);
+
+        // One command list per back buffer, since the previous frames may still be in flight.
+        auto framebufferCount = swapChain->getFramebufferCount();
+        commandAllocators.resize(framebufferCount);
+        commandLists.resize(framebufferCount);
+        for(size_t i = 0; i < framebufferCount; ++i)
+        {
+            commandAllocators[i] = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+            commandLists[i] = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, commandAllocators[i], nullptr);
+            commandLists[i]->close();
+        }
+
+        if(useFences)
+        {
+            fences.resize(framebufferCount);
+            for(size_t i = 0; i < framebufferCount; ++i)
+                fences[i] = device->createFence();
+        }
+
+        // Warm up.
+        renderFrame();
+
+        signalSeconds = 0;
+        fenceWaitSeconds = 0;
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < frameCount; ++i)
+            renderFrame();
+        auto seconds = timer.elapsedSeconds();
+        commandQueue->finishExecution();
+
+        reportResult("headless frames", frameCount, seconds);
+
+        agpu_frame_pacing_statistics statistics;
+        memset(&statistics, 0, sizeof(statistics));
+        try
+        {
+            swapChain->getFramePacingStatistics(&statistics);
+            printMessage("Frames in flight: %u\n", statistics.frames_in_flight);
+            printMessage("Presented frames: %u\n", statistics.frame_count);
+            printMessage("CPU wait time: last %.3f ms, average %.3f ms, max %.3f ms\n",
+                statistics.last_cpu_wait_time, statistics.average_cpu_wait_time, statistics.max_cpu_wait_time);
+        }
+        catch(agpu_exception &e)
+        {
+            // The offscreen swap chains of the OpenGL backend do not pace their frames.
+            printMessage("Frame pacing statistics are not supported\n");
+        }
+        if(useFences && frameCount > 0)
+        {
+            printMessage("Fence signal time: average %.3f us\n", signalSeconds*1e6 / frameCount);
+            printMessage("Fence wait time: average %.3f ms\n", fenceWaitSeconds*1e3 / frameCount);
+        }
+        return 0;
+    }
+
+    void renderFrame()
+    {
+        auto backBufferIndex = swapChain->getCurrentBackBufferIndex();
+        auto &allocator = commandAllocators[backBufferIndex];
+        auto &list = commandLists[backBufferIndex];
+
+        // Wait for the previous frame that used this back buffer.
+        if(useFences)
+        {
+            BenchmarkTimer waitTimer;
+            fences[backBufferIndex]->waitOnClient();
+            fenceWaitSeconds += waitTimer.elapsedSeconds();
+        }
+
+        allocator->reset();
+        list->reset(allocator, nullptr);
+
+        auto backBuffer = swapChain->getCurrentBackBuffer();
+        list->beginRenderPass(mainRenderPass, backBuffer, false);
+        list->endRenderPass();
+        list->close();
+
+        commandQueue->addCommandList(list);
+        if(useFences)
+        {
+            BenchmarkTimer signalTimer;
+            commandQueue->signalFence(fences[backBufferIndex]);
+            signalSeconds += signalTimer.elapsedSeconds();
+        }
+        swapChain->swapBuffers();
+    }
+
+    agpu_swap_chain_ref swapChain;
+    agpu_renderpass_ref mainRenderPass;
+    std::vector<agpu_command_allocator_ref> commandAllocators;
+    std::vector<agpu_command_list_ref> commandLists;
+    std::vector<agpu_fence_ref> fences;
+    bool useFences;
+    double signalSeconds;
+    double fenceWaitSeconds;
+};
+
+BENCHMARK_MAIN(BenchmarkFramePacing)
@@ -0,0 +1,169 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * Opens several headless devices in the same process, like a server that
+ * renders thumbnails or batch jobs without any display, and renders cleared
+ * frames into an offscreen swap chain of each device from its own thread.
+ * The aggregated frame rate of all the devices is reported. On the OpenGL
+ * backend, the devices are created through EGL.
+ */
+class BenchmarkHeadlessDevices : public BenchmarkBase
+{
+public:
+    struct DeviceRenderer
+    {
+        agpu_device_ref device;
+        agpu_command_queue_ref commandQueue;
+        agpu_swap_chain_ref swapChain;
+        agpu_renderpass_ref renderPass;
+        std::vector<agpu_command_allocator_ref> commandAllocators;
+        std::vector<agpu_command_list_ref> commandLists;
+        std::vector<agpu_fence_ref> fences;
+    };
+
+    int run(int argc, const char **argv) override
+    {
+        auto deviceCount = parseSizeOption(argc, argv, "-devices", 4);
+        auto frameCount = parseSizeOption(argc, argv, "-frames", 300);
+        auto width = parseSizeOption(argc, argv, "-width", 640);
+        auto height = parseSizeOption(argc, argv, "-height", 480);
+
+        agpu_platform *platform = nullptr;
+        agpuGetPlatforms(1, &platform, nullptr);
+
+        BenchmarkTimer openTimer;
+        std::vector<DeviceRenderer> renderers(deviceCount);
+        for(auto &renderer : renderers)
+        {
+            agpu_device_open_info openInfo;
+            memset(&openInfo, 0, sizeof(openInfo));
+            openInfo.window_system_name = "headless";
+            renderer.device = platform->openDevice(&openInfo);
+            if(!renderer.device)
+            {
+                printError("Failed to open a headless device\n");
+                return -1;
+            }
+
+            if(!createRenderer(renderer, width, height))
+                return -1;
+        }
+        auto openSeconds = openTimer.elapsedSeconds();
+
+        // Warm up.
+        for(auto &renderer : renderers)
+        {
+            renderFrame(renderer);
+            renderer.commandQueue->finishExecution();
+        }
+
+        std::atomic_bool failed(false);
+        std::vector<std::thread> threads;
+        BenchmarkTimer timer;
+        for(auto &renderer : renderers)
+        {
+            auto rendererPointer = &renderer;
+            threads.push_back(std::thread([=, &failed] {
+                try
+                {
+                    for(size_t i = 0; i < frameCount; ++i)
+                        renderFrame(*rendererPointer);
+                    rendererPointer->commandQueue->finishExecution();
+                }
+                catch(agpu_exception &e)
+                {
+                    failed = true;
+                }
+            }));
+        }
+
+        for(auto &thread : threads)
+            thread.join();
+        auto seconds = timer.elapsedSeconds();
+        if(failed)
+        {
+            printError("Failed to render the headless frames\n");
+            return -1;
+        }
+
+        reportResult("device opens", deviceCount, openSeconds);
+        reportResult("headless frames", deviceCount*frameCount, seconds);
+        return 0;
+    }
+
+    bool createRenderer(DeviceRenderer &renderer, size_t width, size_t height)
+    {
+        auto &rendererDevice = renderer.device;
+        renderer.commandQueue = rendererDevice->getDefaultCommandQueue();
+
+        agpu_swap_chain_create_info swapChainCreateInfo;
+        memset(&swapChainCreateInfo, 0, sizeof(swapChainCreateInfo));
+        swapChainCreateInfo.window_system_name = "headless";
+        swapChainCreateInfo.colorbuffer_format = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
+        swapChainCreateInfo.depth_stencil_format = AGPU_TEXTURE_FORMAT_UNKNOWN;
+        swapChainCreateInfo.width = (agpu_uint)width;
+        swapChainCreateInfo.height = (agpu_uint)height;
+        swapChainCreateInfo.buffer_count = 3;
+
+        renderer.swapChain = rendererDevice->createSwapChain(renderer.commandQueue, &swapChainCreateInfo);
+        if(!renderer.swapChain)
+        {
+            printError("Failed to create the headless swap chain\n");
+            return false;
+        }
+
+        agpu_renderpass_color_attachment_description colorAttachment = {};
+        colorAttachment.format = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
+        colorAttachment.begin_action = AGPU_ATTACHMENT_CLEAR;
+        colorAttachment.end_action = AGPU_ATTACHMENT_KEEP;
+        colorAttachment.clear_value.b = 0.5f;
+        colorAttachment.clear_value.a = 1.0f;
+        colorAttachment.sample_count = 1;
+
+        agpu_renderpass_description description = {};
+        description.color_attachment_count = 1;
+        description.color_attachments = &colorAttachment;
+        renderer.renderPass = rendererDevice->createRenderPass(&description);
+
+        // One command list per back buffer, since the previous frames may still be in flight.
+        auto framebufferCount = renderer.swapChain->getFramebufferCount();
+        for(size_t i = 0; i < framebufferCount; ++i)
+        {
+            auto allocator = rendererDevice->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, renderer.commandQueue);
+            auto list = rendererDevice->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, allocator, nullptr);
+            list->close();
+            renderer.commandAllocators.push_back(allocator);
+            renderer.commandLists.push_back(list);
+            renderer.fences.push_back(rendererDevice->createFence());
+        }
+
+        return true;
+    }
+
+    static void renderFrame(DeviceRenderer &renderer)
+    {
+        auto backBufferIndex = renderer.swapChain->getCurrentBackBufferIndex();
+        auto &allocator = renderer.commandAllocators[backBufferIndex];
+        auto &list = renderer.commandLists[backBufferIndex];
+        auto &fence = renderer.fences[backBufferIndex];
+
+        // Wait for the previous frame that used this back buffer.
+        fence->waitOnClient();
+
+        allocator->reset();
+        list->reset(allocator, nullptr);
+        list->beginRenderPass(renderer.renderPass, renderer.swapChain->getCurrentBackBuffer(), false);
+        list->endRenderPass();
+        list->close();
+
+        renderer.commandQueue->addCommandList(list);
+        renderer.commandQueue->signalFence(fence);
+        renderer.swapChain->swapBuffers();
+    }
+};
+
+BENCHMARK_MAIN(BenchmarkHeadlessDevices)
@@ -0,0 +1,89 @@
+#include "BenchmarkBase.hpp"
+#include "../implementations/OpenGL/job_queue.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+using AgpuGL::JobQueue;
+
+/**
+ * Microbenchmark of the job queue that feeds the OpenGL main context thread.
+ * It measures the rate of fire and forget jobs that are submitted by several
+ * producers, and the round trip latency of the blocking jobs. It does not
+ * need a device.
+ */
+static void benchmarkThroughput(size_t producerCount, size_t jobCount)
+{
+    JobQueue queue;
+    queue.start();
+
+    std::atomic<size_t> executedJobCount(0);
+    auto jobsPerProducer = jobCount / producerCount;
+
+    BenchmarkTimer timer;
+    std::vector<std::thread> producers;
+    for(size_t i = 0; i < producerCount; ++i)
+    {
+        producers.push_back(std::thread([&] {
+            for(size_t j = 0; j < jobsPerProducer; ++j)
+            {
+                queue.addJob([&] {
+                    executedJobCount.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        }));
+    }
+
+    for(auto &producer : producers)
+        producer.join();
+    queue.runBlocking([] {});
+    auto seconds = timer.elapsedSeconds();
+
+    char name[64];
+    snprintf(name, sizeof(name), "jobs with %zu producers", producerCount);
+    BenchmarkBase::reportResult(name, executedJobCount.load(), seconds);
+    queue.shutdown();
+}
+
+static void benchmarkRoundTrip(size_t roundTripCount)
+{
+    JobQueue queue;
+    queue.start();
+
+    std::vector<double> latencies;
+    latencies.reserve(roundTripCount);
+
+    BenchmarkTimer totalTimer;
+    for(size_t i = 0; i < roundTripCount; ++i)
+    {
+        BenchmarkTimer timer;
+        queue.runBlocking([] {});
+        latencies.push_back(timer.elapsedSeconds());
+    }
+    auto seconds = totalTimer.elapsedSeconds();
+
+    BenchmarkBase::reportResult("blocking round trips", roundTripCount, seconds);
+    if(!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+        printMessage("Round trip latency: median %.3f us, p99 %.3f us, max %.3f us\n",
+            latencies[latencies.size()/2]*1e6,
+            latencies[latencies.size()*99/100]*1e6,
+            latencies.back()*1e6);
+    }
+
+    queue.shutdown();
+}
+
+int main(int argc, const char **argv)
+{
+    auto jobCount = BenchmarkBase::parseSizeOption(argc, argv, "-jobs", 1000000);
+    auto maxProducerCount = BenchmarkBase::parseSizeOption(argc, argv, "-producers", 4);
+    auto roundTripCount = BenchmarkBase::parseSizeOption(argc, argv, "-roundtrips", 100000);
+
+    for(size_t producerCount = 1; producerCount <= maxProducerCount; producerCount *= 2)
+        benchmarkThroughput(producerCount, jobCount);
+    benchmarkRoundTrip(roundTripCount);
+    return 0;
+}
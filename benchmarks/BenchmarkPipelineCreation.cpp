@@ -0,0 +1,132 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <vector>
+
+static const char *VertexShaderSource =
+    "#version 450\n"
+    "layout(location = 0) out vec2 fTexcoord;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 position = vec2(float(gl_VertexIndex & 1), float(gl_VertexIndex >> 1));\n"
+    "    fTexcoord = position;\n"
+    "    gl_Position = vec4(position*2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *FragmentShaderSource =
+    "#version 450\n"
+    "layout(set = 0, binding = 0) uniform MaterialState\n"
+    "{\n"
+    "    vec4 color;\n"
+    "} material;\n"
+    "layout(set = 1, binding = 0) uniform texture2D albedoTexture;\n"
+    "layout(set = 2, binding = 0) uniform sampler albedoSampler;\n"
+    "layout(location = 0) in vec2 fTexcoord;\n"
+    "layout(location = 0) out vec4 fbColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fbColor = material.color*texture(sampler2D(albedoTexture, albedoSampler), fTexcoord);\n"
+    "}\n";
+
+/**
+ * Measures the time for creating pipelines whose shaders are created from the
+ * same Spir-V modules, like the permutations that are created by an immediate
+ * renderer. On the OpenGL backend, the translation of Spir-V into GLSL can be
+ * disabled with the DISABLE_GLSL_TRANSLATION_CACHE environment variable for
+ * comparison.
+ */
+class BenchmarkPipelineCreation : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto pipelineCount = parseSizeOption(argc, argv, "-pipelines", 200);
+
+        auto shaderSignatureBuilder = device->createShaderSignatureBuilder();
+        shaderSignatureBuilder->beginBindingBank(1);
+        shaderSignatureBuilder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_UNIFORM_BUFFER, 1);
+        shaderSignatureBuilder->beginBindingBank(1);
+        shaderSignatureBuilder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_SAMPLED_IMAGE, 1);
+        shaderSignatureBuilder->beginBindingBank(1);
+        shaderSignatureBuilder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_SAMPLER, 1);
+        shaderSignature = shaderSignatureBuilder->build();
+
+        if(!compileIntoSpirV(AGPU_VERTEX_SHADER, VertexShaderSource, vertexShaderModule) ||
+            !compileIntoSpirV(AGPU_FRAGMENT_SHADER, FragmentShaderSource, fragmentShaderModule))
+            return -1;
+
+        vertexLayout = device->createVertexLayout();
+
+        // Warm up.
+        if(!createPipeline())
+            return -1;
+
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < pipelineCount; ++i)
+        {
+            if(!createPipeline())
+                return -1;
+        }
+        auto seconds = timer.elapsedSeconds();
+
+        reportResult("pipelines", pipelineCount, seconds);
+        return 0;
+    }
+
+    bool compileIntoSpirV(agpu_shader_type type, const char *source, std::vector<char> &module)
+    {
+        agpu_offline_shader_compiler_ref shaderCompiler = device->createOfflineShaderCompiler();
+        shaderCompiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, type, source, (agpu_string_length)strlen(source));
+        try
+        {
+            shaderCompiler->compileShader(AGPU_SHADER_LANGUAGE_SPIR_V, nullptr);
+        }
+        catch(agpu_exception &e)
+        {
+            std::vector<char> log(shaderCompiler->getCompilationLogLength() + 1);
+            shaderCompiler->getCompilationLog(log.size(), &log[0]);
+            printError("Shader compilation error:%s\n", &log[0]);
+            return false;
+        }
+
+        module.resize(shaderCompiler->getCompilationResultLength());
+        shaderCompiler->getCompilationResult(module.size(), &module[0]);
+        return true;
+    }
+
+    agpu_shader_ref createShader(agpu_shader_type type, std::vector<char> &module)
+    {
+        auto shader = device->createShader(type);
+        shader->setShaderSource(AGPU_SHADER_LANGUAGE_SPIR_V, &module[0], (agpu_string_length)module.size());
+        shader->compileShader(nullptr);
+        return shader;
+    }
+
+    bool createPipeline()
+    {
+        // Each permutation gets its own shader objects, with identical modules.
+        auto builder = device->createPipelineBuilder();
+        builder->setShaderSignature(shaderSignature);
+        builder->attachShader(createShader(AGPU_VERTEX_SHADER, vertexShaderModule));
+        builder->attachShader(createShader(AGPU_FRAGMENT_SHADER, fragmentShaderModule));
+        builder->setVertexLayout(vertexLayout);
+        builder->setRenderTargetFormat(0, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        builder->setDepthStencilFormat(AGPU_TEXTURE_FORMAT_UNKNOWN);
+        builder->setPrimitiveType(AGPU_TRIANGLE_STRIP);
+
+        auto pipeline = builder->build();
+        if(!pipeline)
+        {
+            printError("Failed to build a pipeline state\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    agpu_shader_signature_ref shaderSignature;
+    agpu_vertex_layout_ref vertexLayout;
+    std::vector<char> vertexShaderModule;
+    std::vector<char> fragmentShaderModule;
+};
+
+BENCHMARK_MAIN(BenchmarkPipelineCreation)
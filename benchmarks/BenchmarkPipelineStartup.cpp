@@ -0,0 +1,157 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static const char *VertexShaderSource =
+    "#version 450\n"
+    "layout(location = 0) out vec2 fTexcoord;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 position = vec2(float(gl_VertexIndex & 1), float(gl_VertexIndex >> 1));\n"
+    "    fTexcoord = position;\n"
+    "    gl_Position = vec4(position*2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *FragmentShaderTemplate =
+    "#version 450\n"
+    "layout(location = 0) in vec2 fTexcoord;\n"
+    "layout(location = 0) out vec4 fbColor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 p = fTexcoord;\n"
+    "    for(int i = 0; i < %d; ++i)\n"
+    "        p = vec2(p.x*p.x - p.y*p.y, 2.0*p.x*p.y) + vec2(%d.0/1024.0, 0.25);\n"
+    "    fbColor = vec4(p, float(%d)/1024.0, 1.0);\n"
+    "}\n";
+
+/**
+ * Measures the startup time of an application that creates many different
+ * pipelines from several threads, where every pipeline has its own program.
+ * The Spir-V modules are produced before the measurement, so that only the
+ * creation of the pipelines by the backend is timed. On the OpenGL backend,
+ * the number of shader compiler contexts can be selected with the
+ * SHADER_COMPILER_THREADS environment variable, where zero compiles all the
+ * programs in the main context.
+ */
+class BenchmarkPipelineStartup : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto pipelineCount = parseSizeOption(argc, argv, "-pipelines", 64);
+        auto threadCount = std::max(parseSizeOption(argc, argv, "-threads", 4), size_t(1));
+
+        shaderSignature = device->createShaderSignatureBuilder()->build();
+        vertexLayout = device->createVertexLayout();
+
+        if(!compileIntoSpirV(AGPU_VERTEX_SHADER, VertexShaderSource, vertexShaderModule))
+            return -1;
+
+        // Every pipeline gets a different fragment shader, so that nothing can
+        // be shared between them.
+        fragmentShaderModules.resize(pipelineCount + 1);
+        for(size_t i = 0; i <= pipelineCount; ++i)
+        {
+            char source[1024];
+            snprintf(source, sizeof(source), FragmentShaderTemplate, int(4 + i % 8), int(i), int(i));
+            if(!compileIntoSpirV(AGPU_FRAGMENT_SHADER, source, fragmentShaderModules[i]))
+                return -1;
+        }
+
+        // Warm up.
+        if(!createPipeline(pipelineCount))
+            return -1;
+
+        std::atomic_size_t nextPipeline(0);
+        std::atomic_bool failed(false);
+        std::vector<std::thread> threads;
+
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < threadCount; ++i)
+        {
+            threads.push_back(std::thread([&] {
+                for(;;)
+                {
+                    auto index = nextPipeline.fetch_add(1);
+                    if(index >= pipelineCount)
+                        return;
+
+                    if(!createPipeline(index))
+                        failed = true;
+                }
+            }));
+        }
+
+        for(auto &thread : threads)
+            thread.join();
+        auto seconds = timer.elapsedSeconds();
+
+        if(failed)
+            return -1;
+
+        reportResult("pipelines", pipelineCount, seconds);
+        printMessage("Threads: %d\n", int(threadCount));
+        return 0;
+    }
+
+    bool compileIntoSpirV(agpu_shader_type type, const char *source, std::vector<char> &module)
+    {
+        agpu_offline_shader_compiler_ref shaderCompiler = device->createOfflineShaderCompiler();
+        shaderCompiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, type, source, (agpu_string_length)strlen(source));
+        try
+        {
+            shaderCompiler->compileShader(AGPU_SHADER_LANGUAGE_SPIR_V, nullptr);
+        }
+        catch(agpu_exception &e)
+        {
+            std::vector<char> log(shaderCompiler->getCompilationLogLength() + 1);
+            shaderCompiler->getCompilationLog(log.size(), &log[0]);
+            printError("Shader compilation error:%s\n", &log[0]);
+            return false;
+        }
+
+        module.resize(shaderCompiler->getCompilationResultLength());
+        shaderCompiler->getCompilationResult(module.size(), &module[0]);
+        return true;
+    }
+
+    agpu_shader_ref createShader(agpu_shader_type type, std::vector<char> &module)
+    {
+        auto shader = device->createShader(type);
+        shader->setShaderSource(AGPU_SHADER_LANGUAGE_SPIR_V, &module[0], (agpu_string_length)module.size());
+        shader->compileShader(nullptr);
+        return shader;
+    }
+
+    bool createPipeline(size_t index)
+    {
+        auto builder = device->createPipelineBuilder();
+        builder->setShaderSignature(shaderSignature);
+        builder->attachShader(createShader(AGPU_VERTEX_SHADER, vertexShaderModule));
+        builder->attachShader(createShader(AGPU_FRAGMENT_SHADER, fragmentShaderModules[index]));
+        builder->setVertexLayout(vertexLayout);
+        builder->setRenderTargetFormat(0, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        builder->setDepthStencilFormat(AGPU_TEXTURE_FORMAT_UNKNOWN);
+        builder->setPrimitiveType(AGPU_TRIANGLE_STRIP);
+
+        auto pipeline = builder->build();
+        if(!pipeline)
+        {
+            printError("Failed to build a pipeline state\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    agpu_shader_signature_ref shaderSignature;
+    agpu_vertex_layout_ref vertexLayout;
+    std::vector<char> vertexShaderModule;
+    std::vector<std::vector<char>> fragmentShaderModules;
+};
+
+BENCHMARK_MAIN(BenchmarkPipelineStartup)
@@ -0,0 +1,91 @@
+#include "BenchmarkBase.hpp"
+#include "ImmediateShaderVariants.hpp"
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * Compares the time that is needed for getting the shaders of the immediate
+ * renderer at startup, by compiling them from their sources, and by creating
+ * them from a shader archive that is built by AgpuShaderPackBuilder. The
+ * archive of the immediate renderer shaders is built with the benchmarks, and
+ * another archive can be given with the -archive option. The sources have a
+ * unique header, so that the compilations are not served by the Spir-V cache.
+ */
+class BenchmarkShaderArchive : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto archivePath = getArchivePath(argc, argv);
+
+        // Compile the shaders from their sources.
+        auto header = "// " + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "\n";
+        auto shaderVariants = makeImmediateShaderVariants(header);
+        std::vector<agpu_shader_ref> compiledShaders;
+
+        BenchmarkTimer timer;
+        for(auto &variant : shaderVariants)
+        {
+            agpu_offline_shader_compiler_ref compiler = device->createOfflineShaderCompiler();
+            compiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, variant.type, variant.source.c_str(), (agpu_string_length)variant.source.size());
+            try
+            {
+                compiler->compileShader(AGPU_SHADER_LANGUAGE_DEVICE_SHADER, nullptr);
+            }
+            catch(agpu_exception &e)
+            {
+                printError("Failed to compile an immediate renderer shader\n");
+                return -1;
+            }
+
+            compiledShaders.push_back(compiler->getResultAsShader());
+        }
+        auto compilationSeconds = timer.elapsedSeconds();
+
+        // Create the shaders from the archive.
+        std::vector<agpu_shader_ref> archiveShaders;
+        timer.reset();
+        agpu_shader_archive_ref archive = device->openShaderArchive(archivePath.c_str());
+        if(!archive)
+        {
+            printError("Failed to open the shader archive %s\n", archivePath.c_str());
+            return -1;
+        }
+
+        auto shaderCount = archive->getShaderCount();
+        for(agpu_size i = 0; i < shaderCount; ++i)
+        {
+            agpu_shader_ref shader = archive->createShader(i);
+            if(!shader)
+            {
+                printError("Failed to create the shader %s from the archive\n", archive->getShaderName(i));
+                return -1;
+            }
+
+            archiveShaders.push_back(shader);
+        }
+        auto archiveSeconds = timer.elapsedSeconds();
+
+        reportResult("shaders compiled from source", compiledShaders.size(), compilationSeconds);
+        reportResult("shaders created from the archive", archiveShaders.size(), archiveSeconds);
+        return 0;
+    }
+
+    std::string getArchivePath(int argc, const char **argv)
+    {
+        for(int i = 1; i + 1 < argc; ++i)
+        {
+            if(std::string(argv[i]) == "-archive")
+                return argv[i + 1];
+        }
+
+        // The default archive is next to the benchmark.
+        std::string executablePath = argv[0];
+        auto separator = executablePath.find_last_of("/\\");
+        auto directory = separator != std::string::npos ? executablePath.substr(0, separator + 1) : std::string();
+        return directory + "ImmediateShaders.shaderpack";
+    }
+};
+
+BENCHMARK_MAIN(BenchmarkShaderArchive)
@@ -0,0 +1,75 @@
+#include "BenchmarkBase.hpp"
+#include "ImmediateShaderVariants.hpp"
+#include <string.h>
+
+/**
+ * Compiles all the variants of the shaders of the immediate renderer into
+ * Spir-V several times. The first pass is cold, and the following passes are
+ * served by the Spir-V cache of the offline shader compiler. When the
+ * SPIRV_CACHE_DIR environment variable is set, the first pass of the next run
+ * is served from the disk instead. The cache can be disabled with the
+ * DISABLE_SPIRV_CACHE environment variable for comparison.
+ */
+class BenchmarkShaderCache : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto passCount = parseSizeOption(argc, argv, "-passes", 3);
+        if(passCount < 2)
+            passCount = 2;
+
+        shaderVariants = makeImmediateShaderVariants();
+
+        BenchmarkTimer timer;
+        if(!compileShaderVariants())
+            return -1;
+        auto coldSeconds = timer.elapsedSeconds();
+
+        timer.reset();
+        for(size_t i = 1; i < passCount; ++i)
+        {
+            if(!compileShaderVariants())
+                return -1;
+        }
+        auto warmSeconds = timer.elapsedSeconds();
+
+        reportResult("cold shader compilations", shaderVariants.size(), coldSeconds);
+        reportResult("warm shader compilations", shaderVariants.size()*(passCount - 1), warmSeconds);
+
+        agpu_offline_shader_compiler_ref compiler = device->createOfflineShaderCompiler();
+        agpu_shader_compilation_statistics statistics;
+        memset(&statistics, 0, sizeof(statistics));
+        compiler->getCompilationStatistics(&statistics);
+        printMessage("Compilations: %u, memory cache hits: %u, disk cache hits: %u, cache misses: %u, cached shaders: %u\n",
+            statistics.compilation_count, statistics.memory_cache_hit_count, statistics.disk_cache_hit_count,
+            statistics.cache_miss_count, statistics.cached_shader_count);
+        printMessage("Compilation time: %.3f ms, cache lookup time: %.3f ms\n",
+            statistics.total_compilation_time, statistics.total_cache_lookup_time);
+        return 0;
+    }
+
+    bool compileShaderVariants()
+    {
+        for(auto &variant : shaderVariants)
+        {
+            agpu_offline_shader_compiler_ref compiler = device->createOfflineShaderCompiler();
+            compiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, variant.type, variant.source.c_str(), (agpu_string_length)variant.source.size());
+            try
+            {
+                compiler->compileShader(AGPU_SHADER_LANGUAGE_SPIR_V, nullptr);
+            }
+            catch(agpu_exception &e)
+            {
+                printError("Failed to compile an immediate renderer shader\n");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<ImmediateShaderVariant> shaderVariants;
+};
+
+BENCHMARK_MAIN(BenchmarkShaderCache)
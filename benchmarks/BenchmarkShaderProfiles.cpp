@@ -0,0 +1,172 @@
+#include "BenchmarkBase.hpp"
+#include "ImmediateShaderVariants.hpp"
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+struct ImmediateVertex
+{
+    float texcoord[2];
+    float normal[3];
+    float position[3];
+    float color[4];
+};
+
+/**
+ * Compiles the shaders of the immediate renderer with each one of the
+ * compilation profiles of the offline shader compiler, and compares the size
+ * of the Spir-V modules and the time that is spent by the backend creating
+ * pipelines from them. On the OpenGL backend, this includes translating the
+ * modules into GLSL and linking them. Each profile compiles the shaders with
+ * a different salt, so that its modules are always different from the ones
+ * of the other profiles, and nothing is shared between them by the caches of
+ * the backend.
+ */
+class BenchmarkShaderProfiles : public BenchmarkBase
+{
+public:
+    struct ProfileDescription
+    {
+        agpu_offline_shader_compilation_profile profile;
+        const char *name;
+    };
+
+    int run(int argc, const char **argv) override
+    {
+        static const ProfileDescription profiles[] = {
+            {AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_DEBUG, "debug"},
+            {AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_RELEASE, "release"},
+            {AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_SIZE, "size"},
+        };
+
+        if(!createPipelineObjects())
+            return -1;
+
+        int salt = 0;
+        for(auto &profile : profiles)
+        {
+            auto variants = makeImmediateShaderVariants(std::string(), ++salt);
+
+            std::vector<std::vector<char>> modules(variants.size());
+            size_t totalModuleSize = 0;
+            BenchmarkTimer timer;
+            for(size_t i = 0; i < variants.size(); ++i)
+            {
+                if(!compileIntoSpirV(variants[i], profile.profile, modules[i]))
+                    return -1;
+                totalModuleSize += modules[i].size();
+            }
+            auto compilationSeconds = timer.elapsedSeconds();
+
+            auto vertexShaderCount = variants.size() / 2;
+            size_t pipelineCount = 0;
+            timer.reset();
+            for(size_t i = 0; i < vertexShaderCount; ++i)
+            {
+                if(variants[i].skinningEnabled)
+                    continue;
+
+                if(!createPipeline(modules[i], modules[vertexShaderCount + i]))
+                    return -1;
+                ++pipelineCount;
+            }
+            auto pipelineSeconds = timer.elapsedSeconds();
+
+            printMessage("Profile %s: %d modules, %.1f KB in total, %.1f KB per module\n", profile.name,
+                int(modules.size()), totalModuleSize / 1024.0, totalModuleSize / 1024.0 / modules.size());
+            reportResult("shader compilations", modules.size(), compilationSeconds);
+            reportResult("pipelines", pipelineCount, pipelineSeconds);
+        }
+
+        return 0;
+    }
+
+    // The same objects that are used by the immediate renderer.
+    bool createPipelineObjects()
+    {
+        auto builder = device->createShaderSignatureBuilder();
+        builder->beginBindingBank(1);
+        builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_SAMPLER, 2);
+        static const agpu_uint uniformBufferBankCapacities[] = {1000, 1000, 100000, 100000, 1000};
+        for(auto capacity : uniformBufferBankCapacities)
+        {
+            builder->beginBindingBank(capacity);
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_UNIFORM_BUFFER, 1);
+        }
+        builder->beginBindingBank(1000);
+        builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_SAMPLED_IMAGE, 1);
+        shaderSignature = builder->build();
+        if(!shaderSignature)
+        {
+            printError("Failed to build the shader signature\n");
+            return false;
+        }
+
+        agpu_vertex_attrib_description attributes[] = {
+            {0, AGPU_IMMEDIATE_RENDERER_VERTEX_ATTRIBUTE_POSITION, AGPU_TEXTURE_FORMAT_R32G32B32_FLOAT, offsetof(ImmediateVertex, position), 0},
+            {0, AGPU_IMMEDIATE_RENDERER_VERTEX_ATTRIBUTE_COLOR, AGPU_TEXTURE_FORMAT_R32G32B32A32_FLOAT, offsetof(ImmediateVertex, color), 0},
+            {0, AGPU_IMMEDIATE_RENDERER_VERTEX_ATTRIBUTE_NORMAL, AGPU_TEXTURE_FORMAT_R32G32B32_FLOAT, offsetof(ImmediateVertex, normal), 0},
+            {0, AGPU_IMMEDIATE_RENDERER_VERTEX_ATTRIBUTE_TEXCOORD, AGPU_TEXTURE_FORMAT_R32G32_FLOAT, offsetof(ImmediateVertex, texcoord), 0},
+        };
+        agpu_size stride = sizeof(ImmediateVertex);
+        vertexLayout = device->createVertexLayout();
+        vertexLayout->addVertexAttributeBindings(1, &stride, sizeof(attributes) / sizeof(attributes[0]), attributes);
+        return true;
+    }
+
+    bool compileIntoSpirV(const ImmediateShaderVariant &variant, agpu_offline_shader_compilation_profile profile, std::vector<char> &module)
+    {
+        agpu_offline_shader_compiler_ref shaderCompiler = device->createOfflineShaderCompiler();
+        shaderCompiler->setCompilationProfile(profile);
+        shaderCompiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, variant.type, variant.source.c_str(), (agpu_string_length)variant.source.size());
+        try
+        {
+            shaderCompiler->compileShader(AGPU_SHADER_LANGUAGE_SPIR_V, nullptr);
+        }
+        catch(agpu_exception &e)
+        {
+            std::vector<char> log(shaderCompiler->getCompilationLogLength() + 1);
+            shaderCompiler->getCompilationLog(log.size(), &log[0]);
+            printError("Shader compilation error:%s\n", &log[0]);
+            return false;
+        }
+
+        module.resize(shaderCompiler->getCompilationResultLength());
+        shaderCompiler->getCompilationResult(module.size(), &module[0]);
+        return true;
+    }
+
+    agpu_shader_ref createShader(agpu_shader_type type, std::vector<char> &module)
+    {
+        auto shader = device->createShader(type);
+        shader->setShaderSource(AGPU_SHADER_LANGUAGE_SPIR_V, &module[0], (agpu_string_length)module.size());
+        shader->compileShader(nullptr);
+        return shader;
+    }
+
+    bool createPipeline(std::vector<char> &vertexModule, std::vector<char> &fragmentModule)
+    {
+        auto builder = device->createPipelineBuilder();
+        builder->setShaderSignature(shaderSignature);
+        builder->attachShader(createShader(AGPU_VERTEX_SHADER, vertexModule));
+        builder->attachShader(createShader(AGPU_FRAGMENT_SHADER, fragmentModule));
+        builder->setVertexLayout(vertexLayout);
+        builder->setRenderTargetFormat(0, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        builder->setDepthStencilFormat(AGPU_TEXTURE_FORMAT_D32_FLOAT);
+        builder->setPrimitiveType(AGPU_TRIANGLES);
+
+        auto pipeline = builder->build();
+        if(!pipeline)
+        {
+            printError("Failed to build a pipeline state\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    agpu_shader_signature_ref shaderSignature;
+    agpu_vertex_layout_ref vertexLayout;
+};
+
+BENCHMARK_MAIN(BenchmarkShaderProfiles)
@@ -0,0 +1,180 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <vector>
+
+static const char *VertexShaderSource =
+    "#version 450\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 position = vec2(float(gl_VertexIndex & 1), float(gl_VertexIndex >> 1))*2.0 - 1.0;\n"
+    "    gl_Position = vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *FragmentShaderSource =
+    "#version 450\n"
+    "layout(location = 0) out vec4 fbColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fbColor = vec4(1.0, 0.5, 0.25, 0.5);\n"
+    "}\n";
+
+/**
+ * Records frames that alternate between pipelines which only differ in a few
+ * fixed function states, and reports the number of state changes that reach
+ * the driver per draw call. On the OpenGL backend, the state cache can be
+ * disabled with the DISABLE_STATE_CACHE environment variable for comparison.
+ */
+class BenchmarkStateChanges : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto frameCount = parseSizeOption(argc, argv, "-frames", 200);
+        auto drawCount = parseSizeOption(argc, argv, "-draws", 1000);
+        auto pipelineCount = parseSizeOption(argc, argv, "-pipelines", 4);
+
+        framebuffer = createOffscreenFramebuffer(256, 256, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        if(!framebuffer)
+        {
+            printError("Failed to create the offscreen framebuffer\n");
+            return -1;
+        }
+
+        agpu_renderpass_color_attachment_description colorAttachment = {};
+        colorAttachment.format = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
+        colorAttachment.begin_action = AGPU_ATTACHMENT_CLEAR;
+        colorAttachment.end_action = AGPU_ATTACHMENT_KEEP;
+        colorAttachment.sample_count = 1;
+
+        agpu_renderpass_description renderPassDescription = {};
+        renderPassDescription.color_attachment_count = 1;
+        renderPassDescription.color_attachments = &colorAttachment;
+        renderPass = device->createRenderPass(&renderPassDescription);
+
+        // The vertices are generated in the vertex shader.
+        vertexLayout = device->createVertexLayout();
+        vertexBinding = device->createVertexBinding(vertexLayout);
+
+        if(!createPipelines(pipelineCount))
+            return -1;
+
+        commandAllocator = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+        commandList = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr);
+        commandList->close();
+
+        // Warm up.
+        renderFrame(drawCount);
+        commandQueue->finishExecution();
+
+        agpu_device_object_statistics startStatistics;
+        memset(&startStatistics, 0, sizeof(startStatistics));
+        bool hasStatistics = true;
+        try
+        {
+            device->getObjectStatistics(&startStatistics);
+        }
+        catch(agpu_exception &e)
+        {
+            hasStatistics = false;
+        }
+
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < frameCount; ++i)
+            renderFrame(drawCount);
+        commandQueue->finishExecution();
+        auto seconds = timer.elapsedSeconds();
+
+        reportResult("frames", frameCount, seconds);
+        reportResult("draws", frameCount*drawCount, seconds);
+
+        if(hasStatistics)
+        {
+            agpu_device_object_statistics endStatistics;
+            memset(&endStatistics, 0, sizeof(endStatistics));
+            device->getObjectStatistics(&endStatistics);
+
+            auto totalDraws = double(frameCount*drawCount);
+            auto stateChanges = endStatistics.state_change_count - startStatistics.state_change_count;
+            auto redundantStateChanges = endStatistics.redundant_state_change_count - startStatistics.redundant_state_change_count;
+            printMessage("State changes per draw: %.2f issued, %.2f skipped\n",
+                stateChanges / totalDraws, redundantStateChanges / totalDraws);
+        }
+
+        return 0;
+    }
+
+    bool createPipelines(size_t pipelineCount)
+    {
+        auto shaderSignatureBuilder = device->createShaderSignatureBuilder();
+        shaderSignature = shaderSignatureBuilder->build();
+
+        auto vertexShader = compileShaderFromSource(AGPU_VERTEX_SHADER, VertexShaderSource);
+        auto fragmentShader = compileShaderFromSource(AGPU_FRAGMENT_SHADER, FragmentShaderSource);
+        if(!vertexShader || !fragmentShader)
+            return false;
+
+        for(size_t i = 0; i < pipelineCount; ++i)
+        {
+            // The pipelines share most of their state.
+            auto builder = device->createPipelineBuilder();
+            builder->setShaderSignature(shaderSignature);
+            builder->attachShader(vertexShader);
+            builder->attachShader(fragmentShader);
+            builder->setVertexLayout(vertexLayout);
+            builder->setRenderTargetFormat(0, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+            builder->setDepthStencilFormat(AGPU_TEXTURE_FORMAT_UNKNOWN);
+            builder->setPrimitiveType(AGPU_TRIANGLE_STRIP);
+            builder->setCullMode((i & 1) ? AGPU_CULL_MODE_BACK : AGPU_CULL_MODE_NONE);
+            if(i & 2)
+            {
+                builder->setBlendState(-1, true);
+                builder->setBlendFunction(-1,
+                    AGPU_BLENDING_SRC_ALPHA, AGPU_BLENDING_INVERTED_SRC_ALPHA, AGPU_BLENDING_OPERATION_ADD,
+                    AGPU_BLENDING_ONE, AGPU_BLENDING_INVERTED_SRC_ALPHA, AGPU_BLENDING_OPERATION_ADD);
+            }
+
+            auto pipeline = builder->build();
+            if(!pipeline)
+            {
+                printError("Failed to build a pipeline state\n");
+                return false;
+            }
+
+            pipelines.push_back(pipeline);
+        }
+
+        return true;
+    }
+
+    void renderFrame(size_t drawCount)
+    {
+        commandAllocator->reset();
+        commandList->reset(commandAllocator, nullptr);
+        commandList->setShaderSignature(shaderSignature);
+        commandList->beginRenderPass(renderPass, framebuffer, false);
+        commandList->setViewport(0, 0, 256, 256);
+        commandList->setScissor(0, 0, 256, 256);
+        commandList->useVertexBinding(vertexBinding);
+
+        for(size_t i = 0; i < drawCount; ++i)
+        {
+            commandList->usePipelineState(pipelines[i % pipelines.size()]);
+            commandList->drawArrays(4, 1, 0, 0);
+        }
+
+        commandList->endRenderPass();
+        commandList->close();
+        commandQueue->addCommandList(commandList);
+    }
+
+    agpu_framebuffer_ref framebuffer;
+    agpu_renderpass_ref renderPass;
+    agpu_shader_signature_ref shaderSignature;
+    agpu_vertex_layout_ref vertexLayout;
+    agpu_vertex_binding_ref vertexBinding;
+    std::vector<agpu_pipeline_state_ref> pipelines;
+    agpu_command_allocator_ref commandAllocator;
+    agpu_command_list_ref commandList;
+};
+
+BENCHMARK_MAIN(BenchmarkStateChanges)
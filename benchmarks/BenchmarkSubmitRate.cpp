@@ -0,0 +1,94 @@
+#include "BenchmarkBase.hpp"
+#include <vector>
+
+/**
+ * Measures the cost of submitting many small command lists per frame, both
+ * one by one and through a single addCommandLists call. The end of each
+ * frame is waited with waitOnClient, and also by polling isSignaled, which
+ * must not block the submitting thread.
+ */
+class BenchmarkSubmitRate : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto listCount = parseSizeOption(argc, argv, "-lists", 32);
+        auto frameCount = parseSizeOption(argc, argv, "-frames", 1000);
+
+        auto allocator = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+        commandLists.resize(listCount);
+        for(auto &list : commandLists)
+        {
+            list = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, allocator, nullptr);
+            list->close();
+        }
+
+        fence = device->createFence();
+
+        // Warm up.
+        submitFrameIndividually();
+        submitFrameBatched();
+
+        {
+            BenchmarkTimer timer;
+            for(size_t i = 0; i < frameCount; ++i)
+                submitFrameIndividually();
+            auto seconds = timer.elapsedSeconds();
+            reportResult("addCommandList frames", frameCount, seconds);
+            reportResult("addCommandList command lists", frameCount*listCount, seconds);
+        }
+
+        {
+            BenchmarkTimer timer;
+            for(size_t i = 0; i < frameCount; ++i)
+                submitFrameBatched();
+            auto seconds = timer.elapsedSeconds();
+            reportResult("addCommandLists frames", frameCount, seconds);
+            reportResult("addCommandLists command lists", frameCount*listCount, seconds);
+        }
+
+        {
+            size_t pollCount = 0;
+            BenchmarkTimer timer;
+            for(size_t i = 0; i < frameCount; ++i)
+                pollCount += submitFramePolled();
+            auto seconds = timer.elapsedSeconds();
+            reportResult("polled frames", frameCount, seconds);
+            printMessage("isSignaled calls per frame: %.1f\n", double(pollCount) / double(frameCount));
+        }
+
+        commandQueue->finishExecution();
+        return 0;
+    }
+
+    void submitFrameIndividually()
+    {
+        for(auto &list : commandLists)
+            commandQueue->addCommandList(list);
+        commandQueue->signalFence(fence);
+        fence->waitOnClient();
+    }
+
+    void submitFrameBatched()
+    {
+        commandQueue->addCommandLists((agpu_uint)commandLists.size(), &commandLists[0]);
+        commandQueue->signalFence(fence);
+        fence->waitOnClient();
+    }
+
+    size_t submitFramePolled()
+    {
+        commandQueue->addCommandLists((agpu_uint)commandLists.size(), &commandLists[0]);
+        commandQueue->signalFence(fence);
+
+        size_t pollCount = 1;
+        while(!fence->isSignaled())
+            ++pollCount;
+        return pollCount;
+    }
+
+    std::vector<agpu_command_list_ref> commandLists;
+    agpu_fence_ref fence;
+};
+
+BENCHMARK_MAIN(BenchmarkSubmitRate)
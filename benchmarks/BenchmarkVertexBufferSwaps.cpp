@@ -0,0 +1,194 @@
+#include "BenchmarkBase.hpp"
+#include <algorithm>
+#include <stddef.h>
+#include <vector>
+
+static const char *VertexShaderSource =
+    "#version 450\n"
+    "layout(location = 0) in vec2 vPosition;\n"
+    "layout(location = 1) in vec4 vColor;\n"
+    "layout(location = 0) out vec4 fColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fColor = vColor;\n"
+    "    gl_Position = vec4(vPosition, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *FragmentShaderSource =
+    "#version 450\n"
+    "layout(location = 0) in vec4 fColor;\n"
+    "layout(location = 0) out vec4 fbColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fbColor = fColor;\n"
+    "}\n";
+
+struct SwappedVertex
+{
+    float x, y;
+    float r, g, b, a;
+};
+
+/**
+ * Draws small meshes that have the same vertex layout, but that live in
+ * different vertex buffers, so that the vertex buffers are swapped between all
+ * of the draws. The buffers of every binding are also replaced in each frame.
+ * On the OpenGL backend, the separate attribute formats can be disabled with
+ * the DISABLE_VERTEX_ATTRIB_BINDING environment variable for comparison.
+ */
+class BenchmarkVertexBufferSwaps : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto frameCount = parseSizeOption(argc, argv, "-frames", 200);
+        auto drawCount = parseSizeOption(argc, argv, "-draws", 2000);
+        auto bindingCount = std::max(parseSizeOption(argc, argv, "-bindings", 16), size_t(1));
+
+        framebuffer = createOffscreenFramebuffer(256, 256, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        if(!framebuffer)
+        {
+            printError("Failed to create the offscreen framebuffer\n");
+            return -1;
+        }
+
+        agpu_renderpass_color_attachment_description colorAttachment = {};
+        colorAttachment.format = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
+        colorAttachment.begin_action = AGPU_ATTACHMENT_CLEAR;
+        colorAttachment.end_action = AGPU_ATTACHMENT_KEEP;
+        colorAttachment.sample_count = 1;
+
+        agpu_renderpass_description renderPassDescription = {};
+        renderPassDescription.color_attachment_count = 1;
+        renderPassDescription.color_attachments = &colorAttachment;
+        renderPass = device->createRenderPass(&renderPassDescription);
+
+        agpu_vertex_attrib_description attributes[2] = {};
+        attributes[0].buffer = 0;
+        attributes[0].binding = 0;
+        attributes[0].format = AGPU_TEXTURE_FORMAT_R32G32_FLOAT;
+        attributes[0].offset = offsetof(SwappedVertex, x);
+        attributes[1].buffer = 0;
+        attributes[1].binding = 1;
+        attributes[1].format = AGPU_TEXTURE_FORMAT_R32G32B32A32_FLOAT;
+        attributes[1].offset = offsetof(SwappedVertex, r);
+        agpu_size stride = sizeof(SwappedVertex);
+        vertexLayout = device->createVertexLayout();
+        vertexLayout->addVertexAttributeBindings(1, &stride, 2, attributes);
+
+        // Two buffers per binding, that are swapped on every frame.
+        for(size_t i = 0; i < bindingCount*2; ++i)
+            vertexBuffers.push_back(createTriangleBuffer(i));
+
+        for(size_t i = 0; i < bindingCount; ++i)
+        {
+            auto binding = device->createVertexBinding(vertexLayout);
+            binding->bindVertexBuffers(1, &vertexBuffers[i*2]);
+            vertexBindings.push_back(binding);
+        }
+
+        if(!createPipeline())
+            return -1;
+
+        commandAllocator = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+        commandList = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr);
+        commandList->close();
+
+        // Warm up.
+        renderFrame(0, drawCount);
+        commandQueue->finishExecution();
+
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < frameCount; ++i)
+            renderFrame(i, drawCount);
+        commandQueue->finishExecution();
+        auto seconds = timer.elapsedSeconds();
+
+        reportResult("frames", frameCount, seconds);
+        reportResult("draws", frameCount*drawCount, seconds);
+        return 0;
+    }
+
+    agpu_buffer_ref createTriangleBuffer(size_t index)
+    {
+        auto offset = float(index % 16) / 16.0f;
+        SwappedVertex vertices[3] = {
+            {-1.0f + offset, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f},
+            {-0.5f + offset, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f},
+            {-0.75f + offset, -0.5f, 0.0f, 0.0f, 1.0f, 1.0f},
+        };
+
+        agpu_buffer_description description = {};
+        description.size = agpu_uint(sizeof(vertices));
+        description.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        description.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_ARRAY_BUFFER);
+        description.main_usage_mode = AGPU_ARRAY_BUFFER;
+        description.stride = agpu_uint(sizeof(SwappedVertex));
+        return device->createBuffer(&description, vertices);
+    }
+
+    bool createPipeline()
+    {
+        shaderSignature = device->createShaderSignatureBuilder()->build();
+
+        auto vertexShader = compileShaderFromSource(AGPU_VERTEX_SHADER, VertexShaderSource);
+        auto fragmentShader = compileShaderFromSource(AGPU_FRAGMENT_SHADER, FragmentShaderSource);
+        if(!vertexShader || !fragmentShader)
+            return false;
+
+        auto builder = device->createPipelineBuilder();
+        builder->setShaderSignature(shaderSignature);
+        builder->attachShader(vertexShader);
+        builder->attachShader(fragmentShader);
+        builder->setVertexLayout(vertexLayout);
+        builder->setRenderTargetFormat(0, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        builder->setDepthStencilFormat(AGPU_TEXTURE_FORMAT_UNKNOWN);
+        builder->setPrimitiveType(AGPU_TRIANGLES);
+
+        pipeline = builder->build();
+        if(!pipeline)
+        {
+            printError("Failed to build a pipeline state\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    void renderFrame(size_t frameIndex, size_t drawCount)
+    {
+        // The bindings can only be modified when they are not in use.
+        commandQueue->finishExecution();
+        for(size_t i = 0; i < vertexBindings.size(); ++i)
+            vertexBindings[i]->bindVertexBuffers(1, &vertexBuffers[i*2 + frameIndex % 2]);
+
+        commandAllocator->reset();
+        commandList->reset(commandAllocator, nullptr);
+        commandList->setShaderSignature(shaderSignature);
+        commandList->beginRenderPass(renderPass, framebuffer, false);
+        commandList->setViewport(0, 0, 256, 256);
+        commandList->setScissor(0, 0, 256, 256);
+        commandList->usePipelineState(pipeline);
+        for(size_t i = 0; i < drawCount; ++i)
+        {
+            commandList->useVertexBinding(vertexBindings[i % vertexBindings.size()]);
+            commandList->drawArrays(3, 1, 0, 0);
+        }
+        commandList->endRenderPass();
+        commandList->close();
+
+        commandQueue->addCommandList(commandList);
+    }
+
+    agpu_framebuffer_ref framebuffer;
+    agpu_renderpass_ref renderPass;
+    agpu_shader_signature_ref shaderSignature;
+    agpu_vertex_layout_ref vertexLayout;
+    std::vector<agpu_buffer_ref> vertexBuffers;
+    std::vector<agpu_vertex_binding_ref> vertexBindings;
+    agpu_pipeline_state_ref pipeline;
+    agpu_command_allocator_ref commandAllocator;
+    agpu_command_list_ref commandList;
+};
+
+BENCHMARK_MAIN(BenchmarkVertexBufferSwaps)
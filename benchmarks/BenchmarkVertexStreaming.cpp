@@ -0,0 +1,187 @@
+#include "BenchmarkBase.hpp"
+#include <string.h>
+#include <vector>
+
+static const char *VertexShaderSource =
+    "#version 450\n"
+    "layout(location = 0) in vec2 vPosition;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(vPosition, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *FragmentShaderSource =
+    "#version 450\n"
+    "layout(location = 0) out vec4 fbColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fbColor = vec4(0.25, 0.5, 1.0, 1.0);\n"
+    "}\n";
+
+struct StreamedVertex
+{
+    float x, y;
+};
+
+/**
+ * Streams dynamic vertices into the same vertex buffer every frame, while the
+ * draws of the previous frames may still be reading from it, and reports the
+ * upload throughput. On the OpenGL backend, the persistently mapped upload
+ * ring can be disabled with the DISABLE_STREAMING_UPLOADS environment
+ * variable for comparison.
+ */
+class BenchmarkVertexStreaming : public BenchmarkBase
+{
+public:
+    int run(int argc, const char **argv) override
+    {
+        auto frameCount = parseSizeOption(argc, argv, "-frames", 500);
+        vertexCount = parseSizeOption(argc, argv, "-vertices", 3*4096);
+        auto uploadsPerFrame = parseSizeOption(argc, argv, "-uploads", 4);
+
+        framebuffer = createOffscreenFramebuffer(256, 256, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        if(!framebuffer)
+        {
+            printError("Failed to create the offscreen framebuffer\n");
+            return -1;
+        }
+
+        agpu_renderpass_color_attachment_description colorAttachment = {};
+        colorAttachment.format = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
+        colorAttachment.begin_action = AGPU_ATTACHMENT_CLEAR;
+        colorAttachment.end_action = AGPU_ATTACHMENT_KEEP;
+        colorAttachment.sample_count = 1;
+
+        agpu_renderpass_description renderPassDescription = {};
+        renderPassDescription.color_attachment_count = 1;
+        renderPassDescription.color_attachments = &colorAttachment;
+        renderPass = device->createRenderPass(&renderPassDescription);
+
+        agpu_vertex_attrib_description attribute = {};
+        attribute.buffer = 0;
+        attribute.binding = 0;
+        attribute.format = AGPU_TEXTURE_FORMAT_R32G32_FLOAT;
+        attribute.offset = 0;
+        agpu_size stride = sizeof(StreamedVertex);
+        vertexLayout = device->createVertexLayout();
+        vertexLayout->addVertexAttributeBindings(1, &stride, 1, &attribute);
+
+        agpu_buffer_description bufferDescription = {};
+        bufferDescription.size = agpu_uint(vertexCount*sizeof(StreamedVertex));
+        bufferDescription.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        bufferDescription.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_ARRAY_BUFFER);
+        bufferDescription.main_usage_mode = AGPU_ARRAY_BUFFER;
+        bufferDescription.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
+        bufferDescription.stride = agpu_uint(stride);
+        vertexBuffer = device->createBuffer(&bufferDescription, nullptr);
+
+        vertexBinding = device->createVertexBinding(vertexLayout);
+        vertexBinding->bindVertexBuffers(1, &vertexBuffer);
+
+        if(!createPipeline())
+            return -1;
+
+        commandAllocator = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+        commandList = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr);
+        commandList->close();
+
+        vertices.resize(vertexCount);
+
+        // Warm up.
+        renderFrame(0, uploadsPerFrame);
+        commandQueue->finishExecution();
+
+        BenchmarkTimer timer;
+        for(size_t i = 0; i < frameCount; ++i)
+            renderFrame(i, uploadsPerFrame);
+        auto submissionSeconds = timer.elapsedSeconds();
+        commandQueue->finishExecution();
+        auto seconds = timer.elapsedSeconds();
+
+        reportResult("frames", frameCount, seconds);
+        reportResult("vertex uploads", frameCount*uploadsPerFrame, submissionSeconds);
+
+        auto uploadedBytes = double(frameCount*uploadsPerFrame*vertexCount*sizeof(StreamedVertex));
+        printMessage("Upload throughput: %.2f MB/s\n", uploadedBytes / seconds / (1024.0*1024.0));
+        return 0;
+    }
+
+    bool createPipeline()
+    {
+        auto shaderSignatureBuilder = device->createShaderSignatureBuilder();
+        shaderSignature = shaderSignatureBuilder->build();
+
+        auto vertexShader = compileShaderFromSource(AGPU_VERTEX_SHADER, VertexShaderSource);
+        auto fragmentShader = compileShaderFromSource(AGPU_FRAGMENT_SHADER, FragmentShaderSource);
+        if(!vertexShader || !fragmentShader)
+            return false;
+
+        auto builder = device->createPipelineBuilder();
+        builder->setShaderSignature(shaderSignature);
+        builder->attachShader(vertexShader);
+        builder->attachShader(fragmentShader);
+        builder->setVertexLayout(vertexLayout);
+        builder->setRenderTargetFormat(0, AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM);
+        builder->setDepthStencilFormat(AGPU_TEXTURE_FORMAT_UNKNOWN);
+        builder->setPrimitiveType(AGPU_TRIANGLES);
+
+        pipeline = builder->build();
+        if(!pipeline)
+        {
+            printError("Failed to build a pipeline state\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    void generateVertices(size_t frameIndex, size_t uploadIndex)
+    {
+        auto phase = float((frameIndex*7 + uploadIndex) % 64) / 64.0f;
+        for(size_t i = 0; i < vertexCount; ++i)
+        {
+            auto &vertex = vertices[i];
+            vertex.x = float(i % 64) / 32.0f - 1.0f + phase*0.01f;
+            vertex.y = float((i / 64) % 64) / 32.0f - 1.0f;
+        }
+    }
+
+    void renderFrame(size_t frameIndex, size_t uploadsPerFrame)
+    {
+        commandAllocator->reset();
+        commandList->reset(commandAllocator, nullptr);
+        commandList->setShaderSignature(shaderSignature);
+        commandList->beginRenderPass(renderPass, framebuffer, false);
+        commandList->setViewport(0, 0, 256, 256);
+        commandList->setScissor(0, 0, 256, 256);
+        commandList->usePipelineState(pipeline);
+        commandList->useVertexBinding(vertexBinding);
+        commandList->drawArrays(agpu_uint(vertexCount), 1, 0, 0);
+        commandList->endRenderPass();
+        commandList->close();
+
+        // Every upload overwrites the vertices that are used by the previous draw.
+        auto bufferSize = agpu_size(vertexCount*sizeof(StreamedVertex));
+        for(size_t i = 0; i < uploadsPerFrame; ++i)
+        {
+            generateVertices(frameIndex, i);
+            vertexBuffer->uploadBufferData(0, bufferSize, &vertices[0]);
+            commandQueue->addCommandList(commandList);
+        }
+    }
+
+    size_t vertexCount;
+    std::vector<StreamedVertex> vertices;
+
+    agpu_framebuffer_ref framebuffer;
+    agpu_renderpass_ref renderPass;
+    agpu_shader_signature_ref shaderSignature;
+    agpu_vertex_layout_ref vertexLayout;
+    agpu_buffer_ref vertexBuffer;
+    agpu_vertex_binding_ref vertexBinding;
+    agpu_pipeline_state_ref pipeline;
+    agpu_command_allocator_ref commandAllocator;
+    agpu_command_list_ref commandList;
+};
+
+BENCHMARK_MAIN(BenchmarkVertexStreaming)
@@ -0,0 +1,60 @@
+#include "ImmediateShaderVariants.hpp"
+
+static const char UberShaderSourceCode[] =
+#include "../implementations/Common/uberShader.glsl"
+;
+
+static std::string saltedMainFunction(int stage, int salt)
+{
+    auto saltValue = std::to_string(salt);
+    std::string result = "#undef main\nvoid main()\n{\n";
+    if(stage == 0)
+        result += "    immediateMain();\n    if(gl_VertexIndex == -" + saltValue + ")\n        gl_Position = vec4(0.0);\n";
+    else
+        result += "    if(gl_FragCoord.x == -" + saltValue + ".0)\n        discard;\n    immediateMain();\n";
+    result += "}\n";
+    return result;
+}
+
+std::vector<ImmediateShaderVariant> makeImmediateShaderVariants(const std::string &header, int salt)
+{
+    static const char *lightingModels[] = {
+        nullptr,
+        "#define LIGHTING_ENABLED\n#define PER_VERTEX_LIGHTING\n",
+        "#define LIGHTING_ENABLED\n#define PER_FRAGMENT_LIGHTING\n",
+        "#define LIGHTING_ENABLED\n#define PBR_METALLIC_ROUGHNESS\n",
+    };
+
+    std::vector<ImmediateShaderVariant> variants;
+    for(int stage = 0; stage < 2; ++stage)
+    {
+        for(int flags = 0; flags < 8; ++flags)
+        {
+            for(auto lightingModel : lightingModels)
+            {
+                ImmediateShaderVariant variant;
+                variant.type = stage == 0 ? AGPU_VERTEX_SHADER : AGPU_FRAGMENT_SHADER;
+                variant.skinningEnabled = (flags & 4) != 0;
+                variant.source = header;
+                variant.source += "#version 450\n";
+                variant.source += stage == 0 ? "#define BUILD_VERTEX_SHADER\n" : "#define BUILD_FRAGMENT_SHADER\n";
+                if(flags & 1)
+                    variant.source += "#define FLAT_SHADING\n";
+                if(flags & 2)
+                    variant.source += "#define TEXTURING_ENABLED\n";
+                if(flags & 4)
+                    variant.source += "#define SKINNING_ENABLED\n";
+                if(lightingModel)
+                    variant.source += lightingModel;
+                if(salt)
+                    variant.source += "#define main immediateMain\n";
+                variant.source += UberShaderSourceCode;
+                if(salt)
+                    variant.source += saltedMainFunction(stage, salt);
+                variants.push_back(variant);
+            }
+        }
+    }
+
+    return variants;
+}
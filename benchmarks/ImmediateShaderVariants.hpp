@@ -0,0 +1,27 @@
+#ifndef _IMMEDIATE_SHADER_VARIANTS_HPP_
+#define _IMMEDIATE_SHADER_VARIANTS_HPP_
+
+#include <AGPU/agpu.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * A variant of the shaders of the immediate renderer, with the same
+ * definitions that are generated by the immediate shader library.
+ */
+struct ImmediateShaderVariant
+{
+    agpu_shader_type type;
+    bool skinningEnabled;
+    std::string source;
+};
+
+// The vertex shaders come first, followed by the fragment shaders with the
+// same definitions in the same order. The header is put before the #version directive. A different comment in
+// the header makes the sources different, without changing the shaders.
+// A salt that is not zero wraps the main function of the shaders with a test
+// against a constant that depends on it, which never passes. The shaders with
+// different salts are still different Spir-V modules after being optimized.
+std::vector<ImmediateShaderVariant> makeImmediateShaderVariants(const std::string &header = std::string(), int salt = 0);
+
+#endif //_IMMEDIATE_SHADER_VARIANTS_HPP_
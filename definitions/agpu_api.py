@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# Reader of definitions/api.xml that is shared by the generators of the
+# loader layers, of the encoded command decoders and of the direct C++
+# binding. The public headers, the ICD dispatch tables and the language
+# bindings are produced by the binding generator, from the same definitions.
+import os
+import xml.etree.ElementTree as ET
+
+DEFINITIONS_DIR = os.path.dirname(os.path.abspath(__file__))
+REPO_DIR = os.path.dirname(DEFINITIONS_DIR)
+API_XML = os.path.join(DEFINITIONS_DIR, 'api.xml')
+
+class Api:
+    def __init__(self, path=API_XML):
+        self.root = ET.parse(path).getroot()
+        self.enums = set(e.get('name') for e in self.root.iter('enum'))
+        self.structs = dict((s.get('name'), s) for s in self.root.iter('struct'))
+        for u in self.root.iter('union'):
+            self.structs[u.get('name')] = u
+        self.interfaces = dict((i.get('name'), i) for i in self.root.iter('interface'))
+
+    def split(self, t):
+        base = t.rstrip('*')
+        return base, len(t) - len(base)
+
+    def isInterface(self, base):
+        return base in self.interfaces
+
+    def ctype(self, t):
+        base, stars = self.split(t)
+        return 'agpu_' + base + '*' * stars
+
+    def methods(self, iname):
+        return self.interfaces[iname].findall('method')
+
+    def method(self, iname, name):
+        for m in self.methods(iname):
+            if m.get('name') == name:
+                return m
+        return None
+
+    # The C entry points of the interface methods, in the order of the ICD
+    # dispatch table, which only adds agpuGetPlatforms before them.
+    def entryPoints(self):
+        result = []
+        for iface in self.root.iter('interface'):
+            for m in iface.findall('method'):
+                result.append((iface.get('name'), m))
+        return result
+
+    def enumConstants(self, name):
+        for e in self.root.iter('enum'):
+            if e.get('name') == name:
+                return [(c.get('name'), int(c.get('value'))) for c in e.findall('constant')]
+        raise KeyError(name)
+
+def entryPointName(m):
+    return 'agpu' + m.get('cname')
+
+def upperFirst(s):
+    return s[0].upper() + s[1:]
+
+def writeGeneratedFile(relativePath, text):
+    with open(os.path.join(REPO_DIR, relativePath), 'w', newline='\n') as f:
+        f.write(text)
@@ -0,0 +1,454 @@
+#!/usr/bin/env python3
+# Generates the API capture layer of the loader and the replay functions of
+# AgpuReplay from definitions/api.xml:
+#   implementations/Common/api_capture.inc
+#   implementations/Loader/capture_layer.inc
+#   implementations/Replay/replay.inc
+# It must be run again when the entry points of api.xml change, which is
+# checked when the loader is compiled. The capture of the pointer arguments
+# is described by the tables below, and the script fails on a pointer that
+# it does not know how to capture.
+from agpu_api import Api, entryPointName, upperFirst, writeGeneratedFile
+from make_encoded_commands import INTERFACES as ENCODED_INTERFACES, encodedCommands
+
+api = Api()
+STRUCTS = api.structs
+
+SCALARS = set(['byte', 'sbyte', 'short', 'ushort', 'int', 'uint', 'size', 'enum', 'bool', 'float', 'double', 'bitfield', 'string_length']) | api.enums
+
+# Pointers that are written by the implementation.
+OUTPUT_STRUCTS = set([
+    'buffer.getDescription.description',
+    'texture.getDescription.description',
+    'texture.getFullViewDescription.result',
+    'device.getObjectStatistics.statistics',
+    'swap_chain.getFramePacingStatistics.statistics',
+    'offline_shader_compiler.getCompilationStatistics.statistics',
+    'vr_system.getRecommendedRenderTargetSize.size',
+    'vr_system.getEyeToHeadTransform.transform',
+    'vr_system.getProjectionMatrix.projection_matrix',
+    'vr_system.getProjectionFrustumTangents.frustum',
+    'vr_system.getCurrentTrackedDevicePoseInto.dest',
+    'vr_system.getCurrentRenderTrackedDevicePoseInto.dest',
+    'vr_system.pollEvent.event',
+])
+
+# Pointer arguments whose capture kind and size are given explicitly.
+SPECIAL_ARGS = {
+    'device.createBuffer.initial_data': ('payload', 'description ? description->size : 0'),
+    'command_list.pushConstants.values': ('payload', 'size'),
+    'state_tracker.pushConstants.values': ('payload', 'size'),
+    'command_list.executeEncodedCommands.commands': ('encoded', 'size'),
+    'state_tracker.executeEncodedCommands.commands': ('encoded', 'size'),
+    'texture.readTextureData.buffer': ('scratch_range', 'textureDataRange(texture, level, pitch, slicePitch, nullptr)'),
+    'texture.readTextureSubData.buffer': ('scratch_range', 'textureDataRange(texture, level, pitch, slicePitch, destSize)'),
+    'texture.uploadTextureData.data': ('payload_range', 'textureDataRange(texture, level, pitch, slicePitch, nullptr)'),
+    'texture.uploadTextureSubData.data': ('payload_range', 'textureDataRange(texture, level, pitch, slicePitch, sourceSize)'),
+    'buffer.uploadBufferData.data': ('payload', 'size'),
+    'buffer.readBufferData.data': ('scratch', 'size'),
+    'vertex_binding.bindVertexBuffersWithOffsets.offsets': ('payload', 'count*sizeof(agpu_size)'),
+    'vertex_layout.addVertexAttributeBindings.vertex_strides': ('payload', 'vertex_buffer_count*sizeof(agpu_size)'),
+    'vertex_layout.addVertexAttributeBindings.attributes': ('structures', 'attribute_count'),
+    'offline_shader_compiler.compileShaderBatch.jobs': ('structures', 'job_count'),
+    'renderpass.getColorAttachmentFormats.color_attachment_count': ('payload', 'sizeof(agpu_uint)'),
+    'renderpass.getColorAttachmentFormats.formats': ('scratch', 'color_attachment_count ? *color_attachment_count*sizeof(agpu_texture_format) : 0'),
+    'immediate_renderer.loadMatrix.elements': ('payload', '16*sizeof(agpu_float)'),
+    'immediate_renderer.loadTransposeMatrix.elements': ('payload', '16*sizeof(agpu_float)'),
+    'immediate_renderer.multiplyMatrix.elements': ('payload', '16*sizeof(agpu_float)'),
+    'immediate_renderer.multiplyTransposeMatrix.elements': ('payload', '16*sizeof(agpu_float)'),
+    'immediate_renderer.setSkinBones.matrices': ('payload', 'count*16*sizeof(agpu_float)'),
+    'immediate_renderer.beginMeshWithVertices.vertices': ('payload', 'meshAttributeSize(vertexCount, stride, elementCount)'),
+    'immediate_renderer.setCurrentMeshColors.colors': ('payload', 'meshAttributeSize(getCurrentMeshVertexCount(immediate_renderer), stride, elementCount)'),
+    'immediate_renderer.setCurrentMeshNormals.normals': ('payload', 'meshAttributeSize(getCurrentMeshVertexCount(immediate_renderer), stride, elementCount)'),
+    'immediate_renderer.setCurrentMeshTexCoords.texcoords': ('payload', 'meshAttributeSize(getCurrentMeshVertexCount(immediate_renderer), stride, elementCount)'),
+    'immediate_renderer.drawElementsWithIndices.indices': ('payload', 'index_count*sizeof(uint32_t)'),
+}
+
+# The fields that give the element count of the structure array fields.
+STRUCT_ARRAY_COUNTS = {
+    ('renderpass_description', 'color_attachments'): 'color_attachment_count',
+}
+
+# Code that is run by the capture layer around some calls.
+CAPTURE_BEFORE = {
+    'buffer.unmapBuffer': 'captureMappedBufferWrites(buffer, true);',
+    'buffer.flushWholeBuffer': 'captureMappedBufferWrites(buffer, false);',
+    'buffer.release': 'releaseCapturedBuffer(buffer);',
+    'command_queue.addCommandList': 'captureAllMappedBufferWrites();',
+    'command_queue.addCommandLists': 'captureAllMappedBufferWrites();',
+    'swap_chain.swapBuffers': 'captureAllMappedBufferWrites();',
+}
+
+CAPTURE_AFTER = {
+    'device.createBuffer': 'retainCapturedBuffer(returnValue);',
+    'buffer.addReference': 'retainCapturedBuffer(buffer);',
+    'buffer.mapBuffer': 'registerMappedBuffer(buffer, flags, returnValue);',
+    'immediate_renderer.beginMeshWithVertices': 'setCurrentMeshVertexCount(immediate_renderer, vertexCount);',
+    'swap_chain.swapBuffers': 'flushCapture();',
+}
+
+# Calls that are replayed by hand written functions.
+REPLAY_OVERRIDES = set([
+    'platform.openDevice',
+    'device.createSwapChain',
+    'swap_chain.swapBuffers',
+    'swap_chain.getCurrentBackBuffer',
+    'buffer.mapBuffer',
+    'buffer.unmapBuffer',
+])
+
+def hasPointers(sname):
+    for f in STRUCTS[sname].findall('field'):
+        t = f.get('type')
+        base, stars = api.split(t)
+        if stars or base in ('pointer', 'cstring', 'string'):
+            return True
+        if base in STRUCTS and hasPointers(base):
+            return True
+    return False
+
+def entryPoints():
+    return api.entryPoints()
+
+def argumentKind(iname, m, args, index):
+    name, t = args[index]
+    key = '%s.%s.%s' % (iname, m.get('name'), name)
+    if key in SPECIAL_ARGS:
+        return SPECIAL_ARGS[key]
+    base, stars = api.split(t)
+    if api.isInterface(base):
+        if stars == 1:
+            return ('platform',) if base == 'platform' else ('object',)
+        assert stars == 2
+        countName = args[index - 1][0]
+        return ('objects', countName)
+    if key in OUTPUT_STRUCTS:
+        return ('scratch', 'sizeof(%s)' % api.ctype(base))
+    if base in STRUCTS and stars == 1:
+        return ('structures', '1')
+    if base in STRUCTS and stars == 0:
+        assert not hasPointers(base)
+        return ('structure_value',)
+    if base == 'cstring':
+        return ('string', None)
+    if base == 'string':
+        assert args[index + 1][1] == 'string_length'
+        return ('string', args[index + 1][0])
+    if base in ('string_buffer', 'cstring_buffer'):
+        assert args[index - 1][1] == 'size'
+        return ('scratch', args[index - 1][0])
+    assert stars == 0 and base in SCALARS, key
+    return ('value',)
+
+def methodArguments(iname, m):
+    return [(iname, iname)] + [(a.get('name'), a.get('type')) for a in m.findall('arg')]
+
+def captureArgument(kind, name, t):
+    k = kind[0]
+    if k in ('object', 'platform'):
+        return 'call.object(%s);' % name
+    if k == 'objects':
+        return 'call.objects(%s, %s);' % (name, kind[1])
+    if k == 'value':
+        return 'call.value(%s);' % name
+    if k == 'string':
+        if kind[1]:
+            return 'call.string(%s, %s);' % (name, kind[1])
+        return 'call.string(%s);' % name
+    if k == 'structures':
+        base = api.split(t)[0]
+        if hasPointers(base):
+            return 'captureStructures(call, %s, %s);' % (name, kind[1])
+        return 'call.structures(%s, %s);' % (name, kind[1])
+    if k == 'structure_value':
+        return 'call.structures(&%s, 1);' % name
+    if k == 'payload':
+        return 'call.payload(%s, %s);' % (name, kind[1])
+    if k == 'payload_range':
+        return 'call.payload(%s, %s);' % (name, kind[1])
+    if k == 'scratch':
+        return 'call.scratch(%s, %s);' % (name, kind[1])
+    if k == 'scratch_range':
+        return 'call.scratch(%s, %s);' % (name, kind[1])
+    if k == 'encoded':
+        return 'call.encodedCommands(%s, %s);' % (name, kind[1])
+    assert False, kind
+
+def replayArgument(kind, name, t):
+    k = kind[0]
+    ctype = api.ctype(t)
+    base = api.split(t)[0]
+    if k == 'object':
+        return 'auto %s = state.object<%s> (reader);' % (name, api.ctype(base))
+    if k == 'platform':
+        return 'auto %s = state.platform(reader);' % name
+    if k == 'objects':
+        return 'auto %s = state.objects<%s> (reader);' % (name, api.ctype(base))
+    if k == 'value':
+        return 'auto %s = reader.value<%s> ();' % (name, ctype)
+    if k == 'string':
+        return 'auto %s = reader.string();' % name
+    if k == 'structures':
+        if hasPointers(base):
+            return 'auto %s = replayStructures<%s> (reader, state);' % (name, api.ctype(base))
+        return 'auto %s = reader.structures<%s> ();' % (name, api.ctype(base))
+    if k == 'structure_value':
+        return 'auto %s = reader.structureValue<%s> ();' % (name, ctype)
+    if k in ('payload', 'payload_range', 'scratch', 'scratch_range'):
+        return 'auto %s = static_cast<%s> (reader.%s());' % (name, ctype, 'payload' if k.startswith('payload') else 'scratch')
+    if k == 'encoded':
+        return 'auto %s = state.encodedCommands(reader);' % name
+    assert False, kind
+
+def argumentKinds(iname, m):
+    args = methodArguments(iname, m)
+    kinds = [('platform',) if iname == 'platform' else ('object',)]
+    kinds += [argumentKind(iname, m, args, i) for i in range(1, len(args))]
+    return args, kinds
+
+def captureThunk(iname, m):
+    ep = entryPointName(m)
+    key = '%s.%s' % (iname, m.get('name'))
+    ret = m.get('returnType')
+    retType = api.ctype(ret)
+    args, kinds = argumentKinds(iname, m)
+    cargs = ['%s %s' % (api.ctype(t) if i else 'agpu_%s*' % iname, n) for i, (n, t) in enumerate(args)]
+    callArgs = [n for n, t in args]
+    out = 'static %s captured%s ( %s )\n{\n' % (retType, upperFirst(ep), ', '.join(cargs))
+    out += '\tauto next = getCapturedDriverDispatchTable(%s);\n' % iname
+    out += '\tif(isInsideCapturedCall())\n'
+    out += '\t\treturn next->%s ( %s );\n\n' % (ep, ', '.join(callArgs))
+    out += '\tCapturedCall call(CaptureEntryPoint_%s);\n' % ep
+    if key in CAPTURE_BEFORE:
+        out += '\t%s\n' % CAPTURE_BEFORE[key]
+    out += '\tauto returnValue = next->%s ( %s );\n' % (ep, ', '.join(callArgs))
+    for (n, t), kind in zip(args, kinds):
+        out += '\t%s\n' % captureArgument(kind, n, t)
+    base, stars = api.split(ret)
+    if api.isInterface(base) and stars == 1:
+        out += '\tcall.object(returnValue);\n'
+    out += '\tcall.finish();\n'
+    if key in CAPTURE_AFTER:
+        out += '\t%s\n' % CAPTURE_AFTER[key]
+    out += '\treturn returnValue;\n}\n\n'
+    return out
+
+def replayFunction(iname, m):
+    ep = entryPointName(m)
+    key = '%s.%s' % (iname, m.get('name'))
+    ret = m.get('returnType')
+    args, kinds = argumentKinds(iname, m)
+    # Avoid shadowing the parameters of the replay function.
+    args = [(n + 'Argument' if n in ('reader', 'state') else n, t) for n, t in args]
+    override = key in REPLAY_OVERRIDES
+    out = 'static void replay%s(ReplayReader &reader, ReplayState &state)\n{\n' % upperFirst(ep)
+    lines = []
+    for i, ((n, t), kind) in enumerate(zip(args, kinds)):
+        if i == 0 and override and kind[0] == 'object':
+            lines.append('auto %sId = reader.objectId();' % n)
+            lines.append('auto %s = state.object<agpu_%s> (%sId);' % (n, iname, n))
+            continue
+        lines.append(replayArgument(kind, n, t))
+    base, stars = api.split(ret)
+    returnsObject = api.isInterface(base) and stars == 1
+    if returnsObject:
+        lines.append('auto resultId = reader.objectId();')
+    for l in lines:
+        out += '\t%s\n' % l
+    callArgs = [n for n, t in args]
+    if override:
+        overrideArgs = ['reader', 'state']
+        if kinds[0][0] == 'object':
+            overrideArgs.append('%sId' % iname)
+        overrideArgs += callArgs
+        if returnsObject:
+            overrideArgs.append('resultId')
+        out += '\treplayOverride%s(%s);\n}\n\n' % (m.get('cname'), ', '.join(overrideArgs))
+        return out
+    out += '\tif(!state.beginCall(reader))\n'
+    if returnsObject:
+        out += '\t{\n\t\tstate.setObject(resultId, nullptr);\n\t\treturn;\n\t}\n\n'
+        out += '\tstate.setObject(resultId, %s(%s));\n}\n\n' % (ep, ', '.join(callArgs))
+    else:
+        out += '\t\treturn;\n\n'
+        out += '\t%s(%s);\n}\n\n' % (ep, ', '.join(callArgs))
+    return out
+
+def structFields(sname):
+    fields = [(f.get('name'), f.get('type')) for f in STRUCTS[sname].findall('field')]
+    result = []
+    for i, (n, t) in enumerate(fields):
+        base, stars = api.split(t)
+        if base == 'pointer':
+            result.append((n, t, ('native',)))
+        elif api.isInterface(base):
+            assert stars == 1
+            result.append((n, t, ('object',)))
+        elif base == 'cstring':
+            result.append((n, t, ('string', None)))
+        elif base == 'string':
+            assert fields[i + 1][1] == 'string_length'
+            result.append((n, t, ('string', 's.' + fields[i + 1][0])))
+        elif base in STRUCTS:
+            if stars:
+                count = STRUCT_ARRAY_COUNTS.get((sname, n))
+                result.append((n, t, ('structures', ('s.' + count) if count else '1')))
+            else:
+                result.append((n, t, ('inline',)))
+        else:
+            assert stars == 0 and base in SCALARS, (sname, n)
+            result.append((n, t, ('value',)))
+    return result
+
+def pointerStructs():
+    result = []
+    for iname, m in entryPoints():
+        args, kinds = argumentKinds(iname, m)
+        for (n, t), kind in zip(args, kinds):
+            base = api.split(t)[0]
+            if kind[0] == 'structures' and hasPointers(base) and base not in result:
+                result.append(base)
+    return result
+
+def captureStructure(sname):
+    out = 'static void captureStructure(CapturedCall &call, const %s &s)\n{\n' % api.ctype(sname)
+    fields = structFields(sname)
+    if any(kind[0] == 'native' for n, t, kind in fields):
+        out += '\t// The native handles are not captured, because they can not be replayed.\n'
+    for n, t, kind in fields:
+        k = kind[0]
+        base = api.split(t)[0]
+        if k == 'native':
+            continue
+        elif k == 'object':
+            out += '\tcall.object(s.%s);\n' % n
+        elif k == 'string':
+            out += '\tcall.string(s.%s%s);\n' % (n, (', ' + kind[1]) if kind[1] else '')
+        elif k == 'structures':
+            assert not hasPointers(base)
+            out += '\tcall.structures(s.%s, %s);\n' % (n, kind[1])
+        elif k == 'inline':
+            assert not hasPointers(base)
+            out += '\tcall.structures(&s.%s, 1);\n' % n
+        else:
+            out += '\tcall.value(s.%s);\n' % n
+    out += '}\n\n'
+    return out
+
+def replayStructure(sname):
+    out = 'static void replayStructure(ReplayReader &reader, ReplayState &state, %s &s)\n{\n' % api.ctype(sname)
+    for n, t, kind in structFields(sname):
+        k = kind[0]
+        base = api.split(t)[0]
+        if k == 'native':
+            out += '\ts.%s = nullptr;\n' % n
+        elif k == 'object':
+            out += '\ts.%s = state.object<%s> (reader);\n' % (n, api.ctype(base))
+        elif k == 'string':
+            out += '\ts.%s = reader.string();\n' % n
+        elif k == 'structures':
+            out += '\ts.%s = reader.structures<%s> ();\n' % (n, api.ctype(base))
+        elif k == 'inline':
+            out += '\treader.structureInto(s.%s);\n' % n
+        else:
+            out += '\ts.%s = reader.value<%s> ();\n' % (n, api.ctype(t))
+    out += '}\n\n'
+    return out
+
+def encodedArgumentKinds():
+    result = []
+    sizes = []
+    for cname, value, name in encodedCommands(api):
+        iname = [i for i in ENCODED_INTERFACES if api.method(i, name) is not None][0]
+        m = api.method(iname, name)
+        kinds = ''
+        margs = [(a.get('name'), a.get('type')) for a in m.findall('arg')]
+        for i, (n, t) in enumerate(margs):
+            base, stars = api.split(t)
+            if api.isInterface(base) and stars == 1:
+                kinds += 'r'
+            elif stars or base in ('pointer', 'cstring', 'string'):
+                kinds += 'p'
+                key = '%s.%s.%s' % (iname, name, n)
+                if key in SPECIAL_ARGS:
+                    sizeArgument = SPECIAL_ARGS[key][1]
+                    index = [a[0] for a in margs].index(sizeArgument)
+                    sizes.append((cname, i, 'size_t(arguments[%d])' % index))
+                elif base == 'cstring':
+                    sizes.append((cname, i, 'pointer ? strlen(reinterpret_cast<const char*> (pointer)) + 1 : 0'))
+                else:
+                    assert base in STRUCTS and stars == 1
+                    sizes.append((cname, i, 'sizeof(%s)' % api.ctype(base)))
+            else:
+                kinds += 'v'
+        result.append((cname, value, kinds))
+    return result, sizes
+
+def writeCommon():
+    eps = entryPoints()
+    out = '// This file was generated automatically. DO NOT MODIFY\n\n'
+    out += 'enum CaptureEntryPoint\n{\n'
+    for iname, m in eps:
+        out += '\tCaptureEntryPoint_%s,\n' % entryPointName(m)
+    out += '\tCaptureEntryPointCount\n};\n\n'
+    out += 'static const char * const CaptureEntryPointNames[] = {\n'
+    for iname, m in eps:
+        out += '\t"%s",\n' % entryPointName(m)
+    out += '};\n\n'
+    kinds, sizes = encodedArgumentKinds()
+    out += '// The kinds of the arguments of the encoded commands, indexed by opcode:\n'
+    out += '// v for the values, r for the handles, and p for the other pointers.\n'
+    out += 'static const char * const EncodedCommandArgumentKinds[] = {\n\t"",\n'
+    for i, (cname, value, k) in enumerate(kinds):
+        assert value == i + 1
+        out += '\t"%s", // %s\n' % (k, cname)
+    out += '};\n'
+    writeGeneratedFile('implementations/Common/api_capture.inc', out)
+
+def writeCapture():
+    eps = entryPoints()
+    out = '// This file was generated automatically. DO NOT MODIFY\n\n'
+    for sname in pointerStructs():
+        out += captureStructure(sname)
+    kinds, sizes = encodedArgumentKinds()
+    out += 'static size_t encodedCommandPointerSize(uint32_t opcode, size_t index, const uint64_t *arguments, const void *pointer)\n{\n'
+    out += '\tswitch(opcode)\n\t{\n'
+    byOpcode = {}
+    for cname, i, expr in sizes:
+        byOpcode.setdefault(cname, []).append((i, expr))
+    for cname, entries in byOpcode.items():
+        out += '\tcase %s:\n' % cname
+        if len(entries) == 1:
+            out += '\t\treturn %s;\n' % entries[0][1]
+        else:
+            out += '\t\tswitch(index)\n\t\t{\n'
+            for i, expr in entries:
+                out += '\t\tcase %d: return %s;\n' % (i, expr)
+            out += '\t\tdefault: return 0;\n\t\t}\n'
+    out += '\tdefault:\n\t\treturn 0;\n\t}\n}\n\n'
+    for iname, m in eps:
+        out += captureThunk(iname, m)
+    out += 'static void installCapturedEntryPoints(agpu_icd_dispatch *dispatchTable)\n{\n'
+    for iname, m in eps:
+        ep = entryPointName(m)
+        out += '\tdispatchTable->%s = captured%s;\n' % (ep, upperFirst(ep))
+    out += '}\n'
+    writeGeneratedFile('implementations/Loader/capture_layer.inc', out)
+
+def writeReplay():
+    eps = entryPoints()
+    out = '// This file was generated automatically. DO NOT MODIFY\n\n'
+    for sname in pointerStructs():
+        out += replayStructure(sname)
+    for iname, m in eps:
+        out += replayFunction(iname, m)
+    out += 'static const ReplayFunction ReplayFunctions[] = {\n'
+    for iname, m in eps:
+        out += '\treplay%s,\n' % upperFirst(entryPointName(m))
+    out += '};\n'
+    writeGeneratedFile('implementations/Replay/replay.inc', out)
+
+if __name__ == '__main__':
+    writeCommon()
+    writeCapture()
+    writeReplay()
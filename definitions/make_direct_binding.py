@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+# Generates include/AGPU/agpu_direct.inc from definitions/api.xml, with the
+# mapping between the C handles and the implementation interfaces of the
+# direct C++ binding. It must be run again when an interface is added.
+from agpu_api import Api, writeGeneratedFile
+
+# The platforms are not wrapped, because the loader can give stand-ins for
+# the platforms of the drivers that are not loaded yet.
+EXCLUDED_INTERFACES = set(['platform'])
+
+def main():
+    api = Api()
+    out = '// This file was generated automatically. DO NOT MODIFY\n'
+    for iface in api.root.iter('interface'):
+        iname = iface.get('name')
+        if iname in EXCLUDED_INTERFACES:
+            continue
+        out += '\n'
+        out += 'template<> struct handle_type<%s> { typedef agpu_%s type; };\n' % (iname, iname)
+        out += 'template<> struct interface_type<agpu_%s> { typedef %s type; };\n' % (iname, iname)
+    writeGeneratedFile('include/AGPU/agpu_direct.inc', out)
+
+if __name__ == '__main__':
+    main()
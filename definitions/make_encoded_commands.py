@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+# Generates implementations/Common/encoded_commands.inc, which contains the
+# decoders that are used by agpuExecuteEncodedCommands, from definitions/api.xml.
+# The decoders are templates on the class that implements the methods, which
+# are called without a virtual dispatch.
+#
+# The opcodes are the constants of the encoded_command enum of api.xml. They
+# are a wire format that is shared with the encoders of the bindings, so an
+# opcode is never renumbered nor reused. The constant EncodedCommandFooBar
+# selects the method fooBar of command_list or of state_tracker, and a method
+# is added by appending a constant with the next free value. After that, the
+# headers and the bindings are regenerated with the binding generator, and
+# then this script and make_api_capture.py are run again.
+import sys
+from agpu_api import Api, writeGeneratedFile
+
+INTERFACES = ['command_list', 'state_tracker']
+
+# Methods that can not be encoded, because they change the recording state.
+NOT_ENCODABLE = set(['addReference', 'release', 'close', 'reset', 'resetBundle',
+    'beginRecordingCommands', 'endRecordingAndFlushCommands', 'executeEncodedCommands'])
+
+def upperSnake(name):
+    result = ''
+    for i, c in enumerate(name):
+        if c.isupper() and i > 0 and (name[i - 1].islower() or name[i - 1].isdigit()):
+            result += '_'
+        result += c.upper()
+    return result
+
+def methodSignature(m):
+    return [(a.get('type'), a.get('pointerList')) for a in m.findall('arg')]
+
+# Returns the opcodes as tuples of the C constant, the value and the method name.
+def encodedCommands(api):
+    result = []
+    values = set()
+    for name, value in api.enumConstants('encoded_command'):
+        assert name.startswith('EncodedCommand'), name
+        assert value not in values, 'Duplicated encoded command opcode %d' % value
+        values.add(value)
+        methodName = name[len('EncodedCommand')].lower() + name[len('EncodedCommand') + 1:]
+        signature = None
+        for iname in INTERFACES:
+            m = api.method(iname, methodName)
+            if m is None:
+                continue
+            assert m.get('returnType') == 'error' and methodName not in NOT_ENCODABLE, name
+            if signature is not None:
+                assert signature == methodSignature(m), 'The encoded method %s has different signatures' % methodName
+            signature = methodSignature(m)
+        assert signature is not None, 'The encoded command %s does not name a method' % name
+        result.append(('AGPU_ENCODED_COMMAND_' + upperSnake(name[len('EncodedCommand'):]), value, methodName))
+    return sorted(result, key=lambda command: command[1])
+
+def unassignedMethods(api, commands):
+    assigned = set(command[2] for command in commands)
+    result = []
+    for iname in INTERFACES:
+        for m in api.methods(iname):
+            name = m.get('name')
+            if m.get('returnType') == 'error' and name not in NOT_ENCODABLE and name not in assigned and name not in result:
+                result.append(name)
+    return result
+
+def argumentExpression(api, t, index):
+    base, stars = api.split(t)
+    slot = 'arguments[%d]' % index
+    if api.isInterface(base) and stars == 1:
+        return 'decodeEncodedReference<agpu::%s> (%s)' % (base, slot)
+    if stars > 0 or base in ('pointer', 'cstring', 'string', 'cstring_buffer', 'string_buffer'):
+        return 'reinterpret_cast<%s> (uintptr_t(%s))' % (api.ctype(t), slot)
+    if base in ('float', 'double'):
+        return '%s(decodeEncodedFloat(%s))' % (api.ctype(t), slot)
+    return '%s(%s)' % (api.ctype(t), slot)
+
+def decoder(api, commands, iname, functionName):
+    out = 'template<typename T>\nagpu_error %s(T *self, uint32_t opcode, const uint64_t *arguments, size_t argumentCount)\n{\n' % functionName
+    out += '\tswitch(opcode)\n\t{\n'
+    for cname, value, methodName in commands:
+        m = api.method(iname, methodName)
+        if m is None:
+            continue
+        args = m.findall('arg')
+        out += '\tcase %s:\n' % cname
+        out += '\t\tif(argumentCount != %d) return AGPU_INVALID_PARAMETER;\n' % len(args)
+        callArgs = [argumentExpression(api, a.get('type'), i) for i, a in enumerate(args)]
+        out += '\t\treturn self->T::%s(%s);\n' % (methodName, ', '.join(callArgs))
+    out += '\tdefault:\n\t\treturn AGPU_UNSUPPORTED;\n\t}\n}\n'
+    return out
+
+def main():
+    api = Api()
+    commands = encodedCommands(api)
+    text = '// Decoders of the encoded commands, generated from definitions/api.xml.\n\n'
+    text += decoder(api, commands, 'command_list', 'decodeCommandListCommand') + '\n'
+    text += decoder(api, commands, 'state_tracker', 'decodeStateTrackerCommand')
+    writeGeneratedFile('implementations/Common/encoded_commands.inc', text)
+
+    for name in unassignedMethods(api, commands):
+        sys.stderr.write('Warning: %s does not have an encoded command opcode.\n' % name)
+
+if __name__ == '__main__':
+    main()
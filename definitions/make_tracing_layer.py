@@ -0,0 +1,38 @@
+#!/usr/bin/env python3
+# Generates implementations/Loader/tracing_layer.inc from definitions/api.xml.
+# It must be run again when the entry points of api.xml change, which is
+# checked when the loader is compiled.
+from agpu_api import Api, entryPointName, upperFirst, writeGeneratedFile
+
+def tracedEntryPoints(api):
+    result = []
+    for iname, m in api.entryPoints():
+        args = [(a.get('name'), a.get('type')) for a in m.findall('arg')]
+        cargs = ['agpu_%s* %s' % (iname, iname)] + ['%s %s' % (api.ctype(t), n) for n, t in args]
+        callArgs = [iname] + [n for n, t in args]
+        result.append((entryPointName(m), api.ctype(m.get('returnType')), cargs, callArgs, iname))
+    return result
+
+def main():
+    entryPoints = tracedEntryPoints(Api())
+    out = '// This file was generated automatically. DO NOT MODIFY\n\n'
+    out += 'enum TracedEntryPoint\n{\n'
+    for name, ret, cargs, callArgs, self in entryPoints:
+        out += '\tTracedEntryPoint_%s,\n' % name
+    out += '\tTracedEntryPointCount\n};\n\n'
+    out += 'static const char * const TracedEntryPointNames[] = {\n'
+    for name, ret, cargs, callArgs, self in entryPoints:
+        out += '\t"%s",\n' % name
+    out += '};\n\n'
+    for name, ret, cargs, callArgs, self in entryPoints:
+        out += 'static %s traced%s ( %s )\n{\n' % (ret, upperFirst(name), ', '.join(cargs))
+        out += '\tTracedCall tracedCall(TracedEntryPoint_%s);\n' % name
+        out += '\treturn getTracedDriverDispatchTable(%s)->%s ( %s );\n}\n\n' % (self, name, ', '.join(callArgs))
+    out += 'static void installTracedEntryPoints(agpu_icd_dispatch *dispatchTable)\n{\n'
+    for name, ret, cargs, callArgs, self in entryPoints:
+        out += '\tdispatchTable->%s = traced%s;\n' % (name, upperFirst(name))
+    out += '}\n'
+    writeGeneratedFile('implementations/Loader/tracing_layer.inc', out)
+
+if __name__ == '__main__':
+    main()
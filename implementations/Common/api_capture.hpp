@@ -0,0 +1,125 @@
+#ifndef AGPU_COMMON_API_CAPTURE_HPP
+#define AGPU_COMMON_API_CAPTURE_HPP
+
+#include "encoded_commands.hpp"
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+
+namespace AgpuCommon
+{
+
+#include "api_capture.inc"
+
+/**
+ * Format of the API captures, which are written by the capture layer of the
+ * loader, and which are read by AgpuReplay.
+ *
+ * A capture starts with the magic number, followed by the version and by the
+ * number of entry points, and then it is a sequence of records. A record
+ * starts with its kind. The calls are recorded in the order of completion,
+ * with their arguments in the order of the method signature, followed by the
+ * handle of the returned object, if any.
+ *
+ * The integers are stored as LEB128 varints, with zigzag encoding for the
+ * signed ones, and the floating point values as raw native floats. The
+ * handles are replaced by object identifiers, starting at one, and zero is
+ * the null handle. A pointer to data is stored as its count plus one, or zero
+ * when it is null, followed by the data. The captures use the native byte
+ * order and structure layouts, so they are replayed on the same kind of
+ * machine.
+ */
+static constexpr char ApiCaptureMagic[8] = {'A', 'G', 'P', 'U', 'C', 'A', 'P', 'T'};
+static constexpr uint32_t ApiCaptureVersion = 1;
+
+enum ApiCaptureRecordKind
+{
+    // The bytes that were written by the application into a mapped buffer,
+    // as the buffer identifier, the offset and the bytes.
+    ApiCaptureRecordMappedBufferWrite = 0,
+
+    // The call of an entry point, plus the entry point index.
+    ApiCaptureRecordFirstCall = 16,
+};
+
+inline void writeCaptureUnsigned(std::vector<uint8_t> &out, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        out.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+inline void writeCaptureSigned(std::vector<uint8_t> &out, int64_t value)
+{
+    writeCaptureUnsigned(out, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+inline void writeCaptureBytes(std::vector<uint8_t> &out, const void *data, size_t size)
+{
+    auto bytes = reinterpret_cast<const uint8_t*> (data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+inline bool readCaptureUnsigned(const uint8_t *&position, const uint8_t *end, uint64_t &value)
+{
+    value = 0;
+    for(unsigned int shift = 0; shift < 64; shift += 7)
+    {
+        if(position == end)
+            return false;
+
+        auto byte = *position++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+inline int64_t decodeCaptureSigned(uint64_t value)
+{
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+/**
+ * Calls the function with the opcode, the argument index, the argument kind
+ * of EncodedCommandArgumentKinds and the argument slots of each argument of
+ * the encoded commands. The arguments of unknown commands are values. The
+ * buffer must be aligned to 8 bytes. Returns false when it is malformed.
+ */
+template<typename F>
+bool forEachEncodedCommandArgument(uint8_t *commands, size_t size, const F &function)
+{
+    size_t position = 0;
+    while(position < size)
+    {
+        EncodedCommandHeader header;
+        if(size - position < sizeof(header))
+            return false;
+
+        memcpy(&header, commands + position, sizeof(header));
+        if(header.size < sizeof(header) || header.size > size - position ||
+            (header.size - sizeof(header)) % EncodedCommandSlotSize != 0)
+            return false;
+
+        auto kinds = header.opcode < sizeof(EncodedCommandArgumentKinds) / sizeof(EncodedCommandArgumentKinds[0])
+            ? EncodedCommandArgumentKinds[header.opcode] : "";
+        auto kindCount = strlen(kinds);
+        auto arguments = reinterpret_cast<uint64_t*> (commands + position + sizeof(header));
+        auto argumentCount = (header.size - sizeof(header)) / EncodedCommandSlotSize;
+        for(size_t i = 0; i < argumentCount; ++i)
+            function(header.opcode, i, i < kindCount ? kinds[i] : 'v', arguments);
+
+        position += header.size;
+    }
+
+    return true;
+}
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_API_CAPTURE_HPP
@@ -0,0 +1,126 @@
+#include "disk_cache.hpp"
+#include <stdio.h>
+#include <atomic>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace AgpuCommon
+{
+
+static FILE *openCacheFile(const std::string &path, const char *mode)
+{
+    FILE *f = nullptr;
+#ifdef _WIN32
+    if(fopen_s(&f, path.c_str(), mode))
+        return nullptr;
+#else
+    f = fopen(path.c_str(), mode);
+#endif
+    return f;
+}
+
+ContentHasher::ContentHasher()
+{
+    // FNV-1a and djb2 offsets.
+    firstHash = 14695981039346656037ull;
+    secondHash = 5381;
+}
+
+void ContentHasher::add(const void *data, size_t size)
+{
+    auto bytes = reinterpret_cast<const uint8_t*> (data);
+    for(size_t i = 0; i < size; ++i)
+    {
+        firstHash = (firstHash ^ bytes[i]) * 1099511628211ull;
+        secondHash = secondHash*33 + bytes[i];
+    }
+}
+
+void ContentHasher::add(const std::string &string)
+{
+    // Include the size to separate the consecutive strings.
+    add(uint32_t(string.size()));
+    add(string.data(), string.size());
+}
+
+void ContentHasher::add(uint32_t value)
+{
+    add(&value, sizeof(value));
+}
+
+std::string ContentHasher::finish() const
+{
+    char buffer[40];
+    snprintf(buffer, sizeof(buffer), "%016llx%016llx", (unsigned long long)firstHash, (unsigned long long)secondHash);
+    return buffer;
+}
+
+void createCacheDirectory(const std::string &path)
+{
+    // Failures are detected later, when the files are written.
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+bool readCacheFile(const std::string &path, std::vector<uint8_t> &content)
+{
+    auto f = openCacheFile(path, "rb");
+    if(!f)
+        return false;
+
+    bool succeeded = fseek(f, 0, SEEK_END) == 0;
+    auto size = succeeded ? ftell(f) : -1;
+    succeeded = size >= 0 && fseek(f, 0, SEEK_SET) == 0;
+    if(succeeded)
+    {
+        content.resize(size);
+        succeeded = size == 0 || fread(content.data(), content.size(), 1, f) == 1;
+    }
+
+    fclose(f);
+    return succeeded;
+}
+
+bool writeCacheFile(const std::string &path, const void *data, size_t size)
+{
+    // The temporary name must be unique between the threads and the processes.
+    static std::atomic_uint temporaryFileCount(0);
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", int(getpid()), temporaryFileCount++);
+    auto temporaryPath = path + suffix;
+    auto f = openCacheFile(temporaryPath, "wb");
+    if(!f)
+        return false;
+
+    bool succeeded = size == 0 || fwrite(data, size, 1, f) == 1;
+    succeeded = fclose(f) == 0 && succeeded;
+    if(!succeeded)
+    {
+        remove(temporaryPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    if(rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+} // End of namespace AgpuCommon
@@ -0,0 +1,42 @@
+#ifndef AGPU_COMMON_DISK_CACHE_HPP
+#define AGPU_COMMON_DISK_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AgpuCommon
+{
+
+/**
+ * Incremental 128 bits hash that is used for building the keys of the
+ * content addressed caches.
+ */
+class ContentHasher
+{
+public:
+    ContentHasher();
+
+    void add(const void *data, size_t size);
+    void add(const std::string &string);
+    void add(uint32_t value);
+
+    std::string finish() const;
+
+private:
+    uint64_t firstHash;
+    uint64_t secondHash;
+};
+
+// Helpers for the files of the caches that are persisted into a directory.
+void createCacheDirectory(const std::string &path);
+bool readCacheFile(const std::string &path, std::vector<uint8_t> &content);
+
+// The content is written into a temporary file that is renamed afterwards, so
+// that other processes never read partial files.
+bool writeCacheFile(const std::string &path, const void *data, size_t size);
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_DISK_CACHE_HPP
@@ -0,0 +1,112 @@
+#ifndef AGPU_COMMON_ENCODED_COMMANDS_HPP
+#define AGPU_COMMON_ENCODED_COMMANDS_HPP
+
+#include <AGPU/agpu_impl.hpp>
+#include <type_traits>
+#include <string.h>
+#include <stdint.h>
+
+namespace AgpuCommon
+{
+
+/**
+ * The encoded commands are packed one after the other. Each one of them has
+ * this header, followed by one 64 bits slot per argument of the method that
+ * is selected by the opcode, in the order of the method arguments. The
+ * integers, the booleans and the enums are stored as 64 bits integers, the
+ * floating point values as doubles, and the handles and the other pointers
+ * as addresses. The size of a command includes its header. Everything is
+ * stored with the native byte order, and the buffer is aligned to 8 bytes.
+ *
+ * The opcodes are the constants of the encoded_command enum of
+ * definitions/api.xml, which are shared with the encoders of the bindings, so
+ * they are only appended. The decoders are generated from them by
+ * definitions/make_encoded_commands.py.
+ */
+struct EncodedCommandHeader
+{
+    uint32_t opcode;
+    uint32_t size;
+};
+
+static constexpr size_t EncodedCommandSlotSize = 8;
+
+/**
+ * Decoding of the argument slots that are not integers, which is used by the
+ * generated decoders. The integers and the pointers are converted directly.
+ */
+inline double decodeEncodedFloat(uint64_t slot)
+{
+    double result;
+    memcpy(&result, &slot, sizeof(result));
+    return result;
+}
+
+// The handles are borrowed as references, like in the dispatch of the C API.
+template<typename T>
+inline const agpu::ref<T> &decodeEncodedReference(const uint64_t &slot)
+{
+    return *reinterpret_cast<const agpu::ref<T> *> (&slot);
+}
+
+#include "encoded_commands.inc"
+
+template<typename T, typename DF>
+inline agpu_error decodeEncodedCommands(T *self, agpu_pointer commands, agpu_size size, const DF &decodeCommand)
+{
+    if(!commands && size > 0)
+        return AGPU_NULL_POINTER;
+    if(uintptr_t(commands) % EncodedCommandSlotSize != 0 || size % EncodedCommandSlotSize != 0)
+        return AGPU_INVALID_PARAMETER;
+
+    // The commands are read as slots, so that each one of them is validated
+    // once by its header, and its arguments are read without further checks.
+    auto slot = reinterpret_cast<const uint64_t*> (commands);
+    auto end = slot + size / EncodedCommandSlotSize;
+    while(slot != end)
+    {
+        EncodedCommandHeader header;
+        memcpy(&header, slot, sizeof(header));
+
+        auto slotCount = size_t(header.size / EncodedCommandSlotSize);
+        if(header.size % EncodedCommandSlotSize != 0 || slotCount == 0 || slotCount > size_t(end - slot))
+            return AGPU_INVALID_PARAMETER;
+
+        auto error = decodeCommand(self, header.opcode, slot + 1, slotCount - 1);
+        if(error < 0)
+            return error;
+
+        slot += slotCount;
+    }
+
+    return AGPU_OK;
+}
+
+/**
+ * Executes the commands of an encoded buffer, stopping at the first one that
+ * fails. The commands of the state trackers that are not command list
+ * commands are unsupported by the command lists.
+ *
+ * The decoders call the methods of T without a virtual dispatch, so that they
+ * can be inlined into them. T must be the class that implements the recording
+ * methods of its objects: the command list of each backend, and
+ * AbstractStateTracker, whose subclasses only override the recording
+ * lifecycle.
+ */
+template<typename T>
+inline typename std::enable_if<std::is_base_of<agpu::command_list, T>::value, agpu_error>::type
+executeEncodedCommands(T *commandList, agpu_pointer commands, agpu_size size)
+{
+    return decodeEncodedCommands(commandList, commands, size, decodeCommandListCommand<T>);
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_base_of<agpu::state_tracker, T>::value, agpu_error>::type
+executeEncodedCommands(T *stateTracker, agpu_pointer commands, agpu_size size)
+{
+    return decodeEncodedCommands(stateTracker, commands, size, decodeStateTrackerCommand<T>);
+}
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_ENCODED_COMMANDS_HPP
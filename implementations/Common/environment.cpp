@@ -0,0 +1,34 @@
+#include "environment.hpp"
+#include <stdlib.h>
+
+namespace AgpuCommon
+{
+
+std::string getStringFromEnvironment(const char *varname)
+{
+#ifdef _WIN32
+    char *buffer;
+    size_t size;
+    auto error = _dupenv_s(&buffer, &size, varname);
+    if (error) return std::string();
+    if (!buffer) return std::string();
+    std::string res = buffer;
+    free(buffer);
+    return res;
+#else
+    auto value = getenv(varname);
+    if (!value)
+        return std::string();
+    return value;
+#endif
+}
+
+bool getBooleanEnvironment(const char *varname, bool defaultValue)
+{
+    auto result = getStringFromEnvironment(varname);
+    if (result.empty())
+        return defaultValue;
+    return result != "0" && result != "n";
+}
+
+} // End of namespace AgpuCommon
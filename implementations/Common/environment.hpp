@@ -0,0 +1,17 @@
+#ifndef AGPU_COMMON_ENVIRONMENT_HPP
+#define AGPU_COMMON_ENVIRONMENT_HPP
+
+#include <string>
+
+namespace AgpuCommon
+{
+
+// Returns an empty string when the variable is not defined.
+std::string getStringFromEnvironment(const char *varname);
+
+// Any value other than "0" and "n" is true.
+bool getBooleanEnvironment(const char *varname, bool defaultValue = false);
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_ENVIRONMENT_HPP
@@ -0,0 +1,119 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace AgpuCommon
+{
+
+MappedFile::MappedFile()
+    : data(nullptr), size(0)
+{
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE;
+    mappingHandle = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mappingHandle)
+    {
+        close();
+        return false;
+    }
+
+    data = reinterpret_cast<const uint8_t*> (MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if(!data)
+    {
+        close();
+        return false;
+    }
+
+    size = size_t(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(data)
+        UnmapViewOfFile(data);
+    if(mappingHandle)
+        CloseHandle(mappingHandle);
+    if(fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) < 0 || fileStat.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping keeps its own reference to the file.
+    auto mapping = mmap(nullptr, size_t(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED)
+        return false;
+
+    data = reinterpret_cast<const uint8_t*> (mapping);
+    size = size_t(fileStat.st_size);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(data)
+        munmap(const_cast<uint8_t*> (data), size);
+
+    data = nullptr;
+    size = 0;
+}
+
+#endif
+
+} // End of namespace AgpuCommon
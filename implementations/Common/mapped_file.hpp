@@ -0,0 +1,50 @@
+#ifndef AGPU_COMMON_MAPPED_FILE_HPP
+#define AGPU_COMMON_MAPPED_FILE_HPP
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AgpuCommon
+{
+
+/**
+ * Read only memory mapping of a whole file. The pages are only read from the
+ * disk when they are touched, and they are shared between the processes that
+ * map the same file.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    const uint8_t *getData() const
+    {
+        return data;
+    }
+
+    size_t getSize() const
+    {
+        return size;
+    }
+
+private:
+    const uint8_t *data;
+    size_t size;
+
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+};
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_MAPPED_FILE_HPP
@@ -1,13 +1,23 @@
 #include "offline_shader_compiler.hpp"
+#include "spirv_cache.hpp"
+#include "shader_compilation_pool.hpp"
 #include "glslang/Public/ShaderLang.h"
 #include "StandAlone/ResourceLimits.h"
 #include "SPIRV/GlslangToSpv.h"
 #include "SPIRV/GLSL.std.450.h"
+#ifdef AGPU_HAS_SPIRV_TOOLS_OPT
+#include "spirv-tools/optimizer.hpp"
+#else
+#include "SPIRV/SPVRemapper.h"
+#endif
 //#include "SPIRV/doc.h"
 //#include "SPIRV/disassemble.h"
 
 #include <string.h>
+#include <ctype.h>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 
 namespace AgpuCommon
 {
@@ -52,7 +62,53 @@ static inline glslang::EShClient mapShaderSourceClient(agpu_shader_language lang
     }
 }
 
+// Converts the -DNAME and -DNAME=VALUE options into a preamble with defines.
+static std::string makeDefinitionsPreamble(agpu_cstring options)
+{
+    std::string preamble;
+    if(!options)
+        return preamble;
+
+    auto position = options;
+    while(*position)
+    {
+        while(*position && isspace((unsigned char)*position))
+            ++position;
+
+        auto tokenStart = position;
+        while(*position && !isspace((unsigned char)*position))
+            ++position;
+
+        std::string token(tokenStart, position);
+        if(token.size() <= 2 || token[0] != '-' || token[1] != 'D')
+            continue;
+
+        auto definition = token.substr(2);
+        auto equalsPosition = definition.find('=');
+        preamble += "#define ";
+        if(equalsPosition == std::string::npos)
+        {
+            preamble += definition;
+        }
+        else
+        {
+            preamble += definition.substr(0, equalsPosition);
+            preamble += ' ';
+            preamble += definition.substr(equalsPosition + 1);
+        }
+        preamble += '\n';
+    }
+
+    return preamble;
+}
+
+static inline double millisecondsSince(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - startTime).count();
+}
+
 GLSLangOfflineShaderCompiler::GLSLangOfflineShaderCompiler()
+    : compilationProfile(AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_DEBUG)
 {
 }
 
@@ -140,6 +196,36 @@ agpu_error GLSLangOfflineShaderCompiler::compileShaderWithGLSLang(agpu_shader_la
     if(!isTargetShaderLanguageSupported(target_language))
         return AGPU_UNSUPPORTED;
 
+    auto startTime = std::chrono::steady_clock::now();
+    auto definitionsPreamble = makeDefinitionsPreamble(options);
+
+    // Look for the Spir-V of an identical compilation.
+    auto &spirvCache = SpirVShaderCache::get();
+    std::string cacheKey;
+    if(spirvCache.isEnabled())
+    {
+        auto keyHasher = spirvCache.makeKeyHasher();
+        keyHasher.add(uint32_t(shaderLanguage));
+        keyHasher.add(uint32_t(shaderStage));
+        keyHasher.add(uint32_t(compilationProfile));
+        keyHasher.add(definitionsPreamble);
+        keyHasher.add(shaderSource.data(), shaderSource.size());
+        cacheKey = keyHasher.finish();
+
+        bool readFromDisk = false;
+        auto cachedCode = spirvCache.find(cacheKey, readFromDisk);
+        if(cachedCode)
+        {
+            spirvCode = *cachedCode;
+            compilationLog.clear();
+            spirvCache.recordCacheHit(readFromDisk, millisecondsSince(startTime));
+
+            if(target_language == AGPU_SHADER_LANGUAGE_DEVICE_SHADER)
+                return createDeviceSpecificShader();
+            return AGPU_OK;
+        }
+    }
+
     // Initialize the shader compiler library.
     std::call_once(shaderCompilerLibraryInitializedFlag, []{
         glslang::InitializeProcess();
@@ -153,6 +239,8 @@ agpu_error GLSLangOfflineShaderCompiler::compileShaderWithGLSLang(agpu_shader_la
     auto shaderSourceStringPointer = &shaderSource[0];
     int shaderSourceStringLength = shaderSource.size();
     shader.setStringsWithLengths(&shaderSourceStringPointer, &shaderSourceStringLength, 1);
+    if(!definitionsPreamble.empty())
+        shader.setPreamble(definitionsPreamble.c_str());
 
     // Setup the shader compiler.
     shader.setEnvInput(mapShaderSourceLanguage(shaderLanguage), glslStage, mapShaderSourceClient(shaderLanguage), 10);
@@ -195,20 +283,83 @@ agpu_error GLSLangOfflineShaderCompiler::compileShaderWithGLSLang(agpu_shader_la
     std::string warningsErrors;
     spv::SpvBuildLogger logger;
     glslang::SpvOptions spvOptions;
-    spvOptions.generateDebugInfo = true;
+    spvOptions.generateDebugInfo = compilationProfile == AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_DEBUG;
     spvOptions.disableOptimizer = false;
     spvOptions.optimizeSize = false;
     spvOptions.disassemble = false;
     spvOptions.validate = false;
+    spirvCode.clear();
     glslang::GlslangToSpv(*ir, spirvCode, &logger, &spvOptions);
 
     compilationLog += logger.getAllMessages();
+    if(compilationProfile != AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_DEBUG)
+    {
+        auto error = optimizeSpirVCode();
+        if(error)
+            return error;
+    }
+
+    spirvCache.recordCompilation(millisecondsSince(startTime));
+    if(!cacheKey.empty())
+        spirvCache.store(cacheKey, spirvCode);
+
     if(target_language == AGPU_SHADER_LANGUAGE_DEVICE_SHADER)
         return createDeviceSpecificShader();
 
     return AGPU_OK;
 }
 
+agpu_error GLSLangOfflineShaderCompiler::optimizeSpirVCode()
+{
+#ifdef AGPU_HAS_SPIRV_TOOLS_OPT
+    spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_0);
+    optimizer.SetMessageConsumer([&](spv_message_level_t, const char*, const spv_position_t&, const char *message) {
+        compilationLog += message;
+        compilationLog += '\n';
+    });
+
+    if(compilationProfile == AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_SIZE)
+        optimizer.RegisterSizePasses();
+    else
+        optimizer.RegisterPerformancePasses();
+    optimizer.RegisterPass(spvtools::CreateStripDebugInfoPass());
+
+    std::vector<uint32_t> optimizedCode;
+    if(!optimizer.Run(spirvCode.data(), spirvCode.size(), &optimizedCode))
+    {
+        compilationLog += "Failed to optimize the Spir-V code.\n";
+        return AGPU_COMPILATION_ERROR;
+    }
+
+    spirvCode.swap(optimizedCode);
+#else
+    // The remapper of glslang can only strip the debug information, and remove
+    // the dead code and the redundant loads and stores. The default error
+    // handler of the remapper terminates the process.
+    static thread_local bool remapperFailed;
+    static std::once_flag remapperErrorHandlerFlag;
+    std::call_once(remapperErrorHandlerFlag, []{
+        spv::spirvbin_t::registerErrorHandler([](const std::string &) {
+            remapperFailed = true;
+        });
+    });
+
+    remapperFailed = false;
+    auto optimizedCode = spirvCode;
+    spv::spirvbin_t remapper;
+    remapper.remap(optimizedCode, spv::spirvbin_t::STRIP | spv::spirvbin_t::DCE_ALL | spv::spirvbin_t::OPT_ALL);
+    if(remapperFailed)
+    {
+        // Keep the unoptimized code, which is still valid.
+        compilationLog += "Failed to optimize the Spir-V code.\n";
+        return AGPU_OK;
+    }
+
+    spirvCode.swap(optimizedCode);
+#endif
+    return AGPU_OK;
+}
+
 agpu_error GLSLangOfflineShaderCompiler::assembleSpirVSource(agpu_shader_language target_language, agpu_cstring options)
 {
     return AGPU_UNIMPLEMENTED;
@@ -289,4 +440,53 @@ agpu::shader_ptr GLSLangOfflineShaderCompiler::getResultAsShader()
     return shaderHandleResult.disownedNewRef();
 }
 
+// The statistics are kept by the process wide Spir-V cache, so they include
+// the compilations of every compiler, such as the ones of the batch jobs.
+agpu_error GLSLangOfflineShaderCompiler::getCompilationStatistics(agpu_shader_compilation_statistics* statistics)
+{
+    if(!statistics)
+        return AGPU_NULL_POINTER;
+
+    SpirVShaderCache::get().getStatistics(statistics);
+    return AGPU_OK;
+}
+
+agpu_error GLSLangOfflineShaderCompiler::compileShaderBatch(agpu_size job_count, agpu_offline_shader_compilation_job* jobs, agpu_uint thread_count)
+{
+    if(!jobs && job_count > 0)
+        return AGPU_NULL_POINTER;
+
+    // Each job gets its own compiler, which keeps its result and its log.
+    std::atomic_bool hasFailedJob(false);
+    ShaderCompilationWorkerPool::get().runBatch(job_count, thread_count, [&](size_t jobIndex) {
+        auto &job = jobs[jobIndex];
+        auto jobCompiler = device ? createForDevice(device) : create();
+        job.result = jobCompiler->setCompilationProfile(job.profile);
+        if(job.result == AGPU_OK)
+            job.result = jobCompiler->setShaderSource(job.source_language, job.stage, job.source_text, job.source_text_length);
+        if(job.result == AGPU_OK)
+            job.result = jobCompiler->compileShader(job.target_language, job.options);
+
+        if(job.result != AGPU_OK)
+            hasFailedJob = true;
+        job.compiler = reinterpret_cast<agpu_offline_shader_compiler*> (jobCompiler.disown());
+    });
+
+    return hasFailedJob ? AGPU_COMPILATION_ERROR : AGPU_OK;
+}
+
+agpu_error GLSLangOfflineShaderCompiler::setCompilationProfile(agpu_offline_shader_compilation_profile profile)
+{
+    switch(profile)
+    {
+    case AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_DEBUG:
+    case AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_RELEASE:
+    case AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_SIZE:
+        compilationProfile = profile;
+        return AGPU_OK;
+    default:
+        return AGPU_INVALID_PARAMETER;
+    }
+}
+
 } // End of namespace AgpuCommon
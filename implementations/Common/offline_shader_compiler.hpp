@@ -26,15 +26,20 @@ public:
     virtual agpu_size getCompilationResultLength() override;
 	virtual agpu_error getCompilationResult(agpu_size buffer_size, agpu_string_buffer buffer) override;
 	virtual agpu::shader_ptr getResultAsShader() override;
+    virtual agpu_error getCompilationStatistics(agpu_shader_compilation_statistics* statistics) override;
+    virtual agpu_error compileShaderBatch(agpu_size job_count, agpu_offline_shader_compilation_job* jobs, agpu_uint thread_count) override;
+    virtual agpu_error setCompilationProfile(agpu_offline_shader_compilation_profile profile) override;
 
     agpu_error compileShaderWithGLSLang(agpu_shader_language target_language, agpu_cstring options);
     agpu_error assembleSpirVSource(agpu_shader_language target_language, agpu_cstring options);
     agpu_error createDeviceSpecificShader();
+    agpu_error optimizeSpirVCode();
 
     agpu::device_ref device;
 
     agpu_shader_language shaderLanguage;
     agpu_shader_type shaderStage;
+    agpu_offline_shader_compilation_profile compilationProfile;
     std::vector<char> shaderSource;
     std::string compilationLog;
 
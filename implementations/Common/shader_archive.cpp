@@ -0,0 +1,250 @@
+#include "shader_archive.hpp"
+#include "disk_cache.hpp"
+#include <algorithm>
+#include <string.h>
+
+namespace AgpuCommon
+{
+
+static inline size_t alignedSize(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// ShaderArchiveWriter
+ShaderArchiveWriter::ShaderArchiveWriter()
+{
+}
+
+ShaderArchiveWriter::~ShaderArchiveWriter()
+{
+}
+
+bool ShaderArchiveWriter::addShader(const std::string &name, agpu_shader_type stage, agpu_shader_language language, const void *code, size_t codeSize)
+{
+    if(shaderNames.find(name) != shaderNames.end())
+        return false;
+
+    // The permutations that do not change the code share it.
+    ContentHasher hasher;
+    hasher.add(uint32_t(language));
+    hasher.add(code, codeSize);
+    auto codeKey = hasher.finish();
+
+    auto codeBytes = reinterpret_cast<const uint8_t*> (code);
+    size_t codeIndex = codes.size();
+    auto it = codeIndices.find(codeKey);
+    if(it != codeIndices.end() &&
+        codes[it->second].size() == codeSize &&
+        std::equal(codeBytes, codeBytes + codeSize, codes[it->second].begin()))
+    {
+        codeIndex = it->second;
+    }
+    else
+    {
+        codes.push_back(std::vector<uint8_t> (codeBytes, codeBytes + codeSize));
+        codeIndices.insert(std::make_pair(codeKey, codeIndex));
+    }
+
+    Shader shader;
+    shader.name = name;
+    shader.stage = stage;
+    shader.language = language;
+    shader.codeIndex = codeIndex;
+    shaderNames.insert(std::make_pair(name, shaders.size()));
+    shaders.push_back(shader);
+    return true;
+}
+
+std::vector<uint8_t> ShaderArchiveWriter::build() const
+{
+    // The entries are sorted by name, for the binary search of the loader.
+    std::vector<const Shader*> sortedShaders;
+    sortedShaders.reserve(shaders.size());
+    for(auto &shader : shaders)
+        sortedShaders.push_back(&shader);
+    std::sort(sortedShaders.begin(), sortedShaders.end(), [](const Shader *a, const Shader *b) {
+        return strcmp(a->name.c_str(), b->name.c_str()) < 0;
+    });
+
+    size_t stringTableSize = 0;
+    for(auto &shader : shaders)
+        stringTableSize += shader.name.size() + 1;
+
+    auto entryTableOffset = sizeof(ShaderArchiveHeader);
+    auto stringTableOffset = entryTableOffset + shaders.size()*sizeof(ShaderArchiveEntry);
+    auto codeOffset = alignedSize(stringTableOffset + stringTableSize, ShaderArchiveCodeAlignment);
+
+    std::vector<uint64_t> codeOffsets(codes.size());
+    for(size_t i = 0; i < codes.size(); ++i)
+    {
+        codeOffsets[i] = codeOffset;
+        codeOffset = alignedSize(codeOffset + codes[i].size(), ShaderArchiveCodeAlignment);
+    }
+
+    std::vector<uint8_t> content(codeOffset, 0);
+
+    auto header = reinterpret_cast<ShaderArchiveHeader*> (&content[0]);
+    header->magic = ShaderArchiveMagic;
+    header->version = ShaderArchiveVersion;
+    header->entryCount = uint32_t(shaders.size());
+    header->entryTableOffset = uint32_t(entryTableOffset);
+    header->stringTableOffset = uint32_t(stringTableOffset);
+    header->stringTableSize = uint32_t(stringTableSize);
+    header->fileSize = content.size();
+
+    auto entries = reinterpret_cast<ShaderArchiveEntry*> (&content[entryTableOffset]);
+    auto strings = reinterpret_cast<char*> (&content[stringTableOffset]);
+    size_t nameOffset = 0;
+    for(size_t i = 0; i < sortedShaders.size(); ++i)
+    {
+        auto shader = sortedShaders[i];
+        auto &entry = entries[i];
+        entry.nameOffset = uint32_t(nameOffset);
+        entry.nameLength = uint32_t(shader->name.size());
+        entry.stage = uint32_t(shader->stage);
+        entry.language = uint32_t(shader->language);
+        entry.codeOffset = codeOffsets[shader->codeIndex];
+        entry.codeSize = codes[shader->codeIndex].size();
+
+        memcpy(strings + nameOffset, shader->name.c_str(), shader->name.size() + 1);
+        nameOffset += shader->name.size() + 1;
+    }
+
+    for(size_t i = 0; i < codes.size(); ++i)
+    {
+        if(!codes[i].empty())
+            memcpy(&content[codeOffsets[i]], codes[i].data(), codes[i].size());
+    }
+
+    return content;
+}
+
+bool ShaderArchiveWriter::writeToFile(const std::string &path) const
+{
+    auto content = build();
+    return writeCacheFile(path, content.data(), content.size());
+}
+
+// ShaderArchive
+ShaderArchive::ShaderArchive()
+    : header(nullptr), entries(nullptr), strings(nullptr)
+{
+}
+
+ShaderArchive::~ShaderArchive()
+{
+}
+
+agpu::shader_archive_ref ShaderArchive::open(const agpu::device_ref &device, const std::string &path)
+{
+    auto result = agpu::makeObject<ShaderArchive> ();
+    auto archive = result.as<ShaderArchive> ();
+    archive->device = device;
+    if(!archive->file.open(path) || !archive->validate())
+        return agpu::shader_archive_ref();
+
+    return result;
+}
+
+bool ShaderArchive::validate()
+{
+    auto data = file.getData();
+    auto size = file.getSize();
+    if(size < sizeof(ShaderArchiveHeader))
+        return false;
+
+    header = reinterpret_cast<const ShaderArchiveHeader*> (data);
+    if(header->magic != ShaderArchiveMagic || header->version != ShaderArchiveVersion || header->fileSize != size)
+        return false;
+
+    // Check the bounds of the tables.
+    uint64_t entryTableEnd = uint64_t(header->entryTableOffset) + uint64_t(header->entryCount)*sizeof(ShaderArchiveEntry);
+    uint64_t stringTableEnd = uint64_t(header->stringTableOffset) + header->stringTableSize;
+    if(header->entryTableOffset % alignof(ShaderArchiveEntry) != 0 || entryTableEnd > size || stringTableEnd > size)
+        return false;
+
+    entries = reinterpret_cast<const ShaderArchiveEntry*> (data + header->entryTableOffset);
+    strings = reinterpret_cast<const char*> (data + header->stringTableOffset);
+
+    // Check the bounds of the names and of the code.
+    for(size_t i = 0; i < header->entryCount; ++i)
+    {
+        auto &entry = entries[i];
+        if(uint64_t(entry.nameOffset) + entry.nameLength >= header->stringTableSize ||
+            strings[entry.nameOffset + entry.nameLength] != 0)
+            return false;
+
+        if(entry.codeOffset > size || entry.codeSize > size - entry.codeOffset)
+            return false;
+    }
+
+    return true;
+}
+
+agpu_size ShaderArchive::getShaderCount()
+{
+    return header->entryCount;
+}
+
+agpu_int ShaderArchive::findShader(agpu_cstring name)
+{
+    if(!name)
+        return -1;
+
+    // The entries are sorted by name.
+    auto begin = entries;
+    auto end = entries + header->entryCount;
+    auto it = std::lower_bound(begin, end, name, [&](const ShaderArchiveEntry &entry, agpu_cstring name) {
+        return strcmp(strings + entry.nameOffset, name) < 0;
+    });
+
+    if(it == end || strcmp(strings + it->nameOffset, name) != 0)
+        return -1;
+    return agpu_int(it - begin);
+}
+
+agpu_cstring ShaderArchive::getShaderName(agpu_size index)
+{
+    if(index >= header->entryCount)
+        return nullptr;
+    return strings + entries[index].nameOffset;
+}
+
+agpu_shader_type ShaderArchive::getShaderStage(agpu_size index)
+{
+    if(index >= header->entryCount)
+        return AGPU_VERTEX_SHADER;
+    return agpu_shader_type(entries[index].stage);
+}
+
+agpu::shader_ptr ShaderArchive::createShader(agpu_size index)
+{
+    if(index >= header->entryCount || !device)
+        return nullptr;
+
+    auto &entry = entries[index];
+    auto shader = agpu::shader_ref(device->createShader(agpu_shader_type(entry.stage)));
+    if(!shader)
+        return nullptr;
+
+    // The code is used directly from the mapping.
+    auto code = reinterpret_cast<agpu_string> (file.getData() + entry.codeOffset);
+    auto error = shader->setShaderSource(agpu_shader_language(entry.language), code, agpu_string_length(entry.codeSize));
+    if(!error)
+        error = shader->compileShader(nullptr);
+    if(error)
+        return nullptr;
+
+    return shader.disown();
+}
+
+agpu::shader_ptr ShaderArchive::createShaderWithName(agpu_cstring name)
+{
+    auto index = findShader(name);
+    if(index < 0)
+        return nullptr;
+    return createShader(agpu_size(index));
+}
+
+} // End of namespace AgpuCommon
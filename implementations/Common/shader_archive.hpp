@@ -0,0 +1,121 @@
+#ifndef AGPU_COMMON_SHADER_ARCHIVE_HPP
+#define AGPU_COMMON_SHADER_ARCHIVE_HPP
+
+#include <AGPU/agpu_impl.hpp>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "mapped_file.hpp"
+
+namespace AgpuCommon
+{
+
+// Increment this when the layout of the archives changes.
+static constexpr uint32_t ShaderArchiveVersion = 1;
+static constexpr uint32_t ShaderArchiveMagic = 0x50534741; // AGSP
+static constexpr size_t ShaderArchiveCodeAlignment = 16;
+
+/**
+ * The archives start with this header, which is followed by the table of the
+ * entries, sorted by name, by the string table with the names, and by the
+ * code of the shaders. The offsets are relative to the start of the file, and
+ * everything is stored in little endian, so the archive is used in place,
+ * directly from a memory mapping.
+ */
+struct ShaderArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t entryTableOffset;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+    uint64_t fileSize;
+};
+
+// The names are null terminated. The entries with the same code share it.
+struct ShaderArchiveEntry
+{
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t stage;
+    uint32_t language;
+    uint64_t codeOffset;
+    uint64_t codeSize;
+};
+
+/**
+ * Builds the content of a shader archive. This is used by the shader pack
+ * builder.
+ */
+class ShaderArchiveWriter
+{
+public:
+    ShaderArchiveWriter();
+    ~ShaderArchiveWriter();
+
+    // Fails when there is already a shader with the same name.
+    bool addShader(const std::string &name, agpu_shader_type stage, agpu_shader_language language, const void *code, size_t codeSize);
+
+    size_t getShaderCount() const
+    {
+        return shaders.size();
+    }
+
+    size_t getUniqueCodeCount() const
+    {
+        return codes.size();
+    }
+
+    std::vector<uint8_t> build() const;
+    bool writeToFile(const std::string &path) const;
+
+private:
+    struct Shader
+    {
+        std::string name;
+        agpu_shader_type stage;
+        agpu_shader_language language;
+        size_t codeIndex;
+    };
+
+    std::vector<Shader> shaders;
+    std::unordered_map<std::string, size_t> shaderNames;
+    std::vector<std::vector<uint8_t>> codes;
+    std::unordered_map<std::string, size_t> codeIndices;
+};
+
+/**
+ * Shader archive that is mapped into memory. The shaders are created directly
+ * from the code that is stored in the archive, without compiling anything, so
+ * only the pages of the shaders that are used are read from the disk.
+ */
+class ShaderArchive : public agpu::shader_archive
+{
+public:
+    ShaderArchive();
+    ~ShaderArchive();
+
+    static agpu::shader_archive_ref open(const agpu::device_ref &device, const std::string &path);
+
+    virtual agpu_size getShaderCount() override;
+    virtual agpu_int findShader(agpu_cstring name) override;
+    virtual agpu_cstring getShaderName(agpu_size index) override;
+    virtual agpu_shader_type getShaderStage(agpu_size index) override;
+    virtual agpu::shader_ptr createShader(agpu_size index) override;
+    virtual agpu::shader_ptr createShaderWithName(agpu_cstring name) override;
+
+private:
+    bool validate();
+
+    agpu::device_ref device;
+    MappedFile file;
+    const ShaderArchiveHeader *header;
+    const ShaderArchiveEntry *entries;
+    const char *strings;
+};
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_SHADER_ARCHIVE_HPP
@@ -0,0 +1,136 @@
+#include "shader_compilation_pool.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace AgpuCommon
+{
+
+struct ShaderCompilationWorkerPool::Batch
+{
+    const JobFunction *job;
+    size_t jobCount;
+    std::atomic_size_t nextJobIndex;
+
+    // These are protected by the mutex of the pool.
+    size_t maxHelperCount;
+    size_t helperCount;
+};
+
+ShaderCompilationWorkerPool &ShaderCompilationWorkerPool::get()
+{
+    static ShaderCompilationWorkerPool singleton;
+    return singleton;
+}
+
+ShaderCompilationWorkerPool::ShaderCompilationWorkerPool()
+    : shuttingDown(false)
+{
+}
+
+ShaderCompilationWorkerPool::~ShaderCompilationWorkerPool()
+{
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        shuttingDown = true;
+        pendingBatchCondition.notify_all();
+    }
+
+    for(auto &thread : workerThreads)
+        thread.join();
+}
+
+void ShaderCompilationWorkerPool::runBatch(size_t jobCount, size_t threadCount, const JobFunction &job)
+{
+    if(jobCount == 0)
+        return;
+
+    if(threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::min(threadCount, jobCount);
+
+    // Small batches are not worth waking up the workers.
+    if(threadCount <= 1)
+    {
+        for(size_t i = 0; i < jobCount; ++i)
+            job(i);
+        return;
+    }
+
+    Batch batch;
+    batch.job = &job;
+    batch.jobCount = jobCount;
+    batch.nextJobIndex = 0;
+    batch.maxHelperCount = threadCount - 1;
+    batch.helperCount = 0;
+
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        ensureWorkerCount(threadCount - 1);
+        pendingBatches.push_back(&batch);
+        pendingBatchCondition.notify_all();
+    }
+
+    runBatchJobs(&batch);
+
+    // All of the jobs have been taken, and the batch lives in this stack
+    // frame, so wait for the helpers to finish their last jobs.
+    std::unique_lock<std::mutex> l(mutex);
+    auto it = std::find(pendingBatches.begin(), pendingBatches.end(), &batch);
+    if(it != pendingBatches.end())
+        pendingBatches.erase(it);
+
+    while(batch.helperCount > 0)
+        finishedBatchCondition.wait(l);
+}
+
+void ShaderCompilationWorkerPool::runBatchJobs(Batch *batch)
+{
+    for(;;)
+    {
+        auto jobIndex = batch->nextJobIndex++;
+        if(jobIndex >= batch->jobCount)
+            break;
+
+        (*batch->job)(jobIndex);
+    }
+}
+
+void ShaderCompilationWorkerPool::ensureWorkerCount(size_t count)
+{
+    while(workerThreads.size() < count)
+        workerThreads.push_back(std::thread([this] { workerThreadEntry(); }));
+}
+
+ShaderCompilationWorkerPool::Batch *ShaderCompilationWorkerPool::findBatchNeedingHelp()
+{
+    for(auto batch : pendingBatches)
+    {
+        if(batch->helperCount < batch->maxHelperCount && batch->nextJobIndex < batch->jobCount)
+            return batch;
+    }
+
+    return nullptr;
+}
+
+void ShaderCompilationWorkerPool::workerThreadEntry()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    for(;;)
+    {
+        Batch *batch = nullptr;
+        while(!shuttingDown && !(batch = findBatchNeedingHelp()))
+            pendingBatchCondition.wait(l);
+
+        if(shuttingDown)
+            return;
+
+        ++batch->helperCount;
+        l.unlock();
+        runBatchJobs(batch);
+        l.lock();
+        --batch->helperCount;
+        finishedBatchCondition.notify_all();
+    }
+}
+
+} // End of namespace AgpuCommon
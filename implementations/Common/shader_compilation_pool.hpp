@@ -0,0 +1,52 @@
+#ifndef AGPU_COMMON_SHADER_COMPILATION_POOL_HPP
+#define AGPU_COMMON_SHADER_COMPILATION_POOL_HPP
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stddef.h>
+
+namespace AgpuCommon
+{
+
+/**
+ * Process wide pool of threads for running the batches of offline shader
+ * compilations. The threads are created on demand, up to the largest thread
+ * count that has been requested. The thread that submits a batch also runs
+ * jobs of it, and it only returns when all of the jobs are finished. Batches
+ * from different threads can run at the same time.
+ */
+class ShaderCompilationWorkerPool
+{
+public:
+    typedef std::function<void (size_t)> JobFunction;
+
+    static ShaderCompilationWorkerPool &get();
+
+    // A thread count of zero uses all of the hardware threads.
+    void runBatch(size_t jobCount, size_t threadCount, const JobFunction &job);
+
+private:
+    struct Batch;
+
+    ShaderCompilationWorkerPool();
+    ~ShaderCompilationWorkerPool();
+
+    void ensureWorkerCount(size_t count);
+    void workerThreadEntry();
+    Batch *findBatchNeedingHelp();
+    static void runBatchJobs(Batch *batch);
+
+    std::mutex mutex;
+    std::condition_variable pendingBatchCondition;
+    std::condition_variable finishedBatchCondition;
+    std::vector<Batch*> pendingBatches;
+    std::vector<std::thread> workerThreads;
+    bool shuttingDown;
+};
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_SHADER_COMPILATION_POOL_HPP
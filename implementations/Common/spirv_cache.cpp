@@ -0,0 +1,165 @@
+#include "spirv_cache.hpp"
+#include "environment.hpp"
+#include "glslang/Public/ShaderLang.h"
+#include "SPIRV/GlslangToSpv.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace AgpuCommon
+{
+
+// Increment this when the file format or the content of the keys change.
+static constexpr uint32_t SpirVCacheVersion = 1;
+static constexpr uint32_t SpirVCacheFileMagic = 0x56535041; // APSV
+
+struct SpirVCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t wordCount;
+    uint32_t reserved;
+};
+
+SpirVShaderCache &SpirVShaderCache::get()
+{
+    static SpirVShaderCache singleton;
+    return singleton;
+}
+
+SpirVShaderCache::SpirVShaderCache()
+{
+    memset(&statistics, 0, sizeof(statistics));
+    enabled = !getBooleanEnvironment("DISABLE_SPIRV_CACHE", false);
+    directory = getStringFromEnvironment("SPIRV_CACHE_DIR");
+    if(enabled && !directory.empty())
+        createCacheDirectory(directory);
+}
+
+SpirVShaderCache::~SpirVShaderCache()
+{
+}
+
+ContentHasher SpirVShaderCache::makeKeyHasher() const
+{
+    ContentHasher hasher;
+    hasher.add(SpirVCacheVersion);
+    hasher.add(uint32_t(GLSLANG_MINOR_VERSION));
+    hasher.add(uint32_t(glslang::GetKhronosToolId()));
+    hasher.add(uint32_t(glslang::GetSpirvGeneratorVersion()));
+    hasher.add(std::string(glslang::GetGlslVersionString()));
+    hasher.add(std::string(glslang::GetEsslVersionString()));
+    return hasher;
+}
+
+std::string SpirVShaderCache::pathForKey(const std::string &key) const
+{
+    return directory + "/" + key + ".spv";
+}
+
+SpirVShaderCache::SpirVCodeRef SpirVShaderCache::find(const std::string &key, bool &readFromDisk)
+{
+    readFromDisk = false;
+    if(!enabled)
+        return nullptr;
+
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        auto it = entries.find(key);
+        if(it != entries.end())
+            return it->second;
+    }
+
+    if(directory.empty())
+        return nullptr;
+
+    // Read the entry outside of the lock.
+    auto code = std::make_shared<SpirVCode> ();
+    if(!readSpirVCode(key, *code))
+        return nullptr;
+
+    readFromDisk = true;
+    std::unique_lock<std::mutex> l(mutex);
+    entries[key] = code;
+    return code;
+}
+
+void SpirVShaderCache::store(const std::string &key, const SpirVCode &code)
+{
+    if(!enabled || code.empty())
+        return;
+
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        entries[key] = std::make_shared<SpirVCode> (code);
+    }
+
+    if(!directory.empty())
+        writeSpirVCode(key, code);
+}
+
+bool SpirVShaderCache::readSpirVCode(const std::string &key, SpirVCode &code)
+{
+    std::vector<uint8_t> content;
+    if(!readCacheFile(pathForKey(key), content) || content.size() < sizeof(SpirVCacheFileHeader))
+        return false;
+
+    SpirVCacheFileHeader header;
+    memcpy(&header, content.data(), sizeof(header));
+    if(header.magic != SpirVCacheFileMagic ||
+        header.version != SpirVCacheVersion ||
+        header.wordCount == 0 ||
+        size_t(header.wordCount)*4 != content.size() - sizeof(header))
+        return false;
+
+    code.resize(header.wordCount);
+    memcpy(code.data(), content.data() + sizeof(header), code.size()*4);
+    return true;
+}
+
+void SpirVShaderCache::writeSpirVCode(const std::string &key, const SpirVCode &code)
+{
+    SpirVCacheFileHeader header;
+    header.magic = SpirVCacheFileMagic;
+    header.version = SpirVCacheVersion;
+    header.wordCount = uint32_t(code.size());
+    header.reserved = 0;
+
+    std::vector<uint8_t> content(sizeof(header) + code.size()*4);
+    memcpy(content.data(), &header, sizeof(header));
+    memcpy(content.data() + sizeof(header), code.data(), code.size()*4);
+    writeCacheFile(pathForKey(key), content.data(), content.size());
+}
+
+void SpirVShaderCache::recordCompilation(double compilationTime)
+{
+    std::unique_lock<std::mutex> l(statisticsMutex);
+    ++statistics.compilation_count;
+    ++statistics.cache_miss_count;
+    statistics.total_compilation_time += float(compilationTime);
+    statistics.last_compilation_time = float(compilationTime);
+}
+
+void SpirVShaderCache::recordCacheHit(bool fromDisk, double lookupTime)
+{
+    std::unique_lock<std::mutex> l(statisticsMutex);
+    ++statistics.compilation_count;
+    if(fromDisk)
+        ++statistics.disk_cache_hit_count;
+    else
+        ++statistics.memory_cache_hit_count;
+    statistics.total_cache_lookup_time += float(lookupTime);
+    statistics.last_compilation_time = float(lookupTime);
+}
+
+void SpirVShaderCache::getStatistics(agpu_shader_compilation_statistics *result)
+{
+    {
+        std::unique_lock<std::mutex> l(statisticsMutex);
+        *result = statistics;
+    }
+
+    std::unique_lock<std::mutex> l(mutex);
+    result->cached_shader_count = agpu_uint(entries.size());
+}
+
+} // End of namespace AgpuCommon
@@ -0,0 +1,71 @@
+#ifndef AGPU_COMMON_SPIRV_CACHE_HPP
+#define AGPU_COMMON_SPIRV_CACHE_HPP
+
+#include <AGPU/agpu.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include "disk_cache.hpp"
+
+namespace AgpuCommon
+{
+
+/**
+ * Process wide cache of the Spir-V modules that are generated by the offline
+ * shader compiler. The entries are addressed by the hash of the source, the
+ * stage, the language, the preprocessor definitions and the version of the
+ * compiler, so that the same shader is only compiled once, even when it is
+ * requested by different devices. The entries are optionally persisted into
+ * the directory that is given by the SPIRV_CACHE_DIR environment variable,
+ * and the cache is disabled by the DISABLE_SPIRV_CACHE environment variable.
+ * This cache can be used from any thread.
+ */
+class SpirVShaderCache
+{
+public:
+    typedef std::vector<uint32_t> SpirVCode;
+    typedef std::shared_ptr<const SpirVCode> SpirVCodeRef;
+
+    static SpirVShaderCache &get();
+
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    // Starts the key of a shader, with the version of the compiler.
+    ContentHasher makeKeyHasher() const;
+
+    // Tells whether the entry had to be read from the directory.
+    SpirVCodeRef find(const std::string &key, bool &readFromDisk);
+    void store(const std::string &key, const SpirVCode &code);
+
+    // The statistics are shared by every compiler in the process. The times are in milliseconds.
+    void recordCompilation(double compilationTime);
+    void recordCacheHit(bool fromDisk, double lookupTime);
+    void getStatistics(agpu_shader_compilation_statistics *statistics);
+
+private:
+    SpirVShaderCache();
+    ~SpirVShaderCache();
+
+    std::string pathForKey(const std::string &key) const;
+    bool readSpirVCode(const std::string &key, SpirVCode &code);
+    void writeSpirVCode(const std::string &key, const SpirVCode &code);
+
+    bool enabled;
+    std::string directory;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, SpirVCodeRef> entries;
+
+    std::mutex statisticsMutex;
+    agpu_shader_compilation_statistics statistics;
+};
+
+} // End of namespace AgpuCommon
+
+#endif //AGPU_COMMON_SPIRV_CACHE_HPP
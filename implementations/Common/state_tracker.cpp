@@ -1,4 +1,5 @@
 #include "state_tracker.hpp"
+#include "encoded_commands.hpp"
 
 namespace AgpuCommon
 {
@@ -619,6 +620,11 @@ agpu_error AbstractStateTracker::copyTextureToBuffer(const agpu::texture_ref & t
     return currentCommandList->copyTextureToBuffer(texture, buffer, copy_region);
 }
 
+agpu_error AbstractStateTracker::executeEncodedCommands(agpu_pointer commands, agpu_size size)
+{
+    return AgpuCommon::executeEncodedCommands(this, commands, size);
+}
+
 
 //==============================================================================
 // DirectStateTracker
@@ -426,10 +426,10 @@ agpu::immediate_renderer_ptr StateTrackerCache::createImmediateRenderer()
 
 agpu::pipeline_state_ref StateTrackerCache::getComputePipelineWithDescription(const ComputePipelineStateDescription &description, std::string &pipelineBuildErrorLog)
 {
-    std::unique_lock<std::mutex> l(computePipelineStateCacheMutex);
-
-    // Find an existent
+    // Find an existent. The lock is not held while building, so that different
+    // pipelines can be built concurrently.
     {
+        std::unique_lock<std::mutex> l(computePipelineStateCacheMutex);
         auto it = computePipelineStateCache.find(description);
         if(it != computePipelineStateCache.end())
             return it->second;
@@ -465,19 +465,20 @@ agpu::pipeline_state_ref StateTrackerCache::getComputePipelineWithDescription(co
         return agpu::pipeline_state_ref();
     }
 
-    // Store a copy of the PSO.
-    computePipelineStateCache.insert(std::make_pair(description, pso));
+    // Store a copy of the PSO, unless another thread was faster.
+    std::unique_lock<std::mutex> l(computePipelineStateCacheMutex);
+    auto it = computePipelineStateCache.insert(std::make_pair(description, pso)).first;
 
     // Return the PSO.
-    return pso;
+    return it->second;
 }
 
 agpu::pipeline_state_ref StateTrackerCache::getGraphicsPipelineWithDescription(const GraphicsPipelineStateDescription &description, std::string &pipelineBuildErrorLog)
 {
-    std::unique_lock<std::mutex> l(graphicsPipelineStateCacheMutex);
-
-    // Find an existent
+    // Find an existent. The lock is not held while building, so that different
+    // pipelines can be built concurrently.
     {
+        std::unique_lock<std::mutex> l(graphicsPipelineStateCacheMutex);
         auto it = graphicsPipelineStateCache.find(description);
         if(it != graphicsPipelineStateCache.end())
             return it->second;
@@ -513,11 +514,12 @@ agpu::pipeline_state_ref StateTrackerCache::getGraphicsPipelineWithDescription(c
         return agpu::pipeline_state_ref();
     }
 
-    // Store a copy of the PSO.
-    graphicsPipelineStateCache.insert(std::make_pair(description, pso));
+    // Store a copy of the PSO, unless another thread was faster.
+    std::unique_lock<std::mutex> l(graphicsPipelineStateCacheMutex);
+    auto it = graphicsPipelineStateCache.insert(std::make_pair(description, pso)).first;
 
     // Return the PSO.
-    return pso;
+    return it->second;
 }
 
 } // End of namespace AgpuCommon
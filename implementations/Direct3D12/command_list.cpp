@@ -10,6 +10,7 @@
 #include "renderpass.hpp"
 #include "texture.hpp"
 #include "constants.hpp"
+#include "../Common/encoded_commands.hpp"
 
 namespace AgpuD3D12
 {
@@ -586,4 +587,9 @@ agpu_error ADXCommandList::copyTextureToBuffer(const agpu::texture_ref & texture
     return AGPU_UNIMPLEMENTED;
 }
 
+agpu_error ADXCommandList::executeEncodedCommands(agpu_pointer commands, agpu_size size)
+{
+    return AgpuCommon::executeEncodedCommands(this, commands, size);
+}
+
 } // End of namespace AgpuD3D12
@@ -15,6 +15,7 @@ public:
     static agpu::command_queue_ref createDefault(const agpu::device_ref &device);
 
     virtual agpu_error addCommandList(const agpu::command_list_ref &command_list) override;
+    virtual agpu_error addCommandLists(agpu_uint count, agpu::command_list_ref* command_lists) override;
     virtual agpu_error finishExecution() override;
     virtual agpu_error signalFence(const agpu::fence_ref &fence) override;
     virtual agpu_error waitFence(const agpu::fence_ref &fence) override;
@@ -20,6 +20,7 @@
 #include "sampler.hpp"
 #include "../Common/offline_shader_compiler.hpp"
 #include "../Common/state_tracker_cache.hpp"
+#include "../Common/shader_archive.hpp"
 
 namespace AgpuD3D12
 {
@@ -283,4 +284,17 @@ agpu_error ADXDevice::finishExecution()
 	return defaultCommandQueue->finishExecution();
 }
 
+agpu_error ADXDevice::getObjectStatistics(agpu_device_object_statistics* statistics)
+{
+	CHECK_POINTER(statistics);
+	return AGPU_UNSUPPORTED;
+}
+
+agpu::shader_archive_ptr ADXDevice::openShaderArchive(agpu_cstring path)
+{
+	if(!path)
+		return nullptr;
+	return AgpuCommon::ShaderArchive::open(refFromThis<agpu::device> (), path).disown();
+}
+
 } // End of namespace AgpuD3D12
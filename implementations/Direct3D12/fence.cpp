@@ -52,4 +52,15 @@ agpu_error ADXFence::waitOnClient()
     return AGPU_OK;
 }
 
+agpu_bool ADXFence::isSignaled()
+{
+    UINT64 waitValue = 0;
+    {
+        std::unique_lock<std::mutex> l(fenceMutex);
+        waitValue = fenceValue - 1;
+    }
+
+    return fence->GetCompletedValue() >= waitValue;
+}
+
 } // End of namespace AgpuD3D12
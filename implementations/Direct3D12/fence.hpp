@@ -15,6 +15,7 @@ public:
     static agpu::fence_ref create(const agpu::device_ref &device);
 
     virtual agpu_error waitOnClient() override;
+    virtual agpu_bool isSignaled() override;
 
 public:
     std::mutex fenceMutex;
@@ -163,4 +163,10 @@ agpu_error ADXSwapChain::setOverlayPosition(agpu_int x, agpu_int y)
 	return overlayWindow->setPosition(x, y);
 }
 
+agpu_error ADXSwapChain::getFramePacingStatistics(agpu_frame_pacing_statistics* statistics)
+{
+	CHECK_POINTER(statistics);
+	return AGPU_UNSUPPORTED;
+}
+
 } // End of namespace AgpuD3D12
@@ -22,6 +22,7 @@ public:
     virtual agpu_size getFramebufferCount() override;
 
     virtual agpu_error setOverlayPosition(agpu_int x, agpu_int y) override;
+    virtual agpu_error getFramePacingStatistics(agpu_frame_pacing_statistics* statistics) override;
 
 public:
     agpu::device_ref device;
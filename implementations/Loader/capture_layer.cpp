@@ -0,0 +1,467 @@
+#include "capture_layer.hpp"
+#include "../Common/api_capture.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace AgpuCommon;
+
+static bool captureLayerEnabled = false;
+static FILE *captureFile = nullptr;
+
+/**
+ * Driver whose dispatch table was replaced, with a copy of the entry points
+ * that are called by the capture layer.
+ */
+struct CapturedDriver
+{
+    agpu_icd_dispatch *dispatchTable;
+    agpu_icd_dispatch nextDispatchTable;
+};
+
+static constexpr size_t MaxCapturedDriverCount = 16;
+static std::mutex capturedDriversMutex;
+static CapturedDriver capturedDrivers[MaxCapturedDriverCount];
+static std::atomic<size_t> capturedDriverCount(0);
+
+static agpu_icd_dispatch *getCapturedDriverDispatchTable(void *object)
+{
+    auto dispatchTable = *reinterpret_cast<agpu_icd_dispatch**> (object);
+    auto count = capturedDriverCount.load(std::memory_order_acquire);
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(capturedDrivers[i].dispatchTable == dispatchTable)
+            return &capturedDrivers[i].nextDispatchTable;
+    }
+
+    fprintf(stderr, "AGPU capture layer: object %p does not belong to a captured driver\n", object);
+    abort();
+}
+
+/**
+ * The state of the capture is protected by the capture mutex, which is held
+ * during the captured calls, so that the calls are recorded in the order in
+ * which they are executed. The calls that are made by a driver while it
+ * executes a captured call are not recorded.
+ */
+static std::mutex captureMutex;
+static std::vector<uint8_t> captureBuffer;
+static std::vector<uint8_t> callRecord;
+static std::unordered_map<const void*, uint64_t> objectIdentifiers;
+static uint64_t nextObjectIdentifier = 1;
+static thread_local bool insideCapturedCall = false;
+
+static constexpr size_t CaptureBufferFlushThreshold = 4 << 20;
+
+static bool isInsideCapturedCall()
+{
+    return insideCapturedCall;
+}
+
+static uint64_t getObjectIdentifier(const void *object)
+{
+    if(!object)
+        return 0;
+
+    auto it = objectIdentifiers.find(object);
+    if(it != objectIdentifiers.end())
+        return it->second;
+
+    auto identifier = nextObjectIdentifier++;
+    objectIdentifiers.insert(std::make_pair(object, identifier));
+    return identifier;
+}
+
+static void flushCapture()
+{
+    if(!captureBuffer.empty())
+    {
+        fwrite(&captureBuffer[0], captureBuffer.size(), 1, captureFile);
+        captureBuffer.clear();
+    }
+
+    fflush(captureFile);
+}
+
+/**
+ * Range of memory that is read or written by a call, relative to the pointer
+ * that is passed to it.
+ */
+struct CaptureRange
+{
+    ptrdiff_t offset;
+    size_t size;
+};
+
+/**
+ * Records a call, which is done by a generated entry point.
+ */
+class CapturedCall
+{
+public:
+    CapturedCall(uint32_t entryPoint)
+        : entryPoint(entryPoint), lock(captureMutex)
+    {
+        insideCapturedCall = true;
+        callRecord.clear();
+    }
+
+    ~CapturedCall()
+    {
+        insideCapturedCall = false;
+    }
+
+    template<typename T>
+    void value(T value)
+    {
+        writeCaptureSigned(callRecord, int64_t(value));
+    }
+
+    void value(float value)
+    {
+        writeCaptureBytes(callRecord, &value, sizeof(value));
+    }
+
+    void value(double value)
+    {
+        writeCaptureBytes(callRecord, &value, sizeof(value));
+    }
+
+    void object(const void *object)
+    {
+        writeCaptureUnsigned(callRecord, getObjectIdentifier(object));
+    }
+
+    template<typename T>
+    void objects(T * const *objects, size_t count)
+    {
+        if(!array(objects, count))
+            return;
+
+        for(size_t i = 0; i < count; ++i)
+            object(objects[i]);
+    }
+
+    void string(const char *string, agpu_string_length length = -1)
+    {
+        if(!string)
+        {
+            writeCaptureUnsigned(callRecord, 0);
+            return;
+        }
+
+        auto size = length < 0 ? strlen(string) : size_t(length);
+        writeCaptureUnsigned(callRecord, size + 1);
+        writeCaptureBytes(callRecord, string, size);
+    }
+
+    template<typename T>
+    void structures(const T *structures, size_t count)
+    {
+        if(array(structures, count))
+            writeCaptureBytes(callRecord, structures, count*sizeof(T));
+    }
+
+    // Writes the count of an array, and returns whether its elements follow.
+    bool array(const void *pointer, size_t count)
+    {
+        writeCaptureUnsigned(callRecord, pointer ? count + 1 : 0);
+        return pointer != nullptr;
+    }
+
+    void payload(const void *data, size_t size)
+    {
+        CaptureRange range = {0, size};
+        payload(data, range);
+    }
+
+    void payload(const void *data, const CaptureRange &range)
+    {
+        if(!array(data, range.size))
+            return;
+
+        writeCaptureSigned(callRecord, range.offset);
+        writeCaptureBytes(callRecord, reinterpret_cast<const uint8_t*> (data) + range.offset, range.size);
+    }
+
+    // Memory that is written by the call. Only its size is recorded.
+    void scratch(const void *data, size_t size)
+    {
+        CaptureRange range = {0, size};
+        scratch(data, range);
+    }
+
+    void scratch(const void *data, const CaptureRange &range)
+    {
+        if(array(data, range.size))
+            writeCaptureSigned(callRecord, range.offset);
+    }
+
+    void encodedCommands(agpu_pointer commands, agpu_size size);
+
+    void finish()
+    {
+        writeCaptureUnsigned(captureBuffer, ApiCaptureRecordFirstCall + entryPoint);
+        captureBuffer.insert(captureBuffer.end(), callRecord.begin(), callRecord.end());
+        if(captureBuffer.size() >= CaptureBufferFlushThreshold)
+            flushCapture();
+    }
+
+private:
+    uint32_t entryPoint;
+    std::unique_lock<std::mutex> lock;
+};
+
+template<typename T>
+static void captureStructures(CapturedCall &call, const T *structures, size_t count)
+{
+    if(!call.array(structures, count))
+        return;
+
+    for(size_t i = 0; i < count; ++i)
+        captureStructure(call, structures[i]);
+}
+
+/**
+ * The application writes into the mapped buffers without calling the API, so
+ * their content is compared with a copy when the buffer is flushed, unmapped
+ * or released, and when command lists are submitted, and the modified range
+ * is recorded. The capture layer keeps a reference to the mapped buffers,
+ * which is released when the application releases its last reference.
+ */
+struct MappedBuffer
+{
+    uint8_t *pointer;
+    std::vector<uint8_t> shadow;
+};
+
+static std::unordered_map<agpu_buffer*, MappedBuffer> mappedBuffers;
+static std::unordered_map<agpu_buffer*, size_t> bufferReferenceCounts;
+
+static void captureMappedBufferChanges(agpu_buffer *buffer, MappedBuffer &mappedBuffer)
+{
+    auto size = mappedBuffer.shadow.size();
+    auto current = mappedBuffer.pointer;
+    auto &shadow = mappedBuffer.shadow;
+
+    size_t first = 0;
+    while(first < size && current[first] == shadow[first])
+        ++first;
+    if(first == size)
+        return;
+
+    size_t last = size;
+    while(last > first && current[last - 1] == shadow[last - 1])
+        --last;
+
+    writeCaptureUnsigned(captureBuffer, ApiCaptureRecordMappedBufferWrite);
+    writeCaptureUnsigned(captureBuffer, getObjectIdentifier(buffer));
+    writeCaptureUnsigned(captureBuffer, first);
+    writeCaptureUnsigned(captureBuffer, last - first);
+    writeCaptureBytes(captureBuffer, current + first, last - first);
+    memcpy(&shadow[first], current + first, last - first);
+}
+
+static void captureMappedBufferWrites(agpu_buffer *buffer, bool unmapped)
+{
+    auto it = mappedBuffers.find(buffer);
+    if(it == mappedBuffers.end())
+        return;
+
+    captureMappedBufferChanges(buffer, it->second);
+    if(unmapped)
+    {
+        mappedBuffers.erase(it);
+        getCapturedDriverDispatchTable(buffer)->agpuReleaseBuffer(buffer);
+    }
+}
+
+static void captureAllMappedBufferWrites()
+{
+    for(auto &mappedBuffer : mappedBuffers)
+        captureMappedBufferChanges(mappedBuffer.first, mappedBuffer.second);
+}
+
+static void registerMappedBuffer(agpu_buffer *buffer, agpu_mapping_access flags, agpu_pointer pointer)
+{
+    if(!pointer || flags == AGPU_READ_ONLY || mappedBuffers.find(buffer) != mappedBuffers.end())
+        return;
+
+    auto dispatchTable = getCapturedDriverDispatchTable(buffer);
+    agpu_buffer_description description;
+    memset(&description, 0, sizeof(description));
+    if(dispatchTable->agpuGetBufferDescription(buffer, &description) != AGPU_OK)
+        return;
+
+    dispatchTable->agpuAddBufferReference(buffer);
+    auto &mappedBuffer = mappedBuffers[buffer];
+    mappedBuffer.pointer = reinterpret_cast<uint8_t*> (pointer);
+    mappedBuffer.shadow.assign(mappedBuffer.pointer, mappedBuffer.pointer + description.size);
+}
+
+static void retainCapturedBuffer(agpu_buffer *buffer)
+{
+    if(buffer)
+        ++bufferReferenceCounts[buffer];
+}
+
+static void releaseCapturedBuffer(agpu_buffer *buffer)
+{
+    auto it = bufferReferenceCounts.find(buffer);
+    if(it == bufferReferenceCounts.end() || --it->second != 0)
+        return;
+
+    bufferReferenceCounts.erase(it);
+    captureMappedBufferWrites(buffer, true);
+}
+
+static CaptureRange textureDataRange(agpu_texture *texture, agpu_int level, agpu_int pitch, agpu_int slicePitch, const agpu_size3d *size)
+{
+    agpu_texture_description description;
+    memset(&description, 0, sizeof(description));
+    getCapturedDriverDispatchTable(texture)->agpuGetTextureDescription(texture, &description);
+
+    size_t rows = size ? size->height : std::max(description.height >> level, 1u);
+    size_t slices = 1;
+    if(size)
+        slices = size->depth;
+    else if(description.type == AGPU_TEXTURE_3D)
+        slices = std::max(description.depth >> level, 1u);
+
+    auto absolutePitch = size_t(pitch < 0 ? -pitch : pitch);
+    CaptureRange range;
+    range.size = slicePitch > 0 ? size_t(slicePitch)*std::max(slices, size_t(1)) : absolutePitch*std::max(rows, size_t(1));
+
+    // The rows are read backwards from the pointer when the pitch is negative.
+    range.offset = pitch < 0 ? -ptrdiff_t(range.size - absolutePitch) : 0;
+    return range;
+}
+
+static std::unordered_map<agpu_immediate_renderer*, agpu_size> currentMeshVertexCounts;
+
+static void setCurrentMeshVertexCount(agpu_immediate_renderer *immediateRenderer, agpu_size vertexCount)
+{
+    currentMeshVertexCounts[immediateRenderer] = vertexCount;
+}
+
+static agpu_size getCurrentMeshVertexCount(agpu_immediate_renderer *immediateRenderer)
+{
+    auto it = currentMeshVertexCounts.find(immediateRenderer);
+    return it != currentMeshVertexCounts.end() ? it->second : 0;
+}
+
+static size_t meshAttributeSize(agpu_size vertexCount, agpu_size stride, agpu_size elementCount)
+{
+    if(!vertexCount)
+        return 0;
+    return size_t(vertexCount - 1)*stride + elementCount*sizeof(float);
+}
+
+#include "capture_layer.inc"
+
+// An entry point that is missing from the capture would make the replay
+// diverge silently, so the generated files must match the dispatch table,
+// which has agpuGetPlatforms before the entry points of the interfaces.
+static_assert(CaptureEntryPointCount + 1 == (sizeof(agpu_icd_dispatch) - offsetof(agpu_icd_dispatch, agpuGetPlatforms)) / sizeof(agpuGetPlatforms_FUN),
+    "The API capture is out of date with api.xml. Regenerate it with definitions/make_api_capture.py");
+
+// The handles of the encoded commands are replaced by object identifiers, and
+// their other pointers by the index of the data that follows the commands.
+void CapturedCall::encodedCommands(agpu_pointer commands, agpu_size size)
+{
+    if(!commands)
+    {
+        writeCaptureUnsigned(callRecord, 0);
+        return;
+    }
+
+    std::vector<uint64_t> copy((size + 7) / 8 + 1);
+    auto bytes = reinterpret_cast<uint8_t*> (&copy[0]);
+    memcpy(bytes, commands, size);
+
+    std::vector<std::pair<const void*, size_t>> pointedData;
+    forEachEncodedCommandArgument(bytes, size, [&](uint32_t opcode, size_t index, char kind, uint64_t *arguments) {
+        auto pointer = reinterpret_cast<const void*> (uintptr_t(arguments[index]));
+        if(kind == 'r')
+        {
+            arguments[index] = getObjectIdentifier(pointer);
+        }
+        else if(kind == 'p' && pointer)
+        {
+            pointedData.push_back(std::make_pair(pointer, encodedCommandPointerSize(opcode, index, arguments, pointer)));
+            arguments[index] = pointedData.size();
+        }
+    });
+
+    writeCaptureUnsigned(callRecord, size_t(size) + 1);
+    writeCaptureBytes(callRecord, bytes, size);
+    writeCaptureUnsigned(callRecord, pointedData.size());
+    for(auto &data : pointedData)
+    {
+        writeCaptureUnsigned(callRecord, data.second);
+        writeCaptureBytes(callRecord, data.first, data.second);
+    }
+}
+
+static void finishCapture()
+{
+    std::unique_lock<std::mutex> l(captureMutex);
+    flushCapture();
+    fclose(captureFile);
+    captureFile = nullptr;
+}
+
+bool enableCaptureLayer(const std::string &capturePath)
+{
+    if(captureLayerEnabled)
+        return true;
+
+    captureFile = fopen(capturePath.c_str(), "wb");
+    if(!captureFile)
+    {
+        fprintf(stderr, "AGPU capture layer: failed to create the capture %s\n", capturePath.c_str());
+        return false;
+    }
+
+    writeCaptureBytes(captureBuffer, ApiCaptureMagic, sizeof(ApiCaptureMagic));
+    writeCaptureUnsigned(captureBuffer, ApiCaptureVersion);
+    writeCaptureUnsigned(captureBuffer, CaptureEntryPointCount);
+    captureLayerEnabled = true;
+    atexit(finishCapture);
+    return true;
+}
+
+bool isCaptureLayerEnabled()
+{
+    return captureLayerEnabled;
+}
+
+void installCaptureLayer(agpu_icd_dispatch *driverDispatchTable)
+{
+    std::unique_lock<std::mutex> l(capturedDriversMutex);
+    auto count = capturedDriverCount.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(capturedDrivers[i].dispatchTable == driverDispatchTable)
+            return;
+    }
+
+    if(count == MaxCapturedDriverCount)
+    {
+        fprintf(stderr, "AGPU capture layer: too many drivers, a driver is not captured\n");
+        return;
+    }
+
+    auto &driver = capturedDrivers[count];
+    driver.dispatchTable = driverDispatchTable;
+    driver.nextDispatchTable = *driverDispatchTable;
+    capturedDriverCount.store(count + 1, std::memory_order_release);
+    installCapturedEntryPoints(driverDispatchTable);
+}
@@ -0,0 +1,21 @@
+#ifndef AGPU_LOADER_CAPTURE_LAYER_HPP
+#define AGPU_LOADER_CAPTURE_LAYER_HPP
+
+#include <AGPU/agpu.h>
+#include <string>
+
+/**
+ * Enables the capture layer, which records every call of the C API, with the
+ * data that is passed to it, into a file that is replayed by AgpuReplay.
+ * Returns false when the capture file can not be created.
+ */
+bool enableCaptureLayer(const std::string &capturePath);
+bool isCaptureLayerEnabled();
+
+/**
+ * Interposes the capture layer between the loader and a driver, like the
+ * tracing layer.
+ */
+void installCaptureLayer(agpu_icd_dispatch *driverDispatchTable);
+
+#endif //AGPU_LOADER_CAPTURE_LAYER_HPP
@@ -1,7 +1,14 @@
 #include <algorithm>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <AGPU/agpu.h>
+#include "capture_layer.hpp"
+#include "tracing_layer.hpp"
 
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
@@ -30,6 +37,26 @@ struct CallXInitThreads
 
 #endif
 
+#ifdef _WIN32
+typedef HMODULE DriverModuleHandle;
+#else
+typedef void *DriverModuleHandle;
+#endif
+
+class PlatformInfo;
+
+/**
+ * Platform handle that is given to the application for a driver that is
+ * described by a manifest. Its dispatch table belongs to the loader, which
+ * answers the queries that are covered by the manifest, and loads the driver
+ * the first time that anything else is requested from the platform.
+ */
+struct LazyPlatform
+{
+    agpu_icd_dispatch *dispatchTable;
+    PlatformInfo *info;
+};
+
 /**
  * ICD loaded platform info.
  */
@@ -40,21 +67,28 @@ public:
     ~PlatformInfo();
 
     agpu_platform *platform;
-
-#ifdef _WIN32
-    HMODULE moduleHandle;
-#else
-    void *moduleHandle;
-#endif
+    DriverModuleHandle moduleHandle;
 
     agpu_bool hasRealMultithreading;
     agpu_bool isNative;
     agpu_bool isCrossPlatform;
 
+    // Drivers that are described by a manifest.
+    bool isLazy;
+    std::string name;
+    std::string libraryPath;
+    LazyPlatform lazyPlatform;
+    std::once_flag driverLoadedFlag;
+    agpu_platform *driverPlatform;
 };
 
 PlatformInfo::PlatformInfo()
+    : platform(nullptr), moduleHandle(nullptr),
+      hasRealMultithreading(false), isNative(false), isCrossPlatform(false),
+      isLazy(false), driverPlatform(nullptr)
 {
+    lazyPlatform.dispatchTable = nullptr;
+    lazyPlatform.info = this;
 }
 
 PlatformInfo::~PlatformInfo()
@@ -207,24 +241,27 @@ static std::string joinPath(const std::string &path1, const std::string &path2)
 }
 
 
-static void loadDriver(const std::string &path)
+static const char DriverManifestExtension[] = "agpuicd";
+static bool ignoreDriverManifests = false;
+
+static bool openDriverLibrary(const std::string &path, DriverModuleHandle &handle, std::vector<agpu_platform*> &platforms)
 {
 #if defined(_WIN32)
     auto ext = extension(path);
     if (ext != "dll")
-        return;
+        return false;
 
     auto pathUtf16 = utf8ToUtf16(path);
-    auto handle = LoadLibraryW(pathUtf16.c_str());
+    handle = LoadLibraryW(pathUtf16.c_str());
     if (handle == NULL)
-        return;
+        return false;
 
     // Try to get the platform defined by the library.
     agpuGetPlatforms_FUN getPlatforms = (agpuGetPlatforms_FUN)GetProcAddress(handle, "agpuGetPlatforms");
     if (!getPlatforms)
     {
         FreeLibrary(handle);
-        return;
+        return false;
     }
 
     // Get the driver platform count.
@@ -232,7 +269,7 @@ static void loadDriver(const std::string &path)
     getPlatforms(0, nullptr, &platformCount);
 
     // Get the driver platforms
-    std::vector<agpu_platform*> platforms(platformCount);
+    platforms.resize(platformCount);
 	if (platformCount > 0)
 		getPlatforms(agpu_size(platforms.size()), &platforms[0], &platformCount);
 
@@ -240,7 +277,7 @@ static void loadDriver(const std::string &path)
     if (!platformCount)
     {
         FreeLibrary(handle);
-        return;
+        return false;
     }
 
 #else
@@ -250,16 +287,19 @@ static void loadDriver(const std::string &path)
 #endif
 
     // Load only once.
-    auto handle = dlopen(path.c_str(), flags | RTLD_NOLOAD );
+    handle = dlopen(path.c_str(), flags | RTLD_NOLOAD );
     if(handle)
-        return;
+    {
+        dlclose(handle);
+        return false;
+    }
 
     // Is this a library?
     handle = dlopen(path.c_str(), flags);
     if(!handle)
     {
         fprintf(stderr, "Failed to load %s: %s\n", path.c_str(), dlerror());
-        return;
+        return false;
     }
 
     // Try to get the platform defined by the library.
@@ -267,7 +307,7 @@ static void loadDriver(const std::string &path)
     if(!getPlatforms)
     {
         dlclose(handle);
-        return;
+        return false;
     }
 
     // Get the driver platform count.
@@ -275,7 +315,7 @@ static void loadDriver(const std::string &path)
     getPlatforms(0, nullptr, &platformCount);
 
     // Get the driver platforms
-    std::vector<agpu_platform*> platforms(platformCount);
+    platforms.resize(platformCount);
 	if(platformCount > 0)
 	    getPlatforms(platforms.size(), &platforms[0], &platformCount);
 
@@ -283,15 +323,38 @@ static void loadDriver(const std::string &path)
     if(!platformCount)
     {
         dlclose(handle);
-        return;
+        return false;
     }
 
 #endif
 
+    platforms.resize(platformCount);
+    if(isTracingLayerEnabled())
+    {
+        for(auto platform : platforms)
+            installTracingLayer(*reinterpret_cast<agpu_icd_dispatch**> (platform));
+    }
+
+    // The capture layer is installed last, so that it records the calls of
+    // the application.
+    if(isCaptureLayerEnabled())
+    {
+        for(auto platform : platforms)
+            installCaptureLayer(*reinterpret_cast<agpu_icd_dispatch**> (platform));
+    }
+    return true;
+}
+
+static void loadDriver(const std::string &path)
+{
+    DriverModuleHandle handle;
+    std::vector<agpu_platform*> platforms;
+    if(!openDriverLibrary(path, handle, platforms))
+        return;
+
     // Got the platforms, store them.
-    for (agpu_size i = 0; i < platformCount; ++i)
+    for (auto platform : platforms)
     {
-        auto platform = platforms[i];
         auto platformInfo = new PlatformInfo();
         platformInfo->platform = platform;
         platformInfo->moduleHandle = handle;
@@ -302,11 +365,225 @@ static void loadDriver(const std::string &path)
     }
 }
 
+static void loadLazyDriver(PlatformInfo *platformInfo)
+{
+    std::vector<agpu_platform*> platforms;
+    if(!openDriverLibrary(platformInfo->libraryPath, platformInfo->moduleHandle, platforms))
+    {
+        fprintf(stderr, "Failed to load the driver of the platform %s\n", platformInfo->name.c_str());
+        return;
+    }
+
+    // Prefer the platform with the name that is given by the manifest.
+    platformInfo->driverPlatform = platforms[0];
+    for(auto platform : platforms)
+    {
+        auto name = agpuGetPlatformName(platform);
+        if(name && platformInfo->name == name)
+        {
+            platformInfo->driverPlatform = platform;
+            break;
+        }
+    }
+}
+
+static agpu_platform *getDriverPlatform(agpu_platform *platform)
+{
+    auto platformInfo = reinterpret_cast<LazyPlatform*> (platform)->info;
+    std::call_once(platformInfo->driverLoadedFlag, [=] {
+        loadLazyDriver(platformInfo);
+    });
+    return platformInfo->driverPlatform;
+}
+
+// The methods of the lazy platforms.
+static agpu_device* lazyOpenDevice(agpu_platform* platform, agpu_device_open_info* openInfo)
+{
+    auto driverPlatform = getDriverPlatform(platform);
+    return driverPlatform ? agpuOpenDevice(driverPlatform, openInfo) : nullptr;
+}
+
+static agpu_cstring lazyGetPlatformName(agpu_platform* platform)
+{
+    return reinterpret_cast<LazyPlatform*> (platform)->info->name.c_str();
+}
+
+static agpu_size lazyGetPlatformGpuCount(agpu_platform* platform)
+{
+    auto driverPlatform = getDriverPlatform(platform);
+    return driverPlatform ? agpuGetPlatformGpuCount(driverPlatform) : 0;
+}
+
+static agpu_cstring lazyGetPlatformGpuName(agpu_platform* platform, agpu_size gpu_index)
+{
+    auto driverPlatform = getDriverPlatform(platform);
+    return driverPlatform ? agpuGetPlatformGpuName(driverPlatform, gpu_index) : nullptr;
+}
+
+static agpu_int lazyGetPlatformVersion(agpu_platform* platform)
+{
+    auto driverPlatform = getDriverPlatform(platform);
+    return driverPlatform ? agpuGetPlatformVersion(driverPlatform) : 0;
+}
+
+static agpu_int lazyGetPlatformImplementationVersion(agpu_platform* platform)
+{
+    auto driverPlatform = getDriverPlatform(platform);
+    return driverPlatform ? agpuGetPlatformImplementationVersion(driverPlatform) : 0;
+}
+
+static agpu_bool lazyPlatformHasRealMultithreading(agpu_platform* platform)
+{
+    return reinterpret_cast<LazyPlatform*> (platform)->info->hasRealMultithreading;
+}
+
+static agpu_bool lazyIsNativePlatform(agpu_platform* platform)
+{
+    return reinterpret_cast<LazyPlatform*> (platform)->info->isNative;
+}
+
+static agpu_bool lazyIsCrossPlatform(agpu_platform* platform)
+{
+    return reinterpret_cast<LazyPlatform*> (platform)->info->isCrossPlatform;
+}
+
+static agpu_offline_shader_compiler* lazyCreateOfflineShaderCompiler(agpu_platform* platform)
+{
+    auto driverPlatform = getDriverPlatform(platform);
+    return driverPlatform ? agpuCreateOfflineShaderCompiler(driverPlatform) : nullptr;
+}
+
+// Only the platform methods can be reached through a lazy platform.
+static agpu_icd_dispatch *getLazyPlatformDispatchTable()
+{
+    static agpu_icd_dispatch dispatchTable;
+    static std::once_flag dispatchTableInitializedFlag;
+    std::call_once(dispatchTableInitializedFlag, [] {
+        memset(&dispatchTable, 0, sizeof(dispatchTable));
+        dispatchTable.agpuOpenDevice = lazyOpenDevice;
+        dispatchTable.agpuGetPlatformName = lazyGetPlatformName;
+        dispatchTable.agpuGetPlatformGpuCount = lazyGetPlatformGpuCount;
+        dispatchTable.agpuGetPlatformGpuName = lazyGetPlatformGpuName;
+        dispatchTable.agpuGetPlatformVersion = lazyGetPlatformVersion;
+        dispatchTable.agpuGetPlatformImplementationVersion = lazyGetPlatformImplementationVersion;
+        dispatchTable.agpuPlatformHasRealMultithreading = lazyPlatformHasRealMultithreading;
+        dispatchTable.agpuIsNativePlatform = lazyIsNativePlatform;
+        dispatchTable.agpuIsCrossPlatform = lazyIsCrossPlatform;
+        dispatchTable.agpuCreateOfflineShaderCompiler = lazyCreateOfflineShaderCompiler;
+    });
+    return &dispatchTable;
+}
+
+static std::string trimString(const std::string &string)
+{
+    auto start = string.find_first_not_of(" \t\r\n");
+    if(start == std::string::npos)
+        return std::string();
+    auto end = string.find_last_not_of(" \t\r\n");
+    return string.substr(start, end - start + 1);
+}
+
+static bool parseManifestBoolean(const std::string &value)
+{
+    return value == "true" || value == "1";
+}
+
+/**
+ * Reads the manifest of a driver. The manifests are made of key = value
+ * lines, with the name of the platform, the library of the driver, which is
+ * relative to the manifest, and the capabilities that are used for sorting
+ * the platforms:
+ *
+ *     name = OpenGL 4.x Core
+ *     library = libAgpuOpenGL.so
+ *     native = false
+ *     cross_platform = true
+ *     real_multithreading = false
+ */
+static bool readDriverManifest(const std::string &path, PlatformInfo &platformInfo)
+{
+    auto f = fopen(path.c_str(), "r");
+    if(!f)
+        return false;
+
+    char lineBuffer[1024];
+    while(fgets(lineBuffer, sizeof(lineBuffer), f))
+    {
+        std::string line = lineBuffer;
+        auto commentPosition = line.find('#');
+        if(commentPosition != std::string::npos)
+            line.resize(commentPosition);
+
+        auto separatorPosition = line.find('=');
+        if(separatorPosition == std::string::npos)
+            continue;
+
+        auto key = trimString(line.substr(0, separatorPosition));
+        auto value = trimString(line.substr(separatorPosition + 1));
+        if(key == "name")
+            platformInfo.name = value;
+        else if(key == "library")
+            platformInfo.libraryPath = joinPath(dirname(path), value);
+        else if(key == "native")
+            platformInfo.isNative = parseManifestBoolean(value);
+        else if(key == "cross_platform")
+            platformInfo.isCrossPlatform = parseManifestBoolean(value);
+        else if(key == "real_multithreading")
+            platformInfo.hasRealMultithreading = parseManifestBoolean(value);
+    }
+
+    fclose(f);
+    return !platformInfo.name.empty() && !platformInfo.libraryPath.empty();
+}
+
+static bool isDriverRegistered(const std::string &libraryPath)
+{
+    for(auto platformInfo : loadedPlatforms)
+    {
+        if(platformInfo->isLazy && platformInfo->libraryPath == libraryPath)
+            return true;
+    }
+
+    return false;
+}
+
+static void registerDriverManifest(const std::string &path)
+{
+    std::unique_ptr<PlatformInfo> platformInfo(new PlatformInfo());
+    if(!readDriverManifest(path, *platformInfo))
+    {
+        fprintf(stderr, "Invalid driver manifest %s\n", path.c_str());
+        return;
+    }
+
+    // The same driver can be found through different paths.
+    if(isDriverRegistered(platformInfo->libraryPath))
+        return;
+
+    platformInfo->isLazy = true;
+    platformInfo->lazyPlatform.dispatchTable = getLazyPlatformDispatchTable();
+    platformInfo->platform = reinterpret_cast<agpu_platform*> (&platformInfo->lazyPlatform);
+    loadedPlatforms.push_back(platformInfo.release());
+}
+
 static void loadDriversInPath(const std::string &folder)
 {
+    // Register the drivers with manifests, without loading them.
+    if(!ignoreDriverManifests)
+    {
+        dirEntriesDo(folder, [&](const std::string &fileName) {
+            auto fullPath = joinPath(folder, fileName);
+            if(extension(fileName) == DriverManifestExtension && isFile(fullPath))
+                registerDriverManifest(fullPath);
+        });
+    }
+
+    // Load the drivers without manifests.
     dirEntriesDo(folder, [&](const std::string &fileName) {
         auto fullPath = joinPath(folder, fileName);
-        if(isFile(fullPath))
+        if(extension(fileName) == DriverManifestExtension || !isFile(fullPath))
+            return;
+        if(!isDriverRegistered(fullPath))
             loadDriver(fullPath);
     });
 }
@@ -332,11 +609,30 @@ inline std::string getStringFromEnvironment(const char *varname)
 
 static void loadPlatforms()
 {
+    // The drivers are loaded eagerly when the manifests are ignored.
+    auto ignoreManifests = getStringFromEnvironment("AGPU_IGNORE_DRIVER_MANIFESTS");
+    ignoreDriverManifests = !ignoreManifests.empty() && ignoreManifests != "0";
+
+    // The tracing layer is installed on the drivers when they are loaded.
+    auto trace = getStringFromEnvironment("AGPU_TRACE");
+    auto chromeTracePath = getStringFromEnvironment("AGPU_TRACE_CHROME");
+    if((!trace.empty() && trace != "0") || !chromeTracePath.empty())
+        enableTracingLayer(chromeTracePath);
+
+    // The calls are captured for AgpuReplay.
+    auto capturePath = getStringFromEnvironment("AGPU_CAPTURE");
+    if(!capturePath.empty())
+        enableCaptureLayer(capturePath);
+
     // Single driver path
     auto driverPath = getStringFromEnvironment("AGPU_DRIVER_PATH");
     if(!driverPath.empty())
     {
-        loadDriver(driverPath);
+        if(extension(driverPath) == DriverManifestExtension && !ignoreDriverManifests)
+            registerDriverManifest(driverPath);
+        else
+            loadDriver(driverPath);
+        hasBeenLoaded = true;
         return;
     }
 
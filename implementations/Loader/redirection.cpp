@@ -321,6 +321,22 @@ AGPU_EXPORT agpu_error agpuFinishDeviceExecution ( agpu_device* device )
 	return (*dispatchTable)->agpuFinishDeviceExecution ( device );
 }
 
+AGPU_EXPORT agpu_error agpuGetDeviceObjectStatistics ( agpu_device* device, agpu_device_object_statistics* statistics )
+{
+	if (device == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (device);
+	return (*dispatchTable)->agpuGetDeviceObjectStatistics ( device, statistics );
+}
+
+AGPU_EXPORT agpu_shader_archive* agpuOpenShaderArchive ( agpu_device* device, agpu_cstring path )
+{
+	if (device == nullptr)
+		return (agpu_shader_archive*)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (device);
+	return (*dispatchTable)->agpuOpenShaderArchive ( device, path );
+}
+
 AGPU_EXPORT agpu_error agpuAddVRSystemReference ( agpu_vr_system* vr_system )
 {
 	if (vr_system == nullptr)
@@ -513,6 +529,14 @@ AGPU_EXPORT agpu_error agpuSetSwapChainOverlayPosition ( agpu_swap_chain* swap_c
 	return (*dispatchTable)->agpuSetSwapChainOverlayPosition ( swap_chain, x, y );
 }
 
+AGPU_EXPORT agpu_error agpuGetSwapChainFramePacingStatistics ( agpu_swap_chain* swap_chain, agpu_frame_pacing_statistics* statistics )
+{
+	if (swap_chain == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (swap_chain);
+	return (*dispatchTable)->agpuGetSwapChainFramePacingStatistics ( swap_chain, statistics );
+}
+
 AGPU_EXPORT agpu_error agpuAddComputePipelineBuilderReference ( agpu_compute_pipeline_builder* compute_pipeline_builder )
 {
 	if (compute_pipeline_builder == nullptr)
@@ -817,6 +841,14 @@ AGPU_EXPORT agpu_error agpuAddCommandList ( agpu_command_queue* command_queue, a
 	return (*dispatchTable)->agpuAddCommandList ( command_queue, command_list );
 }
 
+AGPU_EXPORT agpu_error agpuAddCommandLists ( agpu_command_queue* command_queue, agpu_uint count, agpu_command_list** command_lists )
+{
+	if (command_queue == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (command_queue);
+	return (*dispatchTable)->agpuAddCommandLists ( command_queue, count, command_lists );
+}
+
 AGPU_EXPORT agpu_error agpuFinishQueueExecution ( agpu_command_queue* command_queue )
 {
 	if (command_queue == nullptr)
@@ -1177,6 +1209,14 @@ AGPU_EXPORT agpu_error agpuCopyTextureToBuffer ( agpu_command_list* command_list
 	return (*dispatchTable)->agpuCopyTextureToBuffer ( command_list, texture, buffer, copy_region );
 }
 
+AGPU_EXPORT agpu_error agpuExecuteEncodedCommands ( agpu_command_list* command_list, agpu_pointer commands, agpu_size size )
+{
+	if (command_list == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (command_list);
+	return (*dispatchTable)->agpuExecuteEncodedCommands ( command_list, commands, size );
+}
+
 AGPU_EXPORT agpu_error agpuAddTextureReference ( agpu_texture* texture )
 {
 	if (texture == nullptr)
@@ -1753,6 +1793,14 @@ AGPU_EXPORT agpu_error agpuWaitOnClient ( agpu_fence* fence )
 	return (*dispatchTable)->agpuWaitOnClient ( fence );
 }
 
+AGPU_EXPORT agpu_bool agpuIsFenceSignaled ( agpu_fence* fence )
+{
+	if (fence == nullptr)
+		return (agpu_bool)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (fence);
+	return (*dispatchTable)->agpuIsFenceSignaled ( fence );
+}
+
 AGPU_EXPORT agpu_error agpuAddOfflineShaderCompilerReference ( agpu_offline_shader_compiler* offline_shader_compiler )
 {
 	if (offline_shader_compiler == nullptr)
@@ -1841,6 +1889,94 @@ AGPU_EXPORT agpu_shader* agpuGetOfflineShaderCompilerResultAsShader ( agpu_offli
 	return (*dispatchTable)->agpuGetOfflineShaderCompilerResultAsShader ( offline_shader_compiler );
 }
 
+AGPU_EXPORT agpu_error agpuGetOfflineShaderCompilationStatistics ( agpu_offline_shader_compiler* offline_shader_compiler, agpu_shader_compilation_statistics* statistics )
+{
+	if (offline_shader_compiler == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (offline_shader_compiler);
+	return (*dispatchTable)->agpuGetOfflineShaderCompilationStatistics ( offline_shader_compiler, statistics );
+}
+
+AGPU_EXPORT agpu_error agpuCompileOfflineShaderBatch ( agpu_offline_shader_compiler* offline_shader_compiler, agpu_size job_count, agpu_offline_shader_compilation_job* jobs, agpu_uint thread_count )
+{
+	if (offline_shader_compiler == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (offline_shader_compiler);
+	return (*dispatchTable)->agpuCompileOfflineShaderBatch ( offline_shader_compiler, job_count, jobs, thread_count );
+}
+
+AGPU_EXPORT agpu_error agpuSetOfflineShaderCompilationProfile ( agpu_offline_shader_compiler* offline_shader_compiler, agpu_offline_shader_compilation_profile profile )
+{
+	if (offline_shader_compiler == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (offline_shader_compiler);
+	return (*dispatchTable)->agpuSetOfflineShaderCompilationProfile ( offline_shader_compiler, profile );
+}
+
+AGPU_EXPORT agpu_error agpuAddShaderArchiveReference ( agpu_shader_archive* shader_archive )
+{
+	if (shader_archive == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuAddShaderArchiveReference ( shader_archive );
+}
+
+AGPU_EXPORT agpu_error agpuReleaseShaderArchive ( agpu_shader_archive* shader_archive )
+{
+	if (shader_archive == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuReleaseShaderArchive ( shader_archive );
+}
+
+AGPU_EXPORT agpu_size agpuGetShaderArchiveShaderCount ( agpu_shader_archive* shader_archive )
+{
+	if (shader_archive == nullptr)
+		return (agpu_size)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuGetShaderArchiveShaderCount ( shader_archive );
+}
+
+AGPU_EXPORT agpu_int agpuFindShaderInArchive ( agpu_shader_archive* shader_archive, agpu_cstring name )
+{
+	if (shader_archive == nullptr)
+		return (agpu_int)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuFindShaderInArchive ( shader_archive, name );
+}
+
+AGPU_EXPORT agpu_cstring agpuGetShaderArchiveShaderName ( agpu_shader_archive* shader_archive, agpu_size index )
+{
+	if (shader_archive == nullptr)
+		return (agpu_cstring)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuGetShaderArchiveShaderName ( shader_archive, index );
+}
+
+AGPU_EXPORT agpu_shader_type agpuGetShaderArchiveShaderStage ( agpu_shader_archive* shader_archive, agpu_size index )
+{
+	if (shader_archive == nullptr)
+		return (agpu_shader_type)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuGetShaderArchiveShaderStage ( shader_archive, index );
+}
+
+AGPU_EXPORT agpu_shader* agpuCreateShaderFromArchive ( agpu_shader_archive* shader_archive, agpu_size index )
+{
+	if (shader_archive == nullptr)
+		return (agpu_shader*)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuCreateShaderFromArchive ( shader_archive, index );
+}
+
+AGPU_EXPORT agpu_shader* agpuCreateShaderFromArchiveWithName ( agpu_shader_archive* shader_archive, agpu_cstring name )
+{
+	if (shader_archive == nullptr)
+		return (agpu_shader*)0;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (shader_archive);
+	return (*dispatchTable)->agpuCreateShaderFromArchiveWithName ( shader_archive, name );
+}
+
 AGPU_EXPORT agpu_error agpuAddStateTrackerCacheReference ( agpu_state_tracker_cache* state_tracker_cache )
 {
 	if (state_tracker_cache == nullptr)
@@ -2377,6 +2513,14 @@ AGPU_EXPORT agpu_error agpuStateTrackerCopyTextureToBuffer ( agpu_state_tracker*
 	return (*dispatchTable)->agpuStateTrackerCopyTextureToBuffer ( state_tracker, texture, buffer, copy_region );
 }
 
+AGPU_EXPORT agpu_error agpuStateTrackerExecuteEncodedCommands ( agpu_state_tracker* state_tracker, agpu_pointer commands, agpu_size size )
+{
+	if (state_tracker == nullptr)
+		return AGPU_NULL_POINTER;
+	agpu_icd_dispatch **dispatchTable = reinterpret_cast<agpu_icd_dispatch**> (state_tracker);
+	return (*dispatchTable)->agpuStateTrackerExecuteEncodedCommands ( state_tracker, commands, size );
+}
+
 AGPU_EXPORT agpu_error agpuAddImmediateRendererReference ( agpu_immediate_renderer* immediate_renderer )
 {
 	if (immediate_renderer == nullptr)
@@ -0,0 +1,278 @@
+#include "tracing_layer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef std::chrono::steady_clock TracingClock;
+
+static bool tracingLayerEnabled = false;
+static std::string chromeTracePath;
+static TracingClock::time_point tracingStartTime;
+
+/**
+ * Driver whose dispatch table was replaced, with a copy of its original
+ * entry points.
+ */
+struct TracedDriver
+{
+    agpu_icd_dispatch *dispatchTable;
+    agpu_icd_dispatch realDispatchTable;
+};
+
+static constexpr size_t MaxTracedDriverCount = 16;
+static std::mutex tracedDriversMutex;
+static TracedDriver tracedDrivers[MaxTracedDriverCount];
+static std::atomic<size_t> tracedDriverCount(0);
+
+static agpu_icd_dispatch *getTracedDriverDispatchTable(void *object)
+{
+    auto dispatchTable = *reinterpret_cast<agpu_icd_dispatch**> (object);
+    auto count = tracedDriverCount.load(std::memory_order_acquire);
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(tracedDrivers[i].dispatchTable == dispatchTable)
+            return &tracedDrivers[i].realDispatchTable;
+    }
+
+    fprintf(stderr, "AGPU tracing layer: object %p does not belong to a traced driver\n", object);
+    abort();
+}
+
+// The latencies are kept in power of two buckets of nanoseconds.
+static constexpr size_t LatencyHistogramBucketCount = 40;
+
+struct EntryPointStatistics
+{
+    std::atomic<uint64_t> callCount;
+    std::atomic<uint64_t> totalNanoseconds;
+    std::atomic<uint64_t> latencyHistogram[LatencyHistogramBucketCount];
+};
+
+struct ChromeTraceEvent
+{
+    uint32_t entryPoint;
+    uint64_t startNanoseconds;
+    uint64_t durationNanoseconds;
+};
+
+// The buffers of the threads are kept until the process exits.
+struct ChromeTraceThreadBuffer
+{
+    uint32_t threadId;
+    std::vector<ChromeTraceEvent> events;
+};
+
+static constexpr size_t MaxChromeTraceEventCount = 1 << 22;
+static std::mutex chromeTraceBuffersMutex;
+static std::vector<ChromeTraceThreadBuffer*> chromeTraceBuffers;
+static std::atomic<size_t> chromeTraceEventCount(0);
+static std::atomic<size_t> droppedChromeTraceEventCount(0);
+static thread_local ChromeTraceThreadBuffer *currentChromeTraceBuffer = nullptr;
+
+static void recordTracedCall(uint32_t entryPoint, uint64_t startNanoseconds, uint64_t durationNanoseconds);
+
+/**
+ * Measures the time of a call, which is done by a generated entry point.
+ */
+class TracedCall
+{
+public:
+    TracedCall(uint32_t entryPoint)
+        : entryPoint(entryPoint), startTime(TracingClock::now())
+    {
+    }
+
+    ~TracedCall()
+    {
+        auto endTime = TracingClock::now();
+        auto start = std::chrono::duration_cast<std::chrono::nanoseconds> (startTime - tracingStartTime).count();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds> (endTime - startTime).count();
+        recordTracedCall(entryPoint, uint64_t(start), uint64_t(duration));
+    }
+
+private:
+    uint32_t entryPoint;
+    TracingClock::time_point startTime;
+};
+
+#include "tracing_layer.inc"
+
+// The dispatch table has the interface version and agpuGetPlatforms before
+// the entry points of the interface methods, which are all traced.
+static_assert(TracedEntryPointCount + 1 == (sizeof(agpu_icd_dispatch) - offsetof(agpu_icd_dispatch, agpuGetPlatforms)) / sizeof(agpuGetPlatforms_FUN),
+    "tracing_layer.inc is out of date with api.xml. Regenerate it with definitions/make_tracing_layer.py");
+
+static EntryPointStatistics entryPointStatistics[TracedEntryPointCount];
+
+static size_t latencyHistogramBucketFor(uint64_t nanoseconds)
+{
+    size_t bucket = 0;
+    while(nanoseconds > 1 && bucket + 1 < LatencyHistogramBucketCount)
+    {
+        nanoseconds >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+static ChromeTraceThreadBuffer *getChromeTraceBuffer()
+{
+    if(!currentChromeTraceBuffer)
+    {
+        auto buffer = new ChromeTraceThreadBuffer();
+        std::unique_lock<std::mutex> l(chromeTraceBuffersMutex);
+        buffer->threadId = uint32_t(chromeTraceBuffers.size() + 1);
+        chromeTraceBuffers.push_back(buffer);
+        currentChromeTraceBuffer = buffer;
+    }
+
+    return currentChromeTraceBuffer;
+}
+
+static void recordTracedCall(uint32_t entryPoint, uint64_t startNanoseconds, uint64_t durationNanoseconds)
+{
+    auto &statistics = entryPointStatistics[entryPoint];
+    statistics.callCount.fetch_add(1, std::memory_order_relaxed);
+    statistics.totalNanoseconds.fetch_add(durationNanoseconds, std::memory_order_relaxed);
+    statistics.latencyHistogram[latencyHistogramBucketFor(durationNanoseconds)].fetch_add(1, std::memory_order_relaxed);
+
+    if(chromeTracePath.empty())
+        return;
+
+    if(chromeTraceEventCount.fetch_add(1, std::memory_order_relaxed) >= MaxChromeTraceEventCount)
+    {
+        droppedChromeTraceEventCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ChromeTraceEvent event;
+    event.entryPoint = entryPoint;
+    event.startNanoseconds = startNanoseconds;
+    event.durationNanoseconds = durationNanoseconds;
+    getChromeTraceBuffer()->events.push_back(event);
+}
+
+// Upper bound of the bucket that contains the given fraction of the calls.
+static uint64_t latencyPercentile(const EntryPointStatistics &statistics, uint64_t callCount, double fraction)
+{
+    auto threshold = uint64_t(callCount*fraction);
+    uint64_t accumulated = 0;
+    for(size_t i = 0; i < LatencyHistogramBucketCount; ++i)
+    {
+        accumulated += statistics.latencyHistogram[i].load(std::memory_order_relaxed);
+        if(accumulated > threshold)
+            return uint64_t(2) << i;
+    }
+
+    return uint64_t(2) << (LatencyHistogramBucketCount - 1);
+}
+
+static void printTracingReport()
+{
+    std::vector<uint32_t> calledEntryPoints;
+    for(uint32_t i = 0; i < TracedEntryPointCount; ++i)
+    {
+        if(entryPointStatistics[i].callCount.load(std::memory_order_relaxed) != 0)
+            calledEntryPoints.push_back(i);
+    }
+
+    // The entry points with the most time first.
+    std::sort(calledEntryPoints.begin(), calledEntryPoints.end(), [](uint32_t a, uint32_t b) {
+        return entryPointStatistics[a].totalNanoseconds.load(std::memory_order_relaxed) > entryPointStatistics[b].totalNanoseconds.load(std::memory_order_relaxed);
+    });
+
+    fprintf(stderr, "AGPU tracing layer report\n");
+    fprintf(stderr, "%-48s %12s %14s %12s %12s %12s\n", "entry point", "calls", "total ms", "mean ns", "p50 ns <", "p99 ns <");
+    for(auto entryPoint : calledEntryPoints)
+    {
+        auto &statistics = entryPointStatistics[entryPoint];
+        auto callCount = statistics.callCount.load(std::memory_order_relaxed);
+        auto totalNanoseconds = statistics.totalNanoseconds.load(std::memory_order_relaxed);
+        fprintf(stderr, "%-48s %12llu %14.3f %12.1f %12llu %12llu\n", TracedEntryPointNames[entryPoint],
+            (unsigned long long)callCount, double(totalNanoseconds)*1e-6, double(totalNanoseconds) / double(callCount),
+            (unsigned long long)latencyPercentile(statistics, callCount, 0.5),
+            (unsigned long long)latencyPercentile(statistics, callCount, 0.99));
+    }
+}
+
+static void writeChromeTrace()
+{
+    auto f = fopen(chromeTracePath.c_str(), "w");
+    if(!f)
+    {
+        fprintf(stderr, "AGPU tracing layer: failed to write the Chrome trace %s\n", chromeTracePath.c_str());
+        return;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool isFirst = true;
+    std::unique_lock<std::mutex> l(chromeTraceBuffersMutex);
+    for(auto buffer : chromeTraceBuffers)
+    {
+        for(auto &event : buffer->events)
+        {
+            fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"agpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                isFirst ? "" : ",\n", TracedEntryPointNames[event.entryPoint], buffer->threadId,
+                double(event.startNanoseconds)*1e-3, double(event.durationNanoseconds)*1e-3);
+            isFirst = false;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    fclose(f);
+
+    auto droppedCount = droppedChromeTraceEventCount.load();
+    if(droppedCount)
+        fprintf(stderr, "AGPU tracing layer: %llu events were not recorded in the Chrome trace\n", (unsigned long long)droppedCount);
+}
+
+static void finishTracing()
+{
+    printTracingReport();
+    if(!chromeTracePath.empty())
+        writeChromeTrace();
+}
+
+void enableTracingLayer(const std::string &newChromeTracePath)
+{
+    if(tracingLayerEnabled)
+        return;
+
+    tracingLayerEnabled = true;
+    chromeTracePath = newChromeTracePath;
+    tracingStartTime = TracingClock::now();
+    atexit(finishTracing);
+}
+
+bool isTracingLayerEnabled()
+{
+    return tracingLayerEnabled;
+}
+
+void installTracingLayer(agpu_icd_dispatch *driverDispatchTable)
+{
+    std::unique_lock<std::mutex> l(tracedDriversMutex);
+    auto count = tracedDriverCount.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(tracedDrivers[i].dispatchTable == driverDispatchTable)
+            return;
+    }
+
+    if(count == MaxTracedDriverCount)
+    {
+        fprintf(stderr, "AGPU tracing layer: too many drivers, a driver is not traced\n");
+        return;
+    }
+
+    auto &driver = tracedDrivers[count];
+    driver.dispatchTable = driverDispatchTable;
+    driver.realDispatchTable = *driverDispatchTable;
+    tracedDriverCount.store(count + 1, std::memory_order_release);
+    installTracedEntryPoints(driverDispatchTable);
+}
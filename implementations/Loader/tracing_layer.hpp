@@ -0,0 +1,25 @@
+#ifndef AGPU_LOADER_TRACING_LAYER_HPP
+#define AGPU_LOADER_TRACING_LAYER_HPP
+
+#include <AGPU/agpu.h>
+#include <string>
+
+/**
+ * Enables the tracing layer. It counts the calls of every entry point and
+ * keeps histograms of their latencies, which are printed when the process
+ * exits. When a Chrome trace path is given, every call is also recorded as
+ * an event in a Chrome trace JSON file, which is written when the process
+ * exits.
+ */
+void enableTracingLayer(const std::string &chromeTracePath);
+bool isTracingLayerEnabled();
+
+/**
+ * Interposes the tracing layer between the loader and a driver, by replacing
+ * the entry points in the dispatch table of the driver. The objects of the
+ * driver point to this table, so nothing is wrapped, and nothing is changed
+ * when the tracing layer is disabled.
+ */
+void installTracingLayer(agpu_icd_dispatch *driverDispatchTable);
+
+#endif //AGPU_LOADER_TRACING_LAYER_HPP
@@ -9,6 +9,7 @@
 #include "shader_signature.hpp"
 #include "shader_resource_binding.hpp"
 #include "texture_view.hpp"
+#include "../Common/encoded_commands.hpp"
 
 namespace AgpuMetal
 {
@@ -615,4 +616,9 @@ agpu_error AMtlCommandList::copyTextureToBuffer(const agpu::texture_ref & textur
 {
     return AGPU_UNIMPLEMENTED;
 }
+
+agpu_error AMtlCommandList::executeEncodedCommands(agpu_pointer commands, agpu_size size)
+{
+    return AgpuCommon::executeEncodedCommands(this, commands, size);
+}
 } // End of namespace AgpuMetal
@@ -48,6 +48,23 @@ agpu_error AMtlCommandQueue::addCommandList(const agpu::command_list_ref &comman
     return AGPU_OK;
 }
 
+agpu_error AMtlCommandQueue::addCommandLists(agpu_uint count, agpu::command_list_ref* command_lists)
+{
+    if(count == 0)
+        return AGPU_OK;
+    CHECK_POINTER(command_lists);
+
+    // Command buffers are executed in the order in which they are committed.
+    for(agpu_uint i = 0; i < count; ++i)
+    {
+        auto error = addCommandList(command_lists[i]);
+        if(error)
+            return error;
+    }
+
+    return AGPU_OK;
+}
+
 agpu_error AMtlCommandQueue::finishExecution (  )
 {
     std::unique_lock<std::mutex> l(finishFenceMutex);
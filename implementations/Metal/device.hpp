@@ -45,6 +45,8 @@ public:
     virtual agpu::offline_shader_compiler_ptr createOfflineShaderCompiler() override;
     virtual agpu::state_tracker_cache_ptr createStateTrackerCache(const agpu::command_queue_ref & command_queue_family) override;
     virtual agpu_error finishExecution() override;
+    virtual agpu_error getObjectStatistics(agpu_device_object_statistics* statistics) override;
+    virtual agpu::shader_archive_ptr openShaderArchive(agpu_cstring path) override;
 
     id<MTLDevice> device;
 
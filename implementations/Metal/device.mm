@@ -17,6 +17,7 @@
 #include "sampler.hpp"
 #include "../Common/offline_shader_compiler.hpp"
 #include "../Common/state_tracker_cache.hpp"
+#include "../Common/shader_archive.hpp"
 
 namespace AgpuMetal
 {
@@ -231,4 +232,17 @@ agpu_error AMtlDevice::finishExecution()
     return mainCommandQueue->finishExecution();
 }
 
+agpu_error AMtlDevice::getObjectStatistics(agpu_device_object_statistics* statistics)
+{
+    CHECK_POINTER(statistics);
+    return AGPU_UNSUPPORTED;
+}
+
+agpu::shader_archive_ptr AMtlDevice::openShaderArchive(agpu_cstring path)
+{
+    if(!path)
+        return nullptr;
+    return AgpuCommon::ShaderArchive::open(refFromThis<agpu::device> (), path).disown();
+}
+
 } // End of namespace AgpuMetal
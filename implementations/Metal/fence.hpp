@@ -16,6 +16,7 @@ public:
     static agpu::fence_ref create(const agpu::device_ref &device);
 
     virtual agpu_error waitOnClient() override;
+    virtual agpu_bool isSignaled() override;
     agpu_error signalOnQueue(id<MTLCommandQueue> queue);
 
     agpu::device_weakref weakDevice;
@@ -36,6 +36,15 @@ agpu_error AMtlFence::waitOnClient()
     return AGPU_OK;
 }
 
+agpu_bool AMtlFence::isSignaled()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    if(!fenceCommand)
+        return true;
+
+    return [fenceCommand status] == MTLCommandBufferStatusCompleted;
+}
+
 agpu_error AMtlFence::signalOnQueue(id<MTLCommandQueue> queue)
 {
     std::unique_lock<std::mutex> l(mutex);
@@ -36,6 +36,7 @@ public:
     virtual agpu_size getFramebufferCount() override;
     
     virtual agpu_error setOverlayPosition(agpu_int x, agpu_int y) override;
+    virtual agpu_error getFramePacingStatistics(agpu_frame_pacing_statistics* statistics) override;
 
     agpu::device_ref device;
     NSWindow *window;
@@ -222,4 +222,10 @@ agpu_error AMtlSwapChain::setOverlayPosition(agpu_int x, agpu_int y)
     return AGPU_OK;
 }
 
+agpu_error AMtlSwapChain::getFramePacingStatistics(agpu_frame_pacing_statistics* statistics)
+{
+    CHECK_POINTER(statistics);
+    return AGPU_UNSUPPORTED;
+}
+
 } // End of namespace AgpuMetal
@@ -24,10 +24,7 @@ GLBuffer::GLBuffer()
 
 GLBuffer::~GLBuffer()
 {
-    device.as<GLDevice> ()->onMainContextBlocking([&]{
-        // Delete the buffer.
-        device.as<GLDevice> ()->glDeleteBuffers(1, &handle);
-    });
+    deviceForGL->deleteObjectLater(GLObjectKind::Buffer, handle);
 }
 
 agpu::buffer_ref GLBuffer::createBuffer(const agpu::device_ref &device, const agpu_buffer_description &description, agpu_pointer initialData)
@@ -36,18 +33,22 @@ agpu::buffer_ref GLBuffer::createBuffer(const agpu::device_ref &device, const ag
     if(!device)
         return agpu::buffer_ref();
 
-    GLuint handle;
+    auto glDevice = device.as<GLDevice> ();
+    auto handle = glDevice->allocateObjectName(GLObjectKind::Buffer);
     auto binding = mapBinding(description.main_usage_mode);
     auto mappingFlags = mapMappingFlags(description.mapping_flags);
-
-    deviceForGL->onMainContextBlocking([&]{
-        // Generate the buffer
-        deviceForGL->glGenBuffers(1, &handle);
-        deviceForGL->glBindBuffer(binding, handle);
-
-        // Initialize the buffer storage
-        //printf("createBuffer %d %p\n", int(description.size), initialData);
-        deviceForGL->glBufferStorage(binding, description.size, initialData, mappingFlags);
+    auto size = description.size;
+
+    // The storage is allocated asynchronously. The jobs are executed in
+    // order, so the later uses of the handle will see it.
+    GLStagingArena::Allocation stagedData;
+    if(initialData)
+        stagedData = glDevice->stagingArena.allocateCopy(initialData, size);
+
+    glDevice->onMainContextAsync([=]{
+        glDevice->glBindBuffer(binding, handle);
+        glDevice->glBufferStorage(binding, size, stagedData.data, mappingFlags);
+        glDevice->stagingArena.release(stagedData);
     });
 
     // Create the buffer object.
@@ -123,10 +124,23 @@ void GLBuffer::dumpToFile(const char *fileName)
 
 agpu_error GLBuffer::uploadBufferData(agpu_size offset, agpu_size size, agpu_pointer data)
 {
-    //printf("uploadBufferData %d %d %p\n", int(offset), int(size), data);
-    deviceForGL->onMainContextBlocking([&]{
-        bind();
-        deviceForGL->glBufferSubData(target, offset, size, data);
+    if(size == 0)
+        return AGPU_OK;
+    CHECK_POINTER(data);
+
+    // Prefer the streaming ring, which does not stall on the pending draws.
+    auto glDevice = deviceForGL;
+    if(glDevice->streamingUploadRing.upload(handle, offset, size, data))
+        return AGPU_OK;
+
+    // Copy the data, so that the caller does not have to wait for the upload.
+    auto stagedData = glDevice->stagingArena.allocateCopy(data, size);
+    auto target = this->target;
+    auto handle = this->handle;
+    glDevice->onMainContextAsync([=]{
+        glDevice->glBindBuffer(target, handle);
+        glDevice->glBufferSubData(target, offset, size, stagedData.data);
+        glDevice->stagingArena.release(stagedData);
     });
     return AGPU_OK;
 }
@@ -145,9 +159,13 @@ agpu_error GLBuffer::flushWholeBuffer ()
     if((extraMappingFlags & GL_MAP_FLUSH_EXPLICIT_BIT) == 0)
         return AGPU_OK;
 
-    deviceForGL->onMainContextBlocking([&]{
-        bind();
-        deviceForGL->glFlushMappedBufferRange(target, 0, description.size);
+    auto glDevice = deviceForGL;
+    auto target = this->target;
+    auto handle = this->handle;
+    auto size = description.size;
+    glDevice->onMainContextAsync([=]{
+        glDevice->glBindBuffer(target, handle);
+        glDevice->glFlushMappedBufferRange(target, 0, size);
     });
     return AGPU_OK;
 }
@@ -5,6 +5,7 @@
 #include "framebuffer.hpp"
 #include "renderpass.hpp"
 #include "shader_resource_binding.hpp"
+#include "../Common/encoded_commands.hpp"
 #include <string.h>
 
 namespace AgpuGL
@@ -94,7 +95,7 @@ void CommandListExecutionContext::validateBeforeDrawCall()
         }
         else
         {
-            deviceForGL->glUseProgram(0);
+            deviceForGL->getStateCache().useProgram(0);
         }
     }
 
@@ -133,7 +134,7 @@ void CommandListExecutionContext::validateBeforeComputeDispatch()
         }
         else
         {
-            deviceForGL->glUseProgram(0);
+            deviceForGL->getStateCache().useProgram(0);
         }
     }
 
@@ -189,6 +190,7 @@ void CommandListExecutionContext::useComputeShaderResources (const agpu::shader_
 }
 
 GLCommandList::GLCommandList()
+    : commands(std::make_shared<AgpuGLCommands> ())
 {
     closed = false;
 }
@@ -217,14 +219,14 @@ agpu_error GLCommandList::setShaderSignature(const agpu::shader_signature_ref &s
 agpu_error GLCommandList::setViewport(agpu_int x, agpu_int y, agpu_int w, agpu_int h)
 {
     return addCommand([=] {
-        glViewport(x, y, w, h);
+        deviceForGL->getStateCache().setViewport(x, y, w, h);
     });
 }
 
 agpu_error GLCommandList::setScissor(agpu_int x, agpu_int y, agpu_int w, agpu_int h)
 {
     return addCommand([=] {
-        glScissor(x, y, w, h);
+        deviceForGL->getStateCache().setScissor(x, y, w, h);
     });
 }
 
@@ -415,8 +417,9 @@ agpu_error GLCommandList::executeBundle(const agpu::command_list_ref &bundle)
     if(bundle.as<GLCommandList> ()->type != AGPU_COMMAND_LIST_TYPE_BUNDLE)
         return AGPU_INVALID_PARAMETER;
 
+    auto recordedCommands = bundle.as<GLCommandList> ()->getRecordedCommands();
     return addCommand([=] {
-        bundle.as<GLCommandList> ()->execute();
+        bundle.as<GLCommandList> ()->execute(*recordedCommands);
     });
 }
 
@@ -429,7 +432,7 @@ agpu_error GLCommandList::close()
 agpu_error GLCommandList::reset(const agpu::command_allocator_ref &allocator, const agpu::pipeline_state_ref &initial_pipeline_state)
 {
     closed = false;
-    commands.clear();
+    clearCommands();
     if (initial_pipeline_state)
         usePipelineState(initial_pipeline_state);
     return AGPU_OK;
@@ -439,7 +442,7 @@ agpu_error GLCommandList::reset(const agpu::command_allocator_ref &allocator, co
 agpu_error GLCommandList::resetBundle(const agpu::command_allocator_ref & allocator, const agpu::pipeline_state_ref & initial_pipeline_state, agpu_inheritance_info* inheritance_info)
 {
     closed = false;
-    commands.clear();
+    clearCommands();
     if (initial_pipeline_state)
         usePipelineState(initial_pipeline_state);
     return AGPU_OK;
@@ -451,8 +454,9 @@ agpu_error GLCommandList::beginRenderPass(const agpu::renderpass_ref &renderpass
     return addCommand([=] {
         auto glFramebuffer = framebuffer.as<GLFramebuffer>();
         glFramebuffer->bind();
-        glViewport(0, 0, glFramebuffer->width, glFramebuffer->height);
-        glScissor(0, 0, glFramebuffer->width, glFramebuffer->height);
+        auto &stateCache = deviceForGL->getStateCache();
+        stateCache.setViewport(0, 0, glFramebuffer->width, glFramebuffer->height);
+        stateCache.setScissor(0, 0, glFramebuffer->width, glFramebuffer->height);
         renderpass.as<GLRenderPass>()->started();
     });
 }
@@ -470,17 +474,26 @@ agpu_error GLCommandList::addCommand(const AgpuGLCommand &command)
     if (closed)
         return AGPU_COMMAND_LIST_CLOSED;
 
-    commands.push_back(command);
+    commands->push_back(command);
     return AGPU_OK;
 }
 
-void GLCommandList::execute()
+void GLCommandList::clearCommands()
+{
+    // Do not touch the commands of a submission that is still pending.
+    if(commands.use_count() > 1)
+        commands = std::make_shared<AgpuGLCommands> ();
+    else
+        commands->clear();
+}
+
+void GLCommandList::execute(const AgpuGLCommands &recordedCommands)
 {
     currentVertexBinding.reset();
     currentIndexBuffer.reset();
     currentDrawBuffer.reset();
     currentComputeDispatchBuffer.reset();
-    for (auto &command : commands)
+    for (auto &command : recordedCommands)
         command();
 
     executionContext.reset();
@@ -559,4 +572,9 @@ agpu_error GLCommandList::copyTextureToBuffer(const agpu::texture_ref & texture,
 {
     return AGPU_UNIMPLEMENTED;
 }
+
+agpu_error GLCommandList::executeEncodedCommands(agpu_pointer commands, agpu_size size)
+{
+    return AgpuCommon::executeEncodedCommands(this, commands, size);
+}
 } // End of namespace AgpuGL
@@ -2,6 +2,7 @@
 #define AGPU_COMMAND_LIST_HPP_
 
 #include <vector>
+#include <memory>
 #include <functional>
 #include "device.hpp"
 
@@ -9,6 +10,8 @@ namespace AgpuGL
 {
 
 typedef std::function<void()> AgpuGLCommand;
+typedef std::vector<AgpuGLCommand> AgpuGLCommands;
+typedef std::shared_ptr<const AgpuGLCommands> AgpuGLRecordedCommandsRef;
 
 struct CommandListExecutionContext
 {
@@ -92,6 +95,7 @@ public:
     virtual agpu_error copyBuffer(const agpu::buffer_ref & source_buffer, agpu_size source_offset, const agpu::buffer_ref & dest_buffer, agpu_size dest_offset, agpu_size copy_size) override;
     virtual agpu_error copyBufferToTexture(const agpu::buffer_ref & buffer, const agpu::texture_ref & texture, agpu_buffer_image_copy_region* copy_region) override;
     virtual agpu_error copyTextureToBuffer(const agpu::texture_ref & texture, const agpu::buffer_ref & buffer, agpu_buffer_image_copy_region* copy_region) override;
+    virtual agpu_error executeEncodedCommands(agpu_pointer commands, agpu_size size) override;
 
 public:
     agpu::device_ref device;
@@ -107,12 +111,20 @@ public:
     agpu::buffer_ref currentComputeDispatchBuffer;
     agpu_command_list_type type;
 
-    void execute();
+    // The recorded commands are captured when the list is submitted, so that
+    // the list can be reset while its previous submission is executing.
+    AgpuGLRecordedCommandsRef getRecordedCommands() const
+    {
+        return commands;
+    }
+
+    void execute(const AgpuGLCommands &recordedCommands);
 
 private:
     agpu_error addCommand(const AgpuGLCommand &command);
+    void clearCommands();
 
-    std::vector<AgpuGLCommand> commands;
+    std::shared_ptr<AgpuGLCommands> commands;
     bool closed;
     CommandListExecutionContext executionContext;
 };
@@ -5,146 +5,6 @@
 namespace AgpuGL
 {
 
-class GpuCommand
-{
-public:
-    virtual ~GpuCommand() {}
-
-    virtual void execute() = 0;
-    virtual void destroy() = 0;
-};
-
-class GpuFinishCommand: public GpuCommand
-{
-public:
-    GpuFinishCommand()
-        : finished(false)
-    {
-
-    }
-
-    virtual void execute()
-    {
-        OpenGLContext::getCurrent()->finish();
-    }
-
-    virtual void destroy()
-    {
-        {
-            std::unique_lock<std::mutex> l(mutex);
-            finished = true;
-            finishedCondition.notify_all();
-        }
-    }
-
-    void wait()
-    {
-        {
-            std::unique_lock<std::mutex> l(mutex);
-            while(!finished)
-                finishedCondition.wait(l);
-        }
-    }
-
-    bool finished;
-    std::mutex mutex;
-    std::condition_variable finishedCondition;
-};
-
-class GpuSignalFenceCommand: public GpuCommand
-{
-public:
-    GpuSignalFenceCommand(const agpu::fence_ref &fence)
-        : fence(fence), signaled(false)
-    {
-
-    }
-
-    virtual void execute()
-    {
-        auto glFence = fence.as<GLFence> ();
-        std::unique_lock<std::mutex> l(glFence->mutex);
-
-        auto device = OpenGLContext::getCurrent()->weakDevice.lock();
-        if(glFence->fenceObject)
-            deviceForGL->glDeleteSync(glFence->fenceObject);
-
-        glFence->fenceObject = deviceForGL->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-        glFlush();
-    }
-
-    virtual void destroy()
-    {
-        auto glFence = fence.as<GLFence> ();
-        std::unique_lock<std::mutex> l(glFence->mutex);
-        signaled = true;
-        glFence->sendCommandCondition.notify_all();
-    }
-
-    void wait()
-    {
-        auto glFence = fence.as<GLFence> ();
-        {
-            std::unique_lock<std::mutex> l(glFence->mutex);
-            while(!signaled)
-                glFence->sendCommandCondition.wait(l);
-        }
-    }
-
-    agpu::fence_ref fence;
-    bool signaled;
-};
-
-class GpuExecuteCommandList: public GpuCommand
-{
-public:
-    GpuExecuteCommandList(const agpu::command_list_ref &command_list)
-        : command_list(command_list)
-    {
-    }
-
-    ~GpuExecuteCommandList()
-    {
-    }
-
-    virtual void execute()
-    {
-        command_list.as<GLCommandList> ()->execute();
-    }
-
-    virtual void destroy()
-    {
-        delete this;
-    }
-
-    agpu::command_list_ref command_list;
-};
-
-class GpuCustomCommand : public GpuCommand
-{
-public:
-    GpuCustomCommand(const std::function<void()> &command)
-        : command(command)
-    {
-    }
-
-    ~GpuCustomCommand()
-    {
-    }
-
-    virtual void execute()
-    {
-        command();
-    }
-
-    virtual void destroy()
-    {
-        delete this;
-    }
-
-    std::function<void()> command;
-};
-
 GLCommandQueue::GLCommandQueue()
 {
 }
@@ -163,53 +23,70 @@ agpu::command_queue_ref GLCommandQueue::create(const agpu::device_ref &device)
 agpu_error GLCommandQueue::addCommandList(const agpu::command_list_ref &command_list)
 {
 	CHECK_POINTER(command_list);
-    addCommand(new GpuExecuteCommandList(command_list));
+    auto recordedCommands = command_list.as<GLCommandList> ()->getRecordedCommands();
+    addCommand([command_list, recordedCommands] {
+        command_list.as<GLCommandList> ()->execute(*recordedCommands);
+    });
 	return AGPU_OK;
 }
 
-agpu_error GLCommandQueue::addCustomCommand(const std::function<void()> &command)
+agpu_error GLCommandQueue::addCommandLists(agpu_uint count, agpu::command_list_ref* command_lists)
 {
-    addCommand(new GpuCustomCommand(command));
+    if(count == 0)
+        return AGPU_OK;
+    CHECK_POINTER(command_lists);
+    for(agpu_uint i = 0; i < count; ++i)
+        CHECK_POINTER(command_lists[i]);
+
+    // A single job for the whole group of command lists.
+    std::vector<agpu::command_list_ref> commandLists(command_lists, command_lists + count);
+    std::vector<AgpuGLRecordedCommandsRef> recordedCommands;
+    recordedCommands.reserve(count);
+    for(auto &command_list : commandLists)
+        recordedCommands.push_back(command_list.as<GLCommandList> ()->getRecordedCommands());
+
+    addCommand([commandLists, recordedCommands] {
+        for(size_t i = 0; i < commandLists.size(); ++i)
+            commandLists[i].as<GLCommandList> ()->execute(*recordedCommands[i]);
+    });
     return AGPU_OK;
 }
 
-void GLCommandQueue::addCommand(GpuCommand *command)
+agpu_error GLCommandQueue::addCustomCommand(const std::function<void()> &command)
 {
-    lockWeakDeviceForGL->mainContextJobQueue.addJob(new AsyncJob([=] {
-        command->execute();
-        command->destroy();
-    }, true));
+    addCommand(command);
+    return AGPU_OK;
 }
 
 agpu_error GLCommandQueue::finishExecution()
 {
-    GpuFinishCommand finishCommand;
-    addCommand(&finishCommand);
-    finishCommand.wait();
+    lockWeakDeviceForGL->onMainContextBlocking([] {
+        OpenGLContext::getCurrent()->finish();
+    });
     return AGPU_OK;
 }
 
 agpu_error GLCommandQueue::signalFence(const agpu::fence_ref &fence )
 {
-    GpuSignalFenceCommand signalCommand(fence);
-    addCommand(&signalCommand);
-    signalCommand.wait();
+    CHECK_POINTER(fence);
+
+    // The sync object is created when the signal is reached by the main context.
+    auto signalIndex = fence.as<GLFence> ()->requestSignal();
+    addCommand([fence, signalIndex] {
+        fence.as<GLFence> ()->createSyncObjectForSignal(signalIndex);
+    });
     return AGPU_OK;
 }
 
 agpu_error GLCommandQueue::waitFence(const agpu::fence_ref &fence )
 {
-    GLsync fenceObject = nullptr;
-    {
+    CHECK_POINTER(fence);
+    addCommand([fence] {
         auto glFence = fence.as<GLFence> ();
-        std::unique_lock<std::mutex> l(glFence->mutex);
-        fenceObject = glFence->fenceObject;
-    }
-    if(fenceObject)
-        addCustomCommand([=]() {
-            glFlush();
-            lockWeakDeviceForGL->glWaitSync(fenceObject, 0, -1);
-        });
+        auto fenceObject = glFence->getSyncObject();
+        if(fenceObject)
+            glFence->device.as<GLDevice> ()->glWaitSync(fenceObject, 0, GL_TIMEOUT_IGNORED);
+    });
     return AGPU_OK;
 }
 
@@ -11,8 +11,6 @@
 namespace AgpuGL
 {
 
-class GpuCommand;
-
 struct GLCommandQueue: public agpu::command_queue
 {
 public:
@@ -24,13 +22,18 @@ public:
     agpu_error addCustomCommand(const std::function<void()> &command);
 
     virtual agpu_error addCommandList (const agpu::command_list_ref &command_list) override;
+    virtual agpu_error addCommandLists(agpu_uint count, agpu::command_list_ref* command_lists) override;
     virtual agpu_error finishExecution() override;
     virtual agpu_error signalFence(const agpu::fence_ref &fence) override;
     virtual agpu_error waitFence(const agpu::fence_ref &fence) override;
 
 
 public:
-    void addCommand(GpuCommand *command);
+    template<typename FT>
+    void addCommand(FT &&command)
+    {
+        lockWeakDeviceForGL->mainContextJobQueue.addJob(std::forward<FT> (command));
+    }
 
     agpu::device_weakref weakDevice;
 };
@@ -56,30 +56,52 @@ agpu::pipeline_state_ptr GLComputePipelineBuilder::build ()
 		return nullptr;
 	}
 
+	// Compute the key of the linked program.
+	auto &programBinaryCache = deviceForGL->programBinaryCache;
+	std::string programKey;
+	if(programBinaryCache.isEnabled())
+	{
+		auto keyHasher = programBinaryCache.makeKeyHasher();
+		shaderInstance->addToProgramKey(keyHasher);
+		programKey = keyHasher.finish();
+	}
+
+	// The program is linked in a context that shares it with the main context.
 	bool succeded = false;
-	deviceForGL->onMainContextBlocking([&] {
+	deviceForGL->workerContextPool.runBlocking([&] {
 		// Create the progrma
 		program = deviceForGL->glCreateProgram();
 
-		// Attach the shader instance to the program.
-		std::string errorMessage;
-		auto error = shaderInstance->attachToProgram(program, &errorMessage);
-		errorMessages += errorMessage;
-		if (error != AGPU_OK)
-			return;
-
-		// Link the program.
-		deviceForGL->glLinkProgram(program);
-
-		// Check the link status
-		GLint status;
-		deviceForGL->glGetProgramiv(program, GL_LINK_STATUS, &status);
-		if (status != GL_TRUE)
+		if(programKey.empty() || !programBinaryCache.loadProgram(program, programKey))
 		{
-			// TODO: Get the info log
-			return;
+			// Attach the shader instance to the program.
+			std::string errorMessage;
+			auto error = shaderInstance->attachToProgram(program, &errorMessage);
+			errorMessages += errorMessage;
+			if (error != AGPU_OK)
+				return;
+
+			// Link the program.
+			programBinaryCache.prepareForLinking(program);
+			deviceForGL->glLinkProgram(program);
+
+			// Check the link status
+			GLint status;
+			deviceForGL->glGetProgramiv(program, GL_LINK_STATUS, &status);
+			if (status != GL_TRUE)
+			{
+				// The compilation errors are only retrieved when the link fails.
+				shaderInstance->checkCompilation(&errorMessage);
+				errorMessages += errorMessage;
+				return;
+			}
+
+			if(!programKey.empty())
+				programBinaryCache.storeProgram(program, programKey);
 		}
 
+		// Make the program complete before it is used by the main context.
+		glFinish();
 		succeded = true;
 	});
 
@@ -20,39 +20,16 @@
 #include "fence.hpp"
 #include "../Common/offline_shader_compiler.hpp"
 #include "../Common/state_tracker_cache.hpp"
+#include "../Common/shader_archive.hpp"
+#include "../Common/environment.hpp"
 
 #define LOAD_FUNCTION(functionName) loadExtensionFunction(functionName, #functionName)
 
 namespace AgpuGL
 {
 
-std::string getStringFromEnvironment(const char *varname)
-{
-#ifdef _WIN32
-	char *buffer;
-	size_t size;
-	auto error = _dupenv_s(&buffer, &size, varname);;
-	if (error) return std::string();
-	if (!buffer) return std::string();
-	std::string res = buffer;
-	free(buffer);
-	return res;
-#else
-	auto value = getenv(varname);
-	if (!value)
-		return std::string();
-	return value;
-#endif
-}
-
-bool getBooleanEnvironment(const char *varname, bool defaultValue = false)
-{
-	auto result = getStringFromEnvironment(varname);
-	if (result.empty())
-		return defaultValue;
-	return result != "0" && result != "n";
-}
-
+using AgpuCommon::getStringFromEnvironment;
+using AgpuCommon::getBooleanEnvironment;
 
 void printMessage(const char *format, ...)
 {
@@ -113,14 +90,18 @@ void OpenGLContext::finish()
 }
 
 GLDevice::GLDevice()
+    : mainContext(nullptr)
 {
 }
 
 GLDevice::~GLDevice()
 {
+    workerContextPool.shutdown();
     if(mainContext)
     {
         onMainContextBlocking([&]() {
+            streamingUploadRing.destroy();
+            pixelTransferRing.destroy();
             mainContext->destroy();
             delete mainContext;
             mainContext = nullptr;
@@ -219,6 +200,15 @@ void GLDevice::checkEnvironmentVariables()
 {
 	dumpShaders = getBooleanEnvironment("DUMP_SHADERS", false);
 	dumpShadersOnError = getBooleanEnvironment("DUMP_SHADERS_ON_ERROR", false);
+	disableStateCache = getBooleanEnvironment("DISABLE_STATE_CACHE", false);
+	programBinaryCacheDirectory = getStringFromEnvironment("PROGRAM_BINARY_CACHE_DIR");
+	disableGLSLTranslationCache = getBooleanEnvironment("DISABLE_GLSL_TRANSLATION_CACHE", false);
+	glslTranslationCacheDirectory = getStringFromEnvironment("GLSL_TRANSLATION_CACHE_DIR");
+	disableStreamingUploads = getBooleanEnvironment("DISABLE_STREAMING_UPLOADS", false);
+	disableVertexAttribBinding = getBooleanEnvironment("DISABLE_VERTEX_ATTRIB_BINDING", false);
+
+	auto shaderCompilerThreads = getStringFromEnvironment("SHADER_COMPILER_THREADS");
+	shaderCompilerThreadCount = shaderCompilerThreads.empty() ? -1 : atoi(shaderCompilerThreads.c_str());
 }
 
 void GLDevice::loadExtensions()
@@ -237,6 +227,7 @@ void GLDevice::loadExtensions()
     LOAD_FUNCTION(glMapBufferRange);
     LOAD_FUNCTION(glUnmapBuffer);
     LOAD_FUNCTION(glBufferStorage);
+    LOAD_FUNCTION(glCopyBufferSubData);
 
     // Buffer binding
     LOAD_FUNCTION(glBindBufferRange);
@@ -247,6 +238,13 @@ void GLDevice::loadExtensions()
     LOAD_FUNCTION(glDeleteVertexArrays);
     LOAD_FUNCTION(glBindVertexArray);
 
+    // Separate vertex attribute format and buffer binding.
+    LOAD_FUNCTION(glVertexAttribFormat);
+    LOAD_FUNCTION(glVertexAttribIFormat);
+    LOAD_FUNCTION(glVertexAttribBinding);
+    LOAD_FUNCTION(glBindVertexBuffer);
+    LOAD_FUNCTION(glBindVertexBuffers);
+
     // Instancing.
     LOAD_FUNCTION(glDrawArraysInstancedBaseInstance);
     LOAD_FUNCTION(glDrawElementsInstancedBaseVertexBaseInstance);
@@ -286,6 +284,10 @@ void GLDevice::loadExtensions()
     LOAD_FUNCTION(glGetProgramiv);
     LOAD_FUNCTION(glGetProgramInfoLog);
 
+    LOAD_FUNCTION(glGetProgramBinary);
+    LOAD_FUNCTION(glProgramBinary);
+    LOAD_FUNCTION(glProgramParameteri);
+
     LOAD_FUNCTION(glGetActiveAttrib);
     LOAD_FUNCTION(glGetActiveUniform);
 
@@ -336,6 +338,7 @@ void GLDevice::loadExtensions()
     LOAD_FUNCTION(glDeleteSync);
     LOAD_FUNCTION(glFenceSync);
     LOAD_FUNCTION(glClientWaitSync);
+    LOAD_FUNCTION(glGetSynciv);
     LOAD_FUNCTION(glWaitSync);
 
     // Stencil buffer
@@ -353,9 +356,21 @@ void GLDevice::loadExtensions()
 	LOAD_FUNCTION(glMemoryBarrier);
 	LOAD_FUNCTION(glFlushMappedBufferRange);
 
+    // Parallel shader compile
+    loadExtensionFunction(glMaxShaderCompilerThreads, "glMaxShaderCompilerThreadsKHR");
+    if(!glMaxShaderCompilerThreads)
+        loadExtensionFunction(glMaxShaderCompilerThreads, "glMaxShaderCompilerThreadsARB");
+
     isPersistentMemoryMappingSupported_ = isCoherentMemoryMappingSupported_ = glBufferStorage != nullptr && hasOpenGLExtension("GL_ARB_buffer_storage");
     hasExtension_GL_NV_depth_buffer_float = glDepthRangedNV != nullptr && hasOpenGLExtension("GL_NV_depth_buffer_float");
     hasExtension_GL_ARB_clip_control = glClipControl != nullptr && hasOpenGLExtension("GL_ARB_clip_control");
+    hasExtension_GL_parallel_shader_compile = glMaxShaderCompilerThreads != nullptr &&
+        (hasOpenGLExtension("GL_KHR_parallel_shader_compile") || hasOpenGLExtension("GL_ARB_parallel_shader_compile"));
+    hasExtension_GL_ARB_vertex_attrib_binding = !disableVertexAttribBinding &&
+        glVertexAttribFormat != nullptr && glVertexAttribIFormat != nullptr && glVertexAttribBinding != nullptr && glBindVertexBuffer != nullptr &&
+        (versionNumber >= OpenGLVersion::Version43 || hasOpenGLExtension("GL_ARB_vertex_attrib_binding"));
+    hasExtension_GL_ARB_multi_bind = glBindVertexBuffers != nullptr &&
+        (versionNumber >= OpenGLVersion::Version44 || hasOpenGLExtension("GL_ARB_multi_bind"));
 
 }
 
@@ -471,6 +486,19 @@ void GLDevice::initializeObjects()
     readVersionInformation();
 	checkEnvironmentVariables();
     loadExtensions();
+    mainContext->stateCache.initialize(this, !disableStateCache);
+    programBinaryCache.initialize(this, programBinaryCacheDirectory);
+    for(size_t i = 0; i < size_t(GLObjectKind::Count); ++i)
+        objectNamePools[i].initialize(this, GLObjectKind(i));
+    deletionQueue.initialize(this);
+    streamingUploadRing.initialize(this, !disableStreamingUploads);
+    pixelTransferRing.initialize(this);
+
+    // Let the driver use its own threads for compiling the shaders.
+    if(hasExtension_GL_parallel_shader_compile)
+        glMaxShaderCompilerThreads(0xFFFFFFFF);
+    workerContextPool.initialize(this, shaderCompilerThreadCount);
+    glslTranslationCache.initialize(!disableGLSLTranslationCache, glslTranslationCacheDirectory);
     createDefaultCommandQueue();
 }
 
@@ -529,4 +557,25 @@ agpu_error GLDevice::finishExecution()
 	return AGPU_OK;
 }
 
+agpu_error GLDevice::getObjectStatistics(agpu_device_object_statistics* statistics)
+{
+	CHECK_POINTER(statistics);
+	memset(statistics, 0, sizeof(agpu_device_object_statistics));
+
+	// The state cache is only accessed from the main context thread.
+	onMainContextBlocking([&]{
+		auto &stateCache = getStateCache();
+		statistics->state_change_count = agpu_uint(stateCache.getCallCount());
+		statistics->redundant_state_change_count = agpu_uint(stateCache.getSkippedCallCount());
+	});
+	return AGPU_OK;
+}
+
+agpu::shader_archive_ptr GLDevice::openShaderArchive(agpu_cstring path)
+{
+	if(!path)
+		return nullptr;
+	return AgpuCommon::ShaderArchive::open(refFromThis<agpu::device> (), path).disown();
+}
+
 } // End of namespace AgpuGL
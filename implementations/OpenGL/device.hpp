@@ -20,16 +20,35 @@ typedef BOOL(WINAPI * wglChoosePixelFormatARBProc) (HDC hdc, const int *piAttrib
 
 typedef GLXContext (*glXCreateContextAttribsARBProc)(Display*, GLXFBConfig, GLXContext, Bool, const int*);
 
+#ifdef AGPU_GL_USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #else
 #error unsupported platform
 #endif
 
+#ifndef GL_ARB_parallel_shader_compile
+#define GL_MAX_SHADER_COMPILER_THREADS_ARB 0x91B0
+#define GL_COMPLETION_STATUS_ARB 0x91B1
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSARBPROC) (GLuint count);
+#endif
+
 #include <string>
 #include <map>
 #include <list>
 
 #include "common.hpp"
 #include "job_queue.hpp"
+#include "state_cache.hpp"
+#include "program_binary_cache.hpp"
+#include "glsl_translation_cache.hpp"
+#include "object_lifetime.hpp"
+#include "staging_arena.hpp"
+#include "streaming_upload_ring.hpp"
+#include "pixel_transfer_ring.hpp"
+#include "worker_context_pool.hpp"
 
 namespace AgpuGL
 {
@@ -53,6 +72,7 @@ enum class OpenGLVersion
     Version41 = 41,
     Version42 = 42,
     Version43 = 43,
+    Version44 = 44,
 };
 
 extern OpenGLVersion GLContextVersionPriorities[];
@@ -71,11 +91,16 @@ struct OpenGLContext
 
     static OpenGLContext *getCurrent();
 
+    // Creates a context that shares its objects with this one, and that can
+    // be made current in another thread.
+    OpenGLContext *createSharedContext();
+
     agpu::device_weakref weakDevice;
 
     bool ownsWindow;
     bool ownsDisplay;
     OpenGLVersion version;
+    GLStateCache stateCache;
 
 #ifdef _WIN32
     wglCreateContextAttribsARBProc wglCreateContextAttribsARB;
@@ -85,6 +110,11 @@ struct OpenGLContext
     HDC hDC;
     HGLRC context;
 
+    bool isHeadless() const
+    {
+        return false;
+    }
+
 #elif defined(__linux__)
     glXCreateContextAttribsARBProc glXCreateContextAttribsARB;
     GLXFBConfig framebufferConfig;
@@ -92,6 +122,28 @@ struct OpenGLContext
     Display *display;
     Window window;
     GLXContext context;
+
+#ifdef AGPU_GL_USE_EGL
+    // Headless contexts, that do not need an X11 display.
+    EGLDisplay eglDisplay;
+    EGLConfig eglConfig;
+    EGLContext eglContext;
+    EGLSurface eglSurface;
+
+    bool isHeadless() const
+    {
+        return eglContext != EGL_NO_CONTEXT;
+    }
+
+    bool makeCurrentHeadless();
+    void destroyHeadless();
+    OpenGLContext *createSharedHeadlessContext();
+#else
+    bool isHeadless() const
+    {
+        return false;
+    }
+#endif
 #endif
 
     bool isCurrent() const;
@@ -107,6 +159,9 @@ public:
     ~GLDevice();
 
     static agpu::device_ref open(agpu_device_open_info* openInfo);
+#ifdef AGPU_GL_USE_EGL
+    static agpu::device_ref openHeadless(agpu_device_open_info* openInfo);
+#endif
     static bool isExtensionSupported(const char *extList, const char *extension);
     bool hasOpenGLExtension(const char *extension);
 
@@ -125,12 +180,34 @@ public:
         functionPointer = reinterpret_cast<FT> (getProcAddress(functionName));
     }
 
+    // The worker contexts have their own state caches.
+    GLStateCache &getStateCache()
+    {
+        auto currentContext = OpenGLContext::getCurrent();
+        return currentContext ? currentContext->stateCache : mainContext->stateCache;
+    }
+
     template<typename FT>
     void onMainContextBlocking(const FT &f)
     {
-        AsyncJob job(f);
-        mainContextJobQueue.addJob(&job);
-        job.wait();
+        mainContextJobQueue.runBlocking(f);
+    }
+
+    // The job must not capture references to the stack of the caller.
+    template<typename FT>
+    void onMainContextAsync(FT &&f)
+    {
+        mainContextJobQueue.addJob(std::forward<FT> (f));
+    }
+
+    GLuint allocateObjectName(GLObjectKind kind)
+    {
+        return objectNamePools[size_t(kind)].allocate();
+    }
+
+    void deleteObjectLater(GLObjectKind kind, GLuint name)
+    {
+        deletionQueue.deleteObject(kind, name);
     }
 
 public:
@@ -165,6 +242,8 @@ public:
     virtual agpu::state_tracker_cache_ptr createStateTrackerCache(const agpu::command_queue_ref & command_queue_family) override;
 
 	virtual agpu_error finishExecution() override;
+	virtual agpu_error getObjectStatistics(agpu_device_object_statistics* statistics) override;
+	virtual agpu::shader_archive_ptr openShaderArchive(agpu_cstring path) override;
 
 public:
     OpenGLVersion versionNumber;
@@ -177,6 +256,16 @@ public:
 	// Debugging options.
 	bool dumpShaders;
 	bool dumpShadersOnError;
+	bool disableStateCache;
+
+    // Directory of the persistent program binaries.
+    std::string programBinaryCacheDirectory;
+    GLProgramBinaryCache programBinaryCache;
+
+    // Spir-V to GLSL translations.
+    bool disableGLSLTranslationCache;
+    std::string glslTranslationCacheDirectory;
+    GLSLTranslationCache glslTranslationCache;
 
     // Important extensions
     bool isPersistentMemoryMappingSupported_;
@@ -188,6 +277,28 @@ public:
     OpenGLContext *mainContext;
     JobQueue mainContextJobQueue;
 
+    // Asynchronous object creation, upload and destruction.
+    GLNamePool objectNamePools[size_t(GLObjectKind::Count)];
+    GLDeletionQueue deletionQueue;
+    GLStagingArena stagingArena;
+
+    // Buffer uploads through a persistently mapped ring.
+    bool disableStreamingUploads;
+    GLStreamingUploadRing streamingUploadRing;
+
+    // Pixel buffers for the texture transfers.
+    GLPixelTransferRing pixelTransferRing;
+
+    // Shared contexts for compiling and linking programs in parallel.
+    int shaderCompilerThreadCount;
+    GLWorkerContextPool workerContextPool;
+    bool hasExtension_GL_parallel_shader_compile;
+
+    // Vertex formats that are specified once per vertex array.
+    bool disableVertexAttribBinding;
+    bool hasExtension_GL_ARB_vertex_attrib_binding;
+    bool hasExtension_GL_ARB_multi_bind;
+
     // GetStringi
     PFNGLGETSTRINGIPROC glGetStringi;
 
@@ -202,6 +313,7 @@ public:
     PFNGLMAPBUFFERRANGEPROC glMapBufferRange;
     PFNGLUNMAPBUFFERPROC glUnmapBuffer;
     PFNGLBUFFERSTORAGEPROC glBufferStorage;
+    PFNGLCOPYBUFFERSUBDATAPROC glCopyBufferSubData;
 
     // Buffer binding
     PFNGLBINDBUFFERRANGEPROC glBindBufferRange;
@@ -251,12 +363,21 @@ public:
     PFNGLGETPROGRAMIVPROC glGetProgramiv;
     PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog;
 
+    PFNGLGETPROGRAMBINARYPROC glGetProgramBinary;
+    PFNGLPROGRAMBINARYPROC glProgramBinary;
+    PFNGLPROGRAMPARAMETERIPROC glProgramParameteri;
+
     PFNGLGETACTIVEATTRIBPROC glGetActiveAttrib;
     PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform;
 
     PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer;
     PFNGLVERTEXATTRIBIPOINTERPROC glVertexAttribIPointer;
     PFNGLVERTEXATTRIBLPOINTERPROC glVertexAttribLPointer;
+    PFNGLVERTEXATTRIBFORMATPROC glVertexAttribFormat;
+    PFNGLVERTEXATTRIBIFORMATPROC glVertexAttribIFormat;
+    PFNGLVERTEXATTRIBBINDINGPROC glVertexAttribBinding;
+    PFNGLBINDVERTEXBUFFERPROC glBindVertexBuffer;
+    PFNGLBINDVERTEXBUFFERSPROC glBindVertexBuffers;
     PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray;
     PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArray;
     PFNGLGETATTRIBLOCATIONPROC glGetAttribLocation;
@@ -301,6 +422,7 @@ public:
     PFNGLDELETESYNCPROC glDeleteSync;
     PFNGLFENCESYNCPROC glFenceSync;
     PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+    PFNGLGETSYNCIVPROC glGetSynciv;
     PFNGLWAITSYNCPROC glWaitSync;
 
     // Separate stencil
@@ -317,6 +439,9 @@ public:
     // Memory barrier
     PFNGLFLUSHMAPPEDBUFFERRANGEPROC glFlushMappedBufferRange;
     PFNGLMEMORYBARRIERPROC glMemoryBarrier;
+
+    // Parallel shader compile. The KHR and ARB variants have the same signature.
+    PFNGLMAXSHADERCOMPILERTHREADSARBPROC glMaxShaderCompilerThreads;
 };
 
 } // End of namespace AgpuGL
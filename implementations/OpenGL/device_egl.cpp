@@ -0,0 +1,292 @@
+#include <vector>
+#include <map>
+#include <mutex>
+#include <string.h>
+#include "device.hpp"
+
+#if defined(__linux__) && defined(AGPU_GL_USE_EGL)
+
+namespace AgpuGL
+{
+
+//------------------------------------------------------------------------------
+// Headless contexts through EGL, for rendering without any X11 display.
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+// eglTerminate is not reference counted, and the same EGL display is shared
+// by all of the headless devices and worker contexts of the process.
+static std::mutex headlessDisplayMutex;
+static std::map<EGLDisplay, int> headlessDisplayReferenceCounts;
+
+static bool retainHeadlessDisplay(EGLDisplay display)
+{
+    std::unique_lock<std::mutex> l(headlessDisplayMutex);
+    auto &referenceCount = headlessDisplayReferenceCounts[display];
+    if(referenceCount == 0)
+    {
+        EGLint majorVersion, minorVersion;
+        if(!eglInitialize(display, &majorVersion, &minorVersion))
+        {
+            headlessDisplayReferenceCounts.erase(display);
+            return false;
+        }
+    }
+
+    ++referenceCount;
+    return true;
+}
+
+static void releaseHeadlessDisplay(EGLDisplay display)
+{
+    std::unique_lock<std::mutex> l(headlessDisplayMutex);
+    auto it = headlessDisplayReferenceCounts.find(display);
+    if(it == headlessDisplayReferenceCounts.end())
+        return;
+
+    if(--it->second == 0)
+    {
+        eglTerminate(display);
+        headlessDisplayReferenceCounts.erase(it);
+    }
+}
+
+static void getHeadlessDisplayCandidates(agpu_int gpuIndex, std::vector<EGLDisplay> &candidates)
+{
+    auto clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(!clientExtensions || !eglGetPlatformDisplayEXT)
+        return;
+
+    // The surfaceless platform uses the default device.
+    if(gpuIndex <= 0 && GLDevice::isExtensionSupported(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        auto display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if(display != EGL_NO_DISPLAY)
+            candidates.push_back(display);
+    }
+
+    // An explicit device, so that the headless devices can be spread among the GPUs.
+    auto eglQueryDevicesEXT = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+    if(eglQueryDevicesEXT && GLDevice::isExtensionSupported(clientExtensions, "EGL_EXT_platform_device"))
+    {
+        EGLint deviceCount = 0;
+        if(eglQueryDevicesEXT(0, nullptr, &deviceCount) && deviceCount > 0)
+        {
+            std::vector<EGLDeviceEXT> devices(deviceCount);
+            eglQueryDevicesEXT(deviceCount, &devices[0], &deviceCount);
+
+            auto deviceIndex = gpuIndex >= 0 && gpuIndex < deviceCount ? gpuIndex : 0;
+            auto display = eglGetPlatformDisplayEXT(EGL_PLATFORM_DEVICE_EXT, devices[deviceIndex], nullptr);
+            if(display != EGL_NO_DISPLAY)
+                candidates.push_back(display);
+        }
+    }
+}
+
+static bool chooseHeadlessConfig(EGLDisplay display, EGLConfig &config)
+{
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+
+    EGLint configCount = 0;
+    if(eglChooseConfig(display, configAttributes, &config, 1, &configCount) && configCount > 0)
+        return true;
+
+    // The surfaceless contexts can be created without any config.
+    if(GLDevice::isExtensionSupported(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_no_config_context"))
+    {
+        config = EGL_NO_CONFIG_KHR;
+        return true;
+    }
+
+    return false;
+}
+
+static EGLContext createHeadlessContext(EGLDisplay display, EGLConfig config, EGLContext shareContext, OpenGLVersion version)
+{
+    int contextAttributes[] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, (int)version / 10,
+        EGL_CONTEXT_MINOR_VERSION_KHR, (int)version % 10,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    if(contextAttributes[1] < 3)
+        contextAttributes[4] = EGL_NONE;
+
+    return eglCreateContext(display, config, shareContext, contextAttributes);
+}
+
+static EGLSurface createHeadlessSurface(EGLDisplay display, EGLConfig config)
+{
+    // Nothing is rendered into the default framebuffer, so we do not need a
+    // surface when the driver supports making current without one.
+    if(GLDevice::isExtensionSupported(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") ||
+        config == EGL_NO_CONFIG_KHR)
+        return EGL_NO_SURFACE;
+
+    const EGLint surfaceAttributes[] = {
+        EGL_WIDTH, 1,
+        EGL_HEIGHT, 1,
+        EGL_NONE
+    };
+    return eglCreatePbufferSurface(display, config, surfaceAttributes);
+}
+
+bool OpenGLContext::makeCurrentHeadless()
+{
+    // The bound API is part of the state of each thread.
+    eglBindAPI(EGL_OPENGL_API);
+    return eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext) == EGL_TRUE;
+}
+
+void OpenGLContext::destroyHeadless()
+{
+    if(eglContext == EGL_NO_CONTEXT)
+        return;
+
+    eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if(eglSurface != EGL_NO_SURFACE)
+        eglDestroySurface(eglDisplay, eglSurface);
+    eglDestroyContext(eglDisplay, eglContext);
+    eglSurface = EGL_NO_SURFACE;
+    eglContext = EGL_NO_CONTEXT;
+
+    if(ownsDisplay)
+        releaseHeadlessDisplay(eglDisplay);
+    eglReleaseThread();
+}
+
+OpenGLContext *OpenGLContext::createSharedHeadlessContext()
+{
+    if(!retainHeadlessDisplay(eglDisplay))
+        return nullptr;
+
+    auto sharedContext = createHeadlessContext(eglDisplay, eglConfig, eglContext, version);
+    if(sharedContext == EGL_NO_CONTEXT)
+    {
+        releaseHeadlessDisplay(eglDisplay);
+        return nullptr;
+    }
+
+    // A surface can only be current in one thread, so the shared context
+    // needs its own.
+    auto sharedSurface = EGL_NO_SURFACE;
+    if(eglSurface != EGL_NO_SURFACE)
+    {
+        sharedSurface = createHeadlessSurface(eglDisplay, eglConfig);
+        if(sharedSurface == EGL_NO_SURFACE)
+        {
+            eglDestroyContext(eglDisplay, sharedContext);
+            releaseHeadlessDisplay(eglDisplay);
+            return nullptr;
+        }
+    }
+
+    auto result = new OpenGLContext();
+    result->weakDevice = weakDevice;
+    result->version = version;
+    result->ownsDisplay = true;
+    result->eglDisplay = eglDisplay;
+    result->eglConfig = eglConfig;
+    result->eglContext = sharedContext;
+    result->eglSurface = sharedSurface;
+    return result;
+}
+
+agpu::device_ref GLDevice::openHeadless(agpu_device_open_info* openInfo)
+{
+    // Create the device.
+    auto result = agpu::makeObject<GLDevice> ();
+    auto device = result.as<GLDevice> ();
+
+    bool failure = false;
+
+    // Perform the main context creation in the main context thread.
+    device->mainContextJobQueue.start();
+    device->mainContextJobQueue.runBlocking([&] {
+        std::unique_ptr<OpenGLContext> contextWrapper(new OpenGLContext());
+
+        std::vector<EGLDisplay> displayCandidates;
+        getHeadlessDisplayCandidates(openInfo->gpu_index, displayCandidates);
+        for(auto display : displayCandidates)
+        {
+            if(!retainHeadlessDisplay(display))
+                continue;
+
+            EGLConfig config;
+            if(!eglBindAPI(EGL_OPENGL_API) || !chooseHeadlessConfig(display, config))
+            {
+                releaseHeadlessDisplay(display);
+                continue;
+            }
+
+            contextWrapper->eglDisplay = display;
+            contextWrapper->eglConfig = config;
+            contextWrapper->ownsDisplay = true;
+            break;
+        }
+
+        if(contextWrapper->eglDisplay == EGL_NO_DISPLAY)
+        {
+            printError("Failed to open an EGL display for a headless OpenGL device.\n");
+            failure = true;
+            return;
+        }
+
+        auto display = contextWrapper->eglDisplay;
+        auto config = contextWrapper->eglConfig;
+        auto context = EGL_NO_CONTEXT;
+        for(int versionIndex = 0; GLContextVersionPriorities[versionIndex] != OpenGLVersion::Invalid; ++versionIndex)
+        {
+            auto version = GLContextVersionPriorities[versionIndex];
+            context = createHeadlessContext(display, config, EGL_NO_CONTEXT, version);
+            if(context != EGL_NO_CONTEXT)
+            {
+                contextWrapper->version = version;
+                break;
+            }
+        }
+
+        if(context == EGL_NO_CONTEXT)
+        {
+            printError("Failed to create a headless OpenGL context.\n");
+            releaseHeadlessDisplay(display);
+            failure = true;
+            return;
+        }
+
+        contextWrapper->eglContext = context;
+        contextWrapper->eglSurface = createHeadlessSurface(display, config);
+        if(!contextWrapper->makeCurrent())
+        {
+            printError("Failed to make current the main headless OpenGL context.\n");
+            contextWrapper->destroy();
+            failure = true;
+            return;
+        }
+
+        // Initialize the device objects.
+        device->mainContext = contextWrapper.release();
+        device->mainContext->weakDevice = result;
+        device->initializeObjects();
+    });
+
+    if(failure)
+        return agpu::device_ref();
+    return result;
+}
+
+} // End of namespace AgpuGL
+
+#endif
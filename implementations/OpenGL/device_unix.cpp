@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "device.hpp"
+#include "../Common/environment.hpp"
 
 #if defined(__linux__)
 
@@ -47,6 +48,9 @@ private:
 
 OpenGLContext::OpenGLContext()
     : ownsWindow(false), ownsDisplay(false), display(nullptr), window(0), context(0)
+#ifdef AGPU_GL_USE_EGL
+    , eglDisplay(EGL_NO_DISPLAY), eglConfig(nullptr), eglContext(EGL_NO_CONTEXT), eglSurface(EGL_NO_SURFACE)
+#endif
 {
 }
 
@@ -61,6 +65,10 @@ OpenGLContext *OpenGLContext::getCurrent()
 
 bool OpenGLContext::makeCurrentWithWindow(agpu_pointer window)
 {
+    // Headless contexts do not have any window.
+    if(isHeadless())
+        return makeCurrent();
+
     WithX11Display wd(display);
     auto res = glXMakeCurrent(display, (Window)window, context) == True;
     if(res)
@@ -70,6 +78,16 @@ bool OpenGLContext::makeCurrentWithWindow(agpu_pointer window)
 
 bool OpenGLContext::makeCurrent()
 {
+#ifdef AGPU_GL_USE_EGL
+    if(isHeadless())
+    {
+        auto res = makeCurrentHeadless();
+        if(res)
+            currentGLContext = this;
+        return res;
+    }
+#endif
+
     WithX11Display wd(display);
     auto res = glXMakeCurrent(display, window, context) == True;
     if(res)
@@ -79,6 +97,12 @@ bool OpenGLContext::makeCurrent()
 
 void OpenGLContext::swapBuffers()
 {
+    if(isHeadless())
+    {
+        glFlush();
+        return;
+    }
+
     WithX11Display wd(display);
     glFlush();
     glXSwapBuffers(display, window);
@@ -86,6 +110,12 @@ void OpenGLContext::swapBuffers()
 
 void OpenGLContext::swapBuffersOfWindow(agpu_pointer window)
 {
+    if(isHeadless())
+    {
+        glFlush();
+        return;
+    }
+
     WithX11Display wd(display);
     glFlush();
     glXSwapBuffers(display, (Window)window);
@@ -93,6 +123,14 @@ void OpenGLContext::swapBuffersOfWindow(agpu_pointer window)
 
 void OpenGLContext::destroy()
 {
+#ifdef AGPU_GL_USE_EGL
+    if(isHeadless())
+    {
+        destroyHeadless();
+        return;
+    }
+#endif
+
     if(!context)
         return;
 
@@ -115,6 +153,63 @@ void OpenGLContext::destroy()
         XCloseDisplay(display);
 }
 
+OpenGLContext *OpenGLContext::createSharedContext()
+{
+#ifdef AGPU_GL_USE_EGL
+    if(isHeadless())
+        return createSharedHeadlessContext();
+#endif
+
+    if(!context)
+        return nullptr;
+
+    GLXContext sharedContext = 0;
+    {
+        WithX11Display wd(display);
+        std::unique_lock<std::mutex> l(contextErrorMutex);
+        ctxErrorOccurred = false;
+        auto oldHandler = XSetErrorHandler(&ctxErrorHandler);
+
+        if(glXCreateContextAttribsARB && version != OpenGLVersion::Version10)
+        {
+            int contextAttributes[] =
+            {
+                GLX_CONTEXT_MAJOR_VERSION_ARB, (int)version / 10,
+                GLX_CONTEXT_MINOR_VERSION_ARB, (int)version % 10,
+                GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+                None
+            };
+            if(contextAttributes[1] < 3)
+                contextAttributes[4] = 0;
+
+            sharedContext = glXCreateContextAttribsARB(display, framebufferConfig, context, True, contextAttributes);
+        }
+        else
+        {
+            sharedContext = glXCreateNewContext(display, framebufferConfig, GLX_RGBA_TYPE, context, True);
+        }
+
+        // Sync to ensure any errors generated are processed.
+        XSync(display, False);
+        XSetErrorHandler(oldHandler);
+
+        if(ctxErrorOccurred || !sharedContext)
+            return nullptr;
+    }
+
+    // The shared context renders into the window of this context, which it
+    // does not own.
+    auto result = new OpenGLContext();
+    result->weakDevice = weakDevice;
+    result->version = version;
+    result->glXCreateContextAttribsARB = glXCreateContextAttribsARB;
+    result->framebufferConfig = framebufferConfig;
+    result->display = display;
+    result->window = window;
+    result->context = sharedContext;
+    return result;
+}
+
 /*static void deviceOpenInfoToVisualAttributes(agpu_device_open_info* openInfo, std::vector<int> &visualInfo)
 {
     visualInfo.clear();
@@ -226,8 +321,23 @@ void GLDevice::setWindowPixelFormat(agpu_pointer window)
     // Do nothing here.
 }
 
+#ifdef AGPU_GL_USE_EGL
+static bool isHeadlessWindowSystem(const char *windowSystemName)
+{
+    return windowSystemName &&
+        (!strcmp(windowSystemName, "headless") ||
+        !strcmp(windowSystemName, "surfaceless") ||
+        !strcmp(windowSystemName, "egl"));
+}
+#endif
+
 agpu::device_ref GLDevice::open(agpu_device_open_info* openInfo)
 {
+#ifdef AGPU_GL_USE_EGL
+    if(isHeadlessWindowSystem(openInfo->window_system_name))
+        return openHeadless(openInfo);
+#endif
+
     // Ensure X11 threads are initialized
     XInitThreads();
 
@@ -236,10 +346,11 @@ agpu::device_ref GLDevice::open(agpu_device_open_info* openInfo)
     auto device = result.as<GLDevice> ();
 
     bool failure = false;
+    bool missingDisplay = false;
 
     // Perform the main context creation in
     device->mainContextJobQueue.start();
-    AsyncJob contextCreationJob([&] {
+    device->mainContextJobQueue.runBlocking([&] {
         std::unique_ptr<OpenGLContext> contextWrapper(new OpenGLContext());
         const char *displayName = nullptr;
         if(openInfo->display)
@@ -248,6 +359,7 @@ agpu::device_ref GLDevice::open(agpu_device_open_info* openInfo)
         contextWrapper->display = XOpenDisplay(displayName);
         if(!contextWrapper->display)
         {
+            missingDisplay = true;
             failure = true;
             return;
         }
@@ -418,15 +530,30 @@ agpu::device_ref GLDevice::open(agpu_device_open_info* openInfo)
 
     });
 
-    device->mainContextJobQueue.addJob(&contextCreationJob);
-    contextCreationJob.wait();
+#ifdef AGPU_GL_USE_EGL
+    // Without an X11 display, we can still render offscreen.
+    if(missingDisplay && !openInfo->display && !AgpuCommon::getBooleanEnvironment("DISABLE_HEADLESS_FALLBACK", false))
+    {
+        printError("The X11 display could not be opened, using a headless EGL device instead.\n");
+        return openHeadless(openInfo);
+    }
+#endif
+
     if(failure)
+    {
+        if(missingDisplay)
+            printError("Failed to open the X11 display.\n");
         return agpu::device_ref();
+    }
     return result;
 }
 
 void *GLDevice::getProcAddress(const char *symbolName)
 {
+#ifdef AGPU_GL_USE_EGL
+    if(mainContext && mainContext->isHeadless())
+        return (void*)eglGetProcAddress(symbolName);
+#endif
     return (void*)glXGetProcAddress((const GLubyte*)symbolName);
 }
 
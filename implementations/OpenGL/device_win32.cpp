@@ -107,6 +107,47 @@ void OpenGLContext::destroy()
     context = 0;
 }
 
+OpenGLContext *OpenGLContext::createSharedContext()
+{
+    if (!context)
+        return nullptr;
+
+    HGLRC sharedContext = 0;
+    if (wglCreateContextAttribsARB && version != OpenGLVersion::Version10)
+    {
+        int contextAttributes[] =
+        {
+            WGL_CONTEXT_MAJOR_VERSION_ARB, (int)version / 10,
+            WGL_CONTEXT_MINOR_VERSION_ARB, (int)version % 10,
+            0
+        };
+
+        sharedContext = wglCreateContextAttribsARB(hDC, context, contextAttributes);
+    }
+    else
+    {
+        sharedContext = wglCreateContext(hDC);
+        if (sharedContext && !wglShareLists(context, sharedContext))
+        {
+            wglDeleteContext(sharedContext);
+            sharedContext = 0;
+        }
+    }
+
+    if (!sharedContext)
+        return nullptr;
+
+    // The shared context uses the window of this context, which it does not own.
+    auto result = new OpenGLContext();
+    result->weakDevice = weakDevice;
+    result->version = version;
+    result->wglCreateContextAttribsARB = wglCreateContextAttribsARB;
+    result->window = window;
+    result->hDC = hDC;
+    result->context = sharedContext;
+    return result;
+}
+
 /*static void deviceOpenInfoToVisualAttributes(agpu_device_open_info* openInfo, std::vector<int> &visualInfo)
 {
     visualInfo.clear();
@@ -233,7 +274,7 @@ agpu::device_ref GLDevice::open(agpu_device_open_info* openInfo)
 
     // Perform the main context creation in
     device->mainContextJobQueue.start();
-    AsyncJob contextCreationJob([&] {
+    device->mainContextJobQueue.runBlocking([&] {
         std::unique_ptr<OpenGLContext> contextWrapper(new OpenGLContext());
 
         // Window for context creation.
@@ -397,8 +438,6 @@ agpu::device_ref GLDevice::open(agpu_device_open_info* openInfo)
         device->initializeObjects();
     });
 
-    device->mainContextJobQueue.addJob(&contextCreationJob);
-    contextCreationJob.wait();
     if (failure)
         return agpu::device_ref();
 
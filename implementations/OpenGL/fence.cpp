@@ -4,6 +4,7 @@ namespace AgpuGL
 {
 
 GLFence::GLFence()
+    : requestedSignalCount(0), submittedSignalCount(0), completedSignalCount(0), isStatusQueryPending(false)
 {
     fenceObject = nullptr;
 }
@@ -12,8 +13,10 @@ GLFence::~GLFence()
 {
     if(fenceObject)
     {
-        deviceForGL->onMainContextBlocking([&]() {
-            deviceForGL->glDeleteSync(fenceObject);
+        auto glDevice = deviceForGL;
+        auto syncObject = fenceObject;
+        glDevice->onMainContextAsync([glDevice, syncObject]() {
+            glDevice->glDeleteSync(syncObject);
         });
     }
 }
@@ -25,19 +28,122 @@ agpu::fence_ref GLFence::create(const agpu::device_ref &device)
     return result;
 }
 
+uint64_t GLFence::requestSignal()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    return ++requestedSignalCount;
+}
+
+void GLFence::createSyncObjectForSignal(uint64_t signalIndex)
+{
+    auto syncObject = deviceForGL->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    std::unique_lock<std::mutex> l(mutex);
+    if(fenceObject)
+        deviceForGL->glDeleteSync(fenceObject);
+    fenceObject = syncObject;
+    submittedSignalCount = signalIndex;
+}
+
+GLsync GLFence::getSyncObject()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    return fenceObject;
+}
+
+agpu_error GLFence::waitForLastSyncObject()
+{
+    GLsync syncObject;
+    uint64_t signalIndex;
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        syncObject = fenceObject;
+        signalIndex = submittedSignalCount;
+    }
+
+    // The jobs are executed in order, so every signal that was requested
+    // before this wait has its sync object by now.
+    if(syncObject)
+    {
+        GLenum waitReturn = deviceForGL->glClientWaitSync(syncObject, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        while(waitReturn == GL_TIMEOUT_EXPIRED)
+            waitReturn = deviceForGL->glClientWaitSync(syncObject, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        if(waitReturn == GL_WAIT_FAILED)
+            return AGPU_ERROR;
+    }
+
+    completeSignal(syncObject, signalIndex);
+    return AGPU_OK;
+}
+
+void GLFence::queryLastSyncObjectStatus()
+{
+    GLsync syncObject;
+    uint64_t signalIndex;
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        syncObject = fenceObject;
+        signalIndex = submittedSignalCount;
+    }
+
+    GLint status = GL_SIGNALED;
+    if(syncObject)
+        deviceForGL->glGetSynciv(syncObject, GL_SYNC_STATUS, 1, nullptr, &status);
+    if(status == GL_SIGNALED)
+        completeSignal(syncObject, signalIndex);
+
+    std::unique_lock<std::mutex> l(mutex);
+    isStatusQueryPending = false;
+}
+
+void GLFence::completeSignal(GLsync syncObject, uint64_t signalIndex)
+{
+    std::unique_lock<std::mutex> l(mutex);
+    if(signalIndex > completedSignalCount)
+        completedSignalCount = signalIndex;
+
+    // The sync object is not needed anymore, unless there is a newer signal.
+    if(syncObject && fenceObject == syncObject)
+    {
+        deviceForGL->glDeleteSync(fenceObject);
+        fenceObject = nullptr;
+    }
+}
+
 agpu_error GLFence::waitOnClient()
 {
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        if(completedSignalCount >= requestedSignalCount)
+            return AGPU_OK;
+    }
+
+    agpu_error result = AGPU_OK;
     deviceForGL->onMainContextBlocking([&]() {
-        if(fenceObject)
-        {
-            GLenum waitReturn = GL_UNSIGNALED;
-            while (waitReturn != GL_ALREADY_SIGNALED && waitReturn != GL_CONDITION_SATISFIED)
-                waitReturn = deviceForGL->glClientWaitSync(fenceObject, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
-        	deviceForGL->glDeleteSync(fenceObject);
-        	fenceObject = nullptr;
-        }
+        result = waitForLastSyncObject();
     });
-    return AGPU_OK;
+    return result;
+}
+
+agpu_bool GLFence::isSignaled()
+{
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        if(completedSignalCount >= requestedSignalCount)
+            return true;
+
+        // A single query at a time is enough for polling.
+        if(isStatusQueryPending)
+            return false;
+        isStatusQueryPending = true;
+    }
+
+    auto self = refFromThis<agpu::fence> ();
+    deviceForGL->onMainContextAsync([self]() {
+        self.as<GLFence> ()->queryLastSyncObjectStatus();
+    });
+    return false;
 }
 
 } // End of namespace AgpuGL
@@ -2,10 +2,21 @@
 #define AGPU_GL_FENCE_HPP
 
 #include "device.hpp"
+#include <mutex>
 
 namespace AgpuGL
 {
 
+/**
+ * Fence whose signals are submitted without waiting for the main context
+ * thread. The sync object of each signal is created when the signal command
+ * is executed in the main context thread, and the fence keeps the signal
+ * counts, so that the waits and queries on signals that are already known
+ * to be completed do not have to go into the main context thread. Querying
+ * a pending signal does not wait for the main context thread either: it
+ * submits an asynchronous query of the sync object status, whose result is
+ * seen by the following queries.
+ */
 struct GLFence : public agpu::fence
 {
 public:
@@ -15,13 +26,31 @@ public:
     static agpu::fence_ref create(const agpu::device_ref &device);
 
     agpu_error waitOnClient();
+    agpu_bool isSignaled();
+
+    // Returns the index of a new signal, whose command has to be submitted.
+    uint64_t requestSignal();
+
+    // These must be called in the main context thread.
+    void createSyncObjectForSignal(uint64_t signalIndex);
+    GLsync getSyncObject();
 
 public:
     agpu::device_ref device;
     GLsync fenceObject;
 
     std::mutex mutex;
-    std::condition_variable sendCommandCondition;
+
+private:
+    // These must be called in the main context thread.
+    agpu_error waitForLastSyncObject();
+    void queryLastSyncObjectStatus();
+    void completeSignal(GLsync syncObject, uint64_t signalIndex);
+
+    uint64_t requestedSignalCount;
+    uint64_t submittedSignalCount;
+    uint64_t completedSignalCount;
+    bool isStatusQueryPending;
 };
 
 } // End of namespace AgpuGL
@@ -26,9 +26,7 @@ GLFramebuffer::GLFramebuffer()
 
 GLFramebuffer::~GLFramebuffer()
 {
-    deviceForGL->onMainContextBlocking([&] {
-        deviceForGL->glDeleteFramebuffers(1, &handle);
-    });
+    deviceForGL->deleteObjectLater(GLObjectKind::Framebuffer, handle);
 }
 
 agpu::framebuffer_ref GLFramebuffer::create(const agpu::device_ref &device, agpu_uint width, agpu_uint height, agpu_uint colorCount, agpu::texture_view_ref* colorViews, const agpu::texture_view_ref &depthStencilView)
@@ -37,10 +35,7 @@ agpu::framebuffer_ref GLFramebuffer::create(const agpu::device_ref &device, agpu
         return agpu::framebuffer_ref();
 
 	// Create the framebuffer object.
-    GLuint handle;
-    deviceForGL->onMainContextBlocking([&] {
-        deviceForGL->glGenFramebuffers(1, &handle);
-    });
+    auto handle = deviceForGL->allocateObjectName(GLObjectKind::Framebuffer);
 
 	auto result = agpu::makeObject<GLFramebuffer> ();
 	auto framebuffer = result.as<GLFramebuffer> ();
@@ -0,0 +1,76 @@
+#include "glsl_translation_cache.hpp"
+
+namespace AgpuGL
+{
+
+GLSLTranslationCache::GLSLTranslationCache()
+    : enabled(false)
+{
+}
+
+GLSLTranslationCache::~GLSLTranslationCache()
+{
+}
+
+void GLSLTranslationCache::initialize(bool newEnabled, const std::string &newDirectory)
+{
+    std::unique_lock<std::mutex> l(mutex);
+    enabled = newEnabled;
+    directory = newDirectory;
+    entries.clear();
+
+    if(enabled && !directory.empty())
+        AgpuCommon::createCacheDirectory(directory);
+}
+
+std::string GLSLTranslationCache::pathFor(const char *kind, const std::string &key) const
+{
+    return directory + "/" + key + "." + kind;
+}
+
+bool GLSLTranslationCache::find(const char *kind, const std::string &key, std::string &result)
+{
+    if(!enabled)
+        return false;
+
+    auto entryKey = key + "." + kind;
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        auto it = entries.find(entryKey);
+        if(it != entries.end())
+        {
+            result = it->second;
+            return true;
+        }
+    }
+
+    if(directory.empty())
+        return false;
+
+    // Read the entry outside of the lock.
+    std::vector<uint8_t> content;
+    if(!AgpuCommon::readCacheFile(pathFor(kind, key), content))
+        return false;
+
+    result.assign(content.begin(), content.end());
+
+    std::unique_lock<std::mutex> l(mutex);
+    entries[entryKey] = result;
+    return true;
+}
+
+void GLSLTranslationCache::store(const char *kind, const std::string &key, const std::string &value)
+{
+    if(!enabled)
+        return;
+
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        entries[key + "." + kind] = value;
+    }
+
+    if(!directory.empty())
+        AgpuCommon::writeCacheFile(pathFor(kind, key), value.data(), value.size());
+}
+
+} // End of namespace AgpuGL
@@ -0,0 +1,49 @@
+#ifndef AGPU_GL_GLSL_TRANSLATION_CACHE_HPP
+#define AGPU_GL_GLSL_TRANSLATION_CACHE_HPP
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include "../Common/disk_cache.hpp"
+
+namespace AgpuGL
+{
+
+/**
+ * Device wide cache of the results of translating Spir-V modules into GLSL
+ * with spirv-cross. The entries are addressed by the hash of everything that
+ * is used by the translation, so that identical modules that are instanced
+ * with identical shader signatures are only translated once. The entries are
+ * optionally persisted into a directory. This cache can be used from any
+ * thread.
+ */
+class GLSLTranslationCache
+{
+public:
+    GLSLTranslationCache();
+    ~GLSLTranslationCache();
+
+    void initialize(bool enabled, const std::string &directory);
+
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    // The kind of the entry is used for separating the different uses of the cache.
+    bool find(const char *kind, const std::string &key, std::string &result);
+    void store(const char *kind, const std::string &key, const std::string &value);
+
+private:
+    std::string pathFor(const char *kind, const std::string &key) const;
+
+    bool enabled;
+    std::string directory;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::string> entries;
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_GLSL_TRANSLATION_CACHE_HPP
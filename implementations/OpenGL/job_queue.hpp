@@ -1,143 +1,471 @@
 #ifndef AGPU_THREADED_QUEUE_HPP
 #define AGPU_THREADED_QUEUE_HPP
 
-#include <functional>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <deque>
 #include <thread>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <cstddef>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
 
 namespace AgpuGL
 {
 
-typedef std::function<void ()> JobCommand;
+/**
+ * Sleeps until the value of a 32 bits word changes, in the style of a futex.
+ */
+class JobQueueWaitWord
+{
+public:
+    static void wait(std::atomic<uint32_t> &word, uint32_t expectedValue)
+    {
+#if defined(_WIN32)
+        WaitOnAddress(&word, &expectedValue, sizeof(expectedValue), INFINITE);
+#elif defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAIT_PRIVATE, expectedValue, nullptr, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> l(fallbackMutex());
+        while(word.load() == expectedValue)
+            fallbackCondition().wait(l);
+#endif
+    }
+
+    static void wakeAll(std::atomic<uint32_t> &word)
+    {
+#if defined(_WIN32)
+        WakeByAddressAll(&word);
+#elif defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> l(fallbackMutex());
+        fallbackCondition().notify_all();
+#endif
+    }
+
+private:
+#if !defined(_WIN32) && !defined(__linux__)
+    static std::mutex &fallbackMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::condition_variable &fallbackCondition()
+    {
+        static std::condition_variable condition;
+        return condition;
+    }
+#endif
+};
 
 /**
- * An asynhronous job that is executed in a separate thread.
+ * Completion flag of a job whose submitter waits for it. It lives in the
+ * stack of the waiting thread, and the kernel is only entered when the
+ * waiting thread actually has to sleep.
  */
-class AsyncJob
+class JobCompletion
 {
 public:
-    AsyncJob(const JobCommand &command, bool autoreleased = false)
-        : nextJob(nullptr), finished(false), autoreleased(autoreleased), command(command) {}
-    ~AsyncJob() { }
+    JobCompletion()
+        : state(Pending) {}
 
-    void execute()
+    void signal()
     {
-        command();
-        if(!autoreleased)
-        {
-            std::unique_lock<std::mutex> l(mutex);
-            finished = true;
-            finishedCondition.notify_all();
-        }
-        else
-        {
-            delete this;
-        }
+        if(state.exchange(Finished) == PendingWithSleeper)
+            JobQueueWaitWord::wakeAll(state);
     }
 
     void wait()
     {
-        std::unique_lock<std::mutex> l(mutex);
-        while(!finished)
-            finishedCondition.wait(l);
-    }
+        // Most of the jobs are short, so spin for a while before sleeping.
+        for(int i = 0; i < SpinCount; ++i)
+        {
+            if(state.load(std::memory_order_acquire) == Finished)
+                return;
+        }
 
-	AsyncJob *nextJob;
+        uint32_t expected = Pending;
+        state.compare_exchange_strong(expected, PendingWithSleeper);
+        while(state.load(std::memory_order_acquire) != Finished)
+            JobQueueWaitWord::wait(state, PendingWithSleeper);
+    }
 
 private:
-    bool finished;
-    bool autoreleased;
-    std::mutex mutex;
-    std::condition_variable finishedCondition;
-    JobCommand command;
+    static constexpr int SpinCount = 1024;
+    static constexpr uint32_t Pending = 0;
+    static constexpr uint32_t PendingWithSleeper = 1;
+    static constexpr uint32_t Finished = 2;
+
+    std::atomic<uint32_t> state;
 };
 
 /**
- * A thread that processes jobs from a queue.
+ * A thread that processes jobs from a bounded multiple producer single
+ * consumer ring. The jobs are constructed in place inside of the ring slots,
+ * so that submitting a small job does not allocate memory. The worker thread
+ * drains every ready job before looking at the wakeup state, and the
+ * producers only enter the kernel when the worker or another producer is
+ * actually sleeping.
+ *
+ * The worker thread cannot wait for space in the ring, so the jobs that it
+ * submits while the ring is full go into an overflow list. They are executed
+ * after the jobs that were already in the ring, in submission order.
  */
 class JobQueue
 {
 public:
+    static constexpr size_t Capacity = 1024;
+    static constexpr size_t InlineJobSize = 48;
+    static constexpr size_t CacheLineSize = 64;
+
     JobQueue()
-        : isRunning_(false), isShuttingDown_(false), firstPendingJob(nullptr), lastPendingJob(nullptr) {}
+        : isRunning_(false), isShuttingDown_(false),
+          enqueuePosition(0), dequeuePosition(0),
+          isWorkerSleeping(false), workerWakeupCount(0),
+          waitingProducerCount(0), freeSlotCount(0)
+    {
+        // operator new does not honor extended alignments in C++11, so the
+        // ring is aligned by hand to keep each slot in its own cache line.
+        slotStorage = new char[Capacity*sizeof(Slot) + CacheLineSize];
+        slots = reinterpret_cast<Slot*> ((uintptr_t(slotStorage) + CacheLineSize - 1) & ~uintptr_t(CacheLineSize - 1));
+        for(size_t i = 0; i < Capacity; ++i)
+        {
+            new (&slots[i]) Slot();
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
 
     ~JobQueue()
     {
         if(isRunning_)
             shutdown();
+
+        for(size_t i = 0; i < Capacity; ++i)
+            slots[i].~Slot();
+        delete [] slotStorage;
     }
 
     void start()
     {
         assert(!isRunning_);
-        isShuttingDown_ = false;
+        isShuttingDown_.store(false);
         isRunning_ = true;
         std::thread t([this] {
             jobThreadEntry();
         });
 
+        workerThreadId = t.get_id();
         jobThread.swap(t);
     }
 
+    // The pending jobs are executed before the worker thread finishes.
     void shutdown()
     {
         assert(isRunning_);
+        isShuttingDown_.store(true);
+        wakeUpWorker();
+        jobThread.join();
+        isRunning_ = false;
+    }
+
+    bool isWorkerThread() const
+    {
+        return std::this_thread::get_id() == workerThreadId;
+    }
+
+    template<typename FT>
+    void addJob(FT &&job)
+    {
+        typedef typename std::decay<FT>::type JobType;
 
+        // The jobs of the worker thread are not placed in the ring while
+        // there are older ones in the overflow list.
+        if(isWorkerThread() && !overflowJobs.empty())
         {
-            std::unique_lock<std::mutex> l(mutex);
-            isShuttingDown_ = true;
-            moreWorkCondition.notify_all();
+            addOverflowJob<JobType> (std::forward<FT> (job));
+            return;
         }
-        jobThread.join();
-        isRunning_ = false;
+
+        Slot *slot = acquireSlot();
+        if(!slot)
+        {
+            // The worker thread filled the queue by itself, so it cannot wait for space.
+            addOverflowJob<JobType> (std::forward<FT> (job));
+            return;
+        }
+
+        constructJob<JobType> (slot, std::forward<FT> (job), std::integral_constant<bool, fitsInSlot<JobType>()> ());
+        publishSlot(slot);
     }
 
-    void addJob(AsyncJob* job)
+    // Executes a job in the worker thread, and waits for its completion.
+    template<typename FT>
+    void runBlocking(const FT &job)
     {
-        std::unique_lock<std::mutex> l(mutex);
-		if (lastPendingJob)
-			lastPendingJob->nextJob = job;
-		else
-			firstPendingJob = job;
-		job->nextJob = nullptr;
-		lastPendingJob = job;
-        moreWorkCondition.notify_all();
+        // Nested blocking jobs would wait forever for themselves.
+        if(isWorkerThread())
+        {
+            job();
+            return;
+        }
+
+        JobCompletion completion;
+        const FT *jobPointer = &job;
+        JobCompletion *completionPointer = &completion;
+        addJob([jobPointer, completionPointer] {
+            (*jobPointer)();
+            completionPointer->signal();
+        });
+        completion.wait();
     }
 
 private:
+    typedef void (*JobRunFunction)(void *storage);
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        JobRunFunction run;
+        typename std::aligned_storage<InlineJobSize, alignof(std::max_align_t)>::type storage;
+    };
+    static_assert(sizeof(Slot) == CacheLineSize, "A job queue slot must fill exactly one cache line.");
+
+    // A job of the worker thread that runs once the ring reaches its position.
+    struct OverflowJob
+    {
+        size_t position;
+        JobRunFunction run;
+        void *job;
+    };
+
+    template<typename JobType>
+    static constexpr bool fitsInSlot()
+    {
+        return sizeof(JobType) <= InlineJobSize && alignof(JobType) <= alignof(std::max_align_t);
+    }
+
+    // The job is executed exactly once, so running it also destroys it.
+    template<typename JobType>
+    static void runInlineJob(void *storage)
+    {
+        auto job = reinterpret_cast<JobType*> (storage);
+        (*job)();
+        job->~JobType();
+    }
+
+    template<typename JobType>
+    static void runHeapJob(void *storage)
+    {
+        auto job = *reinterpret_cast<JobType**> (storage);
+        (*job)();
+        delete job;
+    }
+
+    template<typename JobType, typename FT>
+    static void constructJob(Slot *slot, FT &&job, std::true_type)
+    {
+        new (&slot->storage) JobType(std::forward<FT> (job));
+        slot->run = &runInlineJob<JobType>;
+    }
+
+    template<typename JobType, typename FT>
+    static void constructJob(Slot *slot, FT &&job, std::false_type)
+    {
+        *reinterpret_cast<JobType**> (&slot->storage) = new JobType(std::forward<FT> (job));
+        slot->run = &runHeapJob<JobType>;
+    }
+
+    template<typename JobType, typename FT>
+    void addOverflowJob(FT &&job)
+    {
+        OverflowJob overflowJob;
+        overflowJob.position = enqueuePosition.load(std::memory_order_relaxed);
+        overflowJob.run = &runHeapJob<JobType>;
+        overflowJob.job = new JobType(std::forward<FT> (job));
+        overflowJobs.push_back(overflowJob);
+    }
+
+    bool hasReadyOverflowJob() const
+    {
+        return !overflowJobs.empty() && overflowJobs.front().position <= dequeuePosition;
+    }
+
+    // The job may submit more jobs, so it is removed from the list before running.
+    void runOverflowJob()
+    {
+        auto overflowJob = overflowJobs.front();
+        overflowJobs.pop_front();
+        overflowJob.run(&overflowJob.job);
+    }
+
+    Slot *acquireSlot()
+    {
+        auto position = enqueuePosition.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            auto slot = &slots[position % Capacity];
+            auto sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = intptr_t(sequence) - intptr_t(position);
+            if(difference == 0)
+            {
+                if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    return slot;
+            }
+            else if(difference < 0)
+            {
+                // The queue is full.
+                if(isWorkerThread())
+                    return nullptr;
+                waitForFreeSlot(slot, position);
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publishSlot(Slot *slot)
+    {
+        auto position = slot->sequence.load(std::memory_order_relaxed);
+        slot->sequence.store(position + 1, std::memory_order_seq_cst);
+        if(isWorkerSleeping.load(std::memory_order_seq_cst))
+            wakeUpWorker();
+    }
+
+    void wakeUpWorker()
+    {
+        workerWakeupCount.fetch_add(1, std::memory_order_seq_cst);
+        JobQueueWaitWord::wakeAll(workerWakeupCount);
+    }
+
+    void waitForFreeSlot(Slot *slot, size_t position)
+    {
+        auto ticket = freeSlotCount.load(std::memory_order_seq_cst);
+        waitingProducerCount.fetch_add(1, std::memory_order_seq_cst);
+        if(intptr_t(slot->sequence.load(std::memory_order_seq_cst)) - intptr_t(position) < 0)
+            JobQueueWaitWord::wait(freeSlotCount, ticket);
+        waitingProducerCount.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    bool hasReadyJob()
+    {
+        if(hasReadyOverflowJob())
+            return true;
+
+        auto &slot = slots[dequeuePosition % Capacity];
+        return slot.sequence.load(std::memory_order_seq_cst) == dequeuePosition + 1;
+    }
+
+    size_t drainReadyJobs()
+    {
+        size_t executedJobCount = 0;
+        for(;;)
+        {
+            if(hasReadyOverflowJob())
+            {
+                runOverflowJob();
+                ++executedJobCount;
+                continue;
+            }
+
+            auto position = dequeuePosition;
+            auto &slot = slots[position % Capacity];
+            if(slot.sequence.load(std::memory_order_acquire) != position + 1)
+                break;
+
+            // Advance before running, in case that the job submits more jobs.
+            dequeuePosition = position + 1;
+            slot.run(&slot.storage);
+            slot.sequence.store(position + Capacity, std::memory_order_seq_cst);
+            ++executedJobCount;
+
+            if(waitingProducerCount.load(std::memory_order_seq_cst))
+            {
+                freeSlotCount.fetch_add(1, std::memory_order_seq_cst);
+                JobQueueWaitWord::wakeAll(freeSlotCount);
+            }
+        }
+
+        return executedJobCount;
+    }
+
     void jobThreadEntry()
     {
         for(;;)
         {
-            AsyncJob *nextJob = nullptr;
+            if(drainReadyJobs() > 0)
+                continue;
+
+            // Spin for a while, in case that another job is coming.
+            bool hasMoreWork = false;
+            for(int i = 0; i < WorkerSpinCount && !hasMoreWork; ++i)
+                hasMoreWork = hasReadyJob();
+            if(hasMoreWork)
+                continue;
+
+            auto ticket = workerWakeupCount.load(std::memory_order_seq_cst);
+            isWorkerSleeping.store(true, std::memory_order_seq_cst);
+            if(hasReadyJob())
             {
-                std::unique_lock<std::mutex> l(mutex);
-                while(!isShuttingDown_ && !firstPendingJob)
-                    moreWorkCondition.wait(l);
-                if(isShuttingDown_)
-                    return;
-
-                nextJob = firstPendingJob;
-				firstPendingJob = firstPendingJob->nextJob;
-				if (!firstPendingJob)
-					lastPendingJob = nullptr;
+                isWorkerSleeping.store(false, std::memory_order_relaxed);
+                continue;
             }
 
-            if(nextJob)
-                nextJob->execute();
+            if(isShuttingDown_.load(std::memory_order_seq_cst))
+                return;
+
+            JobQueueWaitWord::wait(workerWakeupCount, ticket);
+            isWorkerSleeping.store(false, std::memory_order_relaxed);
         }
     }
 
+    static constexpr int WorkerSpinCount = 256;
+
     std::thread jobThread;
-    std::mutex mutex;
-    std::condition_variable moreWorkCondition;
+    std::thread::id workerThreadId;
 
     bool isRunning_;
-    bool isShuttingDown_;
-	AsyncJob *firstPendingJob;
-	AsyncJob *lastPendingJob;
+    std::atomic_bool isShuttingDown_;
+
+    char *slotStorage;
+    Slot *slots;
+
+    // The padding keeps the producer and the worker counters in different cache lines.
+    char enqueuePadding[CacheLineSize];
+    std::atomic<size_t> enqueuePosition;
+    char dequeuePadding[CacheLineSize];
+    size_t dequeuePosition;
+    std::deque<OverflowJob> overflowJobs;
+
+    char wakeupPadding[CacheLineSize];
+    std::atomic_bool isWorkerSleeping;
+    std::atomic<uint32_t> workerWakeupCount;
+    std::atomic<uint32_t> waitingProducerCount;
+    std::atomic<uint32_t> freeSlotCount;
+    char tailPadding[CacheLineSize];
 };
 
 } // End of namespace AgpuGL
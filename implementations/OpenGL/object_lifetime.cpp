@@ -0,0 +1,179 @@
+#include "device.hpp"
+
+namespace AgpuGL
+{
+
+GLNamePool::GLNamePool()
+    : device(nullptr), kind(GLObjectKind::Buffer), isRefillPending(false)
+{
+}
+
+GLNamePool::~GLNamePool()
+{
+}
+
+void GLNamePool::initialize(GLDevice *newDevice, GLObjectKind newKind)
+{
+    device = newDevice;
+    kind = newKind;
+}
+
+GLuint GLNamePool::allocate()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    while(freeNames.empty())
+    {
+        // The pool is exhausted, so we have to wait for new names.
+        l.unlock();
+        device->onMainContextBlocking([&] {
+            refill();
+        });
+        l.lock();
+    }
+
+    auto name = freeNames.back();
+    freeNames.pop_back();
+
+    if(freeNames.size() < LowWatermark && !isRefillPending)
+    {
+        isRefillPending = true;
+        device->mainContextJobQueue.addJob([this] {
+            refill();
+            std::unique_lock<std::mutex> l(mutex);
+            isRefillPending = false;
+        });
+    }
+
+    return name;
+}
+
+void GLNamePool::refill()
+{
+    GLuint names[RefillBatchSize];
+    auto count = GLsizei(RefillBatchSize);
+    switch(kind)
+    {
+    case GLObjectKind::Buffer:
+        device->glGenBuffers(count, names);
+        break;
+    case GLObjectKind::Texture:
+        glGenTextures(count, names);
+        break;
+    case GLObjectKind::Sampler:
+        device->glGenSamplers(count, names);
+        break;
+    case GLObjectKind::Framebuffer:
+        device->glGenFramebuffers(count, names);
+        break;
+    case GLObjectKind::VertexArray:
+        device->glGenVertexArrays(count, names);
+        break;
+    default:
+        // Programs and shaders cannot be created in batches.
+        abort();
+    }
+
+    std::unique_lock<std::mutex> l(mutex);
+    freeNames.insert(freeNames.end(), names, names + RefillBatchSize);
+}
+
+GLDeletionQueue::GLDeletionQueue()
+    : device(nullptr), nextSequence(0)
+{
+}
+
+GLDeletionQueue::~GLDeletionQueue()
+{
+}
+
+void GLDeletionQueue::initialize(GLDevice *newDevice)
+{
+    device = newDevice;
+}
+
+void GLDeletionQueue::deleteObject(GLObjectKind kind, GLuint name)
+{
+    if(!name)
+        return;
+
+    uint64_t sequence;
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        sequence = nextSequence++;
+        PendingDeletion deletion = {sequence, kind, name};
+        pendingDeletions.push_back(deletion);
+    }
+
+    // The job is submitted without the lock, because it may have to wait for
+    // space in the queue.
+    device->mainContextJobQueue.addJob([this, sequence] {
+        flush(sequence);
+    });
+}
+
+void GLDeletionQueue::flush(uint64_t lastSequence)
+{
+    std::vector<GLuint> names[size_t(GLObjectKind::Count)];
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        size_t deletionCount = 0;
+        while(deletionCount < pendingDeletions.size() && pendingDeletions[deletionCount].sequence <= lastSequence)
+        {
+            auto &deletion = pendingDeletions[deletionCount++];
+            names[size_t(deletion.kind)].push_back(deletion.name);
+        }
+
+        pendingDeletions.erase(pendingDeletions.begin(), pendingDeletions.begin() + deletionCount);
+    }
+
+    for(size_t i = 0; i < size_t(GLObjectKind::Count); ++i)
+    {
+        if(!names[i].empty())
+            deleteNames(GLObjectKind(i), names[i]);
+    }
+}
+
+void GLDeletionQueue::deleteNames(GLObjectKind kind, const std::vector<GLuint> &names)
+{
+    auto count = GLsizei(names.size());
+    auto &stateCache = device->getStateCache();
+    switch(kind)
+    {
+    case GLObjectKind::Buffer:
+        device->glDeleteBuffers(count, names.data());
+        for(auto name : names)
+            stateCache.bufferDeleted(name);
+        break;
+    case GLObjectKind::Texture:
+        glDeleteTextures(count, names.data());
+        for(auto name : names)
+            stateCache.textureDeleted(name);
+        break;
+    case GLObjectKind::Sampler:
+        device->glDeleteSamplers(count, names.data());
+        for(auto name : names)
+            stateCache.samplerDeleted(name);
+        break;
+    case GLObjectKind::Program:
+        for(auto name : names)
+        {
+            device->glDeleteProgram(name);
+            stateCache.programDeleted(name);
+        }
+        break;
+    case GLObjectKind::Shader:
+        for(auto name : names)
+            device->glDeleteShader(name);
+        break;
+    case GLObjectKind::Framebuffer:
+        device->glDeleteFramebuffers(count, names.data());
+        break;
+    case GLObjectKind::VertexArray:
+        device->glDeleteVertexArrays(count, names.data());
+        break;
+    default:
+        abort();
+    }
+}
+
+} // End of namespace AgpuGL
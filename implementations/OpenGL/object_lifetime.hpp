@@ -0,0 +1,103 @@
+#ifndef AGPU_GL_OBJECT_LIFETIME_HPP
+#define AGPU_GL_OBJECT_LIFETIME_HPP
+
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+
+namespace AgpuGL
+{
+
+struct GLDevice;
+
+/**
+ * The kinds of OpenGL objects whose names are managed outside of the main
+ * context thread.
+ */
+enum class GLObjectKind
+{
+    Buffer = 0,
+    Texture,
+    Sampler,
+    Program,
+    Shader,
+    Framebuffer,
+    VertexArray,
+
+    Count
+};
+
+/**
+ * Pool of names that are generated in advance in the main context thread.
+ * Taking a name from the pool does not wait for the main context, so the
+ * handle of a new object is known immediately, and its storage is allocated
+ * later by an asynchronous job. The pool is refilled asynchronously when it
+ * is running low, so that it only has to block when it is exhausted. This
+ * pool can be used from any thread.
+ */
+class GLNamePool
+{
+public:
+    GLNamePool();
+    ~GLNamePool();
+
+    void initialize(GLDevice *device, GLObjectKind kind);
+
+    GLuint allocate();
+
+private:
+    static constexpr size_t RefillBatchSize = 256;
+    static constexpr size_t LowWatermark = 64;
+
+    // Must be called in the main context thread.
+    void refill();
+
+    GLDevice *device;
+    GLObjectKind kind;
+
+    std::mutex mutex;
+    std::vector<GLuint> freeNames;
+    bool isRefillPending;
+};
+
+/**
+ * Queue of object names whose deletion is deferred into the main context
+ * thread. Each destructor appends its name into this queue, and submits a
+ * small job that deletes in one batch every name that was appended up to its
+ * own. Since the jobs are executed in order, a name is never deleted before
+ * the jobs that were submitted before its deletion, and the jobs of the names
+ * that were already deleted by an earlier batch do nothing. This queue can be
+ * used from any thread.
+ */
+class GLDeletionQueue
+{
+public:
+    GLDeletionQueue();
+    ~GLDeletionQueue();
+
+    void initialize(GLDevice *device);
+
+    void deleteObject(GLObjectKind kind, GLuint name);
+
+private:
+    struct PendingDeletion
+    {
+        uint64_t sequence;
+        GLObjectKind kind;
+        GLuint name;
+    };
+
+    // Must be called in the main context thread.
+    void flush(uint64_t lastSequence);
+    void deleteNames(GLObjectKind kind, const std::vector<GLuint> &names);
+
+    GLDevice *device;
+
+    std::mutex mutex;
+    std::vector<PendingDeletion> pendingDeletions;
+    uint64_t nextSequence;
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_OBJECT_LIFETIME_HPP
@@ -198,38 +198,65 @@ agpu::pipeline_state_ptr GLGraphicsPipelineBuilder::build ()
         if(!succeded)
             return nullptr;
 
+        // Compute the key of the linked program.
+        auto &programBinaryCache = deviceForGL->programBinaryCache;
+        std::string programKey;
+        if(programBinaryCache.isEnabled())
+        {
+            auto keyHasher = programBinaryCache.makeKeyHasher();
+            for(auto shaderInstance : shaderInstances)
+                shaderInstance->addToProgramKey(keyHasher);
+            programKey = keyHasher.finish();
+        }
+
+        // The program is linked in a context that shares it with the main context.
         succeded = false;
-        deviceForGL->onMainContextBlocking([&]{
+        deviceForGL->workerContextPool.runBlocking([&]{
             // Create the progrma
             program = deviceForGL->glCreateProgram();
 
-            // Attach the shaders.
-            for(auto shaderInstance : shaderInstances)
+            if(programKey.empty() || !programBinaryCache.loadProgram(program, programKey))
             {
-                // Attach the shader instance to the program.
-                std::string errorMessage;
-                auto error = shaderInstance->attachToProgram(program, &errorMessage);
-
-                errorMessages += errorMessage;
-                if(error != AGPU_OK)
+                // Attach the shaders.
+                for(auto shaderInstance : shaderInstances)
+                {
+                    // Attach the shader instance to the program.
+                    std::string errorMessage;
+                    auto error = shaderInstance->attachToProgram(program, &errorMessage);
+
+                    errorMessages += errorMessage;
+                    if(error != AGPU_OK)
+                        return;
+                }
+
+                // Link the program.
+                programBinaryCache.prepareForLinking(program);
+                deviceForGL->glLinkProgram(program);
+
+                // Check the link status
+                GLint status;
+                deviceForGL->glGetProgramiv(program, GL_LINK_STATUS, &status);
+                if(status != GL_TRUE)
+                {
+                    // The compilation errors are only retrieved when the link fails.
+                    for(auto shaderInstance : shaderInstances)
+                    {
+                        std::string errorMessage;
+                        shaderInstance->checkCompilation(&errorMessage);
+                        errorMessages += errorMessage;
+                    }
                     return;
-            }
+                }
 
-        	// Link the program.
-        	deviceForGL->glLinkProgram(program);
-
-        	// Check the link status
-        	GLint status;
-        	deviceForGL->glGetProgramiv(program, GL_LINK_STATUS, &status);
-            if(status != GL_TRUE)
-            {
-				// TODO: Get the info log
-                return;
+                if(!programKey.empty())
+                    programBinaryCache.storeProgram(program, programKey);
             }
 
 			// Get some special uniforms
 			baseInstanceUniformIndex = deviceForGL->glGetUniformLocation(program, "SPIRV_Cross_BaseInstance");
 
+            // Make the program complete before it is used by the main context.
+            glFinish();
             succeded = true;
         });
     }
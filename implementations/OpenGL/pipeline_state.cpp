@@ -12,59 +12,57 @@ namespace AgpuGL
 
 void AgpuGraphicsPipelineStateData::activate()
 {
+	// Only the differences with the state of the context reach the driver.
+	auto &stateCache = deviceForGL->getStateCache();
+
 	// Activate the srgb framebuffer if we have a srgb render target attached.
-	enableState(hasSRGBTarget, GL_FRAMEBUFFER_SRGB);
+	enableState(hasSRGBTarget, GLCachedCapability::FramebufferSRGB);
 
 	// The scissor test is always enabled.
-	glEnable(GL_SCISSOR_TEST);
+	enableState(true, GLCachedCapability::ScissorTest);
 
 	// Face culling
-	glFrontFace(frontFaceWinding);
+	stateCache.setFrontFace(frontFaceWinding);
 	if (cullingMode == GL_NONE)
 	{
-		glDisable(GL_CULL_FACE);
+		enableState(false, GLCachedCapability::CullFace);
 	}
 	else
 	{
-		glEnable(GL_CULL_FACE);
-		glCullFace(cullingMode);
+		enableState(true, GLCachedCapability::CullFace);
+		stateCache.setCullFace(cullingMode);
 	}
 
 	// Depth
-	enableState(depthEnabled, GL_DEPTH_TEST);
-	glDepthMask(depthWriteMask);
-	glDepthFunc(depthFunction);
+	enableState(depthEnabled, GLCachedCapability::DepthTest);
+	stateCache.setDepthMask(depthWriteMask);
+	stateCache.setDepthFunc(depthFunction);
 
 	// Set the depth range mapping to [0.0, 1.0]. This is the same depth range used by Direct3D.
-	if (deviceForGL->hasExtension_GL_ARB_clip_control)
-		deviceForGL->glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
-	else if (deviceForGL->hasExtension_GL_NV_depth_buffer_float)
-		deviceForGL->glDepthRangedNV(-1, 1);
-	else
-		glDepthRange(-1, 1);
+	stateCache.setZeroToOneDepthRange();
 
 	// Color buffer
-	glColorMask(redMask, greenMask, blueMask, alphaMask);
-	enableState(blendingEnabled, GL_BLEND);
+	stateCache.setColorMask(redMask, greenMask, blueMask, alphaMask);
+	enableState(blendingEnabled, GLCachedCapability::Blend);
 	if (blendingEnabled)
 	{
-		deviceForGL->glBlendEquationSeparate(blendOperation, blendOperationAlpha);
-		deviceForGL->glBlendFuncSeparate(sourceBlendFactor, destBlendFactor, sourceBlendFactorAlpha, destBlendFactorAlpha);
+		stateCache.setBlendEquation(blendOperation, blendOperationAlpha);
+		stateCache.setBlendFunc(sourceBlendFactor, destBlendFactor, sourceBlendFactorAlpha, destBlendFactorAlpha);
 	}
 
 	// Stencil
-	enableState(stencilEnabled, GL_STENCIL_TEST);
+	enableState(stencilEnabled, GLCachedCapability::StencilTest);
 
 	if (stencilEnabled)
 	{
-		glStencilMask(stencilWriteMask);
+		stateCache.setStencilMask(stencilWriteMask);
 		updateStencilReference(0);
-		deviceForGL->glStencilOpSeparate(GL_FRONT, stencilFrontFailOp, stencilFrontDepthFailOp, stencilFrontDepthPassOp);
-		deviceForGL->glStencilOpSeparate(GL_BACK, stencilBackFailOp, stencilBackDepthFailOp, stencilBackDepthPassOp);
+		stateCache.setStencilOp(GL_FRONT, stencilFrontFailOp, stencilFrontDepthFailOp, stencilFrontDepthPassOp);
+		stateCache.setStencilOp(GL_BACK, stencilBackFailOp, stencilBackDepthFailOp, stencilBackDepthPassOp);
 	}
 
 	// Multisampling
-	enableState(sampleCount > 1, GL_MULTISAMPLE);
+	enableState(sampleCount > 1, GLCachedCapability::Multisample);
 }
 
 void AgpuGraphicsPipelineStateData::updateStencilReference(int reference)
@@ -72,8 +70,9 @@ void AgpuGraphicsPipelineStateData::updateStencilReference(int reference)
 	if (!stencilEnabled)
 		return;
 
-	deviceForGL->glStencilFuncSeparate(GL_FRONT, stencilFrontFunc, reference, stencilReadMask);
-	deviceForGL->glStencilFuncSeparate(GL_BACK, stencilBackFunc, reference, stencilReadMask);
+	auto &stateCache = deviceForGL->getStateCache();
+	stateCache.setStencilFunc(GL_FRONT, stencilFrontFunc, reference, stencilReadMask);
+	stateCache.setStencilFunc(GL_BACK, stencilBackFunc, reference, stencilReadMask);
 }
 
 void AgpuGraphicsPipelineStateData::setBaseInstance(agpu_uint base_instance)
@@ -81,12 +80,9 @@ void AgpuGraphicsPipelineStateData::setBaseInstance(agpu_uint base_instance)
 	deviceForGL->glUniform1i(baseInstanceUniformIndex, base_instance);
 }
 
-void AgpuGraphicsPipelineStateData::enableState(bool enabled, GLenum state)
+void AgpuGraphicsPipelineStateData::enableState(bool enabled, GLCachedCapability capability)
 {
-	if (enabled)
-		glEnable(state);
-	else
-		glDisable(state);
+	deviceForGL->getStateCache().setCapability(capability, enabled);
 }
 
 GLPipelineState::GLPipelineState()
@@ -96,9 +92,7 @@ GLPipelineState::GLPipelineState()
 
 GLPipelineState::~GLPipelineState()
 {
-    deviceForGL->onMainContextBlocking([&] {
-        deviceForGL->glDeleteProgram(programHandle);
-    });
+    deviceForGL->deleteObjectLater(GLObjectKind::Program, programHandle);
 
 	delete extraStateData;
 }
@@ -111,7 +105,7 @@ agpu_int GLPipelineState::getUniformLocation ( agpu_cstring name )
 void GLPipelineState::activate()
 {
 	// Use the program.
-	deviceForGL->glUseProgram(programHandle);
+	deviceForGL->getStateCache().useProgram(programHandle);
 	if (extraStateData)
 		extraStateData->activate();
 }
@@ -154,7 +148,7 @@ void GLPipelineState::activateShaderResourcesOn(CommandListExecutionContext *con
 		textureBinding->activateInSampledSlot(combination.mappedTextureUnit);
 
         // Activate the sampler.
-        deviceForGL->glBindSampler(combination.mappedTextureUnit, samplerBinding);
+        deviceForGL->getStateCache().bindSampler(combination.mappedTextureUnit, samplerBinding);
     }
 }
 
@@ -38,7 +38,7 @@ public:
 	virtual void activate() override;
 	virtual void updateStencilReference(int reference) override;
 	virtual void setBaseInstance(agpu_uint base_instance) override;
-	void enableState(bool enabled, GLenum state);
+	void enableState(bool enabled, GLCachedCapability capability);
 
 	virtual agpu_primitive_topology getPrimitiveTopology() override
 	{
@@ -0,0 +1,164 @@
+#include "device.hpp"
+
+namespace AgpuGL
+{
+
+GLPixelTransferRing::GLPixelTransferRing()
+    : device(nullptr), nextSlot(0)
+{
+}
+
+GLPixelTransferRing::~GLPixelTransferRing()
+{
+}
+
+void GLPixelTransferRing::initialize(GLDevice *newDevice)
+{
+    device = newDevice;
+}
+
+void GLPixelTransferRing::destroy()
+{
+    for(auto &slot : slots)
+    {
+        if(slot.fence)
+        {
+            device->glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+
+        if(slot.buffer)
+        {
+            device->glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+            device->glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            device->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            device->glDeleteBuffers(1, &slot.buffer);
+            device->getStateCache().bufferDeleted(slot.buffer);
+            slot.buffer = 0;
+        }
+
+        slot.capacity = 0;
+        slot.mappedPointer = nullptr;
+        slot.hasPendingTransfer = false;
+    }
+}
+
+size_t GLPixelTransferRing::acquireSlot(size_t size)
+{
+    size_t slotIndex = 0;
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        for(;;)
+        {
+            bool found = false;
+            for(size_t i = 0; i < SlotCount && !found; ++i)
+            {
+                slotIndex = (nextSlot + i) % SlotCount;
+                found = !slots[slotIndex].isHeld;
+            }
+
+            if(found)
+                break;
+
+            // Every slot is mapped by some texture.
+            slotReleasedCondition.wait(l);
+        }
+
+        slots[slotIndex].isHeld = true;
+        nextSlot = (slotIndex + 1) % SlotCount;
+    }
+
+    auto &slot = slots[slotIndex];
+    if(slot.hasPendingTransfer.load(std::memory_order_acquire) || slot.capacity < size)
+    {
+        device->onMainContextBlocking([&] {
+            waitForSlot(slotIndex);
+            reserveSlotCapacity(slot, size);
+        });
+    }
+
+    return slotIndex;
+}
+
+void GLPixelTransferRing::markSlotWithPendingTransfer(size_t slotIndex)
+{
+    slots[slotIndex].hasPendingTransfer.store(true, std::memory_order_release);
+}
+
+void GLPixelTransferRing::releaseSlot(size_t slotIndex)
+{
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        slots[slotIndex].isHeld = false;
+    }
+    slotReleasedCondition.notify_one();
+}
+
+void GLPixelTransferRing::reserveSlotCapacity(Slot &slot, size_t size)
+{
+    if(slot.capacity >= size)
+        return;
+
+    if(slot.buffer)
+    {
+        device->glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+        device->glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        device->glDeleteBuffers(1, &slot.buffer);
+        device->getStateCache().bufferDeleted(slot.buffer);
+    }
+
+    auto capacity = MinSlotCapacity;
+    while(capacity < size)
+        capacity *= 2;
+
+    // The slots are used in both directions, so they are readable and writable.
+    auto flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    device->glGenBuffers(1, &slot.buffer);
+    device->glBindBuffer(GL_COPY_WRITE_BUFFER, slot.buffer);
+    device->glBufferStorage(GL_COPY_WRITE_BUFFER, capacity, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+    slot.mappedPointer = reinterpret_cast<uint8_t*> (device->glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacity, flags));
+    device->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    slot.capacity = slot.mappedPointer ? capacity : 0;
+}
+
+void GLPixelTransferRing::fenceSlot(size_t slotIndex)
+{
+    auto &slot = slots[slotIndex];
+    if(slot.fence)
+        device->glDeleteSync(slot.fence);
+    slot.fence = device->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void GLPixelTransferRing::waitForSlot(size_t slotIndex)
+{
+    auto &slot = slots[slotIndex];
+    if(slot.fence)
+    {
+        GLenum waitReturn = GL_TIMEOUT_EXPIRED;
+        while(waitReturn == GL_TIMEOUT_EXPIRED)
+            waitReturn = device->glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        device->glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    slot.hasPendingTransfer.store(false, std::memory_order_release);
+}
+
+void GLPixelTransferRing::releaseCompletedSlots()
+{
+    for(auto &slot : slots)
+    {
+        if(!slot.fence)
+            continue;
+
+        auto waitReturn = device->glClientWaitSync(slot.fence, 0, 0);
+        if(waitReturn == GL_ALREADY_SIGNALED || waitReturn == GL_CONDITION_SATISFIED)
+        {
+            device->glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+            slot.hasPendingTransfer.store(false, std::memory_order_release);
+        }
+    }
+}
+
+} // End of namespace AgpuGL
@@ -0,0 +1,97 @@
+#ifndef AGPU_GL_PIXEL_TRANSFER_RING_HPP
+#define AGPU_GL_PIXEL_TRANSFER_RING_HPP
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AgpuGL
+{
+
+struct GLDevice;
+
+/**
+ * Device wide ring of persistently mapped pixel buffers for the texture
+ * transfers. A slot is held by a texture while its data is written or read
+ * through the mapped pointer. When a transfer into a texture is submitted, a
+ * fence is inserted after it, and the slot is only written again when the
+ * fence is signaled. The fences are polled by the main context thread while
+ * it executes the transfers, so acquiring a slot normally does not have to
+ * wait for the main context.
+ */
+class GLPixelTransferRing
+{
+public:
+    static constexpr size_t SlotCount = 8;
+
+    GLPixelTransferRing();
+    ~GLPixelTransferRing();
+
+    void initialize(GLDevice *device);
+
+    // Must be called in the main context thread.
+    void destroy();
+
+    // Returns a slot with at least the requested capacity, whose previous
+    // transfer is finished.
+    size_t acquireSlot(size_t size);
+
+    // A slot with a pending transfer must be marked before submitting the
+    // transfer, and it is released after the submission.
+    void markSlotWithPendingTransfer(size_t slotIndex);
+    void releaseSlot(size_t slotIndex);
+
+    uint8_t *getSlotPointer(size_t slotIndex) const
+    {
+        return slots[slotIndex].mappedPointer;
+    }
+
+    GLuint getSlotBuffer(size_t slotIndex) const
+    {
+        return slots[slotIndex].buffer;
+    }
+
+    // These must be called in the main context thread.
+    void fenceSlot(size_t slotIndex);
+    void waitForSlot(size_t slotIndex);
+    void releaseCompletedSlots();
+
+private:
+    static constexpr size_t MinSlotCapacity = 256*1024;
+
+    struct Slot
+    {
+        Slot()
+            : isHeld(false), hasPendingTransfer(false),
+              buffer(0), capacity(0), mappedPointer(nullptr), fence(nullptr) {}
+
+        // Protected by the mutex.
+        bool isHeld;
+
+        // Set by the application thread, and cleared by the main context
+        // thread when the fence of the transfer is signaled.
+        std::atomic_bool hasPendingTransfer;
+
+        // Only changed in the main context thread, while the slot is held.
+        GLuint buffer;
+        size_t capacity;
+        uint8_t *mappedPointer;
+        GLsync fence;
+    };
+
+    // Must be called in the main context thread.
+    void reserveSlotCapacity(Slot &slot, size_t size);
+
+    GLDevice *device;
+
+    std::mutex mutex;
+    std::condition_variable slotReleasedCondition;
+    size_t nextSlot;
+    Slot slots[SlotCount];
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_PIXEL_TRANSFER_RING_HPP
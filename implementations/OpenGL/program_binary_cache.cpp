@@ -0,0 +1,187 @@
+#include "device.hpp"
+#include <stdio.h>
+#include <string.h>
+
+namespace AgpuGL
+{
+
+// Increment this when the file format or the content of the keys change.
+static constexpr uint32_t ProgramBinaryCacheVersion = 1;
+static constexpr uint32_t ProgramBinaryFileMagic = 0x42504741; // AGPB
+
+struct ProgramBinaryFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t size;
+};
+
+static std::string getGLString(GLenum name)
+{
+    auto value = glGetString(name);
+    return value ? std::string((const char*)value) : std::string();
+}
+
+GLProgramBinaryCache::GLProgramBinaryCache()
+    : device(nullptr), enabled(false)
+{
+}
+
+GLProgramBinaryCache::~GLProgramBinaryCache()
+{
+}
+
+void GLProgramBinaryCache::initialize(GLDevice *newDevice, const std::string &newDirectory)
+{
+    device = newDevice;
+    directory = newDirectory;
+    enabled = false;
+    programBinaries.clear();
+
+    if(directory.empty() || !device->glGetProgramBinary || !device->glProgramBinary || !device->glProgramParameteri)
+        return;
+
+    if(device->versionNumber < OpenGLVersion::Version41 && !device->hasOpenGLExtension("GL_ARB_get_program_binary"))
+        return;
+
+    // Some drivers expose the extension without any binary format.
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if(formatCount <= 0)
+        return;
+
+    driverIdentity = getGLString(GL_VENDOR);
+    driverIdentity += '\n';
+    driverIdentity += getGLString(GL_RENDERER);
+    driverIdentity += '\n';
+    driverIdentity += getGLString(GL_VERSION);
+    driverIdentity += '\n';
+    driverIdentity += getGLString(GL_SHADING_LANGUAGE_VERSION);
+
+    AgpuCommon::createCacheDirectory(directory);
+    enabled = true;
+}
+
+AgpuCommon::ContentHasher GLProgramBinaryCache::makeKeyHasher() const
+{
+    AgpuCommon::ContentHasher hasher;
+    hasher.add(ProgramBinaryCacheVersion);
+    hasher.add(driverIdentity);
+    return hasher;
+}
+
+std::string GLProgramBinaryCache::pathForKey(const std::string &key) const
+{
+    return directory + "/" + key + ".glbin";
+}
+
+bool GLProgramBinaryCache::loadProgram(GLuint &program, const std::string &key)
+{
+    if(!enabled)
+        return false;
+
+    std::shared_ptr<ProgramBinary> binary;
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        auto it = programBinaries.find(key);
+        if(it != programBinaries.end())
+            binary = it->second;
+    }
+
+    if(!binary)
+    {
+        binary = std::make_shared<ProgramBinary> ();
+        if(!readProgramBinary(key, *binary))
+            return false;
+
+        std::unique_lock<std::mutex> l(mutex);
+        programBinaries[key] = binary;
+    }
+
+    device->glProgramBinary(program, binary->format, binary->data.data(), GLsizei(binary->data.size()));
+
+    GLint status = GL_FALSE;
+    device->glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if(status == GL_TRUE)
+        return true;
+
+    // The driver was updated, or the binary is corrupted.
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        programBinaries.erase(key);
+        remove(pathForKey(key).c_str());
+    }
+
+    device->glDeleteProgram(program);
+    device->getStateCache().programDeleted(program);
+    program = device->glCreateProgram();
+    return false;
+}
+
+void GLProgramBinaryCache::prepareForLinking(GLuint program)
+{
+    if(enabled)
+        device->glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void GLProgramBinaryCache::storeProgram(GLuint program, const std::string &key)
+{
+    if(!enabled)
+        return;
+
+    GLint binaryLength = 0;
+    device->glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if(binaryLength <= 0)
+        return;
+
+    auto binary = std::make_shared<ProgramBinary> ();
+    binary->format = 0;
+    binary->data.resize(binaryLength);
+
+    GLsizei writtenLength = 0;
+    device->glGetProgramBinary(program, binaryLength, &writtenLength, &binary->format, binary->data.data());
+    if(writtenLength <= 0)
+        return;
+
+    binary->data.resize(writtenLength);
+
+    std::unique_lock<std::mutex> l(mutex);
+    writeProgramBinary(key, *binary);
+    programBinaries[key] = binary;
+}
+
+bool GLProgramBinaryCache::readProgramBinary(const std::string &key, ProgramBinary &binary)
+{
+    std::vector<uint8_t> content;
+    if(!AgpuCommon::readCacheFile(pathForKey(key), content) || content.size() < sizeof(ProgramBinaryFileHeader))
+        return false;
+
+    ProgramBinaryFileHeader header;
+    memcpy(&header, content.data(), sizeof(header));
+    if(header.magic != ProgramBinaryFileMagic ||
+        header.version != ProgramBinaryCacheVersion ||
+        header.size == 0 ||
+        header.size != content.size() - sizeof(header))
+        return false;
+
+    binary.format = header.format;
+    binary.data.assign(content.begin() + sizeof(header), content.end());
+    return true;
+}
+
+void GLProgramBinaryCache::writeProgramBinary(const std::string &key, const ProgramBinary &binary)
+{
+    ProgramBinaryFileHeader header;
+    header.magic = ProgramBinaryFileMagic;
+    header.version = ProgramBinaryCacheVersion;
+    header.format = binary.format;
+    header.size = uint32_t(binary.data.size());
+
+    std::vector<uint8_t> content(sizeof(header) + binary.data.size());
+    memcpy(content.data(), &header, sizeof(header));
+    memcpy(content.data() + sizeof(header), binary.data.data(), binary.data.size());
+    AgpuCommon::writeCacheFile(pathForKey(key), content.data(), content.size());
+}
+
+} // End of namespace AgpuGL
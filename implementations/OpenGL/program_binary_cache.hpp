@@ -0,0 +1,72 @@
+#ifndef AGPU_GL_PROGRAM_BINARY_CACHE_HPP
+#define AGPU_GL_PROGRAM_BINARY_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include "../Common/disk_cache.hpp"
+
+namespace AgpuGL
+{
+
+struct GLDevice;
+
+/**
+ * Cache of linked program binaries, that are retrieved with glGetProgramBinary
+ * and loaded back with glProgramBinary. The binaries are kept in memory, and
+ * they are also persisted into a directory, so that the shaders do not have to
+ * be compiled and linked again in the next runs. The keys include the identity
+ * of the driver, because a binary is only valid for the driver that produced
+ * it. Binaries that are rejected by the driver are removed from the cache.
+ * The cache can be used from the main context and from the worker contexts,
+ * which share their programs with it.
+ */
+class GLProgramBinaryCache
+{
+public:
+    GLProgramBinaryCache();
+    ~GLProgramBinaryCache();
+
+    void initialize(GLDevice *device, const std::string &directory);
+
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    // Starts the key of a program, with the identity of the driver.
+    AgpuCommon::ContentHasher makeKeyHasher() const;
+
+    // Tries to link the program from a cached binary. When the driver rejects
+    // the binary, the program is replaced by a new one that can be linked.
+    bool loadProgram(GLuint &program, const std::string &key);
+
+    // Must be called before linking a program that is going to be stored.
+    void prepareForLinking(GLuint program);
+    void storeProgram(GLuint program, const std::string &key);
+
+private:
+    struct ProgramBinary
+    {
+        GLenum format;
+        std::vector<uint8_t> data;
+    };
+
+    std::string pathForKey(const std::string &key) const;
+    bool readProgramBinary(const std::string &key, ProgramBinary &binary);
+    void writeProgramBinary(const std::string &key, const ProgramBinary &binary);
+
+    GLDevice *device;
+    bool enabled;
+    std::string directory;
+    std::string driverIdentity;
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<ProgramBinary>> programBinaries;
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_PROGRAM_BINARY_CACHE_HPP
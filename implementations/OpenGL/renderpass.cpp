@@ -52,7 +52,7 @@ void GLRenderPass::started()
         {
             buffers |= GL_COLOR_BUFFER_BIT;
             glClearColor(colorAttachment.clear_value.r, colorAttachment.clear_value.g, colorAttachment.clear_value.b, colorAttachment.clear_value.a);
-            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            deviceForGL->getStateCache().setColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
         }
     }
 
@@ -62,14 +62,14 @@ void GLRenderPass::started()
         {
             buffers |= GL_DEPTH_BUFFER_BIT;
             glClearDepth(depthStencilAttachment.clear_value.depth);
-            glDepthMask(GL_TRUE);
+            deviceForGL->getStateCache().setDepthMask(GL_TRUE);
         }
 
         if (depthStencilAttachment.stencil_begin_action == AGPU_ATTACHMENT_CLEAR)
         {
             buffers |= GL_STENCIL_BUFFER_BIT;
             glClearStencil(depthStencilAttachment.clear_value.stencil);
-            glStencilMask(GL_TRUE);
+            deviceForGL->getStateCache().setStencilMask(GL_TRUE);
         }
     }
 
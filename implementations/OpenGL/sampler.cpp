@@ -63,9 +63,7 @@ GLSampler::GLSampler(const agpu::device_ref &device)
 
 GLSampler::~GLSampler()
 {
-    deviceForGL->onMainContextBlocking([&]() {
-        deviceForGL->glDeleteSamplers(1, &handle);
-    });
+    deviceForGL->deleteObjectLater(GLObjectKind::Sampler, handle);
 }
 
 agpu::sampler_ref GLSampler::create(const agpu::device_ref &device, agpu_sampler_description *description)
@@ -74,17 +72,17 @@ agpu::sampler_ref GLSampler::create(const agpu::device_ref &device, agpu_sampler
         return agpu::sampler_ref();
 
     auto glDevice = device.as<GLDevice> ();
-    GLuint handle;
-    glDevice->onMainContextBlocking([&]{
-        glDevice->glGenSamplers(1, &handle);
-        glDevice->glSamplerParameteri(handle, GL_TEXTURE_MAG_FILTER, mapMagFilter(description->filter));
-        glDevice->glSamplerParameteri(handle, GL_TEXTURE_MIN_FILTER, mapMinFilter(description->filter));
-        glDevice->glSamplerParameteri(handle, GL_TEXTURE_WRAP_S, mapAddressMode(description->address_u));
-        glDevice->glSamplerParameteri(handle, GL_TEXTURE_WRAP_T, mapAddressMode(description->address_v));
-        glDevice->glSamplerParameterf(handle, GL_TEXTURE_MIN_LOD, description->min_lod);
-        glDevice->glSamplerParameterf(handle, GL_TEXTURE_MAX_LOD, description->max_lod);
-        glDevice->glSamplerParameteri(handle, GL_TEXTURE_COMPARE_MODE, description->comparison_enabled ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
-        glDevice->glSamplerParameteri(handle, GL_TEXTURE_COMPARE_FUNC, mapCompareFunction(description->comparison_function));
+    auto handle = glDevice->allocateObjectName(GLObjectKind::Sampler);
+    auto samplerDescription = *description;
+    glDevice->onMainContextAsync([=]{
+        glDevice->glSamplerParameteri(handle, GL_TEXTURE_MAG_FILTER, mapMagFilter(samplerDescription.filter));
+        glDevice->glSamplerParameteri(handle, GL_TEXTURE_MIN_FILTER, mapMinFilter(samplerDescription.filter));
+        glDevice->glSamplerParameteri(handle, GL_TEXTURE_WRAP_S, mapAddressMode(samplerDescription.address_u));
+        glDevice->glSamplerParameteri(handle, GL_TEXTURE_WRAP_T, mapAddressMode(samplerDescription.address_v));
+        glDevice->glSamplerParameterf(handle, GL_TEXTURE_MIN_LOD, samplerDescription.min_lod);
+        glDevice->glSamplerParameterf(handle, GL_TEXTURE_MAX_LOD, samplerDescription.max_lod);
+        glDevice->glSamplerParameteri(handle, GL_TEXTURE_COMPARE_MODE, samplerDescription.comparison_enabled ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
+        glDevice->glSamplerParameteri(handle, GL_TEXTURE_COMPARE_FUNC, mapCompareFunction(samplerDescription.comparison_function));
     });
 
     auto result = agpu::makeObject<GLSampler> (device);
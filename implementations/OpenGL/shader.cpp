@@ -1,4 +1,5 @@
 #include <regex>
+#include <algorithm>
 #include <string.h>
 #include "shader.hpp"
 #include "shader_signature.hpp"
@@ -9,6 +10,9 @@ namespace AgpuGL
 
 static int shaderDumpCount = 0;
 
+// Increment this when the translation into GLSL changes.
+static constexpr uint32_t GLSLTranslationCacheVersion = 1;
+
 inline GLenum mapShaderType(agpu_shader_type type)
 {
 	switch(type)
@@ -45,10 +49,7 @@ GLShaderForSignature::GLShaderForSignature()
 
 GLShaderForSignature::~GLShaderForSignature()
 {
-	deviceForGL->onMainContextBlocking([&]() {
-		if(handle)
-			deviceForGL->glDeleteShader(handle);
-	});
+	deviceForGL->deleteObjectLater(GLObjectKind::Shader, handle);
 }
 
 agpu_error GLShaderForSignature::compile(std::string *errorMessage)
@@ -56,55 +57,100 @@ agpu_error GLShaderForSignature::compile(std::string *errorMessage)
 	CHECK_POINTER(errorMessage);
 
 	agpu_error result = AGPU_OK;
-    deviceForGL->onMainContextBlocking([&]() {
-		// Create the shader
-		handle = deviceForGL->glCreateShader(mapShaderType(type));
-		if(!handle)
-		{
-			result = AGPU_UNSUPPORTED;
-			return;
-		}
+	deviceForGL->workerContextPool.runBlocking([&]() {
+		result = compileInCurrentContext(errorMessage);
+	});
 
-		// Set the shader source
-		const GLchar *sourceText = glslSource.data();
-		GLint sourceTextLength = GLint(glslSource.size());
-        deviceForGL->glShaderSource(handle, 1, &sourceText, &sourceTextLength);
+	return result;
+}
 
-		// Compile the shader
-		deviceForGL->glCompileShader(handle);
+agpu_error GLShaderForSignature::compileInCurrentContext(std::string *errorMessage)
+{
+	CHECK_POINTER(errorMessage);
 
-		// Get the compilation status
-		GLint status;
-		deviceForGL->glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
-		if(status != GL_TRUE)
-		{
-			result = AGPU_COMPILATION_ERROR;
-
-			GLint infoLogLength;
-			deviceForGL->glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &infoLogLength);
-
-			// Get the info log
-			auto buffer = new char[infoLogLength];
-			GLsizei bufferSize;
-			deviceForGL->glGetShaderInfoLog(handle, infoLogLength, &bufferSize, buffer);
-			*errorMessage = "Errors when compiling GLSL shader generated from SpirV:\n";
-			*errorMessage += sourceText;
-			*errorMessage += "\n";
-			*errorMessage += std::string(buffer, buffer + bufferSize);
-			delete [] buffer;
-			return;
-		}
-    });
+	std::unique_lock<std::mutex> l(compilationMutex);
+	auto error = submitCompilation();
+	if(error != AGPU_OK)
+		return error;
 
-	return result;
+	return checkCompilation(errorMessage);
+}
+
+agpu_error GLShaderForSignature::submitCompilation()
+{
+	if(handle)
+		return AGPU_OK;
+
+	// Create the shader
+	auto newHandle = deviceForGL->glCreateShader(mapShaderType(type));
+	if(!newHandle)
+		return AGPU_UNSUPPORTED;
+
+	// Set the shader source
+	const GLchar *sourceText = glslSource.data();
+	GLint sourceTextLength = GLint(glslSource.size());
+	deviceForGL->glShaderSource(newHandle, 1, &sourceText, &sourceTextLength);
+
+	// Compile the shader. The status is not queried here, so that the driver
+	// can compile the other stages of the program in parallel.
+	deviceForGL->glCompileShader(newHandle);
+
+	// The shader can be attached by programs in other shared contexts.
+	glFlush();
+	handle = newHandle;
+	return AGPU_OK;
+}
+
+agpu_error GLShaderForSignature::checkCompilation(std::string *errorMessage)
+{
+	CHECK_POINTER(errorMessage);
+
+	// Get the compilation status
+	GLint status;
+	deviceForGL->glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
+	if(status != GL_TRUE)
+	{
+		GLint infoLogLength;
+		deviceForGL->glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &infoLogLength);
+
+		// Get the info log
+		auto buffer = new char[infoLogLength];
+		GLsizei bufferSize;
+		deviceForGL->glGetShaderInfoLog(handle, infoLogLength, &bufferSize, buffer);
+		*errorMessage = "Errors when compiling GLSL shader generated from SpirV:\n";
+		*errorMessage += glslSource;
+		*errorMessage += "\n";
+		*errorMessage += std::string(buffer, buffer + bufferSize);
+		delete [] buffer;
+		return AGPU_COMPILATION_ERROR;
+	}
+
+	return AGPU_OK;
 }
 
 agpu_error GLShaderForSignature::attachToProgram(GLuint programHandle, std::string *errorMessage)
 {
+	// The compilation is deferred when the program could come from the binary
+	// cache. Its status is only checked when the program fails to link.
+	{
+		std::unique_lock<std::mutex> l(compilationMutex);
+		auto error = submitCompilation();
+		if(error != AGPU_OK)
+			return error;
+	}
+
 	deviceForGL->glAttachShader(programHandle, handle);
 	return AGPU_OK;
 }
 
+void GLShaderForSignature::addToProgramKey(AgpuCommon::ContentHasher &keyHasher)
+{
+	// The generated GLSL already contains the bindings that are mapped from the shader signature.
+	keyHasher.add(uint32_t(type));
+	keyHasher.add(entryPoint);
+	keyHasher.add(glslSource);
+}
+
 GLShader::GLShader()
 {
 	compiled = false;
@@ -129,6 +175,7 @@ agpu::shader_ref GLShader::createShader(const agpu::device_ref &device, agpu_sha
 
 std::vector<TextureWithSamplerCombination> &GLShader::getTextureWithSamplerCombination(const std::string &entryPointName)
 {
+	std::unique_lock<std::mutex> l(instanceMutex);
 	auto it = textureWithSamplerCombinations.find(entryPointName);
 	if (it != textureWithSamplerCombinations.end())
 		return it->second;
@@ -148,6 +195,30 @@ void GLShader::extractGenericShaderTextureWithSamplerCombinations(const std::str
 
 void GLShader::extractSpirVTextureWithSamplerCombinations(const std::string &entryPointName)
 {
+	textureWithSamplerCombinations.insert(std::make_pair(entryPointName, std::vector<TextureWithSamplerCombination>()));
+	auto &dest = textureWithSamplerCombinations[entryPointName];
+
+	// Look for the combinations of an identical module.
+	auto &translationCache = deviceForGL->glslTranslationCache;
+	std::string translationKey;
+	if(translationCache.isEnabled())
+	{
+		AgpuCommon::ContentHasher hasher;
+		hasher.add(GLSLTranslationCacheVersion);
+		hasher.add(&rawShaderSource[0], rawShaderSource.size());
+		hasher.add(entryPointName);
+		translationKey = hasher.finish();
+
+		std::string encodedCombinations;
+		if(translationCache.find("combinations", translationKey, encodedCombinations) &&
+			encodedCombinations.size() % sizeof(TextureWithSamplerCombination) == 0)
+		{
+			dest.resize(encodedCombinations.size() / sizeof(TextureWithSamplerCombination));
+			memcpy(dest.data(), encodedCombinations.data(), encodedCombinations.size());
+			return;
+		}
+	}
+
 	uint32_t *rawData = reinterpret_cast<uint32_t *> (&rawShaderSource[0]);
 	size_t rawDataSize = rawShaderSource.size() / 4;
 
@@ -156,9 +227,6 @@ void GLShader::extractSpirVTextureWithSamplerCombinations(const std::string &ent
 	// Combine the samplers and the images.
 	glsl.build_combined_image_samplers();
 
-	textureWithSamplerCombinations.insert(std::make_pair(entryPointName, std::vector<TextureWithSamplerCombination>()));
-	auto &dest = textureWithSamplerCombinations[entryPointName];
-
 	// Combined sampler/images
 	for(auto &remap : glsl.get_combined_image_samplers())
 	{
@@ -170,6 +238,12 @@ void GLShader::extractSpirVTextureWithSamplerCombinations(const std::string &ent
 		combination.samplerDescriptorBinding = glsl.get_decoration(remap.sampler_id, spv::Decoration::DecorationBinding);
 		dest.push_back(combination);
 	}
+
+	if(!translationKey.empty())
+	{
+		auto encodedData = reinterpret_cast<const char*> (dest.data());
+		translationCache.store("combinations", translationKey, std::string(encodedData, encodedData + dest.size()*sizeof(TextureWithSamplerCombination)));
+	}
 }
 
 agpu_error GLShader::instanceForSignature(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, const std::string &entryPoint, GLShaderForSignatureRef *result, std::string *errorMessage)
@@ -177,6 +251,7 @@ agpu_error GLShader::instanceForSignature(const agpu::shader_signature_ref &sign
 	CHECK_POINTER(result);
 	CHECK_POINTER(errorMessage);
 
+	std::unique_lock<std::mutex> l(instanceMutex);
 	if(rawSourceLanguage == AGPU_SHADER_LANGUAGE_GLSL)
 		return getOrCreateGenericShaderInstance(signature, textureWithSamplerCombinationMap, result, errorMessage);
 	else if(rawSourceLanguage == AGPU_SHADER_LANGUAGE_SPIR_V)
@@ -198,8 +273,10 @@ agpu_error GLShader::getOrCreateGenericShaderInstance(const agpu::shader_signatu
 	shaderInstance->type = type;
 	shaderInstance->glslSource = std::string((const char*)&rawShaderSource[0], (const char*)&rawShaderSource[rawShaderSource.size()]);
 
-	// Compile the shader instance object.
-	auto error = shaderInstance->compile(errorMessage);
+	// Compile the shader instance object, unless the program can come from the binary cache.
+	agpu_error error = AGPU_OK;
+	if(!deviceForGL->programBinaryCache.isEnabled())
+		error = shaderInstance->compile(errorMessage);
 	if(error == AGPU_OK)
 	{
 		// Store the result
@@ -240,9 +317,111 @@ static agpu_error mapShaderResources(spirv_cross::CompilerGLSL &compiler,
 	return AGPU_OK;
 }
 
+std::string GLShader::computeTranslationKey(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, const std::string &entryPoint)
+{
+	AgpuCommon::ContentHasher hasher;
+	hasher.add(GLSLTranslationCacheVersion);
+	hasher.add(uint32_t(type));
+	hasher.add(uint32_t(deviceForGL->glslVersionNumber));
+	hasher.add(&rawShaderSource[0], rawShaderSource.size());
+	hasher.add(entryPoint);
+	signature.as<GLShaderSignature>()->addLayoutToHash(hasher);
+
+	// Sort the combinations, because the iteration order of the map is not deterministic.
+	std::vector<std::pair<TextureWithSamplerCombination, const MappedTextureWithSamplerCombination*>> sortedCombinations;
+	sortedCombinations.reserve(textureWithSamplerCombinationMap.size());
+	for(auto &combination : textureWithSamplerCombinationMap)
+		sortedCombinations.push_back(std::make_pair(combination.first, &combination.second));
+	std::sort(sortedCombinations.begin(), sortedCombinations.end(), [](const std::pair<TextureWithSamplerCombination, const MappedTextureWithSamplerCombination*> &a, const std::pair<TextureWithSamplerCombination, const MappedTextureWithSamplerCombination*> &b) {
+		return a.first < b.first;
+	});
+
+	for(auto &combination : sortedCombinations)
+	{
+		hasher.add(&combination.first, sizeof(combination.first));
+		hasher.add(combination.second->name);
+		hasher.add(uint32_t(combination.second->mappedTextureUnit));
+	}
+
+	return hasher.finish();
+}
+
 agpu_error GLShader::getOrCreateSpirVShaderInstance(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, const std::string &entryPoint, GLShaderForSignatureRef *result, std::string *errorMessage)
 {
 	char buffer[256];
+
+	// Identical modules instanced with identical signatures produce the same GLSL.
+	auto &translationCache = deviceForGL->glslTranslationCache;
+	std::string translationKey;
+	std::string compiled;
+	if(translationCache.isEnabled())
+		translationKey = computeTranslationKey(signature, textureWithSamplerCombinationMap, entryPoint);
+
+	if(translationKey.empty() || !translationCache.find("glsl", translationKey, compiled))
+	{
+		auto error = translateSpirVIntoGLSL(signature, textureWithSamplerCombinationMap, entryPoint, &compiled, errorMessage);
+		if(error != AGPU_OK)
+			return error;
+
+		if(!translationKey.empty())
+			translationCache.store("glsl", translationKey, compiled);
+	}
+
+	// Create the shader instance object
+	auto shaderInstance = agpu::makeObject<GLShaderForSignature>();
+	shaderInstance->device = device;
+	shaderInstance->type = type;
+	shaderInstance->entryPoint = entryPoint;
+	shaderInstance->glslSource = compiled;
+
+	// Compile the shader instance object, unless the program can come from the binary cache.
+	agpu_error error = AGPU_OK;
+	if(!deviceForGL->programBinaryCache.isEnabled())
+		error = shaderInstance->compile(errorMessage);
+
+	if(deviceForGL->dumpShaders ||
+		(error != AGPU_OK && deviceForGL->dumpShadersOnError))
+	{
+		snprintf(buffer, sizeof(buffer), "dump%d.spv", shaderDumpCount);
+
+		FILE *f;
+#ifdef _WIN32
+		auto error = fopen_s(&f, buffer, "wb");
+		if (error) abort();
+#else
+		f = fopen(buffer, "wb");
+#endif
+		auto res = fwrite(&rawShaderSource[0], rawShaderSource.size(), 1, f);
+		fclose(f);
+		(void)res;
+
+		snprintf(buffer, sizeof(buffer), "dump%d.glsl", shaderDumpCount);
+#ifdef _WIN32
+		error = fopen_s(&f, buffer, "wb");
+		if (error) abort();
+#else
+		f = fopen(buffer, "wb");
+#endif
+		res = fwrite(compiled.data(), compiled.size(), 1, f);
+		fclose(f);
+		(void)res;
+
+		++shaderDumpCount;
+	}
+
+	if(error == AGPU_OK)
+	{
+		// Store the result
+		*result = shaderInstance;
+		return AGPU_OK;
+	}
+
+	// Release the shader instance.
+	return error;
+}
+
+agpu_error GLShader::translateSpirVIntoGLSL(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, const std::string &entryPoint, std::string *result, std::string *errorMessage)
+{
 	uint32_t *rawData = reinterpret_cast<uint32_t *> (&rawShaderSource[0]);
 	size_t rawDataSize = rawShaderSource.size() / 4;
 
@@ -310,10 +489,9 @@ agpu_error GLShader::getOrCreateSpirVShaderInstance(const agpu::shader_signature
 	glsl.set_common_options(options);
 
 	// Compile the shader.
-	std::string compiled;
 	try
 	{
-		compiled = glsl.compile();
+		*result = glsl.compile();
 	}
 	catch(spirv_cross::CompilerError &compileError)
 	{
@@ -321,56 +499,9 @@ agpu_error GLShader::getOrCreateSpirVShaderInstance(const agpu::shader_signature
 		*errorMessage += compileError.what();
 		return AGPU_COMPILATION_ERROR;
 	}
-	//printf("Compiled shader:\n%s\n", compiled.c_str());
-
-	// Create the shader instance object
-	auto shaderInstance = agpu::makeObject<GLShaderForSignature>();
-	shaderInstance->device = device;
-	shaderInstance->type = type;
-	shaderInstance->glslSource = compiled;
+	//printf("Compiled shader:\n%s\n", result->c_str());
 
-	// Compile the shader instance object.
-	error = shaderInstance->compile(errorMessage);
-
-	if(deviceForGL->dumpShaders ||
-		(error != AGPU_OK && deviceForGL->dumpShadersOnError))
-	{
-		snprintf(buffer, sizeof(buffer), "dump%d.spv", shaderDumpCount);
-
-		FILE *f;
-#ifdef _WIN32
-		auto error = fopen_s(&f, buffer, "wb");
-		if (error) abort();
-#else
-		f = fopen(buffer, "wb");
-#endif
-		auto res = fwrite(&rawShaderSource[0], rawShaderSource.size(), 1, f);
-		fclose(f);
-		(void)res;
-
-		snprintf(buffer, sizeof(buffer), "dump%d.glsl", shaderDumpCount);
-#ifdef _WIN32
-		error = fopen_s(&f, buffer, "wb");
-		if (error) abort();
-#else
-		f = fopen(buffer, "wb");
-#endif
-		res = fwrite(compiled.data(), compiled.size(), 1, f);
-		fclose(f);
-		(void)res;
-
-		++shaderDumpCount;
-	}
-
-	if(error == AGPU_OK)
-	{
-		// Store the result
-		*result = shaderInstance;
-		return AGPU_OK;
-	}
-
-	// Release the shader instance.
-	return error;
+	return AGPU_OK;
 }
 
 agpu_error GLShader::setShaderSource(agpu_shader_language language, agpu_string sourceText, agpu_string_length sourceTextLength)
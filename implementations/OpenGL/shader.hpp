@@ -105,7 +105,11 @@ public:
     ~GLShaderForSignature();
 
     agpu_error compile(std::string *errorMessage);
+    agpu_error compileInCurrentContext(std::string *errorMessage);
+    agpu_error submitCompilation();
+    agpu_error checkCompilation(std::string *errorMessage);
     agpu_error attachToProgram(GLuint programHandle, std::string *errorMessage);
+    void addToProgramKey(AgpuCommon::ContentHasher &keyHasher);
 
 public:
     agpu::device_ref device;
@@ -113,7 +117,11 @@ public:
     agpu_shader_language rawSourceLanguage;
 
     GLuint handle;
+    std::string entryPoint;
     std::string glslSource;
+
+    // Shader instances can be shared by pipelines that are built concurrently.
+    std::mutex compilationMutex;
 };
 
 typedef agpu::ref<GLShaderForSignature> GLShaderForSignatureRef;
@@ -151,8 +159,13 @@ private:
 
     agpu_error getOrCreateGenericShaderInstance(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, GLShaderForSignatureRef *result, std::string *errorMessage);
     agpu_error getOrCreateSpirVShaderInstance(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, const std::string &entryPoint, GLShaderForSignatureRef *result, std::string *errorMessage);
+    std::string computeTranslationKey(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, const std::string &entryPoint);
+    agpu_error translateSpirVIntoGLSL(const agpu::shader_signature_ref &signature, const TextureWithSamplerCombinationMap &textureWithSamplerCombinationMap, const std::string &entryPoint, std::string *result, std::string *errorMessage);
 
     std::unordered_map<std::string, std::vector<TextureWithSamplerCombination>> textureWithSamplerCombinations;
+
+    // Pipelines that use this shader can be built concurrently.
+    std::mutex instanceMutex;
 };
 
 } // End of namespace AgpuGL
@@ -225,9 +225,9 @@ void GLShaderResourceBinding::activateBuffers(GLenum target, size_t baseIndex, s
         //if(baseIndex + i == 1)
         //    binding.buffer->dumpToFile("camera.bin");
         if (binding.range)
-            glDevice->glBindBufferRange(target, GLuint(baseIndex + i), binding.buffer.as<GLBuffer>()->handle, binding.offset, binding.size);
+            glDevice->getStateCache().bindBufferRange(target, GLuint(baseIndex + i), binding.buffer.as<GLBuffer>()->handle, binding.offset, binding.size);
         else
-            glDevice->glBindBufferBase(target, GLuint(baseIndex + i), binding.buffer.as<GLBuffer>()->handle);
+            glDevice->getStateCache().bindBufferBase(target, GLuint(baseIndex + i), binding.buffer.as<GLBuffer>()->handle);
     }
 }
 
@@ -254,7 +254,7 @@ void GLShaderResourceBinding::activateSamplers()
         const auto &sampler = samplers[i];
         if(sampler)
         {
-            glDevice->glBindSampler(GLuint(baseIndex + i), sampler.as<GLSampler> ()->handle);
+            glDevice->getStateCache().bindSampler(GLuint(baseIndex + i), sampler.as<GLSampler> ()->handle);
         }
     }
 }
@@ -49,4 +49,18 @@ int GLShaderSignature::mapDescriptorSetAndBinding(agpu_shader_binding_type type,
     return element.startIndex;
 }
 
+void GLShaderSignature::addLayoutToHash(AgpuCommon::ContentHasher &hasher)
+{
+    hasher.add(uint32_t(elements.size()));
+    for(auto &bank : elements)
+    {
+        hasher.add(uint32_t(bank.elements.size()));
+        for(auto &element : bank.elements)
+        {
+            hasher.add(uint32_t(element.type));
+            hasher.add(element.startIndex);
+        }
+    }
+}
+
 } // End of namespace AgpuGL
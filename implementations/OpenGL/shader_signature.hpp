@@ -19,6 +19,9 @@ public:
 
     int mapDescriptorSetAndBinding(agpu_shader_binding_type type, unsigned int set, unsigned int binding);
 
+    // Adds the mapping of the descriptor sets into the OpenGL binding points.
+    void addLayoutToHash(AgpuCommon::ContentHasher &hasher);
+
     agpu::device_ref device;
     std::vector<ShaderSignatureElement> elements;
     agpu_uint bindingPointsUsed[(int)OpenGLResourceBindingType::Count];
@@ -0,0 +1,118 @@
+#include "staging_arena.hpp"
+#include <string.h>
+
+namespace AgpuGL
+{
+
+struct GLStagingArena::Block
+{
+    std::unique_ptr<uint8_t[]> storage;
+    size_t capacity;
+    size_t usedSize;
+    size_t liveAllocationCount;
+    bool isDedicated;
+};
+
+GLStagingArena::GLStagingArena()
+    : currentBlock(nullptr)
+{
+}
+
+GLStagingArena::~GLStagingArena()
+{
+    delete currentBlock;
+    for(auto block : freeBlocks)
+        delete block;
+}
+
+GLStagingArena::Block *GLStagingArena::newBlock(size_t capacity, bool isDedicated)
+{
+    auto block = new Block();
+    block->storage.reset(new uint8_t[capacity]);
+    block->capacity = capacity;
+    block->usedSize = 0;
+    block->liveAllocationCount = 0;
+    block->isDedicated = isDedicated;
+    return block;
+}
+
+GLStagingArena::Allocation GLStagingArena::allocate(size_t size)
+{
+    Allocation result;
+    if(size > MaxBlockAllocationSize)
+    {
+        // Big payloads get their own memory, so they do not pin a block.
+        result.block = newBlock(size, true);
+        result.block->liveAllocationCount = 1;
+        result.data = result.block->storage.get();
+        return result;
+    }
+
+    auto alignedSize = (size + AllocationAlignment - 1) & ~(AllocationAlignment - 1);
+
+    std::unique_lock<std::mutex> l(mutex);
+    if(!currentBlock || currentBlock->usedSize + alignedSize > currentBlock->capacity)
+    {
+        // The retired block is recycled by the release of its last allocation.
+        if(currentBlock && currentBlock->liveAllocationCount == 0)
+            currentBlock->usedSize = 0;
+        else
+        {
+            if(!freeBlocks.empty())
+            {
+                currentBlock = freeBlocks.back();
+                freeBlocks.pop_back();
+            }
+            else
+            {
+                currentBlock = newBlock(BlockSize, false);
+            }
+        }
+    }
+
+    result.block = currentBlock;
+    result.data = currentBlock->storage.get() + currentBlock->usedSize;
+    currentBlock->usedSize += alignedSize;
+    ++currentBlock->liveAllocationCount;
+    return result;
+}
+
+GLStagingArena::Allocation GLStagingArena::allocateCopy(const void *data, size_t size)
+{
+    auto result = allocate(size);
+    if(size > 0)
+        memcpy(result.data, data, size);
+    return result;
+}
+
+void GLStagingArena::release(const Allocation &allocation)
+{
+    auto block = allocation.block;
+    if(!block)
+        return;
+
+    if(block->isDedicated)
+    {
+        delete block;
+        return;
+    }
+
+    std::unique_lock<std::mutex> l(mutex);
+    if(--block->liveAllocationCount != 0)
+        return;
+
+    if(block == currentBlock)
+    {
+        // Rewind the current block, instead of moving into another one.
+        block->usedSize = 0;
+        return;
+    }
+
+    block->usedSize = 0;
+    if(freeBlocks.size() < MaxFreeBlockCount)
+        freeBlocks.push_back(block);
+    else
+        delete block;
+}
+
+} // End of namespace AgpuGL
@@ -0,0 +1,57 @@
+#ifndef AGPU_GL_STAGING_ARENA_HPP
+#define AGPU_GL_STAGING_ARENA_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AgpuGL
+{
+
+/**
+ * Memory for the payloads of the asynchronous uploads. The data that is given
+ * by the application is copied into a staging allocation, so that the
+ * application can reuse its memory immediately, and the allocation is
+ * released by the job that consumes it in the main context thread. The small
+ * allocations are bump allocated from blocks that are recycled when all of
+ * their allocations are released. This arena can be used from any thread.
+ */
+class GLStagingArena
+{
+public:
+    struct Block;
+
+    struct Allocation
+    {
+        Allocation()
+            : block(nullptr), data(nullptr) {}
+
+        Block *block;
+        uint8_t *data;
+    };
+
+    GLStagingArena();
+    ~GLStagingArena();
+
+    Allocation allocate(size_t size);
+    Allocation allocateCopy(const void *data, size_t size);
+    void release(const Allocation &allocation);
+
+private:
+    static constexpr size_t BlockSize = 1024*1024;
+    static constexpr size_t MaxBlockAllocationSize = BlockSize / 4;
+    static constexpr size_t MaxFreeBlockCount = 4;
+    static constexpr size_t AllocationAlignment = 16;
+
+    Block *newBlock(size_t capacity, bool isDedicated);
+
+    std::mutex mutex;
+    Block *currentBlock;
+    std::vector<Block*> freeBlocks;
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_STAGING_ARENA_HPP
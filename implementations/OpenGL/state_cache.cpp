@@ -0,0 +1,376 @@
+#include "device.hpp"
+#include <string.h>
+#include <stdlib.h>
+
+namespace AgpuGL
+{
+
+static constexpr GLenum UnknownEnum = GLenum(~0u);
+static constexpr GLuint UnknownName = GLuint(~0u);
+static constexpr GLsizeiptr WholeBufferSize = -1;
+
+static GLenum mapCachedCapability(GLCachedCapability capability)
+{
+    switch(capability)
+    {
+    case GLCachedCapability::FramebufferSRGB: return GL_FRAMEBUFFER_SRGB;
+    case GLCachedCapability::ScissorTest: return GL_SCISSOR_TEST;
+    case GLCachedCapability::CullFace: return GL_CULL_FACE;
+    case GLCachedCapability::DepthTest: return GL_DEPTH_TEST;
+    case GLCachedCapability::Blend: return GL_BLEND;
+    case GLCachedCapability::StencilTest: return GL_STENCIL_TEST;
+    case GLCachedCapability::Multisample: return GL_MULTISAMPLE;
+    default: abort();
+    }
+}
+
+GLStateCache::GLStateCache()
+    : device(nullptr), enabled(true), callCount(0), skippedCallCount(0)
+{
+    invalidate();
+}
+
+GLStateCache::~GLStateCache()
+{
+}
+
+void GLStateCache::initialize(GLDevice *newDevice, bool newEnabled)
+{
+    device = newDevice;
+    enabled = newEnabled;
+    invalidate();
+}
+
+void GLStateCache::invalidate()
+{
+    memset(capabilities, -1, sizeof(capabilities));
+    frontFace = UnknownEnum;
+    cullFace = UnknownEnum;
+    depthMask = -1;
+    depthFunction = UnknownEnum;
+    hasZeroToOneDepthRange = false;
+    for(auto &mask : colorMask)
+        mask = -1;
+    for(auto &equation : blendEquation)
+        equation = UnknownEnum;
+    for(auto &factor : blendFunc)
+        factor = UnknownEnum;
+    stencilMask = 0;
+    hasStencilMask = false;
+    for(auto &face : stencilFaces)
+    {
+        face.fail = UnknownEnum;
+        face.depthFail = UnknownEnum;
+        face.depthPass = UnknownEnum;
+        face.function = UnknownEnum;
+        face.reference = 0;
+        face.mask = 0;
+    }
+    for(int i = 0; i < 4; ++i)
+    {
+        viewport[i] = -1;
+        scissor[i] = -1;
+    }
+
+    program = UnknownName;
+    activeTextureUnit = UnknownName;
+    uniformBufferBindings.clear();
+    storageBufferBindings.clear();
+    textureUnitBindings.clear();
+    samplerBindings.clear();
+}
+
+void GLStateCache::setCapability(GLCachedCapability capability, bool enabledValue)
+{
+    auto &cached = capabilities[int(capability)];
+    if(isRedundant(cached == int8_t(enabledValue)))
+        return;
+
+    cached = int8_t(enabledValue);
+    if(enabledValue)
+        glEnable(mapCachedCapability(capability));
+    else
+        glDisable(mapCachedCapability(capability));
+}
+
+void GLStateCache::setFrontFace(GLenum mode)
+{
+    if(isRedundant(frontFace == mode))
+        return;
+
+    frontFace = mode;
+    glFrontFace(mode);
+}
+
+void GLStateCache::setCullFace(GLenum mode)
+{
+    if(isRedundant(cullFace == mode))
+        return;
+
+    cullFace = mode;
+    glCullFace(mode);
+}
+
+void GLStateCache::setDepthMask(GLboolean mask)
+{
+    if(isRedundant(depthMask == GLint(mask)))
+        return;
+
+    depthMask = mask;
+    glDepthMask(mask);
+}
+
+void GLStateCache::setDepthFunc(GLenum function)
+{
+    if(isRedundant(depthFunction == function))
+        return;
+
+    depthFunction = function;
+    glDepthFunc(function);
+}
+
+void GLStateCache::setZeroToOneDepthRange()
+{
+    if(isRedundant(hasZeroToOneDepthRange))
+        return;
+
+    // Set the depth range mapping to [0.0, 1.0]. This is the same depth range used by Direct3D.
+    hasZeroToOneDepthRange = true;
+    if (device->hasExtension_GL_ARB_clip_control)
+        device->glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+    else if (device->hasExtension_GL_NV_depth_buffer_float)
+        device->glDepthRangedNV(-1, 1);
+    else
+        glDepthRange(-1, 1);
+}
+
+void GLStateCache::setColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    if(isRedundant(colorMask[0] == GLint(red) && colorMask[1] == GLint(green) &&
+        colorMask[2] == GLint(blue) && colorMask[3] == GLint(alpha)))
+        return;
+
+    colorMask[0] = red;
+    colorMask[1] = green;
+    colorMask[2] = blue;
+    colorMask[3] = alpha;
+    glColorMask(red, green, blue, alpha);
+}
+
+void GLStateCache::setBlendEquation(GLenum colorOperation, GLenum alphaOperation)
+{
+    if(isRedundant(blendEquation[0] == colorOperation && blendEquation[1] == alphaOperation))
+        return;
+
+    blendEquation[0] = colorOperation;
+    blendEquation[1] = alphaOperation;
+    device->glBlendEquationSeparate(colorOperation, alphaOperation);
+}
+
+void GLStateCache::setBlendFunc(GLenum sourceColor, GLenum destColor, GLenum sourceAlpha, GLenum destAlpha)
+{
+    if(isRedundant(blendFunc[0] == sourceColor && blendFunc[1] == destColor &&
+        blendFunc[2] == sourceAlpha && blendFunc[3] == destAlpha))
+        return;
+
+    blendFunc[0] = sourceColor;
+    blendFunc[1] = destColor;
+    blendFunc[2] = sourceAlpha;
+    blendFunc[3] = destAlpha;
+    device->glBlendFuncSeparate(sourceColor, destColor, sourceAlpha, destAlpha);
+}
+
+void GLStateCache::setStencilMask(GLuint mask)
+{
+    if(isRedundant(hasStencilMask && stencilMask == mask))
+        return;
+
+    hasStencilMask = true;
+    stencilMask = mask;
+    glStencilMask(mask);
+}
+
+GLStateCache::StencilFaceState &GLStateCache::stencilFaceFor(GLenum face)
+{
+    return stencilFaces[face == GL_BACK ? 1 : 0];
+}
+
+void GLStateCache::setStencilOp(GLenum face, GLenum fail, GLenum depthFail, GLenum depthPass)
+{
+    auto &state = stencilFaceFor(face);
+    if(isRedundant(state.fail == fail && state.depthFail == depthFail && state.depthPass == depthPass))
+        return;
+
+    state.fail = fail;
+    state.depthFail = depthFail;
+    state.depthPass = depthPass;
+    device->glStencilOpSeparate(face, fail, depthFail, depthPass);
+}
+
+void GLStateCache::setStencilFunc(GLenum face, GLenum function, GLint reference, GLuint mask)
+{
+    auto &state = stencilFaceFor(face);
+    if(isRedundant(state.function == function && state.reference == reference && state.mask == mask))
+        return;
+
+    state.function = function;
+    state.reference = reference;
+    state.mask = mask;
+    device->glStencilFuncSeparate(face, function, reference, mask);
+}
+
+void GLStateCache::setViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if(isRedundant(viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height))
+        return;
+
+    viewport[0] = x;
+    viewport[1] = y;
+    viewport[2] = width;
+    viewport[3] = height;
+    glViewport(x, y, width, height);
+}
+
+void GLStateCache::setScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if(isRedundant(scissor[0] == x && scissor[1] == y && scissor[2] == width && scissor[3] == height))
+        return;
+
+    scissor[0] = x;
+    scissor[1] = y;
+    scissor[2] = width;
+    scissor[3] = height;
+    glScissor(x, y, width, height);
+}
+
+void GLStateCache::useProgram(GLuint newProgram)
+{
+    if(isRedundant(program == newProgram))
+        return;
+
+    program = newProgram;
+    device->glUseProgram(newProgram);
+}
+
+std::vector<GLStateCache::IndexedBufferBinding> &GLStateCache::indexedBindingsFor(GLenum target)
+{
+    return target == GL_SHADER_STORAGE_BUFFER ? storageBufferBindings : uniformBufferBindings;
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    auto &bindings = indexedBindingsFor(target);
+    if(index >= bindings.size())
+        bindings.resize(index + 1, IndexedBufferBinding{UnknownName, 0, 0});
+
+    auto &binding = bindings[index];
+    if(isRedundant(binding.buffer == buffer && binding.offset == 0 && binding.size == WholeBufferSize))
+        return;
+
+    binding.buffer = buffer;
+    binding.offset = 0;
+    binding.size = WholeBufferSize;
+    device->glBindBufferBase(target, index, buffer);
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    auto &bindings = indexedBindingsFor(target);
+    if(index >= bindings.size())
+        bindings.resize(index + 1, IndexedBufferBinding{UnknownName, 0, 0});
+
+    auto &binding = bindings[index];
+    if(isRedundant(binding.buffer == buffer && binding.offset == offset && binding.size == size))
+        return;
+
+    binding.buffer = buffer;
+    binding.offset = offset;
+    binding.size = size;
+    device->glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLStateCache::setActiveTexture(GLuint unit)
+{
+    if(isRedundant(activeTextureUnit == unit))
+        return;
+
+    activeTextureUnit = unit;
+    device->glActiveTexture(GLenum(GL_TEXTURE0 + unit));
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+    // The binding goes into the active texture unit, so it has to be known.
+    if(activeTextureUnit == UnknownName)
+        setActiveTexture(0);
+    bindTextureInUnit(activeTextureUnit, target, texture);
+}
+
+void GLStateCache::bindTextureInUnit(GLuint unit, GLenum target, GLuint texture)
+{
+    if(unit >= textureUnitBindings.size())
+        textureUnitBindings.resize(unit + 1, TextureUnitBinding{UnknownEnum, UnknownName});
+
+    auto &binding = textureUnitBindings[unit];
+    if(isRedundant(binding.target == target && binding.texture == texture))
+        return;
+
+    setActiveTexture(unit);
+    binding.target = target;
+    binding.texture = texture;
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::bindSampler(GLuint unit, GLuint sampler)
+{
+    if(unit >= samplerBindings.size())
+        samplerBindings.resize(unit + 1, UnknownName);
+
+    auto &binding = samplerBindings[unit];
+    if(isRedundant(binding == sampler))
+        return;
+
+    binding = sampler;
+    device->glBindSampler(unit, sampler);
+}
+
+void GLStateCache::programDeleted(GLuint deletedProgram)
+{
+    if(program == deletedProgram)
+        program = UnknownName;
+}
+
+void GLStateCache::bufferDeleted(GLuint buffer)
+{
+    for(auto &binding : uniformBufferBindings)
+    {
+        if(binding.buffer == buffer)
+            binding.buffer = UnknownName;
+    }
+
+    for(auto &binding : storageBufferBindings)
+    {
+        if(binding.buffer == buffer)
+            binding.buffer = UnknownName;
+    }
+}
+
+void GLStateCache::textureDeleted(GLuint texture)
+{
+    for(auto &binding : textureUnitBindings)
+    {
+        if(binding.texture == texture)
+            binding.texture = UnknownName;
+    }
+}
+
+void GLStateCache::samplerDeleted(GLuint sampler)
+{
+    for(auto &binding : samplerBindings)
+    {
+        if(binding == sampler)
+            binding = UnknownName;
+    }
+}
+
+} // End of namespace AgpuGL
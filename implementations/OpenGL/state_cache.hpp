@@ -0,0 +1,155 @@
+#ifndef AGPU_GL_STATE_CACHE_HPP
+#define AGPU_GL_STATE_CACHE_HPP
+
+#include <vector>
+#include <stdint.h>
+
+namespace AgpuGL
+{
+
+struct GLDevice;
+
+/**
+ * The capabilities that are toggled with glEnable and glDisable.
+ */
+enum class GLCachedCapability
+{
+    FramebufferSRGB = 0,
+    ScissorTest,
+    CullFace,
+    DepthTest,
+    Blend,
+    StencilTest,
+    Multisample,
+
+    Count
+};
+
+/**
+ * Shadow copy of the state of an OpenGL context. The state changes that go
+ * through this cache are compared with the last values that were set in the
+ * context, and only the differences are sent to the driver. The cache must
+ * only be used in the thread where its context is current.
+ */
+class GLStateCache
+{
+public:
+    GLStateCache();
+    ~GLStateCache();
+
+    void initialize(GLDevice *device, bool enabled);
+
+    // Forgets every cached value, so that the next state changes are sent to the driver.
+    void invalidate();
+
+    // Fixed function state.
+    void setCapability(GLCachedCapability capability, bool enabled);
+    void setFrontFace(GLenum mode);
+    void setCullFace(GLenum mode);
+    void setDepthMask(GLboolean mask);
+    void setDepthFunc(GLenum function);
+    void setZeroToOneDepthRange();
+    void setColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+    void setBlendEquation(GLenum colorOperation, GLenum alphaOperation);
+    void setBlendFunc(GLenum sourceColor, GLenum destColor, GLenum sourceAlpha, GLenum destAlpha);
+    void setStencilMask(GLuint mask);
+    void setStencilOp(GLenum face, GLenum fail, GLenum depthFail, GLenum depthPass);
+    void setStencilFunc(GLenum face, GLenum function, GLint reference, GLuint mask);
+    void setViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void setScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // Object bindings.
+    void useProgram(GLuint program);
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void bindTexture(GLenum target, GLuint texture);
+    void bindTextureInUnit(GLuint unit, GLenum target, GLuint texture);
+    void bindSampler(GLuint unit, GLuint sampler);
+
+    // Deleted object names can be reused, so they must be removed from the cache.
+    void programDeleted(GLuint program);
+    void bufferDeleted(GLuint buffer);
+    void textureDeleted(GLuint texture);
+    void samplerDeleted(GLuint sampler);
+
+    uint64_t getCallCount() const
+    {
+        return callCount;
+    }
+
+    uint64_t getSkippedCallCount() const
+    {
+        return skippedCallCount;
+    }
+
+private:
+    struct IndexedBufferBinding
+    {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    struct TextureUnitBinding
+    {
+        GLenum target;
+        GLuint texture;
+    };
+
+    struct StencilFaceState
+    {
+        GLenum fail;
+        GLenum depthFail;
+        GLenum depthPass;
+        GLenum function;
+        GLint reference;
+        GLuint mask;
+    };
+
+    bool isRedundant(bool unchanged)
+    {
+        if(enabled && unchanged)
+        {
+            ++skippedCallCount;
+            return true;
+        }
+
+        ++callCount;
+        return false;
+    }
+
+    std::vector<IndexedBufferBinding> &indexedBindingsFor(GLenum target);
+    void setActiveTexture(GLuint unit);
+    StencilFaceState &stencilFaceFor(GLenum face);
+
+    GLDevice *device;
+    bool enabled;
+    uint64_t callCount;
+    uint64_t skippedCallCount;
+
+    int8_t capabilities[int(GLCachedCapability::Count)];
+    GLenum frontFace;
+    GLenum cullFace;
+    GLint depthMask;
+    GLenum depthFunction;
+    bool hasZeroToOneDepthRange;
+    GLint colorMask[4];
+    GLenum blendEquation[2];
+    GLenum blendFunc[4];
+    GLuint stencilMask;
+    bool hasStencilMask;
+    StencilFaceState stencilFaces[2];
+    GLint viewport[4];
+    GLint scissor[4];
+
+    GLuint program;
+    GLuint activeTextureUnit;
+    std::vector<IndexedBufferBinding> uniformBufferBindings;
+    std::vector<IndexedBufferBinding> storageBufferBindings;
+    std::vector<TextureUnitBinding> textureUnitBindings;
+    std::vector<GLuint> samplerBindings;
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_STATE_CACHE_HPP
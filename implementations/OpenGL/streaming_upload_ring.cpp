@@ -0,0 +1,147 @@
+#include "device.hpp"
+#include <string.h>
+
+namespace AgpuGL
+{
+
+GLStreamingUploadRing::GLStreamingUploadRing()
+    : device(nullptr), ringBuffer(0), mappedPointer(nullptr),
+      currentSegment(0), currentSegmentOffset(0)
+{
+}
+
+GLStreamingUploadRing::~GLStreamingUploadRing()
+{
+}
+
+void GLStreamingUploadRing::initialize(GLDevice *newDevice, bool enabled)
+{
+    device = newDevice;
+    if(!enabled ||
+        !device->isPersistentMemoryMappingSupported_ || !device->isCoherentMemoryMappingSupported_ ||
+        !device->glCopyBufferSubData || !device->glMapBufferRange || !device->glFenceSync)
+        return;
+
+    auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    auto ringSize = SegmentCount*SegmentSize;
+    device->glGenBuffers(1, &ringBuffer);
+    device->glBindBuffer(GL_COPY_READ_BUFFER, ringBuffer);
+    device->glBufferStorage(GL_COPY_READ_BUFFER, ringSize, nullptr, flags);
+    mappedPointer = reinterpret_cast<uint8_t*> (device->glMapBufferRange(GL_COPY_READ_BUFFER, 0, ringSize, flags));
+    device->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    if(!mappedPointer)
+    {
+        device->glDeleteBuffers(1, &ringBuffer);
+        ringBuffer = 0;
+    }
+}
+
+void GLStreamingUploadRing::destroy()
+{
+    if(!ringBuffer)
+        return;
+
+    for(auto &segment : segments)
+    {
+        if(segment.fence)
+        {
+            device->glDeleteSync(segment.fence);
+            segment.fence = nullptr;
+        }
+        segment.isInFlight = false;
+    }
+
+    device->glBindBuffer(GL_COPY_READ_BUFFER, ringBuffer);
+    device->glUnmapBuffer(GL_COPY_READ_BUFFER);
+    device->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    device->glDeleteBuffers(1, &ringBuffer);
+    device->getStateCache().bufferDeleted(ringBuffer);
+    ringBuffer = 0;
+    mappedPointer = nullptr;
+}
+
+bool GLStreamingUploadRing::upload(GLuint destinationBuffer, size_t destinationOffset, size_t size, const void *data)
+{
+    if(!mappedPointer || size > SegmentSize)
+        return false;
+
+    // The lock is kept until the copy job is submitted, so that the fence of
+    // a segment is always submitted after the copies that read from it.
+    std::unique_lock<std::mutex> l(mutex);
+    if(currentSegmentOffset + size > SegmentSize)
+    {
+        retireSegment(currentSegment);
+        currentSegment = (currentSegment + 1) % SegmentCount;
+        currentSegmentOffset = 0;
+        if(segments[currentSegment].isInFlight.load(std::memory_order_acquire))
+            waitForSegment(currentSegment);
+    }
+
+    auto sourceOffset = currentSegment*SegmentSize + currentSegmentOffset;
+    currentSegmentOffset += (size + UploadAlignment - 1) & ~(UploadAlignment - 1);
+    memcpy(mappedPointer + sourceOffset, data, size);
+
+    auto ring = this;
+    device->onMainContextAsync([=] {
+        ring->copyIntoBuffer(sourceOffset, destinationBuffer, destinationOffset, size);
+    });
+    return true;
+}
+
+void GLStreamingUploadRing::retireSegment(size_t segmentIndex)
+{
+    segments[segmentIndex].isInFlight.store(true, std::memory_order_release);
+
+    auto ring = this;
+    device->onMainContextAsync([=] {
+        auto &segment = ring->segments[segmentIndex];
+        segment.fence = ring->device->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    });
+}
+
+void GLStreamingUploadRing::waitForSegment(size_t segmentIndex)
+{
+    // The fence job was submitted before, so the fence exists when this runs.
+    device->onMainContextBlocking([&] {
+        auto &segment = segments[segmentIndex];
+        if(segment.fence)
+        {
+            GLenum waitReturn = GL_TIMEOUT_EXPIRED;
+            while(waitReturn == GL_TIMEOUT_EXPIRED)
+                waitReturn = device->glClientWaitSync(segment.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            device->glDeleteSync(segment.fence);
+            segment.fence = nullptr;
+        }
+
+        segment.isInFlight.store(false, std::memory_order_release);
+    });
+}
+
+void GLStreamingUploadRing::copyIntoBuffer(size_t sourceOffset, GLuint destinationBuffer, size_t destinationOffset, size_t size)
+{
+    device->glBindBuffer(GL_COPY_READ_BUFFER, ringBuffer);
+    device->glBindBuffer(GL_COPY_WRITE_BUFFER, destinationBuffer);
+    device->glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size);
+    releaseCompletedSegments();
+}
+
+void GLStreamingUploadRing::releaseCompletedSegments()
+{
+    // Poll the fences, so that the application thread rarely has to wait.
+    for(auto &segment : segments)
+    {
+        if(!segment.fence)
+            continue;
+
+        auto waitReturn = device->glClientWaitSync(segment.fence, 0, 0);
+        if(waitReturn == GL_ALREADY_SIGNALED || waitReturn == GL_CONDITION_SATISFIED)
+        {
+            device->glDeleteSync(segment.fence);
+            segment.fence = nullptr;
+            segment.isInFlight.store(false, std::memory_order_release);
+        }
+    }
+}
+
+} // End of namespace AgpuGL
@@ -0,0 +1,79 @@
+#ifndef AGPU_GL_STREAMING_UPLOAD_RING_HPP
+#define AGPU_GL_STREAMING_UPLOAD_RING_HPP
+
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AgpuGL
+{
+
+struct GLDevice;
+
+/**
+ * Ring of persistently and coherently mapped memory for buffer uploads. The
+ * application thread copies the data directly into the ring, and a job copies
+ * it into the destination buffer with glCopyBufferSubData. Unlike
+ * glBufferSubData, this does not make the driver wait for the draws that are
+ * still using the destination buffer. The ring is split into segments, and a
+ * fence is inserted after the copies of each segment, so that a segment is
+ * only written again when the GPU has finished reading it.
+ */
+class GLStreamingUploadRing
+{
+public:
+    GLStreamingUploadRing();
+    ~GLStreamingUploadRing();
+
+    // These must be called in the main context thread.
+    void initialize(GLDevice *device, bool enabled);
+    void destroy();
+
+    bool isEnabled() const
+    {
+        return mappedPointer != nullptr;
+    }
+
+    // Returns false when the data cannot go through the ring, so that the
+    // caller has to use another upload path.
+    bool upload(GLuint destinationBuffer, size_t destinationOffset, size_t size, const void *data);
+
+private:
+    static constexpr size_t SegmentCount = 8;
+    static constexpr size_t SegmentSize = 512*1024;
+    static constexpr size_t UploadAlignment = 64;
+
+    struct Segment
+    {
+        Segment()
+            : isInFlight(false), fence(nullptr) {}
+
+        // Set by the application thread when the segment is retired, and
+        // cleared by the main context thread when its fence is signaled.
+        std::atomic_bool isInFlight;
+
+        // Only used in the main context thread.
+        GLsync fence;
+    };
+
+    void retireSegment(size_t segmentIndex);
+    void waitForSegment(size_t segmentIndex);
+
+    // These must be called in the main context thread.
+    void copyIntoBuffer(size_t sourceOffset, GLuint destinationBuffer, size_t destinationOffset, size_t size);
+    void releaseCompletedSegments();
+
+    GLDevice *device;
+    GLuint ringBuffer;
+    uint8_t *mappedPointer;
+
+    std::mutex mutex;
+    size_t currentSegment;
+    size_t currentSegmentOffset;
+    Segment segments[SegmentCount];
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_STREAMING_UPLOAD_RING_HPP
@@ -9,7 +9,7 @@ namespace AgpuGL
 {
 
 GLSwapChain::GLSwapChain()
-    : window(nullptr), width(0), height(0), backBufferIndex(0)
+    : window(nullptr), isOffscreen(false), width(0), height(0), backBufferIndex(0)
 {
 }
 
@@ -97,12 +97,18 @@ agpu::swap_chain_ref GLSwapChain::create(const agpu::device_ref &device, const a
     auto chain = result.as<GLSwapChain> ();
     chain->device = device;
     chain->window = create_info->window;
+
+    // The offscreen swap chains just cycle through their framebuffers, which
+    // are read back by the application.
+    chain->isOffscreen = !chain->window || deviceForGL->mainContext->isHeadless() ||
+        (create_info->window_system_name && !strcmp(create_info->window_system_name, "headless"));
     chain->width = create_info->width;
     chain->height = create_info->height;
     chain->commandQueue = commandQueue;
 
     // Set the window pixel format.
-    deviceForGL->setWindowPixelFormat(chain->window);
+    if(!chain->isOffscreen)
+        deviceForGL->setWindowPixelFormat(chain->window);
 
     // Store the framebuffers.
 	chain->framebuffers = framebuffers;
@@ -111,6 +117,12 @@ agpu::swap_chain_ref GLSwapChain::create(const agpu::device_ref &device, const a
 
 agpu_error GLSwapChain::swapBuffers()
 {
+    if(isOffscreen)
+    {
+        backBufferIndex = (backBufferIndex + 1) % framebuffers.size();
+        return AGPU_OK;
+    }
+
     auto glDevice = device.as<GLDevice> ();
     glDevice->onMainContextBlocking([&](){
         auto currentContext = OpenGLContext::getCurrent();
@@ -152,4 +164,10 @@ agpu_error GLSwapChain::setOverlayPosition(agpu_int x, agpu_int y)
     return AGPU_OK;
 }
 
+agpu_error GLSwapChain::getFramePacingStatistics(agpu_frame_pacing_statistics* statistics)
+{
+    CHECK_POINTER(statistics);
+    return AGPU_UNSUPPORTED;
+}
+
 } // End of namespace AgpuGL
@@ -22,10 +22,12 @@ public:
     virtual agpu_error swapBuffers() override;
 
 	virtual agpu_error setOverlayPosition(agpu_int x, agpu_int y) override;
+	virtual agpu_error getFramePacingStatistics(agpu_frame_pacing_statistics* statistics) override;
 
 public:
     agpu::device_ref device;
     agpu_pointer window;
+    bool isOffscreen;
     agpu_uint width;
     agpu_uint height;
     agpu_uint backBufferIndex;
@@ -49,95 +49,90 @@ void BufferTextureTransferLayout::setFromDescriptionAndLevel(const agpu_texture_
     }
 }
 
-void GLTexture::allocateTexture1D(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description)
+void GLTexture::allocateTexture1D(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description)
 {
-    glBindTexture(target, handle);
+    glDevice->getStateCache().bindTexture(target, handle);
     if(description->layers > 1)
-        deviceForGL->glTexStorage2D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->layers);
+        glDevice->glTexStorage2D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->layers);
     else
-        deviceForGL->glTexStorage1D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width);
+        glDevice->glTexStorage1D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width);
 }
 
-void GLTexture::allocateTexture2D(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description)
+void GLTexture::allocateTexture2D(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description)
 {
-    glBindTexture(target, handle);
+    glDevice->getStateCache().bindTexture(target, handle);
     if(description->sample_count > 1)
     {
-        deviceForGL->glTexStorage2DMultisample(target, description->sample_count, mapInternalTextureFormat(description->format), description->width, description->height, GL_FALSE);
+        glDevice->glTexStorage2DMultisample(target, description->sample_count, mapInternalTextureFormat(description->format), description->width, description->height, GL_FALSE);
     }
     else
     {
         if(description->layers > 1)
-            deviceForGL->glTexStorage3D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height, description->layers);
+            glDevice->glTexStorage3D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height, description->layers);
         else
-            deviceForGL->glTexStorage2D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height);
+            glDevice->glTexStorage2D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height);
     }
 }
 
-void GLTexture::allocateTexture3D(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description)
+void GLTexture::allocateTexture3D(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description)
 {
-    glBindTexture(target, handle);
-    deviceForGL->glTexStorage3D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height, description->layers);
+    glDevice->getStateCache().bindTexture(target, handle);
+    glDevice->glTexStorage3D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height, description->layers);
 }
 
-void GLTexture::allocateTextureCube(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description)
+void GLTexture::allocateTextureCube(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description)
 {
-    glBindTexture(target, handle);
-    deviceForGL->glTexStorage2D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height);
+    glDevice->getStateCache().bindTexture(target, handle);
+    glDevice->glTexStorage2D(target, description->miplevels, mapInternalTextureFormat(description->format), description->width, description->height);
 }
 
-void GLTexture::allocateTextureBuffer(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description)
+void GLTexture::allocateTextureBuffer(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description)
 {
-    glBindTexture(target, handle);
+    glDevice->getStateCache().bindTexture(target, handle);
     // Do nothing here.
 }
 
-void GLTexture::allocateTexture(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description)
+void GLTexture::allocateTexture(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description)
 {
     switch(description->type)
     {
     case AGPU_TEXTURE_1D:
-        return allocateTexture1D(device, handle, target, description);
+        return allocateTexture1D(glDevice, handle, target, description);
     case AGPU_TEXTURE_2D:
-        return allocateTexture2D(device, handle, target, description);
+        return allocateTexture2D(glDevice, handle, target, description);
     case AGPU_TEXTURE_3D:
-        return allocateTexture3D(device, handle, target, description);
+        return allocateTexture3D(glDevice, handle, target, description);
     case AGPU_TEXTURE_CUBE:
-        return allocateTextureCube(device, handle, target, description);
+        return allocateTextureCube(glDevice, handle, target, description);
     case AGPU_TEXTURE_BUFFER:
-        return allocateTextureBuffer(device, handle, target, description);
+        return allocateTextureBuffer(glDevice, handle, target, description);
     default:
         abort();
     }
 }
 
 GLTexture::GLTexture()
-    : transferBuffer(0), mappedLevel(0), mappedPointer(nullptr)
+    : transferSlot(NoTransferSlot), mappedLevel(0), mappedPointer(nullptr)
 {
 }
 
 GLTexture::~GLTexture()
 {
-    deviceForGL->onMainContextBlocking([&]() {
-        if(transferBuffer)
-        {
-            deviceForGL->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-            deviceForGL->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-            deviceForGL->glDeleteBuffers(1, &transferBuffer);
-        }
-        glDeleteTextures(1, &handle);
-    });
+    if(transferSlot != NoTransferSlot)
+        deviceForGL->pixelTransferRing.releaseSlot(transferSlot);
+    deviceForGL->deleteObjectLater(GLObjectKind::Texture, handle);
 }
 
 agpu::texture_ref GLTexture::create(const agpu::device_ref &device, agpu_texture_description *description)
 {
-    GLuint handle;
+    auto glDevice = device.as<GLDevice> ();
+    auto handle = glDevice->allocateObjectName(GLObjectKind::Texture);
     GLenum target = findTextureTarget(description);
 
-    deviceForGL->onMainContextBlocking([&]() {
-        glGenTextures(1, &handle);
-        allocateTexture(device, handle, target, description);
-        glFinish();
+    // The storage is allocated asynchronously.
+    auto allocatedDescription = *description;
+    glDevice->onMainContextAsync([=]() mutable {
+        allocateTexture(glDevice, handle, target, &allocatedDescription);
     });
 
     auto result = agpu::makeObject<GLTexture> ();
@@ -151,23 +146,15 @@ agpu::texture_ref GLTexture::create(const agpu::device_ref &device, agpu_texture
 }
 
 
-void GLTexture::createTransferBuffer(GLenum target)
-{
-    auto bufferSize = BufferTextureTransferLayout::fromDescriptionAndLevel(description, 0).size;
-    deviceForGL->glGenBuffers(1, &transferBuffer);
-    deviceForGL->glBindBuffer(target, transferBuffer);
-    deviceForGL->glBufferStorage(target, bufferSize, nullptr, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT |  GL_CLIENT_STORAGE_BIT);
-}
-
-void GLTexture::performTransferToCpu(int level)
+void GLTexture::transferToCpu(GLDevice *glDevice, GLuint handle, GLenum target, const agpu_texture_description &description, int level, GLuint destinationBuffer)
 {
-    deviceForGL->glBindBuffer(GL_PIXEL_PACK_BUFFER, transferBuffer);
-    glBindTexture(target, handle);
+    glDevice->glBindBuffer(GL_PIXEL_PACK_BUFFER, destinationBuffer);
+    glDevice->getStateCache().bindTexture(target, handle);
     bool isArray = description.layers > 1;
     if(isArray)
         return; // Can't support it.
 
-    if(isCompressed)
+    if(isCompressedTextureFormat(description.format))
     {
         printf("TODO: Readback compressed texture\n");
     }
@@ -175,17 +162,18 @@ void GLTexture::performTransferToCpu(int level)
     {
         glGetTexImage(target, level, mapExternalFormat(description.format), mapExternalFormatType(description.format), 0);
     }
-    glFinish();
 
-    deviceForGL->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDevice->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 }
 
-void GLTexture::performTransferToGpu(int level, int arrayIndex)
+void GLTexture::transferToGpu(GLDevice *glDevice, GLuint handle, GLenum target, const agpu_texture_description &description, int level, int arrayIndex, GLuint sourceBuffer, const void *sourceData)
 {
-    deviceForGL->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, transferBuffer);
-    glBindTexture(target, handle);
+    // The source data is an offset when the source buffer is not zero.
+    glDevice->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sourceBuffer);
+    glDevice->getStateCache().bindTexture(target, handle);
     auto transferLayout = BufferTextureTransferLayout::fromDescriptionAndLevel(description, level);
     bool isArray = description.layers > 1;
+    bool isCompressed = isCompressedTextureFormat(description.format);
     auto width = transferLayout.logicalWidth;
     auto height = transferLayout.logicalHeight;
     auto depth = transferLayout.logicalDepthOrArraySize;
@@ -200,9 +188,9 @@ void GLTexture::performTransferToGpu(int level, int arrayIndex)
         else
         {
             if(isArray)
-                glTexSubImage2D(target, level, 0, arrayIndex, width, 1, mapExternalFormat(description.format), mapExternalFormatType(description.format), 0);
+                glTexSubImage2D(target, level, 0, arrayIndex, width, 1, mapExternalFormat(description.format), mapExternalFormatType(description.format), sourceData);
             else
-                glTexSubImage1D(target, level, 0, width, mapExternalFormat(description.format), mapExternalFormatType(description.format), 0);
+                glTexSubImage1D(target, level, 0, width, mapExternalFormat(description.format), mapExternalFormatType(description.format), sourceData);
         }
         break;
     case AGPU_TEXTURE_BUFFER:
@@ -211,26 +199,26 @@ void GLTexture::performTransferToGpu(int level, int arrayIndex)
         if(isCompressed)
         {
             if(isArray)
-                deviceForGL->glCompressedTexSubImage3D(target, level, 0, 0, arrayIndex, width, height, 1, mapInternalTextureFormat(description.format), transferLayout.size, 0);
+                glDevice->glCompressedTexSubImage3D(target, level, 0, 0, arrayIndex, width, height, 1, mapInternalTextureFormat(description.format), transferLayout.size, sourceData);
             else
-                deviceForGL->glCompressedTexSubImage2D(target, level, 0, 0, width, height, mapInternalTextureFormat(description.format), transferLayout.size, 0);
+                glDevice->glCompressedTexSubImage2D(target, level, 0, 0, width, height, mapInternalTextureFormat(description.format), transferLayout.size, sourceData);
         }
         else
         {
             if(isArray)
-                deviceForGL->glTexSubImage3D(target, level, 0, 0, arrayIndex, width, height, 1, mapExternalFormat(description.format), mapExternalFormatType(description.format), 0);
+                glDevice->glTexSubImage3D(target, level, 0, 0, arrayIndex, width, height, 1, mapExternalFormat(description.format), mapExternalFormatType(description.format), sourceData);
             else
-                glTexSubImage2D(target, level, 0, 0, width, height, mapExternalFormat(description.format), mapExternalFormatType(description.format), 0);
+                glTexSubImage2D(target, level, 0, 0, width, height, mapExternalFormat(description.format), mapExternalFormatType(description.format), sourceData);
         }
         break;
     case AGPU_TEXTURE_3D:
         if(isCompressed)
         {
-            deviceForGL->glCompressedTexSubImage3D(target, level, 0, 0, 0, width, height, depth, mapInternalTextureFormat(description.format), transferLayout.size, 0);
+            glDevice->glCompressedTexSubImage3D(target, level, 0, 0, 0, width, height, depth, mapInternalTextureFormat(description.format), transferLayout.size, sourceData);
         }
         else
         {
-            deviceForGL->glTexSubImage3D(target, level, 0, 0, 0, width, height, depth, mapExternalFormat(description.format), mapExternalFormatType(description.format), 0);
+            glDevice->glTexSubImage3D(target, level, 0, 0, 0, width, height, depth, mapExternalFormat(description.format), mapExternalFormatType(description.format), sourceData);
         }
         break;
     case AGPU_TEXTURE_CUBE:
@@ -242,7 +230,7 @@ void GLTexture::performTransferToGpu(int level, int arrayIndex)
             }
             else
             {
-                deviceForGL->glCompressedTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + arrayIndex, level, 0, 0, width, height, mapInternalTextureFormat(description.format), transferLayout.size, 0);
+                glDevice->glCompressedTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + arrayIndex, level, 0, 0, width, height, mapInternalTextureFormat(description.format), transferLayout.size, sourceData);
             }
         }
         else
@@ -253,7 +241,7 @@ void GLTexture::performTransferToGpu(int level, int arrayIndex)
             }
             else
             {
-                glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + arrayIndex, level, 0, 0, width, height, mapExternalFormat(description.format), mapExternalFormatType(description.format), 0);
+                glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + arrayIndex, level, 0, 0, width, height, mapExternalFormat(description.format), mapExternalFormatType(description.format), sourceData);
             }
         }
         break;
@@ -261,8 +249,7 @@ void GLTexture::performTransferToGpu(int level, int arrayIndex)
         abort();
     }
 
-    glFinish();
-    deviceForGL->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDevice->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
 agpu_pointer GLTexture::mapLevel ( agpu_int level, agpu_int arrayIndex, agpu_mapping_access flags, agpu_region3d *region )
@@ -272,26 +259,31 @@ agpu_pointer GLTexture::mapLevel ( agpu_int level, agpu_int arrayIndex, agpu_map
 
     this->mappingAccess = flags;
     this->mappedLevel = level;
+    this->mappedArrayIndex = arrayIndex;
     bool isRead = mappingAccess == AGPU_READ_ONLY || mappingAccess == AGPU_READ_WRITE;
-    bool isWrite = mappingAccess == AGPU_WRITE_ONLY || mappingAccess == AGPU_READ_WRITE;
 
-    GLenum target = isWrite ? GL_PIXEL_UNPACK_BUFFER : GL_PIXEL_PACK_BUFFER;
-    GLenum access = mapMappingAccess(mappingAccess);
-
-    deviceForGL->onMainContextBlocking([&]() {
-        if(!transferBuffer)
-            createTransferBuffer(GL_PIXEL_PACK_BUFFER);
-
-        if(isRead)
-            performTransferToCpu(level);
-
-        deviceForGL->glBindBuffer(target, transferBuffer);
-        mappedPointer = deviceForGL->glMapBuffer(target, access);
-        deviceForGL->glBindBuffer(target, 0);
-    });
+    auto glDevice = deviceForGL;
+    auto &ring = glDevice->pixelTransferRing;
+    auto transferSize = BufferTextureTransferLayout::fromDescriptionAndLevel(description, level).size;
+    transferSlot = ring.acquireSlot(transferSize);
+    if(!ring.getSlotPointer(transferSlot))
+    {
+        ring.releaseSlot(transferSlot);
+        transferSlot = NoTransferSlot;
+        return nullptr;
+    }
 
-    mappedArrayIndex = arrayIndex;
+    // A write only mapping does not have to wait for the main context.
+    if(isRead)
+    {
+        glDevice->onMainContextBlocking([&]() {
+            transferToCpu(glDevice, handle, target, description, level, ring.getSlotBuffer(transferSlot));
+            ring.fenceSlot(transferSlot);
+            ring.waitForSlot(transferSlot);
+        });
+    }
 
+    mappedPointer = ring.getSlotPointer(transferSlot);
     return mappedPointer;
 }
 
@@ -300,23 +292,35 @@ agpu_error GLTexture::unmapLevel ( )
     if(!mappedPointer)
         return AGPU_INVALID_OPERATION;
 
-    //bool isRead = mappingAccess == AGPU_READ_ONLY || mappingAccess == AGPU_READ_WRITE;
     bool isWrite = mappingAccess == AGPU_WRITE_ONLY || mappingAccess == AGPU_READ_WRITE;
-    GLenum target = isWrite ? GL_PIXEL_UNPACK_BUFFER : GL_PIXEL_PACK_BUFFER;
-
-    deviceForGL->onMainContextBlocking([&]() {
-        deviceForGL->glBindBuffer(target, transferBuffer);
-        deviceForGL->glUnmapBuffer(target);
-        deviceForGL->glBindBuffer(target, 0);
-
-        if(isWrite)
-            performTransferToGpu(mappedLevel, mappedArrayIndex);
-    });
+    auto glDevice = deviceForGL;
+    auto &ring = glDevice->pixelTransferRing;
+    if(isWrite)
+        submitTransferToGpu(transferSlot, mappedLevel, mappedArrayIndex);
 
+    ring.releaseSlot(transferSlot);
+    transferSlot = NoTransferSlot;
     mappedPointer = nullptr;
     return AGPU_OK;
 }
 
+void GLTexture::submitTransferToGpu(size_t slotIndex, int level, int arrayIndex)
+{
+    // The slot is not written again until the fence after the transfer is signaled.
+    auto glDevice = deviceForGL;
+    auto ring = &glDevice->pixelTransferRing;
+    ring->markSlotWithPendingTransfer(slotIndex);
+
+    auto handle = this->handle;
+    auto target = this->target;
+    auto textureDescription = description;
+    glDevice->onMainContextAsync([=]{
+        transferToGpu(glDevice, handle, target, textureDescription, level, arrayIndex, ring->getSlotBuffer(slotIndex), nullptr);
+        ring->fenceSlot(slotIndex);
+        ring->releaseCompletedSlots();
+    });
+}
+
 agpu_error GLTexture::readTextureData ( agpu_int level, agpu_int arrayIndex, agpu_int dstPitch, agpu_int slicePitch, agpu_pointer data )
 {
     CHECK_POINTER(data);
@@ -359,11 +363,20 @@ agpu_error GLTexture::uploadTextureData ( agpu_int level, agpu_int arrayIndex, a
 
 agpu_error GLTexture::uploadTextureSubData ( agpu_int level, agpu_int arrayIndex, agpu_int pitch, agpu_int slicePitch, agpu_size3d* sourceSize, agpu_region3d* destRegion, agpu_pointer data )
 {
-    auto dst = reinterpret_cast<uint8_t*> (mapLevel(level, arrayIndex, AGPU_WRITE_ONLY, destRegion));
+    CHECK_POINTER(data);
+
+    // The data is copied into a slot of the pixel transfer ring, and it is
+    // uploaded asynchronously from there.
+    auto &ring = deviceForGL->pixelTransferRing;
+    auto transferLayout = BufferTextureTransferLayout::fromDescriptionAndLevel(description, level);
+    auto slotIndex = ring.acquireSlot(transferLayout.size);
+    auto dst = ring.getSlotPointer(slotIndex);
     if(!dst)
+    {
+        ring.releaseSlot(slotIndex);
         return AGPU_ERROR;
+    }
 
-    auto transferLayout = BufferTextureTransferLayout::fromDescriptionAndLevel(description, level);
     auto dstPitch = transferLayout.pitch;
     auto src = reinterpret_cast<uint8_t*> (data);
 
@@ -377,19 +390,21 @@ agpu_error GLTexture::uploadTextureSubData ( agpu_int level, agpu_int arrayIndex
         auto srcPitchAbs = pitch;
         if(srcPitchAbs < 0)
             srcPitchAbs = -srcPitchAbs;
+        auto rowSize = std::min(srcPitchAbs, dstPitch);
 
         auto height = transferLayout.height;
         auto fdst = dst + (height - 1)*dstPitch;
         ptrdiff_t fdstPitch = -ptrdiff_t(dstPitch);
         for (size_t y = 0; y < height; ++y)
         {
-            memcpy(fdst, src, srcPitchAbs);
+            memcpy(fdst, src, rowSize);
             fdst += fdstPitch;
             src += pitch;
         }
     }
 
-    unmapLevel();
+    submitTransferToGpu(slotIndex, level, arrayIndex);
+    ring.releaseSlot(slotIndex);
     return AGPU_OK;
 }
 
@@ -52,7 +52,9 @@ public:
     GLuint handle;
     GLenum target;
 
-    GLuint transferBuffer;
+    static constexpr size_t NoTransferSlot = ~size_t(0);
+
+    size_t transferSlot;
     agpu_mapping_access mappingAccess;
     agpu_int mappedLevel;
     agpu_uint mappedArrayIndex;
@@ -61,16 +63,16 @@ public:
     agpu::texture_view_ref fullTextureView;
 
 private:
-    static void allocateTexture(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description);
-    static void allocateTexture1D(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description);
-    static void allocateTexture2D(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description);
-    static void allocateTexture3D(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description);
-    static void allocateTextureCube(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description);
-    static void allocateTextureBuffer(const agpu::device_ref &device, GLuint handle, GLenum target, agpu_texture_description *description);
-
-    void createTransferBuffer(GLenum target);
-    void performTransferToCpu(int level);
-    void performTransferToGpu(int level, int arrayIndex);
+    static void allocateTexture(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description);
+    static void allocateTexture1D(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description);
+    static void allocateTexture2D(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description);
+    static void allocateTexture3D(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description);
+    static void allocateTextureCube(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description);
+    static void allocateTextureBuffer(GLDevice *glDevice, GLuint handle, GLenum target, agpu_texture_description *description);
+
+    void submitTransferToGpu(size_t slotIndex, int level, int arrayIndex);
+    static void transferToCpu(GLDevice *glDevice, GLuint handle, GLenum target, const agpu_texture_description &description, int level, GLuint destinationBuffer);
+    static void transferToGpu(GLDevice *glDevice, GLuint handle, GLenum target, const agpu_texture_description &description, int level, int arrayIndex, GLuint sourceBuffer, const void *sourceData);
 };
 
 } // End of namespace AgpuGL
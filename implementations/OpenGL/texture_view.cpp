@@ -30,8 +30,7 @@ GLFullTextureView::~GLFullTextureView()
 void GLFullTextureView::activateInSampledSlot(int slotIndex)
 {
     auto glTexture = texture.lock().as<GLTexture> ();
-    deviceForGL->glActiveTexture(GLenum(GL_TEXTURE0 + slotIndex));
-    glBindTexture(glTexture->target, glTexture->handle);
+    deviceForGL->getStateCache().bindTextureInUnit(GLuint(slotIndex), glTexture->target, glTexture->handle);
 }
 
 void GLFullTextureView::attachToFramebuffer(GLenum target, GLenum attachmentPoint)
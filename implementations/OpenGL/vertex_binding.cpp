@@ -7,25 +7,27 @@
 namespace AgpuGL
 {
 
+// The minimum value of GL_MAX_VERTEX_ATTRIB_BINDINGS.
+static constexpr size_t MaxMultiBindVertexBufferCount = 16;
+
 GLVertexBinding::GLVertexBinding()
 {
+    handle = 0;
     changed = true;
 }
 
 GLVertexBinding::~GLVertexBinding()
 {
-    deviceForGL->onMainContextBlocking([&] {
-        deviceForGL->glBindVertexArray(0);
-        deviceForGL->glDeleteVertexArrays(1, &handle);
-    });
+    deviceForGL->deleteObjectLater(GLObjectKind::VertexArray, handle);
 }
 
 agpu::vertex_binding_ref GLVertexBinding::createVertexBinding(const agpu::device_ref &device, const agpu::vertex_layout_ref &layout)
 {
-    GLuint handle;
-    deviceForGL->onMainContextBlocking([&] {
-        deviceForGL->glGenVertexArrays(1, &handle);
-    });
+    // The bindings share the vertex array of their layout when its format can
+    // be separated from the buffers.
+    GLuint handle = 0;
+    if(!deviceForGL->hasExtension_GL_ARB_vertex_attrib_binding)
+        handle = deviceForGL->allocateObjectName(GLObjectKind::VertexArray);
 
     auto result = agpu::makeObject<GLVertexBinding> ();
 	auto binding = result.as<GLVertexBinding> ();
@@ -37,6 +39,14 @@ agpu::vertex_binding_ref GLVertexBinding::createVertexBinding(const agpu::device
 
 void GLVertexBinding::bind()
 {
+    if(deviceForGL->hasExtension_GL_ARB_vertex_attrib_binding)
+    {
+        auto buffersAttached = vertexLayout.as<GLVertexLayout> ()->bindForVertexBinding(this);
+        if(changed || !buffersAttached)
+            updateBindings();
+        return;
+    }
+
     deviceForGL->glBindVertexArray(handle);
     if(changed)
         updateBindings();
@@ -65,12 +75,56 @@ agpu_error GLVertexBinding::bindVertexBuffersWithOffsets(agpu_uint count, agpu::
 }
 
 agpu_error GLVertexBinding::updateBindings()
+{
+    auto error = deviceForGL->hasExtension_GL_ARB_vertex_attrib_binding
+        ? updateVertexBuffers()
+        : updateAttributePointers();
+    if(error == AGPU_OK)
+        changed = false;
+    return error;
+}
+
+agpu_error GLVertexBinding::updateVertexBuffers()
+{
+    auto glVertexLayout = vertexLayout.as<GLVertexLayout> ();
+    if(vertexBuffers.size() != glVertexLayout->vertexBufferCount)
+        return AGPU_ERROR;
+
+    // Swapping the buffers does not touch the attribute formats.
+    auto bufferCount = vertexBuffers.size();
+    if(deviceForGL->hasExtension_GL_ARB_multi_bind && bufferCount <= MaxMultiBindVertexBufferCount)
+    {
+        GLuint bufferHandles[MaxMultiBindVertexBufferCount];
+        GLintptr bufferOffsets[MaxMultiBindVertexBufferCount];
+        GLsizei bufferStrides[MaxMultiBindVertexBufferCount];
+        for(size_t i = 0; i < bufferCount; ++i)
+        {
+            bufferHandles[i] = vertexBuffers[i] ? vertexBuffers[i].as<GLBuffer> ()->handle : 0;
+            bufferOffsets[i] = GLintptr(offsets[i]);
+            bufferStrides[i] = GLsizei(glVertexLayout->strides[i]);
+        }
+
+        deviceForGL->glBindVertexBuffers(0, GLsizei(bufferCount), bufferHandles, bufferOffsets, bufferStrides);
+    }
+    else
+    {
+        for(size_t i = 0; i < bufferCount; ++i)
+        {
+            auto bufferHandle = vertexBuffers[i] ? vertexBuffers[i].as<GLBuffer> ()->handle : 0;
+            deviceForGL->glBindVertexBuffer(GLuint(i), bufferHandle, GLintptr(offsets[i]), GLsizei(glVertexLayout->strides[i]));
+        }
+    }
+
+    return AGPU_OK;
+}
+
+agpu_error GLVertexBinding::updateAttributePointers()
 {
     agpu::buffer_ref prevBuffer;
     auto glVertxLayout = vertexLayout.as<GLVertexLayout> ();
     for (auto &attr : glVertxLayout->attributes)
     {
-        if (attr.buffer > vertexBuffers.size())
+        if (attr.buffer >= vertexBuffers.size())
             return AGPU_ERROR;
 
         // Bind the buffer
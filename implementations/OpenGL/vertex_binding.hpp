@@ -31,6 +31,8 @@ public:
 
     void bind();
     agpu_error updateBindings();
+    agpu_error updateVertexBuffers();
+    agpu_error updateAttributePointers();
     GLuint handle;
     bool changed;
 };
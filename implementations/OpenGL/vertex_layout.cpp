@@ -1,4 +1,6 @@
 #include "vertex_layout.hpp"
+#include "vertex_binding.hpp"
+#include "texture_formats.hpp"
 
 namespace AgpuGL
 {
@@ -6,10 +8,14 @@ namespace AgpuGL
 GLVertexLayout::GLVertexLayout()
 {
     vertexBufferCount = 0;
+    handle = 0;
+    formatSpecified = false;
+    currentBinding = nullptr;
 }
 
 GLVertexLayout::~GLVertexLayout()
 {
+    deviceForGL->deleteObjectLater(GLObjectKind::VertexArray, handle);
 }
 
 agpu::vertex_layout_ref GLVertexLayout::createVertexLayout(const agpu::device_ref &device)
@@ -29,7 +35,45 @@ agpu_error GLVertexLayout::addVertexAttributeBindings(agpu_uint vertex_buffer_co
     this->attributes.reserve(attribute_count);
     for (size_t i = 0; i < attribute_count; ++i)
         this->attributes.push_back(attributes[i]);
+    formatSpecified = false;
     return AGPU_OK;
 }
 
+bool GLVertexLayout::bindForVertexBinding(GLVertexBinding *binding)
+{
+    if(!handle)
+        handle = deviceForGL->allocateObjectName(GLObjectKind::VertexArray);
+
+    deviceForGL->glBindVertexArray(handle);
+    if(!formatSpecified)
+    {
+        specifyAttributeFormats();
+        formatSpecified = true;
+        currentBinding = nullptr;
+    }
+
+    if(currentBinding == binding)
+        return true;
+
+    currentBinding = binding;
+    return false;
+}
+
+void GLVertexLayout::specifyAttributeFormats()
+{
+    // The format is part of the vertex array, so it is only specified once
+    // for all of the bindings that use this layout.
+    for (auto &attr : attributes)
+    {
+        auto components = getFormatNumberOfComponents(attr.format);
+        auto type = mapExternalFormatType(attr.format);
+        deviceForGL->glEnableVertexAttribArray(attr.binding);
+        if(isIntegerVertexAttributeFormat(attr.format))
+            deviceForGL->glVertexAttribIFormat(attr.binding, components, type, GLuint(attr.offset));
+        else
+            deviceForGL->glVertexAttribFormat(attr.binding, components, type, isFormatNormalized(attr.format), GLuint(attr.offset));
+        deviceForGL->glVertexAttribBinding(attr.binding, attr.buffer);
+    }
+}
+
 } // End of namespace AgpuGL
@@ -7,6 +7,8 @@
 namespace AgpuGL
 {
 
+struct GLVertexBinding;
+
 /**
 * Vertex binding
 */
@@ -20,12 +22,25 @@ public:
 
     virtual agpu_error addVertexAttributeBindings(agpu_uint vertex_buffer_count, agpu_size* vertex_strides, agpu_size attribute_count, agpu_vertex_attrib_description* attributes) override;
 
+    // Binds the vertex array that is shared by the bindings of this layout,
+    // when the attribute formats can be separated from the buffers. Returns
+    // true when the buffers of the binding are already attached to it.
+    bool bindForVertexBinding(GLVertexBinding *binding);
+
 public:
     agpu::device_ref device;
 
     agpu_uint vertexBufferCount;
     std::vector<agpu_vertex_attrib_description> attributes;
     std::vector<agpu_size> strides;
+
+private:
+    void specifyAttributeFormats();
+
+    // Only used in the main context thread.
+    GLuint handle;
+    bool formatSpecified;
+    GLVertexBinding *currentBinding;
 };
 
 } // End of namespace AgpuGL
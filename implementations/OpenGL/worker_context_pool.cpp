@@ -0,0 +1,123 @@
+#include "worker_context_pool.hpp"
+#include "device.hpp"
+#include "job_queue.hpp"
+#include <algorithm>
+
+namespace AgpuGL
+{
+
+static constexpr int MaxDefaultWorkerContextCount = 4;
+
+static thread_local GLWorkerContextPool *currentWorkerContextPool = nullptr;
+
+GLWorkerContextPool::GLWorkerContextPool()
+    : device(nullptr), isShuttingDown(false)
+{
+}
+
+GLWorkerContextPool::~GLWorkerContextPool()
+{
+    shutdown();
+}
+
+void GLWorkerContextPool::initialize(GLDevice *newDevice, int threadCount)
+{
+    device = newDevice;
+    if(threadCount < 0)
+    {
+        int hardwareThreadCount = std::thread::hardware_concurrency();
+        threadCount = std::min(std::max(hardwareThreadCount - 1, 1), MaxDefaultWorkerContextCount);
+    }
+
+    for(int i = 0; i < threadCount; ++i)
+    {
+        auto context = device->mainContext->createSharedContext();
+        if(!context)
+        {
+            if(workerThreads.empty())
+                printError("Failed to create a shared OpenGL context. Shaders are compiled in the main context.\n");
+            break;
+        }
+
+        workerThreads.push_back(std::thread([=] {
+            workerThreadEntry(context);
+        }));
+    }
+}
+
+void GLWorkerContextPool::shutdown()
+{
+    if(workerThreads.empty())
+        return;
+
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        isShuttingDown = true;
+    }
+    pendingJobCondition.notify_all();
+
+    for(auto &thread : workerThreads)
+        thread.join();
+    workerThreads.clear();
+}
+
+bool GLWorkerContextPool::isWorkerThread() const
+{
+    return currentWorkerContextPool == this;
+}
+
+void GLWorkerContextPool::runBlocking(const std::function<void()> &job)
+{
+    if(!isEnabled() || isWorkerThread())
+    {
+        device->onMainContextBlocking(job);
+        return;
+    }
+
+    JobCompletion completion;
+    {
+        std::unique_lock<std::mutex> l(mutex);
+        pendingJobs.push_back([&] {
+            job();
+            completion.signal();
+        });
+    }
+    pendingJobCondition.notify_one();
+    completion.wait();
+}
+
+void GLWorkerContextPool::workerThreadEntry(OpenGLContext *context)
+{
+    currentWorkerContextPool = this;
+    auto isContextUsable = context->makeCurrent();
+    if(isContextUsable)
+        context->stateCache.initialize(device, !device->disableStateCache);
+    else
+        printError("Failed to make current a shared OpenGL context.\n");
+
+    for(;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> l(mutex);
+            while(pendingJobs.empty() && !isShuttingDown)
+                pendingJobCondition.wait(l);
+            if(pendingJobs.empty())
+                break;
+
+            job = std::move(pendingJobs.front());
+            pendingJobs.pop_front();
+        }
+
+        if(isContextUsable)
+            job();
+        else
+            device->onMainContextBlocking(job);
+    }
+
+    if(isContextUsable)
+        context->destroy();
+    delete context;
+}
+
+} // End of namespace AgpuGL
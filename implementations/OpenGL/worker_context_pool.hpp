@@ -0,0 +1,61 @@
+#ifndef AGPU_GL_WORKER_CONTEXT_POOL_HPP
+#define AGPU_GL_WORKER_CONTEXT_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace AgpuGL
+{
+
+struct GLDevice;
+struct OpenGLContext;
+
+/**
+ * Threads with contexts that share their objects with the main context. They
+ * are used for compiling shaders and linking programs, so that several
+ * pipelines can be built at the same time without going through the main
+ * context thread. The jobs must only create and use shareable objects, and
+ * they have to finish their work before the main context uses the objects.
+ * When no worker context can be created, the jobs are executed in the main
+ * context thread.
+ */
+class GLWorkerContextPool
+{
+public:
+    GLWorkerContextPool();
+    ~GLWorkerContextPool();
+
+    // Must be called in the main context thread. A negative thread count
+    // selects a default that depends on the number of processors.
+    void initialize(GLDevice *device, int threadCount);
+    void shutdown();
+
+    bool isEnabled() const
+    {
+        return !workerThreads.empty();
+    }
+
+    // Executes a job in a worker context, and waits for its completion.
+    void runBlocking(const std::function<void()> &job);
+
+private:
+    bool isWorkerThread() const;
+    void workerThreadEntry(OpenGLContext *context);
+
+    GLDevice *device;
+
+    std::mutex mutex;
+    std::condition_variable pendingJobCondition;
+    std::deque<std::function<void()>> pendingJobs;
+    bool isShuttingDown;
+
+    std::vector<std::thread> workerThreads;
+};
+
+} // End of namespace AgpuGL
+
+#endif //AGPU_GL_WORKER_CONTEXT_POOL_HPP
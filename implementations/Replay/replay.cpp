@@ -0,0 +1,777 @@
+#include "../Common/api_capture.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Replays an API capture, which is recorded by the loader when the
+ * AGPU_CAPTURE environment variable is set to the path of the capture, on
+ * any platform, and reports the frame times. The frames are delimited by the
+ * agpuSwapBuffers calls. The calls are replayed in the order of the capture,
+ * by a single thread, and the calls whose objects could not be created by the
+ * replay are skipped.
+ *
+ * The native window handles are not captured, so the swap chains are created
+ * without a window. When that fails, or in headless mode, they are replaced
+ * by offscreen framebuffers.
+ */
+
+using namespace AgpuCommon;
+
+typedef std::chrono::steady_clock ReplayClock;
+
+static void printUsage()
+{
+    fprintf(stderr,
+        "Usage: AgpuReplay [options] <capture>\n"
+        "Options:\n"
+        "  -platform <index>      The platform that replays the capture. Defaults to the first one.\n"
+        "  -headless              Opens the devices in headless mode, with offscreen swap chains.\n"
+        "  -sync                  Waits for the devices at the end of each frame.\n"
+        "  -frame-times <file>    Writes the time of each frame in milliseconds, one per line.\n");
+}
+
+/**
+ * Reader of the records of a capture. The data of the current call is copied
+ * into memory that is aligned for any type, which is released after the
+ * call. A truncated capture is reported by hasFailed.
+ */
+class ReplayReader
+{
+public:
+    ReplayReader(const uint8_t *data, size_t size)
+        : position(data), end(data + size), failed(false)
+    {
+    }
+
+    bool atEnd() const
+    {
+        return position == end;
+    }
+
+    bool hasFailed() const
+    {
+        return failed;
+    }
+
+    uint64_t unsignedValue()
+    {
+        uint64_t result = 0;
+        if(!failed && !readCaptureUnsigned(position, end, result))
+            failed = true;
+        return failed ? 0 : result;
+    }
+
+    int64_t signedValue()
+    {
+        return decodeCaptureSigned(unsignedValue());
+    }
+
+    template<typename T>
+    T value()
+    {
+        T result;
+        readValue(result);
+        return result;
+    }
+
+    uint64_t objectId()
+    {
+        return unsignedValue();
+    }
+
+    const uint8_t *bytes(size_t size)
+    {
+        if(failed || size_t(end - position) < size)
+        {
+            failed = true;
+            return nullptr;
+        }
+
+        auto result = position;
+        position += size;
+        return result;
+    }
+
+    // Reads an array count, and returns whether the array is present.
+    bool array(size_t &count, size_t elementSize)
+    {
+        auto encodedCount = unsignedValue();
+        if(!encodedCount)
+            return false;
+
+        count = size_t(encodedCount - 1);
+        if(elementSize && count > size_t(end - position) / elementSize)
+        {
+            failed = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    const char *string()
+    {
+        size_t size;
+        if(!array(size, 1))
+            return nullptr;
+
+        auto data = bytes(size);
+        auto result = reinterpret_cast<char*> (allocate(size + 1));
+        if(data)
+            memcpy(result, data, size);
+        result[size] = 0;
+        return result;
+    }
+
+    template<typename T>
+    T *structures()
+    {
+        size_t count;
+        if(!array(count, sizeof(T)))
+            return nullptr;
+
+        auto result = reinterpret_cast<T*> (allocate(count*sizeof(T)));
+        auto data = bytes(count*sizeof(T));
+        if(data)
+            memcpy(result, data, count*sizeof(T));
+        return result;
+    }
+
+    template<typename T>
+    void structureInto(T &result)
+    {
+        auto data = structures<T> ();
+        if(data)
+            result = *data;
+        else
+            memset(&result, 0, sizeof(result));
+    }
+
+    template<typename T>
+    T structureValue()
+    {
+        T result;
+        structureInto(result);
+        return result;
+    }
+
+    void *payload()
+    {
+        size_t size;
+        if(!array(size, 1))
+            return nullptr;
+
+        auto offset = signedValue();
+        auto result = allocate(size);
+        auto data = bytes(size);
+        if(data)
+            memcpy(result, data, size);
+        return result - offset;
+    }
+
+    void *scratch()
+    {
+        size_t size;
+        if(!array(size, 0))
+            return nullptr;
+
+        auto offset = signedValue();
+        return allocate(size) - offset;
+    }
+
+    uint8_t *allocate(size_t size)
+    {
+        allocations.push_back(std::vector<uint64_t> (size / sizeof(uint64_t) + 1));
+        return reinterpret_cast<uint8_t*> (&allocations.back()[0]);
+    }
+
+    void releaseAllocations()
+    {
+        allocations.clear();
+    }
+
+private:
+    void readValue(float &result)
+    {
+        auto data = bytes(sizeof(result));
+        result = 0;
+        if(data)
+            memcpy(&result, data, sizeof(result));
+    }
+
+    void readValue(double &result)
+    {
+        auto data = bytes(sizeof(result));
+        result = 0;
+        if(data)
+            memcpy(&result, data, sizeof(result));
+    }
+
+    template<typename T>
+    void readValue(T &result)
+    {
+        result = T(signedValue());
+    }
+
+    const uint8_t *position;
+    const uint8_t *end;
+    bool failed;
+    std::vector<std::vector<uint64_t>> allocations;
+};
+
+/**
+ * Framebuffer that replaces a swap chain. The views of the attachments do not
+ * keep their textures alive, so the textures are kept with the framebuffer.
+ */
+struct OffscreenSwapChain
+{
+    OffscreenSwapChain()
+        : framebuffer(nullptr), colorBuffer(nullptr), depthStencilBuffer(nullptr)
+    {
+    }
+
+    void release()
+    {
+        if(framebuffer)
+            agpuReleaseFramebuffer(framebuffer);
+        if(colorBuffer)
+            agpuReleaseTexture(colorBuffer);
+        if(depthStencilBuffer)
+            agpuReleaseTexture(depthStencilBuffer);
+        *this = OffscreenSwapChain();
+    }
+
+    agpu_framebuffer *framebuffer;
+    agpu_texture *colorBuffer;
+    agpu_texture *depthStencilBuffer;
+};
+
+/**
+ * The objects of the replay, indexed by their identifier in the capture,
+ * and the frame times.
+ */
+class ReplayState
+{
+public:
+    ReplayState()
+        : platform_(nullptr), headless(false), synchronizeFrames(false),
+          unresolvedObject(false), callCount(0), skippedCallCount(0)
+    {
+        lastFrameEnd = ReplayClock::now();
+    }
+
+    template<typename T>
+    T *object(uint64_t id)
+    {
+        if(!id)
+            return nullptr;
+
+        auto result = id < objectTable.size() ? objectTable[id] : nullptr;
+        if(!result)
+            unresolvedObject = true;
+        return static_cast<T*> (result);
+    }
+
+    template<typename T>
+    T *object(ReplayReader &reader)
+    {
+        return object<T> (reader.objectId());
+    }
+
+    template<typename T>
+    T **objects(ReplayReader &reader)
+    {
+        size_t count;
+        if(!reader.array(count, 1))
+            return nullptr;
+
+        auto result = reinterpret_cast<T**> (reader.allocate(count*sizeof(T*)));
+        for(size_t i = 0; i < count; ++i)
+            result[i] = object<T> (reader);
+        return result;
+    }
+
+    // Every captured platform is replayed by the selected platform.
+    agpu_platform *platform(ReplayReader &reader)
+    {
+        reader.objectId();
+        return platform_;
+    }
+
+    void setObject(uint64_t id, void *object)
+    {
+        if(!id || id > MaxObjectId)
+            return;
+
+        if(id >= objectTable.size())
+            objectTable.resize(id + 1, nullptr);
+        objectTable[id] = object;
+    }
+
+    // Returns whether the call can be replayed, after reading its arguments.
+    bool beginCall(ReplayReader &reader, bool requiresAllObjects = true)
+    {
+        ++callCount;
+        auto hadUnresolvedObject = unresolvedObject;
+        unresolvedObject = false;
+        if(reader.hasFailed() || (requiresAllObjects && hadUnresolvedObject))
+        {
+            ++skippedCallCount;
+            return false;
+        }
+
+        return true;
+    }
+
+    agpu_pointer encodedCommands(ReplayReader &reader);
+
+    void writeMappedBuffer(ReplayReader &reader);
+    void createOffscreenSwapChain(uint64_t id, agpu_device *device, const agpu_swap_chain_create_info &info);
+    void endFrame();
+    void finish();
+    void report(double totalSeconds, const std::string &frameTimesPath);
+
+    static constexpr uint64_t MaxObjectId = uint64_t(1) << 32;
+
+    agpu_platform *platform_;
+    bool headless;
+    bool synchronizeFrames;
+
+    std::vector<void*> objectTable;
+    bool unresolvedObject;
+    size_t callCount;
+    size_t skippedCallCount;
+
+    std::unordered_map<uint64_t, uint8_t*> mappedBuffers;
+    std::unordered_map<uint64_t, OffscreenSwapChain> offscreenSwapChains;
+    std::vector<agpu_device*> devices;
+
+    ReplayClock::time_point lastFrameEnd;
+    std::vector<double> frameTimes;
+};
+
+agpu_pointer ReplayState::encodedCommands(ReplayReader &reader)
+{
+    size_t size;
+    if(!reader.array(size, 1))
+        return nullptr;
+
+    auto commands = reader.allocate(size);
+    auto data = reader.bytes(size);
+    if(data)
+        memcpy(commands, data, size);
+
+    size_t pointedDataCount = size_t(reader.unsignedValue());
+    std::vector<void*> pointedData;
+    for(size_t i = 0; i < pointedDataCount && !reader.hasFailed(); ++i)
+    {
+        auto dataSize = size_t(reader.unsignedValue());
+        auto copy = reader.allocate(dataSize);
+        auto data = reader.bytes(dataSize);
+        if(data)
+            memcpy(copy, data, dataSize);
+        pointedData.push_back(copy);
+    }
+
+    if(reader.hasFailed())
+        return nullptr;
+
+    forEachEncodedCommandArgument(commands, size, [&](uint32_t opcode, size_t index, char kind, uint64_t *arguments) {
+        (void)opcode;
+        if(kind == 'r')
+        {
+            arguments[index] = uint64_t(uintptr_t(object<void> (arguments[index])));
+        }
+        else if(kind == 'p' && arguments[index])
+        {
+            auto dataIndex = arguments[index] - 1;
+            arguments[index] = dataIndex < pointedData.size() ? uint64_t(uintptr_t(pointedData[dataIndex])) : 0;
+        }
+    });
+    return commands;
+}
+
+void ReplayState::writeMappedBuffer(ReplayReader &reader)
+{
+    auto bufferId = reader.objectId();
+    auto offset = size_t(reader.unsignedValue());
+    auto size = size_t(reader.unsignedValue());
+    auto data = reader.bytes(size);
+    auto it = mappedBuffers.find(bufferId);
+    if(data && it != mappedBuffers.end())
+        memcpy(it->second + offset, data, size);
+}
+
+static agpu_texture *createOffscreenAttachment(agpu_device *device, agpu_uint width, agpu_uint height, agpu_texture_format format, agpu_texture_usage_mode_mask usageModes, agpu_texture_usage_mode_mask mainUsageMode)
+{
+    agpu_texture_description description;
+    memset(&description, 0, sizeof(description));
+    description.type = AGPU_TEXTURE_2D;
+    description.width = width;
+    description.height = height;
+    description.depth = 1;
+    description.layers = 1;
+    description.miplevels = 1;
+    description.format = format;
+    description.usage_modes = usageModes;
+    description.main_usage_mode = mainUsageMode;
+    description.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+    description.sample_count = 1;
+    return agpuCreateTexture(device, &description);
+}
+
+void ReplayState::createOffscreenSwapChain(uint64_t id, agpu_device *device, const agpu_swap_chain_create_info &info)
+{
+    auto &offscreenSwapChain = offscreenSwapChains[id];
+    offscreenSwapChain.release();
+
+    offscreenSwapChain.colorBuffer = createOffscreenAttachment(device, info.width, info.height, info.colorbuffer_format,
+        agpu_texture_usage_mode_mask(AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT | AGPU_TEXTURE_USAGE_SAMPLED), AGPU_TEXTURE_USAGE_SAMPLED);
+    if(!offscreenSwapChain.colorBuffer)
+    {
+        offscreenSwapChains.erase(id);
+        return;
+    }
+
+    if(info.depth_stencil_format != AGPU_TEXTURE_FORMAT_UNKNOWN)
+    {
+        auto hasStencil = info.depth_stencil_format == AGPU_TEXTURE_FORMAT_D24_UNORM_S8_UINT ||
+            info.depth_stencil_format == AGPU_TEXTURE_FORMAT_D32_FLOAT_S8X24_UINT;
+        auto usageModes = hasStencil
+            ? agpu_texture_usage_mode_mask(AGPU_TEXTURE_USAGE_DEPTH_ATTACHMENT | AGPU_TEXTURE_USAGE_STENCIL_ATTACHMENT)
+            : AGPU_TEXTURE_USAGE_DEPTH_ATTACHMENT;
+        offscreenSwapChain.depthStencilBuffer = createOffscreenAttachment(device, info.width, info.height, info.depth_stencil_format, usageModes, usageModes);
+    }
+
+    auto colorView = agpuGetOrCreateFullTextureView(offscreenSwapChain.colorBuffer);
+    auto depthStencilView = offscreenSwapChain.depthStencilBuffer ? agpuGetOrCreateFullTextureView(offscreenSwapChain.depthStencilBuffer) : nullptr;
+    offscreenSwapChain.framebuffer = agpuCreateFrameBuffer(device, info.width, info.height, 1, &colorView, depthStencilView);
+    agpuReleaseTextureView(colorView);
+    if(depthStencilView)
+        agpuReleaseTextureView(depthStencilView);
+
+    if(!offscreenSwapChain.framebuffer)
+    {
+        offscreenSwapChain.release();
+        offscreenSwapChains.erase(id);
+    }
+}
+
+void ReplayState::endFrame()
+{
+    if(synchronizeFrames)
+    {
+        for(auto device : devices)
+            agpuFinishDeviceExecution(device);
+    }
+
+    auto now = ReplayClock::now();
+    frameTimes.push_back(std::chrono::duration<double, std::milli> (now - lastFrameEnd).count());
+    lastFrameEnd = now;
+}
+
+void ReplayState::finish()
+{
+    for(auto device : devices)
+        agpuFinishDeviceExecution(device);
+
+    // The offscreen swap chains are released before their devices.
+    for(auto &offscreenSwapChain : offscreenSwapChains)
+        offscreenSwapChain.second.release();
+    offscreenSwapChains.clear();
+
+    for(auto device : devices)
+        agpuReleaseDevice(device);
+    devices.clear();
+}
+
+void ReplayState::report(double totalSeconds, const std::string &frameTimesPath)
+{
+    printf("Replayed calls: %zu\n", callCount);
+    printf("Skipped calls: %zu\n", skippedCallCount);
+    printf("Total time: %.3f ms\n", totalSeconds*1000.0);
+    printf("Frames: %zu\n", frameTimes.size());
+
+    if(!frameTimesPath.empty())
+    {
+        auto f = fopen(frameTimesPath.c_str(), "w");
+        if(f)
+        {
+            for(auto frameTime : frameTimes)
+                fprintf(f, "%.4f\n", frameTime);
+            fclose(f);
+        }
+        else
+        {
+            fprintf(stderr, "Failed to write the frame times into %s\n", frameTimesPath.c_str());
+        }
+    }
+
+    // The first frame includes the creation of the resources.
+    if(frameTimes.size() < 2)
+        return;
+
+    printf("First frame: %.3f ms\n", frameTimes[0]);
+    std::vector<double> sorted(frameTimes.begin() + 1, frameTimes.end());
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0;
+    for(auto frameTime : sorted)
+        sum += frameTime;
+
+    auto percentile = [&](double fraction) {
+        return sorted[std::min(sorted.size() - 1, size_t(fraction*sorted.size()))];
+    };
+    printf("Frame time: min %.3f ms, mean %.3f ms, median %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+        sorted.front(), sum / sorted.size(), percentile(0.5), percentile(0.95), percentile(0.99), sorted.back());
+}
+
+template<typename T>
+static T *replayStructures(ReplayReader &reader, ReplayState &state)
+{
+    size_t count;
+    if(!reader.array(count, 1))
+        return nullptr;
+
+    auto result = reinterpret_cast<T*> (reader.allocate(count*sizeof(T)));
+    memset(result, 0, count*sizeof(T));
+    for(size_t i = 0; i < count; ++i)
+        replayStructure(reader, state, result[i]);
+    return result;
+}
+
+static void replayOverrideOpenDevice(ReplayReader &reader, ReplayState &state, agpu_platform *platform, agpu_device_open_info *openInfo, uint64_t resultId)
+{
+    if(!state.beginCall(reader) || !openInfo)
+    {
+        state.setObject(resultId, nullptr);
+        return;
+    }
+
+    if(state.headless)
+        openInfo->window_system_name = "headless";
+
+    auto device = agpuOpenDevice(platform, openInfo);
+    if(device)
+    {
+        agpuAddDeviceReference(device);
+        state.devices.push_back(device);
+    }
+    else
+    {
+        fprintf(stderr, "Failed to open a device\n");
+    }
+
+    state.setObject(resultId, device);
+}
+
+// The swap chain that is replaced by this one may be an offscreen swap chain.
+static void replayOverrideCreateSwapChain(ReplayReader &reader, ReplayState &state, uint64_t deviceId, agpu_device *device, agpu_command_queue *commandQueue, agpu_swap_chain_create_info *swapChainInfo, uint64_t resultId)
+{
+    (void)deviceId;
+    agpu_swap_chain *swapChain = nullptr;
+    if(state.beginCall(reader, false) && device && swapChainInfo)
+    {
+        if(!state.headless)
+            swapChain = agpuCreateSwapChain(device, commandQueue, swapChainInfo);
+        if(!swapChain)
+            state.createOffscreenSwapChain(resultId, device, *swapChainInfo);
+    }
+
+    state.setObject(resultId, swapChain);
+}
+
+static void replayOverrideSwapBuffers(ReplayReader &reader, ReplayState &state, uint64_t swapChainId, agpu_swap_chain *swapChain)
+{
+    (void)swapChainId;
+    if(state.beginCall(reader, false) && swapChain)
+        agpuSwapBuffers(swapChain);
+    state.endFrame();
+}
+
+static void replayOverrideGetCurrentBackBuffer(ReplayReader &reader, ReplayState &state, uint64_t swapChainId, agpu_swap_chain *swapChain, uint64_t resultId)
+{
+    agpu_framebuffer *framebuffer = nullptr;
+    if(state.beginCall(reader, false))
+    {
+        if(swapChain)
+        {
+            framebuffer = agpuGetCurrentBackBuffer(swapChain);
+        }
+        else
+        {
+            auto it = state.offscreenSwapChains.find(swapChainId);
+            if(it != state.offscreenSwapChains.end())
+            {
+                framebuffer = it->second.framebuffer;
+                agpuAddFramebufferReference(framebuffer);
+            }
+        }
+    }
+
+    state.setObject(resultId, framebuffer);
+}
+
+static void replayOverrideMapBuffer(ReplayReader &reader, ReplayState &state, uint64_t bufferId, agpu_buffer *buffer, agpu_mapping_access flags)
+{
+    if(!state.beginCall(reader))
+        return;
+
+    auto pointer = agpuMapBuffer(buffer, flags);
+    if(pointer)
+        state.mappedBuffers[bufferId] = reinterpret_cast<uint8_t*> (pointer);
+}
+
+static void replayOverrideUnmapBuffer(ReplayReader &reader, ReplayState &state, uint64_t bufferId, agpu_buffer *buffer)
+{
+    state.mappedBuffers.erase(bufferId);
+    if(state.beginCall(reader))
+        agpuUnmapBuffer(buffer);
+}
+
+typedef void (*ReplayFunction)(ReplayReader &reader, ReplayState &state);
+
+#include "replay.inc"
+
+static_assert(sizeof(ReplayFunctions) / sizeof(ReplayFunctions[0]) == CaptureEntryPointCount,
+    "replay.inc is out of date with api_capture.inc. Regenerate them with definitions/make_api_capture.py");
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &data)
+{
+    auto f = fopen(path.c_str(), "rb");
+    if(!f)
+        return false;
+
+    uint8_t buffer[1 << 16];
+    size_t readCount;
+    while((readCount = fread(buffer, 1, sizeof(buffer), f)) != 0)
+        data.insert(data.end(), buffer, buffer + readCount);
+    fclose(f);
+    return true;
+}
+
+static agpu_platform *selectPlatform(size_t platformIndex)
+{
+    agpu_size platformCount = 0;
+    agpuGetPlatforms(0, nullptr, &platformCount);
+    if(platformIndex >= platformCount)
+        return nullptr;
+
+    std::vector<agpu_platform*> platforms(platformCount);
+    agpuGetPlatforms(platformCount, &platforms[0], &platformCount);
+    return platforms[platformIndex];
+}
+
+int main(int argc, const char **argv)
+{
+    std::string capturePath;
+    std::string frameTimesPath;
+    size_t platformIndex = 0;
+    ReplayState state;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "-platform" && i + 1 < argc)
+        {
+            platformIndex = size_t(atoi(argv[++i]));
+        }
+        else if(arg == "-headless")
+        {
+            state.headless = true;
+        }
+        else if(arg == "-sync")
+        {
+            state.synchronizeFrames = true;
+        }
+        else if(arg == "-frame-times" && i + 1 < argc)
+        {
+            frameTimesPath = argv[++i];
+        }
+        else if(arg == "-h" || arg == "-help" || arg == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if(!arg.empty() && arg[0] != '-' && capturePath.empty())
+        {
+            capturePath = arg;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if(capturePath.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<uint8_t> capture;
+    if(!readFile(capturePath, capture))
+    {
+        fprintf(stderr, "Failed to read the capture %s\n", capturePath.c_str());
+        return 1;
+    }
+
+    if(capture.size() < sizeof(ApiCaptureMagic) || memcmp(&capture[0], ApiCaptureMagic, sizeof(ApiCaptureMagic)) != 0)
+    {
+        fprintf(stderr, "%s is not an AGPU capture\n", capturePath.c_str());
+        return 1;
+    }
+
+    ReplayReader reader(&capture[0] + sizeof(ApiCaptureMagic), capture.size() - sizeof(ApiCaptureMagic));
+    auto version = reader.unsignedValue();
+    auto entryPointCount = reader.unsignedValue();
+    if(version != ApiCaptureVersion || entryPointCount != CaptureEntryPointCount)
+    {
+        fprintf(stderr, "The capture %s was recorded by an incompatible version of AGPU\n", capturePath.c_str());
+        return 1;
+    }
+
+    state.platform_ = selectPlatform(platformIndex);
+    if(!state.platform_)
+    {
+        fprintf(stderr, "Failed to get the AGPU platform %zu\n", platformIndex);
+        return 1;
+    }
+
+    printf("Platform: %s\n", agpuGetPlatformName(state.platform_));
+
+    auto startTime = ReplayClock::now();
+    state.lastFrameEnd = startTime;
+    while(!reader.atEnd() && !reader.hasFailed())
+    {
+        auto kind = reader.unsignedValue();
+        if(kind == ApiCaptureRecordMappedBufferWrite)
+        {
+            state.writeMappedBuffer(reader);
+        }
+        else if(kind >= ApiCaptureRecordFirstCall && kind < ApiCaptureRecordFirstCall + CaptureEntryPointCount)
+        {
+            ReplayFunctions[kind - ApiCaptureRecordFirstCall](reader, state);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown record kind %llu in the capture\n", (unsigned long long)kind);
+            break;
+        }
+
+        reader.releaseAllocations();
+    }
+
+    if(reader.hasFailed())
+        fprintf(stderr, "The capture is truncated\n");
+
+    state.finish();
+    auto totalSeconds = std::chrono::duration<double> (ReplayClock::now() - startTime).count();
+    state.report(totalSeconds, frameTimesPath);
+    return 0;
+}
@@ -0,0 +1,10 @@
+// The objects of the common interfaces need the dispatch table of the ICDs.
+#include <AGPU/agpu_impl_dispatch.inc>
+
+// The shader pack builder does not provide any platform.
+AGPU_EXPORT agpu_error agpuGetPlatforms(agpu_size numplatforms, agpu_platform** platforms, agpu_size* ret_numplatforms)
+{
+    if(ret_numplatforms)
+        *ret_numplatforms = 0;
+    return AGPU_OK;
+}
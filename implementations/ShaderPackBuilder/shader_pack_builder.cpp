@@ -0,0 +1,435 @@
+#include "../Common/offline_shader_compiler.hpp"
+#include "../Common/shader_archive.hpp"
+#include "../Common/disk_cache.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Compiles the shaders that are listed in a manifest, and packs them into a
+ * shader archive, which is opened at runtime with agpuOpenShaderArchive.
+ *
+ * Each line of the manifest describes a shader, as a name, a stage, the path
+ * of the source file, relative to the manifest, and the compiler options:
+ *
+ *     basic.vertex vertex basic.glsl -DBUILD_VERTEX_SHADER
+ *
+ * An option between braces is a list of alternatives that are separated by
+ * '|', and the shader is compiled once for each alternative. An alternative
+ * is made of a label and of options separated by ',', such as
+ * "lit:-DLIGHTING,-DPER_FRAGMENT". The labels are appended to the name of
+ * the shader, separated by dots, and an empty alternative leaves the options
+ * out. The text after a '#' is a comment. The sources are Vulkan flavored
+ * GLSL, unless their extension is .hlsl.
+ */
+
+using namespace AgpuCommon;
+
+struct ManifestShader
+{
+    std::string name;
+    agpu_shader_type stage;
+    agpu_shader_language language;
+    std::string sourcePath;
+    std::string options;
+    size_t lineNumber;
+};
+
+struct OptionAlternative
+{
+    std::string label;
+    std::string options;
+};
+
+typedef std::vector<OptionAlternative> OptionGroup;
+
+static void printUsage()
+{
+    fprintf(stderr,
+        "Usage: AgpuShaderPackBuilder [options] <manifest>\n"
+        "Options:\n"
+        "  -o <archive>                  The output archive. Defaults to the manifest with the .shaderpack extension.\n"
+        "  -profile <debug|release|size> The compilation profile. Defaults to release.\n"
+        "  -threads <count>              The number of compilation threads. Defaults to one per core.\n");
+}
+
+static bool parseStage(const std::string &name, agpu_shader_type &stage)
+{
+    static const struct
+    {
+        const char *name;
+        agpu_shader_type stage;
+    } stages[] = {
+        {"vertex", AGPU_VERTEX_SHADER},
+        {"fragment", AGPU_FRAGMENT_SHADER},
+        {"geometry", AGPU_GEOMETRY_SHADER},
+        {"compute", AGPU_COMPUTE_SHADER},
+        {"tessellation_control", AGPU_TESSELLATION_CONTROL_SHADER},
+        {"tessellation_evaluation", AGPU_TESSELLATION_EVALUATION_SHADER},
+    };
+
+    for(auto &entry : stages)
+    {
+        if(name == entry.name)
+        {
+            stage = entry.stage;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool parseProfile(const std::string &name, agpu_offline_shader_compilation_profile &profile)
+{
+    if(name == "debug")
+        profile = AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_DEBUG;
+    else if(name == "release")
+        profile = AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_RELEASE;
+    else if(name == "size")
+        profile = AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_SIZE;
+    else
+        return false;
+    return true;
+}
+
+static bool endsWith(const std::string &string, const std::string &suffix)
+{
+    return string.size() >= suffix.size() && string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::string directoryOf(const std::string &path)
+{
+    auto separator = path.find_last_of("/\\");
+    if(separator == std::string::npos)
+        return std::string();
+    return path.substr(0, separator + 1);
+}
+
+static bool isAbsolutePath(const std::string &path)
+{
+    if(path.empty())
+        return false;
+    if(path[0] == '/' || path[0] == '\\')
+        return true;
+    return path.size() > 1 && path[1] == ':';
+}
+
+static std::vector<std::string> splitString(const std::string &string, char separator)
+{
+    std::vector<std::string> result;
+    size_t start = 0;
+    for(;;)
+    {
+        auto end = string.find(separator, start);
+        if(end == std::string::npos)
+        {
+            result.push_back(string.substr(start));
+            return result;
+        }
+
+        result.push_back(string.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+static std::vector<std::string> tokenizeLine(const std::string &line)
+{
+    std::vector<std::string> tokens;
+    size_t position = 0;
+    while(position < line.size())
+    {
+        while(position < line.size() && isspace((unsigned char)line[position]))
+            ++position;
+        if(position >= line.size() || line[position] == '#')
+            break;
+
+        auto start = position;
+        while(position < line.size() && !isspace((unsigned char)line[position]))
+            ++position;
+        tokens.push_back(line.substr(start, position - start));
+    }
+
+    return tokens;
+}
+
+static OptionGroup parseOptionGroup(const std::string &token)
+{
+    OptionGroup group;
+    for(auto &alternativeText : splitString(token.substr(1, token.size() - 2), '|'))
+    {
+        OptionAlternative alternative;
+        auto labelEnd = alternativeText.find(':');
+        auto optionsText = alternativeText;
+        if(labelEnd != std::string::npos)
+        {
+            alternative.label = alternativeText.substr(0, labelEnd);
+            optionsText = alternativeText.substr(labelEnd + 1);
+        }
+
+        if(!optionsText.empty())
+        {
+            for(auto &option : splitString(optionsText, ','))
+            {
+                if(option.empty())
+                    continue;
+                if(!alternative.options.empty())
+                    alternative.options += ' ';
+                alternative.options += option;
+            }
+        }
+
+        group.push_back(alternative);
+    }
+
+    return group;
+}
+
+static void expandPermutations(const ManifestShader &base, const std::vector<OptionGroup> &groups, size_t groupIndex, std::vector<ManifestShader> &shaders)
+{
+    if(groupIndex == groups.size())
+    {
+        shaders.push_back(base);
+        return;
+    }
+
+    for(auto &alternative : groups[groupIndex])
+    {
+        auto shader = base;
+        if(!alternative.label.empty())
+            shader.name += "." + alternative.label;
+        if(!alternative.options.empty())
+        {
+            if(!shader.options.empty())
+                shader.options += ' ';
+            shader.options += alternative.options;
+        }
+
+        expandPermutations(shader, groups, groupIndex + 1, shaders);
+    }
+}
+
+static bool parseManifest(const std::string &manifestPath, std::vector<ManifestShader> &shaders)
+{
+    std::vector<uint8_t> content;
+    if(!readCacheFile(manifestPath, content))
+    {
+        fprintf(stderr, "Failed to read the manifest %s\n", manifestPath.c_str());
+        return false;
+    }
+
+    auto manifestDirectory = directoryOf(manifestPath);
+    auto lines = splitString(std::string(content.begin(), content.end()), '\n');
+    for(size_t i = 0; i < lines.size(); ++i)
+    {
+        auto tokens = tokenizeLine(lines[i]);
+        if(tokens.empty())
+            continue;
+
+        if(tokens.size() < 3)
+        {
+            fprintf(stderr, "%s:%zu: Expected a shader name, a stage and a source file\n", manifestPath.c_str(), i + 1);
+            return false;
+        }
+
+        ManifestShader shader;
+        shader.name = tokens[0];
+        shader.lineNumber = i + 1;
+        if(!parseStage(tokens[1], shader.stage))
+        {
+            fprintf(stderr, "%s:%zu: Unknown shader stage %s\n", manifestPath.c_str(), i + 1, tokens[1].c_str());
+            return false;
+        }
+
+        shader.sourcePath = isAbsolutePath(tokens[2]) ? tokens[2] : manifestDirectory + tokens[2];
+        shader.language = endsWith(shader.sourcePath, ".hlsl") ? AGPU_SHADER_LANGUAGE_HLSL : AGPU_SHADER_LANGUAGE_VGLSL;
+
+        std::vector<OptionGroup> groups;
+        for(size_t j = 3; j < tokens.size(); ++j)
+        {
+            auto &token = tokens[j];
+            if(token.size() >= 2 && token.front() == '{' && token.back() == '}')
+            {
+                groups.push_back(parseOptionGroup(token));
+                continue;
+            }
+
+            if(!shader.options.empty())
+                shader.options += ' ';
+            shader.options += token;
+        }
+
+        expandPermutations(shader, groups, 0, shaders);
+    }
+
+    return true;
+}
+
+// The shaders that are embedded in C++ sources, such as the uber shader of
+// the immediate renderer, are stored as raw string literals.
+static std::string unwrapRawStringLiteral(const std::string &source)
+{
+    auto start = source.find_first_not_of(" \t\r\n");
+    if(start == std::string::npos || source.compare(start, 2, "R\"") != 0)
+        return source;
+
+    auto delimiterStart = start + 2;
+    auto delimiterEnd = source.find('(', delimiterStart);
+    if(delimiterEnd == std::string::npos)
+        return source;
+
+    auto terminator = ")" + source.substr(delimiterStart, delimiterEnd - delimiterStart) + "\"";
+    auto end = source.rfind(terminator);
+    if(end == std::string::npos || end < delimiterEnd)
+        return source;
+
+    return source.substr(delimiterEnd + 1, end - delimiterEnd - 1);
+}
+
+int main(int argc, const char **argv)
+{
+    std::string manifestPath;
+    std::string outputPath;
+    agpu_offline_shader_compilation_profile profile = AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_RELEASE;
+    agpu_uint threadCount = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "-o" && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if(arg == "-profile" && i + 1 < argc)
+        {
+            if(!parseProfile(argv[++i], profile))
+            {
+                fprintf(stderr, "Unknown compilation profile %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if(arg == "-threads" && i + 1 < argc)
+        {
+            threadCount = agpu_uint(atoi(argv[++i]));
+        }
+        else if(arg == "-h" || arg == "-help" || arg == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if(!arg.empty() && arg[0] != '-' && manifestPath.empty())
+        {
+            manifestPath = arg;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if(manifestPath.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    if(outputPath.empty())
+    {
+        auto extension = manifestPath.find_last_of('.');
+        auto separator = manifestPath.find_last_of("/\\");
+        if(extension != std::string::npos && (separator == std::string::npos || extension > separator))
+            outputPath = manifestPath.substr(0, extension);
+        else
+            outputPath = manifestPath;
+        outputPath += ".shaderpack";
+    }
+
+    std::vector<ManifestShader> shaders;
+    if(!parseManifest(manifestPath, shaders))
+        return 1;
+
+    // Read each of the sources once.
+    std::map<std::string, std::string> sources;
+    for(auto &shader : shaders)
+    {
+        if(sources.find(shader.sourcePath) != sources.end())
+            continue;
+
+        std::vector<uint8_t> content;
+        if(!readCacheFile(shader.sourcePath, content))
+        {
+            fprintf(stderr, "%s:%zu: Failed to read the source file %s\n", manifestPath.c_str(), shader.lineNumber, shader.sourcePath.c_str());
+            return 1;
+        }
+
+        sources[shader.sourcePath] = unwrapRawStringLiteral(std::string(content.begin(), content.end()));
+    }
+
+    // Compile all of the shaders in a single batch.
+    std::vector<agpu_offline_shader_compilation_job> jobs(shaders.size());
+    for(size_t i = 0; i < shaders.size(); ++i)
+    {
+        auto &shader = shaders[i];
+        auto &source = sources[shader.sourcePath];
+        auto &job = jobs[i];
+        memset(&job, 0, sizeof(job));
+        job.source_language = shader.language;
+        job.stage = shader.stage;
+        job.source_text = source.c_str();
+        job.source_text_length = agpu_string_length(source.size());
+        job.target_language = AGPU_SHADER_LANGUAGE_SPIR_V;
+        job.options = shader.options.c_str();
+        job.profile = profile;
+    }
+
+    auto compiler = GLSLangOfflineShaderCompiler::create();
+    compiler->compileShaderBatch(jobs.size(), jobs.empty() ? nullptr : &jobs[0], threadCount);
+
+    ShaderArchiveWriter writer;
+    bool succeeded = true;
+    for(size_t i = 0; i < shaders.size(); ++i)
+    {
+        auto &shader = shaders[i];
+        auto &job = jobs[i];
+        auto jobCompiler = agpu::offline_shader_compiler_ref::import(job.compiler);
+        if(job.result != AGPU_OK)
+        {
+            auto logLength = jobCompiler ? jobCompiler->getCompilationLogLength() : 0;
+            std::unique_ptr<char[]> log(new char[logLength + 1]);
+            log[0] = 0;
+            if(logLength > 0)
+                jobCompiler->getCompilationLog(logLength + 1, log.get());
+
+            fprintf(stderr, "%s:%zu: Failed to compile %s:\n%s\n", manifestPath.c_str(), shader.lineNumber, shader.name.c_str(), log.get());
+            succeeded = false;
+            continue;
+        }
+
+        auto codeSize = jobCompiler->getCompilationResultLength();
+        std::vector<uint8_t> code(codeSize);
+        if(codeSize > 0)
+            jobCompiler->getCompilationResult(codeSize, reinterpret_cast<agpu_string_buffer> (&code[0]));
+
+        if(!writer.addShader(shader.name, shader.stage, AGPU_SHADER_LANGUAGE_SPIR_V, code.data(), code.size()))
+        {
+            fprintf(stderr, "%s:%zu: Duplicated shader name %s\n", manifestPath.c_str(), shader.lineNumber, shader.name.c_str());
+            succeeded = false;
+        }
+    }
+
+    if(!succeeded)
+        return 1;
+
+    if(!writer.writeToFile(outputPath))
+    {
+        fprintf(stderr, "Failed to write the shader archive %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    printf("Packed %zu shaders with %zu unique modules into %s\n", writer.getShaderCount(), writer.getUniqueCodeCount(), outputPath.c_str());
+    return 0;
+}
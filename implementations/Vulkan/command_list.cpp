@@ -10,6 +10,7 @@
 #include "shader_signature.hpp"
 #include "shader_resource_binding.hpp"
 #include "constants.hpp"
+#include "../Common/encoded_commands.hpp"
 
 namespace AgpuVulkan
 {
@@ -82,6 +83,13 @@ agpu::command_list_ref AVkCommandList::create(const agpu::device_ref &device, ag
 
 agpu_error AVkCommandList::close()
 {
+    while(!textureTransitionStack.empty())
+        popTextureTransitionBarrier();
+
+    // Leave the textures in their main usage mode for the following command lists.
+    textureLayoutTracker.restoreMainUsageModes();
+    textureLayoutTracker.flush(commandBuffer);
+
     while(!bufferTransitionStack.empty())
         popBufferTransitionBarrier();
 
@@ -164,6 +172,9 @@ void AVkCommandList::resetState()
     drawIndirectBuffer.reset();
     computeDispatchIndirectBuffer.reset();
     shaderSignature.reset();
+    textureLayoutTracker.reset();
+    textureTransitionStack.clear();
+    bufferTransitionStack.clear();
 
     isSecondaryContent = false;
 
@@ -181,11 +192,6 @@ agpu_buffer_usage_mask AVkCommandList::getCurrentBufferUsageMode(const agpu::buf
     return buffer.as<AVkBuffer> ()->description.main_usage_mode;
 }
 
-agpu_texture_usage_mode_mask AVkCommandList::getCurrentTextureUsageMode(const agpu::texture_ref &texture)
-{
-    return texture.as<AVkTexture> ()->description.main_usage_mode;
-}
-
 agpu_error AVkCommandList::setShaderSignature(const agpu::shader_signature_ref &signature)
 {
     CHECK_POINTER(signature);
@@ -335,6 +341,7 @@ agpu_error AVkCommandList::drawElementsIndirect(agpu_size offset, agpu_size draw
 
 agpu_error AVkCommandList::dispatchCompute ( agpu_uint group_count_x, agpu_uint group_count_y, agpu_uint group_count_z )
 {
+    textureLayoutTracker.flush(commandBuffer);
     vkCmdDispatch(commandBuffer, group_count_x, group_count_y, group_count_z);
     return AGPU_OK;
 }
@@ -344,6 +351,7 @@ agpu_error AVkCommandList::dispatchComputeIndirect ( agpu_size offset )
     if (!computeDispatchIndirectBuffer)
         return AGPU_INVALID_OPERATION;
 
+    textureLayoutTracker.flush(commandBuffer);
     vkCmdDispatchIndirect(commandBuffer, computeDispatchIndirectBuffer.as<AVkBuffer> ()->handle, offset);
     return AGPU_OK;
 }
@@ -361,25 +369,53 @@ agpu_error AVkCommandList::executeBundle(const agpu::command_list_ref &bundle)
     if (!avkBundle->isClosed || !avkBundle->isSecondaryContent)
         return AGPU_INVALID_PARAMETER;
 
+    if(!currentFramebuffer)
+        textureLayoutTracker.flush(commandBuffer);
     vkCmdExecuteCommands(commandBuffer, 1, &avkBundle->commandBuffer);
     return AGPU_OK;
 }
 
-agpu_error AVkCommandList::transitionImageUsageMode(VkImage image, agpu_texture_usage_mode_mask allowedUsages, agpu_texture_usage_mode_mask sourceUsage, agpu_texture_usage_mode_mask destUsage, VkImageSubresourceRange range)
+void AVkCommandList::transitionAttachmentUsageModes(bool toAttachment)
 {
-    if(sourceUsage == destUsage)
-        return AGPU_OK;
+    auto avkCurrentFramebuffer = currentFramebuffer.as<AVkFramebuffer> ();
+
+    // Transition the color attachments.
+    for (agpu_uint i = 0; i < avkCurrentFramebuffer->colorCount; ++i)
+    {
+        auto &attachmentTexture = avkCurrentFramebuffer->attachmentTextures[i];
+        auto &desc = avkCurrentFramebuffer->attachmentViews[i].as<AVkTextureView> ()->description;
+        VkImageSubresourceRange range = {};
+        range.baseArrayLayer = desc.subresource_range.base_arraylayer;
+        range.baseMipLevel = desc.subresource_range.base_miplevel;
+        range.layerCount = 1;
+        range.levelCount = 1;
 
-    VkPipelineStageFlags srcStages = 0;
-    VkPipelineStageFlags destStages = 0;
-    auto barrier = barrierForImageUsageTransition(image, range, allowedUsages, sourceUsage, destUsage, srcStages, destStages);
+        auto usageMode = toAttachment ? AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT : attachmentTexture.as<AVkTexture> ()->description.main_usage_mode;
+        textureLayoutTracker.transition(attachmentTexture, range, usageMode);
+    }
 
-    vkCmdPipelineBarrier(commandBuffer, srcStages, destStages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-    return AGPU_OK;
+    // Transition the depth stencil attachment, if needed.
+    if(avkCurrentFramebuffer->hasDepthStencil)
+    {
+        auto &depthStencilAttachment = avkCurrentFramebuffer->attachmentTextures.back();
+        auto &desc = avkCurrentFramebuffer->attachmentViews.back().as<AVkTextureView> ()->description;
+        VkImageSubresourceRange range = {};
+        range.baseArrayLayer = desc.subresource_range.base_arraylayer;
+        range.baseMipLevel = desc.subresource_range.base_miplevel;
+        range.layerCount = 1;
+        range.levelCount = 1;
+
+        auto &depthStencilDescription = depthStencilAttachment.as<AVkTexture> ()->description;
+        auto depthStencilUsageMode = depthStencilDescription.usage_modes & (AGPU_TEXTURE_USAGE_DEPTH_ATTACHMENT | AGPU_TEXTURE_USAGE_STENCIL_ATTACHMENT);
+        auto usageMode = toAttachment ? agpu_texture_usage_mode_mask(depthStencilUsageMode) : depthStencilDescription.main_usage_mode;
+        textureLayoutTracker.transition(depthStencilAttachment, range, usageMode);
+    }
 }
 
 agpu_error AVkCommandList::transitionBufferUsageMode(VkBuffer buffer, agpu_buffer_usage_mask oldUsageMode, agpu_buffer_usage_mask newUsageMode)
 {
+    textureLayoutTracker.flush(commandBuffer);
+
     VkBufferMemoryBarrier barrier = {};
     barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
     barrier.srcAccessMask = mapBufferUsageModeToAccessFlags(oldUsageMode);
@@ -404,39 +440,11 @@ agpu_error AVkCommandList::beginRenderPass(const agpu::renderpass_ref &renderpas
     currentFramebuffer = framebuffer;
     isSecondaryContent = secondaryContent;
 
-    auto avkCurrentFramebuffer = currentFramebuffer.as<AVkFramebuffer> ();
-
-    // Transition the color attachments.
-    for (agpu_uint i = 0; i < avkCurrentFramebuffer->colorCount; ++i)
-    {
-        VkImageSubresourceRange range = {};
+    // Transition the attachments, together with any other pending transition.
+    transitionAttachmentUsageModes(true);
+    textureLayoutTracker.flush(commandBuffer);
 
-        auto &desc = avkCurrentFramebuffer->attachmentViews[i].as<AVkTextureView> ()->description;
-        range.baseArrayLayer = desc.subresource_range.base_arraylayer;
-        range.baseMipLevel = desc.subresource_range.base_miplevel;
-        range.layerCount = 1;
-        range.levelCount = 1;
-        range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        auto attachmentTexture = avkCurrentFramebuffer->attachmentTextures[i].as<AVkTexture> ();
-        transitionImageUsageMode(attachmentTexture->image, attachmentTexture->description.usage_modes, attachmentTexture->description.main_usage_mode, AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT, range);
-    }
-
-    // Transition the depth stencil attachment, if needed.
-    if(avkCurrentFramebuffer->hasDepthStencil)
-    {
-        auto depthStencilAttachment = avkCurrentFramebuffer->attachmentTextures.back().as<AVkTexture> ();
-
-        auto &desc = avkCurrentFramebuffer->attachmentViews.back().as<AVkTextureView> ()->description;;
-        VkImageSubresourceRange range = {};
-        range.baseArrayLayer = desc.subresource_range.base_arraylayer;
-        range.baseMipLevel = desc.subresource_range.base_miplevel;
-        range.layerCount = 1;
-        range.levelCount = 1;
-        range.aspectMask = depthStencilAttachment->imageAspect;
-
-        auto depthStencilUsageMode = depthStencilAttachment->description.usage_modes & (AGPU_TEXTURE_USAGE_DEPTH_ATTACHMENT | AGPU_TEXTURE_USAGE_STENCIL_ATTACHMENT);
-        transitionImageUsageMode(depthStencilAttachment->image, depthStencilAttachment->description.usage_modes, depthStencilAttachment->description.main_usage_mode, agpu_texture_usage_mode_mask(depthStencilUsageMode), range);
-    }
+    auto avkCurrentFramebuffer = currentFramebuffer.as<AVkFramebuffer> ();
 
     // Begin the render pass.
     auto avkRenderPass = renderpass.as<AVkRenderPass> ();
@@ -465,39 +473,8 @@ agpu_error AVkCommandList::endRenderPass()
 
     vkCmdEndRenderPass(commandBuffer);
 
-    auto avkCurrentFramebuffer = currentFramebuffer.as<AVkFramebuffer> ();
-
-    // Transition the color attachments.
-    for (agpu_uint i = 0; i < avkCurrentFramebuffer->colorCount; ++i)
-    {
-        auto &desc = avkCurrentFramebuffer->attachmentViews[i].as<AVkTextureView> ()->description;
-        VkImageSubresourceRange range = {};
-        range.baseArrayLayer = desc.subresource_range.base_arraylayer;
-        range.baseMipLevel = desc.subresource_range.base_miplevel;
-        range.layerCount = 1;
-        range.levelCount = 1;
-        range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-
-        auto attachmentTexture = avkCurrentFramebuffer->attachmentTextures[i].as<AVkTexture> ();
-        transitionImageUsageMode(attachmentTexture->image, attachmentTexture->description.usage_modes, AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT, attachmentTexture->description.main_usage_mode, range);
-    }
-
-    // Transition the depth stencil attachment if needed
-    if(avkCurrentFramebuffer->hasDepthStencil)
-    {
-        auto depthStencilAttachment = avkCurrentFramebuffer->attachmentTextures.back().as<AVkTexture> ();
-
-        auto &desc = avkCurrentFramebuffer->attachmentViews.back().as<AVkTextureView> ()->description;
-        VkImageSubresourceRange range = {};
-        range.baseArrayLayer = desc.subresource_range.base_arraylayer;
-        range.baseMipLevel = desc.subresource_range.base_miplevel;
-        range.layerCount = 1;
-        range.levelCount = 1;
-        range.aspectMask = depthStencilAttachment->imageAspect;
-
-        auto depthStencilUsageMode = depthStencilAttachment->description.usage_modes & (AGPU_TEXTURE_USAGE_DEPTH_ATTACHMENT | AGPU_TEXTURE_USAGE_STENCIL_ATTACHMENT);
-        transitionImageUsageMode(depthStencilAttachment->image, depthStencilAttachment->description.usage_modes, agpu_texture_usage_mode_mask(depthStencilUsageMode), depthStencilAttachment->description.main_usage_mode, range);
-    }
+    // The transitions back into the main usage modes are deferred until the next use.
+    transitionAttachmentUsageModes(false);
 
     // Unset the current framebuffer
     currentFramebuffer.reset();
@@ -537,14 +514,22 @@ agpu_error AVkCommandList::resolveTexture (const agpu::texture_ref &sourceTextur
     if(resolveAspects == 0)
         return AGPU_INVALID_PARAMETER;
 
-    VkImageSubresourceRange range = {};
-    range.layerCount = 1;
-    range.levelCount = 1;
-    range.aspectMask = avkSourceTexture->imageAspect;
+    VkImageSubresourceRange sourceRange = {};
+    sourceRange.baseMipLevel = sourceLevel;
+    sourceRange.levelCount = 1;
+    sourceRange.baseArrayLayer = sourceLayer;
+    sourceRange.layerCount = layerCount;
+
+    VkImageSubresourceRange destRange = {};
+    destRange.baseMipLevel = destLevel;
+    destRange.levelCount = 1;
+    destRange.baseArrayLayer = destLayer;
+    destRange.layerCount = layerCount;
 
     // Transition the textures into a copy layout.
-    transitionImageUsageMode(avkSourceTexture->image, avkSourceTexture->description.usage_modes, avkSourceTexture->description.main_usage_mode, AGPU_TEXTURE_USAGE_COPY_SOURCE, range);
-    transitionImageUsageMode(avkDestTexture->image, avkDestTexture->description.usage_modes, avkDestTexture->description.main_usage_mode, AGPU_TEXTURE_USAGE_COPY_DESTINATION, range);
+    textureLayoutTracker.transition(sourceTexture, sourceRange, AGPU_TEXTURE_USAGE_COPY_SOURCE);
+    textureLayoutTracker.transition(destTexture, destRange, AGPU_TEXTURE_USAGE_COPY_DESTINATION);
+    textureLayoutTracker.flush(commandBuffer);
 
     if(avkSourceTexture->description.sample_count == 1 && avkDestTexture->description.sample_count == 1)
     {
@@ -557,7 +542,7 @@ agpu_error AVkCommandList::resolveTexture (const agpu::texture_ref &sourceTextur
         blitRegion.srcOffsets[1].z = 1;
 
         blitRegion.dstSubresource.aspectMask = resolveAspects;
-        blitRegion.srcSubresource.baseArrayLayer = destLayer;
+        blitRegion.dstSubresource.baseArrayLayer = destLayer;
         blitRegion.dstSubresource.layerCount = layerCount;
         blitRegion.dstOffsets[1].x = avkDestTexture->description.width;
         blitRegion.dstOffsets[1].y = avkDestTexture->description.height;
@@ -588,15 +573,17 @@ agpu_error AVkCommandList::resolveTexture (const agpu::texture_ref &sourceTextur
             1, &region);
     }
 
-    // Transition the textures back to their original layout
-    transitionImageUsageMode(avkSourceTexture->image, avkSourceTexture->description.usage_modes, AGPU_TEXTURE_USAGE_COPY_SOURCE, avkSourceTexture->description.main_usage_mode, range);
-    transitionImageUsageMode(avkDestTexture->image, avkDestTexture->description.usage_modes, AGPU_TEXTURE_USAGE_COPY_DESTINATION, avkDestTexture->description.main_usage_mode, range);
+    // Transition the textures back to their original layout, when they are used again.
+    textureLayoutTracker.transition(sourceTexture, sourceRange, avkSourceTexture->description.main_usage_mode);
+    textureLayoutTracker.transition(destTexture, destRange, avkDestTexture->description.main_usage_mode);
 
     return AGPU_OK;
 }
 
 agpu_error AVkCommandList::memoryBarrier(agpu_pipeline_stage_flags source_stage, agpu_pipeline_stage_flags dest_stage, agpu_access_flags source_accesses, agpu_access_flags dest_accesses)
 {
+    textureLayoutTracker.flush(commandBuffer);
+
     VkMemoryBarrier barrier = {};
     barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
     barrier.srcAccessMask = VkAccessFlags(source_accesses);
@@ -609,6 +596,7 @@ agpu_error AVkCommandList::memoryBarrier(agpu_pipeline_stage_flags source_stage,
 agpu_error AVkCommandList::bufferMemoryBarrier(const agpu::buffer_ref & buffer, agpu_pipeline_stage_flags source_stage, agpu_pipeline_stage_flags dest_stage, agpu_access_flags source_accesses, agpu_access_flags dest_accesses, agpu_size offset, agpu_size size)
 {
     CHECK_POINTER(buffer);
+    textureLayoutTracker.flush(commandBuffer);
 
     VkBufferMemoryBarrier barrier = {};
     barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
@@ -627,7 +615,17 @@ agpu_error AVkCommandList::bufferMemoryBarrier(const agpu::buffer_ref & buffer,
 
 agpu_error AVkCommandList::textureMemoryBarrier(const agpu::texture_ref & texture, agpu_pipeline_stage_flags source_stage, agpu_pipeline_stage_flags dest_stage, agpu_access_flags source_accesses, agpu_access_flags dest_accesses, agpu_subresource_range* subresource_range)
 {
-    return AGPU_UNIMPLEMENTED;
+    CHECK_POINTER(texture);
+    if(currentFramebuffer)
+        return AGPU_INVALID_OPERATION;
+
+    auto range = subresource_range
+        ? textureLayoutTracker.clampRange(texture, *subresource_range)
+        : textureLayoutTracker.wholeRangeOf(texture);
+
+    // The barrier is merged with the pending transitions at the next use.
+    textureLayoutTracker.memoryBarrier(texture, range, VkPipelineStageFlags(source_stage), VkPipelineStageFlags(dest_stage), VkAccessFlags(source_accesses), VkAccessFlags(dest_accesses));
+    return AGPU_OK;
 }
 
 agpu_error AVkCommandList::pushBufferTransitionBarrier(const agpu::buffer_ref & buffer, agpu_buffer_usage_mask new_usage)
@@ -642,7 +640,32 @@ agpu_error AVkCommandList::pushBufferTransitionBarrier(const agpu::buffer_ref &
 
 agpu_error AVkCommandList::pushTextureTransitionBarrier(const agpu::texture_ref & texture, agpu_texture_usage_mode_mask new_usage, agpu_subresource_range* subresource_range)
 {
-    return AGPU_UNIMPLEMENTED;
+    CHECK_POINTER(texture);
+    if(currentFramebuffer)
+        return AGPU_INVALID_OPERATION;
+
+    auto &description = texture.as<AVkTexture> ()->description;
+    if((description.usage_modes & new_usage) != new_usage)
+        return AGPU_INVALID_PARAMETER;
+
+    TextureTransition transition;
+    transition.texture = texture;
+    transition.range = subresource_range
+        ? textureLayoutTracker.clampRange(texture, *subresource_range)
+        : textureLayoutTracker.wholeRangeOf(texture);
+
+    // Remember the usage modes that are restored by the pop.
+    auto &range = transition.range;
+    transition.previousUsages.reserve(range.levelCount*range.layerCount);
+    for(agpu_uint level = 0; level < range.levelCount; ++level)
+    {
+        for(agpu_uint layer = 0; layer < range.layerCount; ++layer)
+            transition.previousUsages.push_back(textureLayoutTracker.getUsageMode(texture, range.baseMipLevel + level, range.baseArrayLayer + layer));
+    }
+
+    textureLayoutTracker.transition(texture, range, new_usage);
+    textureTransitionStack.push_back(transition);
+    return AGPU_OK;
 }
 
 agpu_error AVkCommandList::popBufferTransitionBarrier()
@@ -660,7 +683,29 @@ agpu_error AVkCommandList::popBufferTransitionBarrier()
 
 agpu_error AVkCommandList::popTextureTransitionBarrier()
 {
-    return AGPU_UNIMPLEMENTED;
+    if(textureTransitionStack.empty())
+        return AGPU_OUT_OF_BOUNDS;
+    if(currentFramebuffer)
+        return AGPU_INVALID_OPERATION;
+
+    auto &transition = textureTransitionStack.back();
+    auto &range = transition.range;
+    size_t index = 0;
+    for(agpu_uint level = 0; level < range.levelCount; ++level)
+    {
+        for(agpu_uint layer = 0; layer < range.layerCount; ++layer)
+        {
+            VkImageSubresourceRange subresource = {};
+            subresource.baseMipLevel = range.baseMipLevel + level;
+            subresource.levelCount = 1;
+            subresource.baseArrayLayer = range.baseArrayLayer + layer;
+            subresource.layerCount = 1;
+            textureLayoutTracker.transition(transition.texture, subresource, transition.previousUsages[index++]);
+        }
+    }
+
+    textureTransitionStack.pop_back();
+    return AGPU_OK;
 }
 
 agpu_error AVkCommandList::copyBuffer(const agpu::buffer_ref & source_buffer, agpu_size source_offset, const agpu::buffer_ref & dest_buffer, agpu_size dest_offset, agpu_size copy_size)
@@ -673,6 +718,7 @@ agpu_error AVkCommandList::copyBuffer(const agpu::buffer_ref & source_buffer, ag
     region.dstOffset = dest_offset;
     region.size = copy_size;
 
+    textureLayoutTracker.flush(commandBuffer);
     vkCmdCopyBuffer(commandBuffer, source_buffer.as<AVkBuffer> ()->handle, dest_buffer.as<AVkBuffer> ()->handle, 1, &region);
     return AGPU_OK;
 }
@@ -687,4 +733,9 @@ agpu_error AVkCommandList::copyTextureToBuffer(const agpu::texture_ref & texture
     return AGPU_UNIMPLEMENTED;
 }
 
+agpu_error AVkCommandList::executeEncodedCommands(agpu_pointer commands, agpu_size size)
+{
+    return AgpuCommon::executeEncodedCommands(this, commands, size);
+}
+
 } // End of namespace AgpuVulkan
@@ -2,6 +2,7 @@
 #define AGPU_COMMAND_LIST_HPP
 
 #include "device.hpp"
+#include "texture_layout_tracker.hpp"
 
 namespace AgpuVulkan
 {
@@ -54,6 +55,7 @@ public:
     virtual agpu_error copyBuffer(const agpu::buffer_ref & source_buffer, agpu_size source_offset, const agpu::buffer_ref & dest_buffer, agpu_size dest_offset, agpu_size copy_size) override;
     virtual agpu_error copyBufferToTexture(const agpu::buffer_ref & buffer, const agpu::texture_ref & texture, agpu_buffer_image_copy_region* copy_region) override;
     virtual agpu_error copyTextureToBuffer(const agpu::texture_ref & texture, const agpu::buffer_ref & buffer, agpu_buffer_image_copy_region* copy_region) override;
+    virtual agpu_error executeEncodedCommands(agpu_pointer commands, agpu_size size) override;
 
     agpu::device_ref device;
     agpu::command_allocator_ref allocator;
@@ -63,10 +65,9 @@ public:
 
 private:
     agpu_buffer_usage_mask getCurrentBufferUsageMode(const agpu::buffer_ref &buffer);
-    agpu_texture_usage_mode_mask getCurrentTextureUsageMode(const agpu::texture_ref &texture);
 
     void resetState();
-    agpu_error transitionImageUsageMode(VkImage image, agpu_texture_usage_mode_mask allowedUsages, agpu_texture_usage_mode_mask sourceUsage, agpu_texture_usage_mode_mask destUsage, VkImageSubresourceRange range);
+    void transitionAttachmentUsageModes(bool toAttachment);
     agpu_error transitionBufferUsageMode(VkBuffer buffer, agpu_buffer_usage_mask oldUsageMode, agpu_buffer_usage_mask newUsageMode);
 
     agpu::framebuffer_ref currentFramebuffer;
@@ -78,6 +79,16 @@ private:
     agpu::shader_signature_ref shaderSignature;
 
     std::vector<std::pair<agpu::buffer_ref, agpu_buffer_usage_mask>> bufferTransitionStack;
+
+    struct TextureTransition
+    {
+        agpu::texture_ref texture;
+        VkImageSubresourceRange range;
+        std::vector<agpu_texture_usage_mode_mask> previousUsages;
+    };
+
+    AVkTextureLayoutTracker textureLayoutTracker;
+    std::vector<TextureTransition> textureTransitionStack;
 };
 
 } // End of namespace AgpuVulkan
@@ -9,10 +9,13 @@ AVkCommandQueue::AVkCommandQueue(const agpu::device_ref &device)
     : weakDevice(device)
 {
     queue = nullptr;
+    pendingCommandBufferCount = 0;
 }
 
 AVkCommandQueue::~AVkCommandQueue()
 {
+    std::unique_lock<std::mutex> l(submissionMutex);
+    submitPendingBatches(VK_NULL_HANDLE);
 }
 
 agpu::command_queue_ref AVkCommandQueue::create(const agpu::device_ref &device, agpu_uint queueFamilyIndex, agpu_uint queueIndex, VkQueue queue, agpu_command_queue_type type)
@@ -34,26 +37,118 @@ bool AVkCommandQueue::supportsPresentingSurface(VkSurfaceKHR surface)
     return presentSupported != 0;
 }
 
-agpu_error AVkCommandQueue::addCommandList(const agpu::command_list_ref &command_list)
+agpu_error AVkCommandQueue::validateCommandList(const agpu::command_list_ref &command_list)
 {
     CHECK_POINTER(command_list);
     auto avkCommandList = command_list.as<AVkCommandList> ();
     if (avkCommandList->queueFamilyIndex != queueFamilyIndex)
         return AGPU_INVALID_PARAMETER;
+    return AGPU_OK;
+}
+
+void AVkCommandQueue::enqueueCommandList(const agpu::command_list_ref &command_list)
+{
+    if (pendingBatches.empty() || !pendingBatches.back().canAppendCommandBuffers())
+        pendingBatches.push_back(AVkSubmitBatch());
+
+    pendingBatches.back().commandBuffers.push_back(command_list.as<AVkCommandList> ()->commandBuffer);
+    pendingCommandLists.push_back(command_list);
+    ++pendingCommandBufferCount;
+}
+
+agpu_error AVkCommandQueue::submitPendingBatches(VkFence fence)
+{
+    if (pendingBatches.empty() && fence == VK_NULL_HANDLE)
+        return AGPU_OK;
+
+    submitInfos.resize(pendingBatches.size());
+#ifdef VK_KHR_timeline_semaphore
+    timelineSubmitInfos.resize(pendingBatches.size());
+#endif
+    for (size_t i = 0; i < pendingBatches.size(); ++i)
+    {
+        auto &batch = pendingBatches[i];
+        auto &submitInfo = submitInfos[i];
+        memset(&submitInfo, 0, sizeof(VkSubmitInfo));
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = uint32_t(batch.waitSemaphores.size());
+        submitInfo.pWaitSemaphores = batch.waitSemaphores.data();
+        submitInfo.pWaitDstStageMask = batch.waitStages.data();
+        submitInfo.commandBufferCount = uint32_t(batch.commandBuffers.size());
+        submitInfo.pCommandBuffers = batch.commandBuffers.data();
+        submitInfo.signalSemaphoreCount = uint32_t(batch.signalSemaphores.size());
+        submitInfo.pSignalSemaphores = batch.signalSemaphores.data();
+
+#ifdef VK_KHR_timeline_semaphore
+        if (batch.hasTimelineValues())
+        {
+            auto &timelineSubmitInfo = timelineSubmitInfos[i];
+            memset(&timelineSubmitInfo, 0, sizeof(timelineSubmitInfo));
+            timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+            timelineSubmitInfo.waitSemaphoreValueCount = uint32_t(batch.waitValues.size());
+            timelineSubmitInfo.pWaitSemaphoreValues = batch.waitValues.data();
+            timelineSubmitInfo.signalSemaphoreValueCount = uint32_t(batch.signalValues.size());
+            timelineSubmitInfo.pSignalSemaphoreValues = batch.signalValues.data();
+            submitInfo.pNext = &timelineSubmitInfo;
+        }
+#endif
+    }
 
-    VkSubmitInfo submitInfo;
-    memset(&submitInfo, 0, sizeof(VkSubmitInfo));
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &avkCommandList->commandBuffer;
+    auto error = vkQueueSubmit(queue, uint32_t(submitInfos.size()), submitInfos.data(), fence);
+
+    // The command lists are only kept alive until they are handed to Vulkan.
+    pendingBatches.clear();
+    pendingCommandLists.clear();
+    pendingCommandBufferCount = 0;
 
-    auto error = vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
     CONVERT_VULKAN_ERROR(error);
     return AGPU_OK;
 }
 
+agpu_error AVkCommandQueue::addCommandList(const agpu::command_list_ref &command_list)
+{
+    auto error = validateCommandList(command_list);
+    if (error)
+        return error;
+
+    // The submission is deferred, so that consecutive command lists and
+    // fence signals are coalesced into a single vkQueueSubmit.
+    std::unique_lock<std::mutex> l(submissionMutex);
+    enqueueCommandList(command_list);
+    if (pendingCommandBufferCount >= MaxPendingCommandBufferCount)
+        return submitPendingBatches(VK_NULL_HANDLE);
+
+    return AGPU_OK;
+}
+
+agpu_error AVkCommandQueue::addCommandLists(agpu_uint count, agpu::command_list_ref* command_lists)
+{
+    if (count == 0)
+        return AGPU_OK;
+    CHECK_POINTER(command_lists);
+
+    for (agpu_uint i = 0; i < count; ++i)
+    {
+        auto error = validateCommandList(command_lists[i]);
+        if (error)
+            return error;
+    }
+
+    // Submit everything together with the previously deferred command lists.
+    std::unique_lock<std::mutex> l(submissionMutex);
+    for (agpu_uint i = 0; i < count; ++i)
+        enqueueCommandList(command_lists[i]);
+
+    return submitPendingBatches(VK_NULL_HANDLE);
+}
+
 agpu_error AVkCommandQueue::finishExecution()
 {
+    std::unique_lock<std::mutex> l(submissionMutex);
+    auto submitError = submitPendingBatches(VK_NULL_HANDLE);
+    if (submitError)
+        return submitError;
+
     auto error = vkQueueWaitIdle(queue);
     CONVERT_VULKAN_ERROR(error);
     return AGPU_OK;
@@ -62,16 +157,68 @@ agpu_error AVkCommandQueue::finishExecution()
 agpu_error AVkCommandQueue::signalFence(const agpu::fence_ref &fence)
 {
     CHECK_POINTER(fence);
+    auto avkFence = fence.as<AVkFence> ();
 
-    auto error = vkQueueSubmit(queue, 0, nullptr, fence.as<AVkFence> ()->fence);
-    CONVERT_VULKAN_ERROR(error);
-    return AGPU_OK;
+    std::unique_lock<std::mutex> l(submissionMutex);
+    return avkFence->signal([&](uint64_t signalValue) -> agpu_error {
+        if (!avkFence->isTimeline())
+            return submitPendingBatches(avkFence->fence);
+
+        // Signal the next timeline value at the end of the pending batches.
+        if (pendingBatches.empty())
+            pendingBatches.push_back(AVkSubmitBatch());
+        pendingBatches.back().addSignalSemaphore(avkFence->semaphore, signalValue);
+        return submitPendingBatches(VK_NULL_HANDLE);
+    });
 }
 
 agpu_error AVkCommandQueue::waitFence(const agpu::fence_ref &fence)
 {
     CHECK_POINTER(fence);
-    return AGPU_UNSUPPORTED;
+    auto avkFence = fence.as<AVkFence> ();
+    if (!avkFence->isTimeline())
+        return AGPU_UNSUPPORTED;
+
+    // Wait for the last signaled value. This wait is kept in the GPU, and it
+    // applies to the command lists that are added after it.
+    auto waitValue = avkFence->getLastSignalValue();
+    if (waitValue == 0)
+        return AGPU_OK;
+
+    std::unique_lock<std::mutex> l(submissionMutex);
+    pendingBatches.push_back(AVkSubmitBatch());
+    pendingBatches.back().addWaitSemaphore(avkFence->semaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, waitValue);
+    return AGPU_OK;
+}
+
+agpu_error AVkCommandQueue::flushPendingSubmissions()
+{
+    std::unique_lock<std::mutex> l(submissionMutex);
+    return submitPendingBatches(VK_NULL_HANDLE);
+}
+
+agpu_error AVkCommandQueue::submitBatch(const AVkSubmitBatch &batch, VkFence fence)
+{
+    std::unique_lock<std::mutex> l(submissionMutex);
+    pendingBatches.push_back(batch);
+    return submitPendingBatches(fence);
+}
+
+void AVkCommandQueue::addPendingWaitSemaphore(VkSemaphore semaphore, VkPipelineStageFlags stages)
+{
+    std::unique_lock<std::mutex> l(submissionMutex);
+    if (pendingBatches.empty() || !pendingBatches.back().commandBuffers.empty() || !pendingBatches.back().canAppendCommandBuffers())
+        pendingBatches.push_back(AVkSubmitBatch());
+    pendingBatches.back().addWaitSemaphore(semaphore, stages);
+}
+
+agpu_error AVkCommandQueue::submitCommandBuffer(VkCommandBuffer commandBuffer, VkFence fence)
+{
+    std::unique_lock<std::mutex> l(submissionMutex);
+    if (pendingBatches.empty() || !pendingBatches.back().canAppendCommandBuffers())
+        pendingBatches.push_back(AVkSubmitBatch());
+    pendingBatches.back().commandBuffers.push_back(commandBuffer);
+    return submitPendingBatches(fence);
 }
 
 } // End of namespace AgpuVulkan
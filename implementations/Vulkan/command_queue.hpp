@@ -6,26 +6,101 @@
 namespace AgpuVulkan
 {
 
+/**
+ * A group of command buffers that are submitted with a single VkSubmitInfo.
+ * The semaphore values are only used by timeline semaphores, and they are
+ * ignored for binary semaphores.
+ */
+struct AVkSubmitBatch
+{
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<uint64_t> waitValues;
+    std::vector<VkPipelineStageFlags> waitStages;
+    std::vector<VkCommandBuffer> commandBuffers;
+    std::vector<VkSemaphore> signalSemaphores;
+    std::vector<uint64_t> signalValues;
+
+    void addWaitSemaphore(VkSemaphore semaphore, VkPipelineStageFlags stages, uint64_t value = 0)
+    {
+        waitSemaphores.push_back(semaphore);
+        waitStages.push_back(stages);
+        waitValues.push_back(value);
+    }
+
+    void addSignalSemaphore(VkSemaphore semaphore, uint64_t value = 0)
+    {
+        signalSemaphores.push_back(semaphore);
+        signalValues.push_back(value);
+    }
+
+    bool hasTimelineValues() const
+    {
+        for (auto value : waitValues)
+        {
+            if (value)
+                return true;
+        }
+        for (auto value : signalValues)
+        {
+            if (value)
+                return true;
+        }
+        return false;
+    }
+
+    bool canAppendCommandBuffers() const
+    {
+        return signalSemaphores.empty();
+    }
+};
+
 struct AVkCommandQueue : public agpu::command_queue
 {
 public:
+    static constexpr size_t MaxPendingCommandBufferCount = 64;
+
     AVkCommandQueue(const agpu::device_ref &device);
     ~AVkCommandQueue();
 
     static agpu::command_queue_ref create(const agpu::device_ref &device, agpu_uint queueFamilyIndex, agpu_uint queueIndex, VkQueue queue, agpu_command_queue_type type);
 
     virtual agpu_error addCommandList(const agpu::command_list_ref &command_list) override;
+    virtual agpu_error addCommandLists(agpu_uint count, agpu::command_list_ref* command_lists) override;
     virtual agpu_error finishExecution() override;
     virtual agpu_error signalFence(const agpu::fence_ref &fence) override;
     virtual agpu_error waitFence(const agpu::fence_ref &fence) override;
 
     bool supportsPresentingSurface(VkSurfaceKHR surface);
 
+    // Submission entry points for the internal users of the queue. They
+    // always flush the pending batches first, to preserve the submission order.
+    agpu_error flushPendingSubmissions();
+    agpu_error submitBatch(const AVkSubmitBatch &batch, VkFence fence = VK_NULL_HANDLE);
+    agpu_error submitCommandBuffer(VkCommandBuffer commandBuffer, VkFence fence = VK_NULL_HANDLE);
+
+    // Adds a semaphore wait without submitting it. The wait is consumed by
+    // the next command lists that are submitted in this queue.
+    void addPendingWaitSemaphore(VkSemaphore semaphore, VkPipelineStageFlags stages);
+
     agpu::device_weakref weakDevice;
     agpu_uint queueFamilyIndex;
     agpu_uint queueIndex;
     VkQueue queue;
     agpu_command_queue_type type;
+
+private:
+    agpu_error validateCommandList(const agpu::command_list_ref &command_list);
+    void enqueueCommandList(const agpu::command_list_ref &command_list);
+    agpu_error submitPendingBatches(VkFence fence);
+
+    std::mutex submissionMutex;
+    std::vector<AVkSubmitBatch> pendingBatches;
+    std::vector<agpu::command_list_ref> pendingCommandLists;
+    std::vector<VkSubmitInfo> submitInfos;
+#ifdef VK_KHR_timeline_semaphore
+    std::vector<VkTimelineSemaphoreSubmitInfoKHR> timelineSubmitInfos;
+#endif
+    size_t pendingCommandBufferCount;
 };
 
 } // End of namespace AgpuVulkan
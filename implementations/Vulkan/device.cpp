@@ -21,6 +21,7 @@
 #include "sampler.hpp"
 #include "../Common/offline_shader_compiler.hpp"
 #include "../Common/state_tracker_cache.hpp"
+#include "../Common/shader_archive.hpp"
 
 #define GET_INSTANCE_PROC_ADDR(procName) \
     {                                                                          \
@@ -211,6 +212,11 @@ AVkDevice::AVkDevice()
 
     isVRDisplaySupported = false;
     isVRInputDevicesSupported = false;
+    hasTimelineSemaphores = false;
+    hasHeadlessSurface = false;
+
+    pipelineStateCount = 0;
+    framebufferCount = 0;
 }
 
 AVkDevice::~AVkDevice()
@@ -219,6 +225,10 @@ AVkDevice::~AVkDevice()
 	implicitResourceSetupCommandList.destroy();
 	implicitResourceUploadCommandList.destroy();
 	implicitResourceReadbackCommandList.destroy();
+
+	// Destroy the cached render passes.
+	if(device)
+		renderPassCache.destroy(device);
 }
 
 bool AVkDevice::checkVulkanImplementation(VulkanPlatform *platform)
@@ -459,6 +469,23 @@ bool AVkDevice::initialize(agpu_device_open_info* openInfo)
         instanceExtensions.push_back("VK_EXT_debug_report");
     }
 
+    // The physical device properties 2 extension is required by some optional device extensions.
+    bool hasPhysicalDeviceProperties2 = false;
+    if (hasExtension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, instanceExtensionProperties))
+    {
+        hasPhysicalDeviceProperties2 = true;
+        instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
+
+    // The headless surface extension is used for presenting without a window system.
+#ifdef VK_EXT_headless_surface
+    if (hasExtension(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME, instanceExtensionProperties))
+    {
+        hasHeadlessSurface = true;
+        instanceExtensions.push_back(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+    }
+#endif
+
     // Set the enabled layers and extensions.
     if (!instanceLayers.empty())
     {
@@ -592,6 +619,10 @@ bool AVkDevice::initialize(agpu_device_open_info* openInfo)
     GET_INSTANCE_PROC_ADDR(GetPhysicalDeviceSurfaceFormatsKHR);
     GET_INSTANCE_PROC_ADDR(GetPhysicalDeviceSurfacePresentModesKHR);
     GET_INSTANCE_PROC_ADDR(GetSwapchainImagesKHR);
+#ifdef VK_EXT_headless_surface
+    if (hasHeadlessSurface)
+        GET_INSTANCE_PROC_ADDR(CreateHeadlessSurfaceEXT);
+#endif
 
     if (sharedContext->hasDebugReportExtension)
         sharedContext->hasDebugReportExtension = checkDebugReportExtension();
@@ -630,6 +661,23 @@ bool AVkDevice::initialize(agpu_device_open_info* openInfo)
             deviceLayers.push_back(validationLayerNames[i]);
     }
 
+    // Use timeline semaphores for the fences, when they are available.
+#ifdef VK_KHR_timeline_semaphore
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures;
+    memset(&timelineSemaphoreFeatures, 0, sizeof(timelineSemaphoreFeatures));
+    if (hasPhysicalDeviceProperties2 && hasExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, deviceExtensionProperties))
+    {
+        hasTimelineSemaphores = true;
+        deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+
+        timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+        timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+        deviceCreateInfo.pNext = &timelineSemaphoreFeatures;
+    }
+#else
+    (void)hasPhysicalDeviceProperties2;
+#endif
+
     // Set the device layers and extensions
     deviceCreateInfo.ppEnabledExtensionNames = &deviceExtensions[0];
     deviceCreateInfo.enabledExtensionCount = (uint32_t)deviceExtensions.size();
@@ -652,6 +700,14 @@ bool AVkDevice::initialize(agpu_device_open_info* openInfo)
     GET_DEVICE_PROC_ADDR(AcquireNextImageKHR);
     GET_DEVICE_PROC_ADDR(QueuePresentKHR);
 
+#ifdef VK_KHR_timeline_semaphore
+    if (hasTimelineSemaphores)
+    {
+        GET_DEVICE_PROC_ADDR(GetSemaphoreCounterValueKHR);
+        GET_DEVICE_PROC_ADDR(WaitSemaphoresKHR);
+    }
+#endif
+
     // Get the queues.
     for (uint32_t i = 0; i < queueFamilyCount; ++i)
     {
@@ -905,7 +961,40 @@ agpu::state_tracker_cache_ptr AVkDevice::createStateTrackerCache(const agpu::com
 
 agpu_error AVkDevice::finishExecution()
 {
+    for (auto &queue : graphicsCommandQueues)
+        queue.as<AVkCommandQueue> ()->flushPendingSubmissions();
+    for (auto &queue : computeCommandQueues)
+        queue.as<AVkCommandQueue> ()->flushPendingSubmissions();
+    for (auto &queue : transferCommandQueues)
+        queue.as<AVkCommandQueue> ()->flushPendingSubmissions();
+
     vkDeviceWaitIdle(device);
     return AGPU_OK;
 }
+
+agpu_error AVkDevice::getObjectStatistics(agpu_device_object_statistics* statistics)
+{
+    CHECK_POINTER(statistics);
+
+    VmaStats memoryStats;
+    vmaCalculateStats(sharedContext->memoryAllocator, &memoryStats);
+
+    statistics->render_pass_count = renderPassCache.getRenderPassCount();
+    statistics->render_pass_cache_hit_count = renderPassCache.getHitCount();
+    statistics->render_pass_cache_miss_count = renderPassCache.getMissCount();
+    statistics->pipeline_state_count = pipelineStateCount;
+    statistics->framebuffer_count = framebufferCount;
+    statistics->memory_block_count = memoryStats.total.blockCount;
+    statistics->memory_allocation_count = memoryStats.total.allocationCount;
+    statistics->state_change_count = 0;
+    statistics->redundant_state_change_count = 0;
+    return AGPU_OK;
+}
+
+agpu::shader_archive_ptr AVkDevice::openShaderArchive(agpu_cstring path)
+{
+    if(!path)
+        return nullptr;
+    return AgpuCommon::ShaderArchive::open(refFromThis<agpu::device> (), path).disown();
+}
 } // End of namespace AgpuVulkan
@@ -2,7 +2,9 @@
 #define AGPU_VULKAN_DEVICE_HPP
 
 #include "implicit_resource_command_list.hpp"
+#include "renderpass_cache.hpp"
 #include <string.h>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -82,6 +84,8 @@ public:
     virtual agpu::state_tracker_cache_ptr createStateTrackerCache(const agpu::command_queue_ref & command_queue_family) override;
 
     virtual agpu_error finishExecution() override;
+    virtual agpu_error getObjectStatistics(agpu_device_object_statistics* statistics) override;
+    virtual agpu::shader_archive_ptr openShaderArchive(agpu_cstring path) override;
 
 public:
     std::vector<VkPhysicalDevice> physicalDevices;
@@ -116,6 +120,17 @@ public:
     DECLARE_VK_EXTENSION_FP(AcquireNextImageKHR);
     DECLARE_VK_EXTENSION_FP(QueuePresentKHR);
 
+    // Optional extension pointers.
+    bool hasTimelineSemaphores;
+#ifdef VK_KHR_timeline_semaphore
+    DECLARE_VK_EXTENSION_FP(GetSemaphoreCounterValueKHR);
+    DECLARE_VK_EXTENSION_FP(WaitSemaphoresKHR);
+#endif
+    bool hasHeadlessSurface;
+#ifdef VK_EXT_headless_surface
+    DECLARE_VK_EXTENSION_FP(CreateHeadlessSurfaceEXT);
+#endif
+
     // VR support
     bool isVRDisplaySupported;
     bool isVRInputDevicesSupported;
@@ -130,6 +145,13 @@ public:
     // The device shared context data. This is keep in a separate object with lifetime management objectives.
     AVkDeviceSharedContextPtr sharedContext;
 
+    // Render passes shared by the pipelines, framebuffers and render pass objects.
+    AVkRenderPassCache renderPassCache;
+
+    // Object statistics.
+    std::atomic<agpu_uint> pipelineStateCount;
+    std::atomic<agpu_uint> framebufferCount;
+
 public:
     /*bool findMemoryType(uint32_t typeBits, VkFlags requirementsMask, uint32_t *typeIndex)
     {
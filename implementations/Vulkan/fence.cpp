@@ -4,55 +4,113 @@ namespace AgpuVulkan
 {
 
 AVkFence::AVkFence(const agpu::device_ref &device)
-    : device(device)
+    : device(device), lastSignalValue(0), hasPendingBinarySignal(false)
 {
+    fence = VK_NULL_HANDLE;
+    semaphore = VK_NULL_HANDLE;
 }
 
 AVkFence::~AVkFence()
 {
-    vkDestroyFence(deviceForVk->device, fence, nullptr);
+    if (fence)
+        vkDestroyFence(deviceForVk->device, fence, nullptr);
+    if (semaphore)
+        vkDestroySemaphore(deviceForVk->device, semaphore, nullptr);
 }
 
 agpu::fence_ref AVkFence::create(const agpu::device_ref &device)
 {
-    VkFenceCreateInfo info;
-    memset(&info, 0, sizeof(info));
-    info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence = VK_NULL_HANDLE;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
 
-    VkFence fence;
-    auto error = vkCreateFence(deviceForVk->device, &info, nullptr, &fence);
-    if (error)
-        return agpu::fence_ref();
+#ifdef VK_KHR_timeline_semaphore
+    if (deviceForVk->hasTimelineSemaphores)
+    {
+        VkSemaphoreTypeCreateInfoKHR typeInfo;
+        memset(&typeInfo, 0, sizeof(typeInfo));
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo info;
+        memset(&info, 0, sizeof(info));
+        info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        info.pNext = &typeInfo;
+
+        auto error = vkCreateSemaphore(deviceForVk->device, &info, nullptr, &semaphore);
+        if (error)
+            return agpu::fence_ref();
+    }
+#endif
+
+    if (!semaphore)
+    {
+        VkFenceCreateInfo info;
+        memset(&info, 0, sizeof(info));
+        info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        auto error = vkCreateFence(deviceForVk->device, &info, nullptr, &fence);
+        if (error)
+            return agpu::fence_ref();
+    }
 
     auto result = agpu::makeObject<AVkFence> (device);
     auto avkFence = result.as<AVkFence> ();
     avkFence->fence = fence;
+    avkFence->semaphore = semaphore;
     return result;
 }
 
 agpu_error AVkFence::waitOnClient()
 {
-    auto result = vkGetFenceStatus(deviceForVk->device, fence);
-    if (result == VK_SUCCESS)
-    {
-        // Do nothing
-    }
-    else if (result == VK_NOT_READY)
+    // Nothing to wait for if the fence was never signaled.
+    auto waitValue = lastSignalValue.load();
+    if (waitValue == 0)
+        return AGPU_OK;
+
+#ifdef VK_KHR_timeline_semaphore
+    if (isTimeline())
     {
-        auto error = vkWaitForFences(deviceForVk->device, 1, &fence, VK_TRUE, UINT64_MAX);
+        VkSemaphoreWaitInfoKHR waitInfo;
+        memset(&waitInfo, 0, sizeof(waitInfo));
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &semaphore;
+        waitInfo.pValues = &waitValue;
+
+        auto error = deviceForVk->fpWaitSemaphoresKHR(deviceForVk->device, &waitInfo, UINT64_MAX);
         CONVERT_VULKAN_ERROR(error);
+        return AGPU_OK;
     }
-    else
-    {
-        CONVERT_VULKAN_ERROR(result);
-        return AGPU_ERROR;
-    }
+#endif
 
-    // Reset the fence.
-    auto error = vkResetFences(deviceForVk->device, 1, &fence);
+    // The fence is not reset while waiting on it.
+    std::unique_lock<std::mutex> l(signalMutex);
+    if (!hasPendingBinarySignal)
+        return AGPU_OK;
+
+    auto error = vkWaitForFences(deviceForVk->device, 1, &fence, VK_TRUE, UINT64_MAX);
     CONVERT_VULKAN_ERROR(error);
     return AGPU_OK;
+}
+
+agpu_bool AVkFence::isSignaled()
+{
+    auto waitValue = lastSignalValue.load();
+    if (waitValue == 0)
+        return true;
+
+#ifdef VK_KHR_timeline_semaphore
+    if (isTimeline())
+    {
+        uint64_t currentValue = 0;
+        auto error = deviceForVk->fpGetSemaphoreCounterValueKHR(deviceForVk->device, semaphore, &currentValue);
+        return !error && currentValue >= waitValue;
+    }
+#endif
 
+    std::unique_lock<std::mutex> l(signalMutex);
+    return !hasPendingBinarySignal || vkGetFenceStatus(deviceForVk->device, fence) == VK_SUCCESS;
 }
 
 } // End of namespace AgpuVulkan
@@ -2,10 +2,17 @@
 #define AGPU_VULKAN_FENCE_HPP
 
 #include "device.hpp"
+#include <atomic>
+#include <mutex>
 
 namespace AgpuVulkan
 {
 
+/**
+ * An agpu fence. When VK_KHR_timeline_semaphore is available the fence is
+ * backed by a timeline semaphore, where each signal operation increments the
+ * value that is waited for. Otherwise a binary VkFence is used.
+ */
 class AVkFence : public agpu::fence
 {
 public:
@@ -15,9 +22,71 @@ public:
     static agpu::fence_ref create(const agpu::device_ref &device);
 
     virtual agpu_error waitOnClient() override;
+    virtual agpu_bool isSignaled() override;
+
+    bool isTimeline() const
+    {
+        return semaphore != VK_NULL_HANDLE;
+    }
+
+    // Returns the timeline value of the last signal operation that was submitted.
+    uint64_t getLastSignalValue() const
+    {
+        return lastSignalValue.load();
+    }
+
+    /**
+     * Performs a signal operation, where submit is called with the timeline
+     * value to signal, or with zero for a binary fence. The new value is only
+     * committed when the submission succeeds, so that a failed submission
+     * is never waited for. The binary fence is reset here when its previous
+     * signal completes, and that is serialized with the waits on it.
+     */
+    template<typename FT>
+    agpu_error signal(const FT &submit)
+    {
+        std::unique_lock<std::mutex> l(signalMutex);
+        if (isTimeline())
+        {
+            auto signalValue = lastSignalValue.load() + 1;
+            auto error = submit(signalValue);
+            if (!error)
+                lastSignalValue.store(signalValue);
+            return error;
+        }
+
+        if (hasPendingBinarySignal)
+        {
+            auto error = vkWaitForFences(deviceForVk->device, 1, &fence, VK_TRUE, UINT64_MAX);
+            CONVERT_VULKAN_ERROR(error);
+
+            error = vkResetFences(deviceForVk->device, 1, &fence);
+            CONVERT_VULKAN_ERROR(error);
+            hasPendingBinarySignal = false;
+        }
+
+        auto error = submit(0);
+        if (!error)
+        {
+            hasPendingBinarySignal = true;
+            ++lastSignalValue;
+        }
+        return error;
+    }
 
     agpu::device_ref device;
     VkFence fence;
+    VkSemaphore semaphore;
+
+private:
+    // Serializes the signal operations, and the reset of the binary fence
+    // with the waits on it.
+    std::mutex signalMutex;
+    std::atomic<uint64_t> lastSignalValue;
+
+    // Whether the binary fence was passed to a successful vkQueueSubmit
+    // after it was last reset.
+    bool hasPendingBinarySignal;
 };
 
 } // End of namespace AgpuVulkan
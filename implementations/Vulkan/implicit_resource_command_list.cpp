@@ -105,6 +105,7 @@ void AVkImplicitResourceSetupCommandList::destroy()
     vkDestroyCommandPool(device.device, commandPool, nullptr);
 	commandPool = VK_NULL_HANDLE;
 	commandBuffer = VK_NULL_HANDLE;
+    textureLayoutTracker.reset();
 }
 
 bool AVkImplicitResourceSetupCommandList::createCommandBuffer()
@@ -154,6 +155,7 @@ bool AVkImplicitResourceSetupCommandList::createCommandBuffer()
 
 bool AVkImplicitResourceSetupCommandList::setupCommandBuffer()
 {
+    textureLayoutTracker.reset();
     if(!commandBuffer)
         return createCommandBuffer();
 
@@ -187,18 +189,11 @@ bool AVkImplicitResourceSetupCommandList::submitCommandBuffer()
     if (error)
         abort();
 
-    VkSubmitInfo submitInfo;
-    memset(&submitInfo, 0, sizeof(submitInfo));
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    error = vkQueueSubmit(commandQueue.as<AVkCommandQueue> ()->queue, 1, &submitInfo, VK_NULL_HANDLE);
-    if (error)
+    auto avkCommandQueue = commandQueue.as<AVkCommandQueue> ();
+    if (avkCommandQueue->submitCommandBuffer(commandBuffer))
         abort();
 
-    error = vkQueueWaitIdle(commandQueue.as<AVkCommandQueue> ()->queue);
-    if (error)
+    if (avkCommandQueue->finishExecution())
         abort();
 
     return true;
@@ -234,6 +229,22 @@ bool AVkImplicitResourceSetupCommandList::transitionImageUsageMode(VkImage image
     return true;
 }
 
+bool AVkImplicitResourceSetupCommandList::transitionTextureUsageMode(const agpu::texture_ref &texture, VkImageSubresourceRange range, agpu_texture_usage_mode_mask destUsage)
+{
+    textureLayoutTracker.transition(texture, range, destUsage);
+    textureLayoutTracker.flush(commandBuffer);
+    return true;
+}
+
+bool AVkImplicitResourceSetupCommandList::restoreTextureUsageModes()
+{
+    // The tracked textures are released here, so that they are not kept alive by the device.
+    textureLayoutTracker.restoreMainUsageModes();
+    textureLayoutTracker.flush(commandBuffer);
+    textureLayoutTracker.reset();
+    return true;
+}
+
 VkResult AVkImplicitResourceSetupCommandList::destroyStagingBuffer(VkBuffer bufferHandle, VmaAllocation allocationHandle)
 {
 	vmaUnmapMemory(device.sharedContext->memoryAllocator, allocationHandle);
@@ -4,6 +4,7 @@
 #include "common.hpp"
 #include "include_vulkan.h"
 #include "vk_mem_alloc.h"
+#include "texture_layout_tracker.hpp"
 #include "../Common/utility.hpp"
 #include <memory>
 #include <mutex>
@@ -34,12 +35,17 @@ public:
     bool submitCommandBuffer();
     bool transitionImageUsageMode(VkImage image, agpu_texture_usage_mode_mask allowedUsages, agpu_texture_usage_mode_mask sourceUsage, agpu_texture_usage_mode_mask destUsage, VkImageSubresourceRange range);
 
+    // Transitions of textures that are already in their main usage mode, which go through the layout tracker.
+    bool transitionTextureUsageMode(const agpu::texture_ref &texture, VkImageSubresourceRange range, agpu_texture_usage_mode_mask destUsage);
+    bool restoreTextureUsageModes();
+
     AVkDevice &device;
 
     std::mutex mutex;
     agpu::command_queue_ref commandQueue;
     VkCommandPool commandPool;
     VkCommandBuffer commandBuffer;
+    AVkTextureLayoutTracker textureLayoutTracker;
 
 private:
     bool createCommandBuffer();
@@ -110,58 +110,29 @@ agpu::pipeline_state_ptr AVkGraphicsPipelineBuilder::build()
     if (stages.empty())
         return nullptr;
 
-    // Attachments
-    std::vector<VkAttachmentDescription> attachments(renderTargetFormats.size() + (depthStencilFormat != AGPU_TEXTURE_FORMAT_UNKNOWN? 1 : 0));
+    // Get a compatible render pass from the device cache.
+    if (renderTargetFormats.size() > AVkRenderPassKey::MaxColorAttachmentCount)
+        return nullptr;
+
+    AVkRenderPassKey renderPassKey;
+    renderPassKey.colorAttachmentCount = (uint32_t)renderTargetFormats.size();
     for (agpu_uint i = 0; i < renderTargetFormats.size(); ++i)
     {
-        auto &attachment = attachments[i];
+        auto &attachment = renderPassKey.colorAttachments[i];
         attachment.format = mapTextureFormat(renderTargetFormats[i]);
         attachment.samples = multisampleState.rasterizationSamples;
-        attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-        attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     }
 
     if (depthStencilFormat != AGPU_TEXTURE_FORMAT_UNKNOWN)
     {
-        auto &attachment = attachments.back();
+        auto &attachment = renderPassKey.depthStencilAttachment;
+        renderPassKey.hasDepthStencil = true;
         attachment.format = mapTextureFormat(depthStencilFormat);
         attachment.samples = multisampleState.rasterizationSamples;
-        attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-        attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
         attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
-        attachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-    }
-
-    // Color reference
-    std::vector<VkAttachmentReference> colorReference(renderTargetFormats.size());
-    for (agpu_uint i = 0; i < renderTargetFormats.size(); ++i)
-    {
-        colorReference[i].attachment = i;
-        colorReference[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     }
 
-    // Depth reference
-    VkAttachmentReference depthReference;
-    memset(&depthReference, 0, sizeof(depthReference));
-    depthReference.attachment = (uint32_t)renderTargetFormats.size();
-    depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    // Sub pass
-    VkSubpassDescription subpass;
-    memset(&subpass, 0, sizeof(subpass));
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = (uint32_t)renderTargetFormats.size();
-    subpass.pColorAttachments = colorReference.empty() ? nullptr : &colorReference[0];
-    subpass.pDepthStencilAttachment = &depthReference;
-    if (depthStencilFormat == AGPU_TEXTURE_FORMAT_UNKNOWN)
-        subpass.pDepthStencilAttachment = nullptr;
-
     // Finish the color blend state.
     if (colorBlendAttachmentState.empty())
     {
@@ -174,18 +145,8 @@ agpu::pipeline_state_ptr AVkGraphicsPipelineBuilder::build()
         colorBlendState.pAttachments = &colorBlendAttachmentState[0];
     }
 
-    // Render pass
-    VkRenderPassCreateInfo renderPassCreateInfo;
-    memset(&renderPassCreateInfo, 0, sizeof(renderPassCreateInfo));
-    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassCreateInfo.attachmentCount = (uint32_t)attachments.size();
-    renderPassCreateInfo.pAttachments = &attachments[0];
-    renderPassCreateInfo.subpassCount = 1;
-    renderPassCreateInfo.pSubpasses = &subpass;
-
-    VkRenderPass renderPass;
-    auto error = vkCreateRenderPass(deviceForVk->device, &renderPassCreateInfo, nullptr, &renderPass);
-    if (error)
+    auto renderPass = deviceForVk->renderPassCache.getOrCreate(deviceForVk->device, renderPassKey);
+    if (!renderPass)
         return nullptr;
 
     pipelineInfo.stageCount = (uint32_t)stages.size();
@@ -193,17 +154,13 @@ agpu::pipeline_state_ptr AVkGraphicsPipelineBuilder::build()
     pipelineInfo.renderPass = renderPass;
 
     VkPipeline pipeline;
-    error = vkCreateGraphicsPipelines(deviceForVk->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    auto error = vkCreateGraphicsPipelines(deviceForVk->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
     if (error)
-    {
-        vkDestroyRenderPass(deviceForVk->device, renderPass, nullptr);
         return nullptr;
-    }
 
     auto result = agpu::makeObject<AVkPipelineState> (device);
     auto avkPipeline = result.as<AVkPipelineState> ();
     avkPipeline->pipeline = pipeline;
-    avkPipeline->renderPass = renderPass;
 	avkPipeline->bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     return result.disown();
 }
@@ -7,14 +7,13 @@ AVkPipelineState::AVkPipelineState(const agpu::device_ref &device)
     : device(device)
 {
     pipeline = VK_NULL_HANDLE;
-	renderPass = VK_NULL_HANDLE;
+    ++deviceForVk->pipelineStateCount;
 }
 
 AVkPipelineState::~AVkPipelineState()
 {
     vkDestroyPipeline(deviceForVk->device, pipeline, nullptr);
-	if(renderPass != VK_NULL_HANDLE)
-		vkDestroyRenderPass(deviceForVk->device, renderPass, nullptr);
+    --deviceForVk->pipelineStateCount;
 }
 
 agpu_int AVkPipelineState::getUniformLocation(agpu_cstring name)
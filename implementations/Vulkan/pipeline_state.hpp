@@ -16,7 +16,6 @@ public:
 
     agpu::device_ref device;
     VkPipeline pipeline;
-    VkRenderPass renderPass;
 	VkPipelineBindPoint bindPoint;
 };
 
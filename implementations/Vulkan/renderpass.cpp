@@ -34,8 +34,7 @@ AVkRenderPass::AVkRenderPass(const agpu::device_ref &device)
 
 AVkRenderPass::~AVkRenderPass()
 {
-    if (handle)
-        vkDestroyRenderPass(deviceForVk->device, handle, nullptr);
+    // The render pass handle is owned by the device render pass cache.
 }
 
 agpu::renderpass_ref AVkRenderPass::create(const agpu::device_ref &device, agpu_renderpass_description *description)
@@ -55,13 +54,16 @@ agpu::renderpass_ref AVkRenderPass::create(const agpu::device_ref &device, agpu_
     agpu_uint sampleQuality = 0;
 
     bool hasDepthStencil = description->depth_stencil_attachment != nullptr;
-    std::vector<VkAttachmentDescription> attachments(colorCount + (hasDepthStencil ? 1 : 0));
+    AVkRenderPassKey renderPassKey;
+    renderPassKey.colorAttachmentCount = colorCount;
+    renderPassKey.hasDepthStencil = hasDepthStencil;
+
     std::vector<VkClearValue> clearValues;
-    clearValues.reserve(attachments.size());
+    clearValues.reserve(colorCount + (hasDepthStencil ? 1 : 0));
     for (agpu_uint i = 0; i < colorCount; ++i)
     {
         auto desc = description->color_attachments[i];
-        auto &attachment = attachments[i];
+        auto &attachment = renderPassKey.colorAttachments[i];
         colorAttachmentFormats[i] = desc.format;
 
         attachment.format = mapTextureFormat(desc.format);
@@ -70,8 +72,6 @@ agpu::renderpass_ref AVkRenderPass::create(const agpu::device_ref &device, agpu_
         attachment.storeOp = mapStoreOp(desc.end_action);
         attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
         sampleCount = desc.sample_count;
         sampleQuality = desc.sample_quality;
@@ -87,7 +87,7 @@ agpu::renderpass_ref AVkRenderPass::create(const agpu::device_ref &device, agpu_
     if (hasDepthStencil)
     {
         auto desc = description->depth_stencil_attachment;
-        auto &attachment = attachments.back();
+        auto &attachment = renderPassKey.depthStencilAttachment;
         auto hasStencil = hasStencilComponent(desc->format);
         depthStencilFormat = desc->format;
         attachment.format = mapTextureFormat(desc->format);
@@ -102,9 +102,6 @@ agpu::renderpass_ref AVkRenderPass::create(const agpu::device_ref &device, agpu_
             attachment.stencilStoreOp = mapStoreOp(desc->stencil_end_action);
         }
 
-        attachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
         sampleCount = desc->sample_count;
         sampleQuality = desc->sample_quality;
 
@@ -114,42 +111,9 @@ agpu::renderpass_ref AVkRenderPass::create(const agpu::device_ref &device, agpu_
         clearValues.push_back(clearValue);
     }
 
-    // Color reference
-    std::vector<VkAttachmentReference> colorReference(colorCount);
-    for (agpu_uint i = 0; i < colorCount; ++i)
-    {
-        colorReference[i].attachment = i;
-        colorReference[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    }
-
-    // Depth reference
-    VkAttachmentReference depthReference;
-    memset(&depthReference, 0, sizeof(depthReference));
-    depthReference.attachment = colorCount;
-    depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    // Sub pass
-    VkSubpassDescription subpass;
-    memset(&subpass, 0, sizeof(subpass));
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = colorCount;
-    subpass.pColorAttachments = colorReference.empty() ? nullptr : &colorReference[0];
-    subpass.pDepthStencilAttachment = &depthReference;
-    if (!hasDepthStencil)
-        subpass.pDepthStencilAttachment = nullptr;
-
-    // Render pass
-    VkRenderPassCreateInfo renderPassCreateInfo;
-    memset(&renderPassCreateInfo, 0, sizeof(renderPassCreateInfo));
-    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassCreateInfo.attachmentCount = (uint32_t)attachments.size();
-    renderPassCreateInfo.pAttachments = &attachments[0];
-    renderPassCreateInfo.subpassCount = 1;
-    renderPassCreateInfo.pSubpasses = &subpass;
-
-    VkRenderPass renderPass;
-    auto error = vkCreateRenderPass(deviceForVk->device, &renderPassCreateInfo, nullptr, &renderPass);
-    if (error)
+    // Get the render pass from the device cache.
+    auto renderPass = deviceForVk->renderPassCache.getOrCreate(deviceForVk->device, renderPassKey);
+    if (!renderPass)
         return agpu::renderpass_ref();
 
     auto result = agpu::makeObject<AVkRenderPass> (device);
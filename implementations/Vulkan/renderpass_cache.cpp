@@ -0,0 +1,205 @@
+#include "renderpass_cache.hpp"
+#include <vector>
+
+namespace AgpuVulkan
+{
+
+template<typename T>
+static size_t hashOf(const T &v)
+{
+    return std::hash<T> ()(v);
+}
+
+static size_t hashOfEnum(uint32_t v)
+{
+    return hashOf(v);
+}
+
+// AVkRenderPassAttachmentKey
+AVkRenderPassAttachmentKey::AVkRenderPassAttachmentKey()
+{
+    format = VK_FORMAT_UNDEFINED;
+    samples = VK_SAMPLE_COUNT_1_BIT;
+    loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+}
+
+bool AVkRenderPassAttachmentKey::operator==(const AVkRenderPassAttachmentKey &o) const
+{
+    return
+        format == o.format &&
+        samples == o.samples &&
+        loadOp == o.loadOp &&
+        storeOp == o.storeOp &&
+        stencilLoadOp == o.stencilLoadOp &&
+        stencilStoreOp == o.stencilStoreOp;
+}
+
+size_t AVkRenderPassAttachmentKey::hash() const
+{
+    return
+        hashOfEnum(format) ^
+        (hashOfEnum(samples) << 1) ^
+        (hashOfEnum(loadOp) << 2) ^
+        (hashOfEnum(storeOp) << 3) ^
+        (hashOfEnum(stencilLoadOp) << 4) ^
+        (hashOfEnum(stencilStoreOp) << 5);
+}
+
+// AVkRenderPassKey
+AVkRenderPassKey::AVkRenderPassKey()
+{
+    colorAttachmentCount = 0;
+    hasDepthStencil = false;
+}
+
+bool AVkRenderPassKey::operator==(const AVkRenderPassKey &o) const
+{
+    if(colorAttachmentCount != o.colorAttachmentCount || hasDepthStencil != o.hasDepthStencil)
+        return false;
+
+    for(uint32_t i = 0; i < colorAttachmentCount; ++i)
+    {
+        if(!(colorAttachments[i] == o.colorAttachments[i]))
+            return false;
+    }
+
+    return !hasDepthStencil || depthStencilAttachment == o.depthStencilAttachment;
+}
+
+size_t AVkRenderPassKey::hash() const
+{
+    auto result = hashOf(colorAttachmentCount) ^ hashOf(hasDepthStencil);
+    for(uint32_t i = 0; i < colorAttachmentCount; ++i)
+        result = result*31 + colorAttachments[i].hash();
+    if(hasDepthStencil)
+        result = result*31 + depthStencilAttachment.hash();
+    return result;
+}
+
+// AVkRenderPassCache
+AVkRenderPassCache::AVkRenderPassCache()
+{
+    hitCount = 0;
+    missCount = 0;
+}
+
+AVkRenderPassCache::~AVkRenderPassCache()
+{
+    assert(renderPasses.empty());
+}
+
+void AVkRenderPassCache::destroy(VkDevice device)
+{
+    std::unique_lock<std::mutex> l(mutex);
+    for(auto &entry : renderPasses)
+        vkDestroyRenderPass(device, entry.second, nullptr);
+    renderPasses.clear();
+}
+
+VkRenderPass AVkRenderPassCache::getOrCreate(VkDevice device, const AVkRenderPassKey &key)
+{
+    std::unique_lock<std::mutex> l(mutex);
+    auto it = renderPasses.find(key);
+    if(it != renderPasses.end())
+    {
+        ++hitCount;
+        return it->second;
+    }
+
+    ++missCount;
+
+    // Attachments
+    auto colorCount = key.colorAttachmentCount;
+    std::vector<VkAttachmentDescription> attachments(colorCount + (key.hasDepthStencil ? 1 : 0));
+    for (uint32_t i = 0; i < colorCount; ++i)
+    {
+        auto &source = key.colorAttachments[i];
+        auto &attachment = attachments[i];
+        memset(&attachment, 0, sizeof(attachment));
+        attachment.format = source.format;
+        attachment.samples = source.samples;
+        attachment.loadOp = source.loadOp;
+        attachment.storeOp = source.storeOp;
+        attachment.stencilLoadOp = source.stencilLoadOp;
+        attachment.stencilStoreOp = source.stencilStoreOp;
+        attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    if (key.hasDepthStencil)
+    {
+        auto &source = key.depthStencilAttachment;
+        auto &attachment = attachments.back();
+        memset(&attachment, 0, sizeof(attachment));
+        attachment.format = source.format;
+        attachment.samples = source.samples;
+        attachment.loadOp = source.loadOp;
+        attachment.storeOp = source.storeOp;
+        attachment.stencilLoadOp = source.stencilLoadOp;
+        attachment.stencilStoreOp = source.stencilStoreOp;
+        attachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    }
+
+    // Color reference
+    std::vector<VkAttachmentReference> colorReference(colorCount);
+    for (uint32_t i = 0; i < colorCount; ++i)
+    {
+        colorReference[i].attachment = i;
+        colorReference[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    // Depth reference
+    VkAttachmentReference depthReference;
+    memset(&depthReference, 0, sizeof(depthReference));
+    depthReference.attachment = colorCount;
+    depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    // Sub pass
+    VkSubpassDescription subpass;
+    memset(&subpass, 0, sizeof(subpass));
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = colorCount;
+    subpass.pColorAttachments = colorReference.empty() ? nullptr : &colorReference[0];
+    subpass.pDepthStencilAttachment = key.hasDepthStencil ? &depthReference : nullptr;
+
+    // Render pass
+    VkRenderPassCreateInfo renderPassCreateInfo;
+    memset(&renderPassCreateInfo, 0, sizeof(renderPassCreateInfo));
+    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassCreateInfo.attachmentCount = (uint32_t)attachments.size();
+    renderPassCreateInfo.pAttachments = attachments.empty() ? nullptr : &attachments[0];
+    renderPassCreateInfo.subpassCount = 1;
+    renderPassCreateInfo.pSubpasses = &subpass;
+
+    VkRenderPass renderPass;
+    auto error = vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass);
+    if (error)
+        return VK_NULL_HANDLE;
+
+    renderPasses.insert(std::make_pair(key, renderPass));
+    return renderPass;
+}
+
+agpu_uint AVkRenderPassCache::getRenderPassCount()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    return (agpu_uint)renderPasses.size();
+}
+
+agpu_uint AVkRenderPassCache::getHitCount()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    return hitCount;
+}
+
+agpu_uint AVkRenderPassCache::getMissCount()
+{
+    std::unique_lock<std::mutex> l(mutex);
+    return missCount;
+}
+
+} // End of namespace AgpuVulkan
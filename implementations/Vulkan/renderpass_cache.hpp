@@ -0,0 +1,95 @@
+#ifndef AGPU_VULKAN_RENDERPASS_CACHE_HPP
+#define AGPU_VULKAN_RENDERPASS_CACHE_HPP
+
+#include "common.hpp"
+#include "include_vulkan.h"
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+namespace AgpuVulkan
+{
+
+/**
+ * The description of a render pass attachment, as used by the render pass cache.
+ */
+struct AVkRenderPassAttachmentKey
+{
+    AVkRenderPassAttachmentKey();
+
+    bool operator==(const AVkRenderPassAttachmentKey &o) const;
+    size_t hash() const;
+
+    VkFormat format;
+    VkSampleCountFlagBits samples;
+    VkAttachmentLoadOp loadOp;
+    VkAttachmentStoreOp storeOp;
+    VkAttachmentLoadOp stencilLoadOp;
+    VkAttachmentStoreOp stencilStoreOp;
+};
+
+/**
+ * The key of a single subpass render pass in the cache. Keys that only
+ * differ in their load and store operations produce compatible render passes.
+ */
+struct AVkRenderPassKey
+{
+    static constexpr size_t MaxColorAttachmentCount = 16;
+
+    AVkRenderPassKey();
+
+    bool operator==(const AVkRenderPassKey &o) const;
+    size_t hash() const;
+
+    uint32_t colorAttachmentCount;
+    std::array<AVkRenderPassAttachmentKey, MaxColorAttachmentCount> colorAttachments;
+    bool hasDepthStencil;
+    AVkRenderPassAttachmentKey depthStencilAttachment;
+};
+
+} // End of namespace AgpuVulkan
+
+namespace std
+{
+template<>
+struct hash<AgpuVulkan::AVkRenderPassKey>
+{
+    size_t operator()(const AgpuVulkan::AVkRenderPassKey &ref) const
+    {
+        return ref.hash();
+    }
+};
+}
+
+namespace AgpuVulkan
+{
+
+/**
+ * A device level cache of render passes. The render passes that are created
+ * through this cache are owned by it, and they are shared between the
+ * pipelines, the framebuffers and the user render passes.
+ */
+class AVkRenderPassCache
+{
+public:
+    AVkRenderPassCache();
+    ~AVkRenderPassCache();
+
+    void destroy(VkDevice device);
+
+    VkRenderPass getOrCreate(VkDevice device, const AVkRenderPassKey &key);
+
+    agpu_uint getRenderPassCount();
+    agpu_uint getHitCount();
+    agpu_uint getMissCount();
+
+private:
+    std::mutex mutex;
+    std::unordered_map<AVkRenderPassKey, VkRenderPass> renderPasses;
+    agpu_uint hitCount;
+    agpu_uint missCount;
+};
+
+} // End of namespace AgpuVulkan
+
+#endif //AGPU_VULKAN_RENDERPASS_CACHE_HPP
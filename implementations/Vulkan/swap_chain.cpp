@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <chrono>
 #include "swap_chain.hpp"
 #include "texture.hpp"
 #include "texture_format.hpp"
@@ -18,17 +19,42 @@ AVkSwapChain::AVkSwapChain(const agpu::device_ref &device)
 {
     surface = VK_NULL_HANDLE;
     handle = VK_NULL_HANDLE;
+    imageCount = 0;
+    framesInFlight = 0;
     currentBackBufferIndex = 0;
+    currentFrameIndex = 0;
+    hasAcquiredBackBuffer = false;
+
+    frameCount = 0;
+    lastCpuWaitTime = 0.0;
+    totalCpuWaitTime = 0.0;
+    maxCpuWaitTime = 0.0;
 }
 
 AVkSwapChain::~AVkSwapChain()
 {
-    for(auto semaphore : semaphores)
+    // The semaphores and the fences may still be in use by the GPU.
+    if(graphicsQueue)
+        graphicsQueue->finishExecution();
+
+    for(auto semaphore : presentSemaphores)
+    {
+        if(semaphore)
+            vkDestroySemaphore(deviceForVk->device, semaphore, nullptr);
+    }
+
+    for(auto semaphore : acquireSemaphores)
     {
         if(semaphore)
             vkDestroySemaphore(deviceForVk->device, semaphore, nullptr);
     }
 
+    for(auto fence : frameFences)
+    {
+        if(fence)
+            vkDestroyFence(deviceForVk->device, fence, nullptr);
+    }
+
     if (handle)
         vkDestroySwapchainKHR(deviceForVk->device, handle, nullptr);
     if(surface)
@@ -111,6 +137,22 @@ static VkResult createDisplaySurface(const agpu::device_ref &device, const agpu:
     return VK_INCOMPLETE;
 }
 
+static VkResult createHeadlessSurface(const agpu::device_ref &device, const agpu::command_queue_ref &graphicsCommandQueue, agpu_swap_chain_create_info *createInfo, VkSurfaceKHR *surface)
+{
+#ifdef VK_EXT_headless_surface
+    if(!deviceForVk->hasHeadlessSurface)
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+
+    VkHeadlessSurfaceCreateInfoEXT surfaceCreateInfo;
+    memset(&surfaceCreateInfo, 0, sizeof(surfaceCreateInfo));
+    surfaceCreateInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+    return deviceForVk->fpCreateHeadlessSurfaceEXT(deviceForVk->vulkanInstance, &surfaceCreateInfo, nullptr, surface);
+#else
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+#endif
+}
+
 static VkResult createDefaultSurface(const agpu::device_ref &device, const agpu::command_queue_ref &graphicsCommandQueue, agpu_swap_chain_create_info *createInfo, const OverlaySwapChainWindowPtr &overlayWindow, VkSurfaceKHR *surface)
 {
 #if defined(_WIN32)
@@ -168,6 +210,8 @@ agpu::swap_chain_ref AVkSwapChain::create(const agpu::device_ref &device, const
             error = createWin32Surface(device, graphicsCommandQueue, createInfo, overlayWindow, &surface);
         else if(!strcmp(createInfo->window_system_name, "display"))
             error = createDisplaySurface(device, graphicsCommandQueue, createInfo, &surface);
+        else if(!strcmp(createInfo->window_system_name, "headless"))
+            error = createHeadlessSurface(device, graphicsCommandQueue, createInfo, &surface);
 
         if(error || surface == VK_NULL_HANDLE)
         {
@@ -385,15 +429,39 @@ bool AVkSwapChain::initialize(agpu_swap_chain_create_info *createInfo)
         depthStencilDesc.usage_modes = agpu_texture_usage_mode_mask(depthStencilDesc.usage_modes | AGPU_TEXTURE_USAGE_STENCIL_ATTACHMENT);
     depthStencilDesc.main_usage_mode = depthStencilDesc.usage_modes;
 
+    // Compute the number of frames in flight.
+    framesInFlight = createInfo->frames_in_flight;
+    if(framesInFlight == 0)
+        framesInFlight = DefaultFramesInFlight;
+    framesInFlight = std::max(1u, std::min(framesInFlight, imageCount));
+
     // Create the semaphores
     VkSemaphoreCreateInfo semaphoreInfo;
     memset(&semaphoreInfo, 0, sizeof(semaphoreInfo));
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphores.resize(imageCount, VK_NULL_HANDLE);
-    currentSemaphoreIndex = 0;
+    presentSemaphores.resize(imageCount, VK_NULL_HANDLE);
     for (size_t i = 0; i < imageCount; ++i)
     {
-        error = vkCreateSemaphore(deviceForVk->device, &semaphoreInfo, nullptr, &semaphores[i]);
+        error = vkCreateSemaphore(deviceForVk->device, &semaphoreInfo, nullptr, &presentSemaphores[i]);
+        if(error)
+            return false;
+    }
+
+    // Create the per frame synchronization objects.
+    VkFenceCreateInfo fenceInfo;
+    memset(&fenceInfo, 0, sizeof(fenceInfo));
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    acquireSemaphores.resize(framesInFlight, VK_NULL_HANDLE);
+    frameFences.resize(framesInFlight, VK_NULL_HANDLE);
+    submittedFrameFences.resize(framesInFlight, false);
+    currentFrameIndex = 0;
+    for (size_t i = 0; i < framesInFlight; ++i)
+    {
+        error = vkCreateSemaphore(deviceForVk->device, &semaphoreInfo, nullptr, &acquireSemaphores[i]);
+        if(error)
+            return false;
+
+        error = vkCreateFence(deviceForVk->device, &fenceInfo, nullptr, &frameFences[i]);
         if(error)
             return false;
     }
@@ -457,11 +525,35 @@ bool AVkSwapChain::initialize(agpu_swap_chain_create_info *createInfo)
     return nextBackBufferError == AGPU_OK || nextBackBufferError == AGPU_OUT_OF_DATE || nextBackBufferError == AGPU_SUBOPTIMAL;
 }
 
+agpu_error AVkSwapChain::waitForFrameFence(uint32_t frameIndex)
+{
+    if(!submittedFrameFences[frameIndex])
+        return AGPU_OK;
+
+    auto fence = frameFences[frameIndex];
+    auto error = vkWaitForFences(deviceForVk->device, 1, &fence, VK_TRUE, UINT64_MAX);
+    CONVERT_VULKAN_ERROR(error);
+
+    submittedFrameFences[frameIndex] = false;
+    return AGPU_OK;
+}
+
 agpu_error AVkSwapChain::getNextBackBufferIndex()
 {
-    auto semaphore = semaphores[currentSemaphoreIndex];
-    currentSemaphoreIndex = (currentSemaphoreIndex + 1) % semaphores.size();
+    // Do not get more than framesInFlight frames ahead of the GPU. This wait
+    // and the image acquisition are accounted as the CPU wait time.
+    auto waitStartTime = std::chrono::high_resolution_clock::now();
+    auto waitError = waitForFrameFence(currentFrameIndex);
+    if(waitError)
+        return waitError;
+
+    auto semaphore = acquireSemaphores[currentFrameIndex];
     auto error = deviceForVk->fpAcquireNextImageKHR(deviceForVk->device, handle, UINT64_MAX, semaphore, VK_NULL_HANDLE, &currentBackBufferIndex);
+
+    lastCpuWaitTime = std::chrono::duration<double, std::milli> (std::chrono::high_resolution_clock::now() - waitStartTime).count();
+    totalCpuWaitTime += lastCpuWaitTime;
+    maxCpuWaitTime = std::max(maxCpuWaitTime, lastCpuWaitTime);
+
     agpu_error result = AGPU_OK;
     if (error == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -476,32 +568,52 @@ agpu_error AVkSwapChain::getNextBackBufferIndex()
         CONVERT_VULKAN_ERROR(error);
     }
 
-    {
-        VkSubmitInfo submit;
-        memset(&submit, 0, sizeof(submit));
-        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit.waitSemaphoreCount = 1;
-        submit.pWaitSemaphores = &semaphore;
-
-        VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
-        submit.pWaitDstStageMask = &waitDstStageMask;
-
-        vkQueueSubmit(graphicsQueue.as<AVkCommandQueue> ()->queue, 1, &submit, VK_NULL_HANDLE);
-    }
-
+    // The acquire semaphore is waited by the first command lists that are
+    // submitted for this frame, instead of using an empty submission.
+    graphicsQueue.as<AVkCommandQueue> ()->addPendingWaitSemaphore(semaphore, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT);
+    hasAcquiredBackBuffer = true;
     return result;
 }
 
 agpu_error AVkSwapChain::swapBuffers()
 {
+    if(!hasAcquiredBackBuffer)
+        return getNextBackBufferIndex();
+
+    // Submit the deferred command lists that render into the back buffer,
+    // and signal the semaphore for the presentation and the frame fence.
+    auto frameFence = frameFences[currentFrameIndex];
+    auto error = vkResetFences(deviceForVk->device, 1, &frameFence);
+    CONVERT_VULKAN_ERROR(error);
+
+    auto renderFinishedSemaphore = presentSemaphores[currentBackBufferIndex];
+    {
+        AVkSubmitBatch batch;
+        batch.addSignalSemaphore(renderFinishedSemaphore);
+        auto submitError = graphicsQueue.as<AVkCommandQueue> ()->submitBatch(batch, frameFence);
+        if(submitError)
+            return submitError;
+    }
+    submittedFrameFences[currentFrameIndex] = true;
+    hasAcquiredBackBuffer = false;
+    ++frameCount;
+
+    if (presentationQueue != graphicsQueue)
+        presentationQueue.as<AVkCommandQueue> ()->flushPendingSubmissions();
+
     // Present.
     VkPresentInfoKHR presentInfo;
     memset(&presentInfo, 0, sizeof(presentInfo));
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = &handle;
     presentInfo.pImageIndices = &currentBackBufferIndex;
-    auto error = deviceForVk->fpQueuePresentKHR(presentationQueue.as<AVkCommandQueue> ()->queue, &presentInfo);
+    error = deviceForVk->fpQueuePresentKHR(presentationQueue.as<AVkCommandQueue> ()->queue, &presentInfo);
+
+    // Advance to the next frame.
+    currentFrameIndex = (currentFrameIndex + 1) % framesInFlight;
 
     if (error == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -541,4 +653,27 @@ agpu_error AVkSwapChain::setOverlayPosition(agpu_int x, agpu_int y)
     return overlayWindow->setPosition(x, y);
 }
 
+agpu_error AVkSwapChain::getFramePacingStatistics(agpu_frame_pacing_statistics* statistics)
+{
+    CHECK_POINTER(statistics);
+
+    agpu_uint pendingFrameCount = 0;
+    for(uint32_t i = 0; i < framesInFlight; ++i)
+    {
+        if(submittedFrameFences[i] && vkGetFenceStatus(deviceForVk->device, frameFences[i]) == VK_NOT_READY)
+            ++pendingFrameCount;
+    }
+
+    // The first wait happens during the initialization.
+    auto waitCount = frameCount + 1;
+
+    statistics->frames_in_flight = framesInFlight;
+    statistics->frame_count = frameCount;
+    statistics->pending_frame_count = pendingFrameCount;
+    statistics->last_cpu_wait_time = agpu_float(lastCpuWaitTime);
+    statistics->average_cpu_wait_time = agpu_float(totalCpuWaitTime / waitCount);
+    statistics->max_cpu_wait_time = agpu_float(maxCpuWaitTime);
+    return AGPU_OK;
+}
+
 } // End of namespace AgpuVulkan
@@ -14,6 +14,8 @@ namespace AgpuVulkan
 struct AVkSwapChain : public agpu::swap_chain
 {
 public:
+    static constexpr uint32_t DefaultFramesInFlight = 2;
+
     AVkSwapChain(const agpu::device_ref &device);
     ~AVkSwapChain();
 
@@ -26,6 +28,7 @@ public:
     virtual agpu_size getFramebufferCount() override;
 
     virtual agpu_error setOverlayPosition(agpu_int x, agpu_int y) override;
+    virtual agpu_error getFramePacingStatistics(agpu_frame_pacing_statistics* statistics) override;
 
     agpu::device_ref device;
     VkSurfaceKHR surface;
@@ -39,15 +42,32 @@ public:
     VkColorSpaceKHR colorSpace;
 
     VkSwapchainKHR handle;
-    std::vector<VkSemaphore> semaphores;
     std::vector<agpu::framebuffer_ref> framebuffers;
 
+    // One semaphore per image, signaled when the rendering of the image is finished.
+    std::vector<VkSemaphore> presentSemaphores;
+
+    // One acquire semaphore and fence per frame in flight.
+    std::vector<VkSemaphore> acquireSemaphores;
+    std::vector<VkFence> frameFences;
+    std::vector<bool> submittedFrameFences;
+
     uint32_t imageCount;
+    uint32_t framesInFlight;
     uint32_t currentBackBufferIndex;
-    uint32_t currentSemaphoreIndex;
+    uint32_t currentFrameIndex;
+    bool hasAcquiredBackBuffer;
     AgpuCommon::OverlaySwapChainWindowPtr overlayWindow;
+
+    // Frame pacing statistics. The times are in milliseconds.
+    agpu_uint frameCount;
+    double lastCpuWaitTime;
+    double totalCpuWaitTime;
+    double maxCpuWaitTime;
+
 private:
     agpu_error getNextBackBufferIndex();
+    agpu_error waitForFrameFence(uint32_t frameIndex);
 };
 
 } // End of namespace AgpuVulkan
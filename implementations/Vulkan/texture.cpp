@@ -402,9 +402,9 @@ agpu_error AVkTexture::readTextureSubData(agpu_int level, agpu_int arrayIndex, a
 
         // Copy the image data into staging buffer.
         auto success = readbackList.setupCommandBuffer() &&
-            readbackList.transitionImageUsageMode(image, description.usage_modes, description.main_usage_mode, AGPU_TEXTURE_USAGE_COPY_SOURCE, range) &&
+            readbackList.transitionTextureUsageMode(refFromThis<agpu::texture> (), range, AGPU_TEXTURE_USAGE_COPY_SOURCE) &&
             readbackList.readbackImageDataToBuffer(image, copy) &&
-            readbackList.transitionImageUsageMode(image, description.usage_modes, AGPU_TEXTURE_USAGE_COPY_SOURCE, description.main_usage_mode, range) &&
+            readbackList.restoreTextureUsageModes() &&
             readbackList.submitCommandBuffer();
 
         if(success)
@@ -489,9 +489,9 @@ agpu_error AVkTexture::uploadTextureSubData (agpu_int level, agpu_int arrayIndex
         }
 
         auto success = uploadList.setupCommandBuffer() &&
-            uploadList.transitionImageUsageMode(image, description.usage_modes, description.main_usage_mode, AGPU_TEXTURE_USAGE_COPY_DESTINATION, range) &&
+            uploadList.transitionTextureUsageMode(refFromThis<agpu::texture> (), range, AGPU_TEXTURE_USAGE_COPY_DESTINATION) &&
             uploadList.uploadBufferDataToImage(image, copy) &&
-            uploadList.transitionImageUsageMode(image, description.usage_modes, AGPU_TEXTURE_USAGE_COPY_DESTINATION, description.main_usage_mode, range) &&
+            uploadList.restoreTextureUsageModes() &&
             uploadList.submitCommandBuffer();
         resultCode = success ? AGPU_OK : AGPU_ERROR;
     });
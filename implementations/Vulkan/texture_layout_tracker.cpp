@@ -0,0 +1,258 @@
+#include "texture_layout_tracker.hpp"
+#include "implicit_resource_command_list.hpp"
+#include "texture.hpp"
+#include "constants.hpp"
+#include <algorithm>
+
+namespace AgpuVulkan
+{
+
+AVkTextureLayoutTracker::AVkTextureLayoutTracker()
+{
+    explicitSrcStages = 0;
+    explicitDstStages = 0;
+}
+
+AVkTextureLayoutTracker::~AVkTextureLayoutTracker()
+{
+}
+
+void AVkTextureLayoutTracker::reset()
+{
+    textureStates.clear();
+    dirtyTextures.clear();
+    explicitSrcStages = 0;
+    explicitDstStages = 0;
+}
+
+AVkTextureLayoutTracker::TextureState &AVkTextureLayoutTracker::stateFor(const agpu::texture_ref &texture)
+{
+    auto avkTexture = texture.as<AVkTexture> ();
+    auto it = textureStates.find(avkTexture);
+    if(it != textureStates.end())
+        return it->second;
+
+    auto wholeRange = wholeRangeOf(texture);
+    auto subresourceCount = wholeRange.levelCount * wholeRange.layerCount;
+
+    auto &state = textureStates[avkTexture];
+    state.texture = texture;
+    state.levelCount = wholeRange.levelCount;
+    state.layerCount = wholeRange.layerCount;
+    state.currentUsages.resize(subresourceCount, avkTexture->description.main_usage_mode);
+    state.targetUsages.resize(subresourceCount, avkTexture->description.main_usage_mode);
+    state.explicitSrcAccesses.resize(subresourceCount, 0);
+    state.explicitDstAccesses.resize(subresourceCount, 0);
+    state.dirtySubresources.resize(subresourceCount, false);
+    state.isDirty = false;
+    return state;
+}
+
+void AVkTextureLayoutTracker::markDirty(TextureState &state, agpu_uint index)
+{
+    state.dirtySubresources[index] = true;
+    if(!state.isDirty)
+    {
+        state.isDirty = true;
+        dirtyTextures.push_back(state.texture.as<AVkTexture> ());
+    }
+}
+
+VkImageSubresourceRange AVkTextureLayoutTracker::wholeRangeOf(const agpu::texture_ref &texture)
+{
+    auto avkTexture = texture.as<AVkTexture> ();
+    auto &description = avkTexture->description;
+
+    VkImageSubresourceRange range = {};
+    range.aspectMask = avkTexture->imageAspect;
+    range.levelCount = std::max(agpu_uint(description.miplevels), 1u);
+    range.layerCount = std::max(agpu_uint(description.layers), 1u);
+    if(description.type == AGPU_TEXTURE_CUBE)
+        range.layerCount *= 6;
+    return range;
+}
+
+VkImageSubresourceRange AVkTextureLayoutTracker::clampRange(const agpu::texture_ref &texture, const agpu_subresource_range &subresourceRange)
+{
+    auto range = wholeRangeOf(texture);
+    auto baseLevel = std::min(subresourceRange.base_miplevel, range.levelCount);
+    auto baseLayer = std::min(subresourceRange.base_arraylayer, range.layerCount);
+    auto levelCount = range.levelCount - baseLevel;
+    auto layerCount = range.layerCount - baseLayer;
+
+    // A count of zero means the remaining levels or layers.
+    if(subresourceRange.level_count != 0)
+        levelCount = std::min(subresourceRange.level_count, levelCount);
+    if(subresourceRange.layer_count != 0)
+        layerCount = std::min(subresourceRange.layer_count, layerCount);
+
+    range.baseMipLevel = baseLevel;
+    range.levelCount = levelCount;
+    range.baseArrayLayer = baseLayer;
+    range.layerCount = layerCount;
+    return range;
+}
+
+agpu_texture_usage_mode_mask AVkTextureLayoutTracker::getUsageMode(const agpu::texture_ref &texture, agpu_uint level, agpu_uint layer)
+{
+    auto avkTexture = texture.as<AVkTexture> ();
+    auto it = textureStates.find(avkTexture);
+    if(it == textureStates.end())
+        return avkTexture->description.main_usage_mode;
+
+    auto &state = it->second;
+    if(level >= state.levelCount || layer >= state.layerCount)
+        return avkTexture->description.main_usage_mode;
+    return state.targetUsages[level*state.layerCount + layer];
+}
+
+void AVkTextureLayoutTracker::transition(const agpu::texture_ref &texture, const VkImageSubresourceRange &range, agpu_texture_usage_mode_mask newUsage)
+{
+    auto &state = stateFor(texture);
+    auto endLevel = std::min(range.baseMipLevel + range.levelCount, state.levelCount);
+    auto endLayer = std::min(range.baseArrayLayer + range.layerCount, state.layerCount);
+    for(auto level = range.baseMipLevel; level < endLevel; ++level)
+    {
+        for(auto layer = range.baseArrayLayer; layer < endLayer; ++layer)
+        {
+            auto index = level*state.layerCount + layer;
+            if(state.targetUsages[index] == newUsage)
+                continue;
+
+            state.targetUsages[index] = newUsage;
+            markDirty(state, index);
+        }
+    }
+}
+
+void AVkTextureLayoutTracker::memoryBarrier(const agpu::texture_ref &texture, const VkImageSubresourceRange &range, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, VkAccessFlags srcAccesses, VkAccessFlags dstAccesses)
+{
+    auto &state = stateFor(texture);
+    auto endLevel = std::min(range.baseMipLevel + range.levelCount, state.levelCount);
+    auto endLayer = std::min(range.baseArrayLayer + range.layerCount, state.layerCount);
+    for(auto level = range.baseMipLevel; level < endLevel; ++level)
+    {
+        for(auto layer = range.baseArrayLayer; layer < endLayer; ++layer)
+        {
+            auto index = level*state.layerCount + layer;
+            state.explicitSrcAccesses[index] |= srcAccesses;
+            state.explicitDstAccesses[index] |= dstAccesses;
+            markDirty(state, index);
+        }
+    }
+
+    explicitSrcStages |= srcStages;
+    explicitDstStages |= dstStages;
+}
+
+void AVkTextureLayoutTracker::restoreMainUsageModes()
+{
+    for(auto &textureAndState : textureStates)
+    {
+        auto &state = textureAndState.second;
+        VkImageSubresourceRange range = {};
+        range.levelCount = state.levelCount;
+        range.layerCount = state.layerCount;
+        transition(state.texture, range, textureAndState.first->description.main_usage_mode);
+    }
+}
+
+bool AVkTextureLayoutTracker::hasPendingBarriers() const
+{
+    return !dirtyTextures.empty();
+}
+
+void AVkTextureLayoutTracker::flush(VkCommandBuffer commandBuffer)
+{
+    if(!hasPendingBarriers())
+        return;
+
+    barriers.clear();
+    VkPipelineStageFlags srcStages = explicitSrcStages;
+    VkPipelineStageFlags dstStages = explicitDstStages;
+
+    for(auto avkTexture : dirtyTextures)
+    {
+        auto &state = textureStates[avkTexture];
+        for(agpu_uint level = 0; level < state.levelCount; ++level)
+        {
+            auto levelBase = level*state.layerCount;
+            agpu_uint layer = 0;
+            while(layer < state.layerCount)
+            {
+                auto sourceUsage = state.currentUsages[levelBase + layer];
+                auto destUsage = state.targetUsages[levelBase + layer];
+                auto explicitSrcAccess = state.explicitSrcAccesses[levelBase + layer];
+                auto explicitDstAccess = state.explicitDstAccesses[levelBase + layer];
+                if(sourceUsage == destUsage && !state.dirtySubresources[levelBase + layer])
+                {
+                    ++layer;
+                    continue;
+                }
+
+                // Gather the run of layers that go through the same transition.
+                auto firstLayer = layer;
+                while(layer < state.layerCount &&
+                    state.currentUsages[levelBase + layer] == sourceUsage &&
+                    state.targetUsages[levelBase + layer] == destUsage &&
+                    state.explicitSrcAccesses[levelBase + layer] == explicitSrcAccess &&
+                    state.explicitDstAccesses[levelBase + layer] == explicitDstAccess &&
+                    (sourceUsage != destUsage || state.dirtySubresources[levelBase + layer]))
+                    ++layer;
+
+                VkImageSubresourceRange range = {};
+                range.aspectMask = avkTexture->imageAspect;
+                range.baseMipLevel = level;
+                range.levelCount = 1;
+                range.baseArrayLayer = firstLayer;
+                range.layerCount = layer - firstLayer;
+
+                // Subresources that returned into their layout only need a memory dependency.
+                // The accesses of the explicit barriers are added into the barrier of the
+                // transition, which starts in the tracked layout of the subresources.
+                auto barrier = barrierForImageUsageTransition(avkTexture->image, range, avkTexture->description.usage_modes, sourceUsage, destUsage, srcStages, dstStages);
+                barrier.srcAccessMask |= explicitSrcAccess;
+                barrier.dstAccessMask |= explicitDstAccess;
+
+                // Merge with the barrier of the previous level, when possible.
+                if(!barriers.empty())
+                {
+                    auto &last = barriers.back();
+                    if(last.image == barrier.image &&
+                        last.oldLayout == barrier.oldLayout && last.newLayout == barrier.newLayout &&
+                        last.srcAccessMask == barrier.srcAccessMask && last.dstAccessMask == barrier.dstAccessMask &&
+                        last.subresourceRange.baseArrayLayer == range.baseArrayLayer &&
+                        last.subresourceRange.layerCount == range.layerCount &&
+                        last.subresourceRange.baseMipLevel + last.subresourceRange.levelCount == level)
+                    {
+                        ++last.subresourceRange.levelCount;
+                        continue;
+                    }
+                }
+
+                barriers.push_back(barrier);
+            }
+        }
+
+        state.currentUsages = state.targetUsages;
+        std::fill(state.explicitSrcAccesses.begin(), state.explicitSrcAccesses.end(), 0);
+        std::fill(state.explicitDstAccesses.begin(), state.explicitDstAccesses.end(), 0);
+        std::fill(state.dirtySubresources.begin(), state.dirtySubresources.end(), false);
+        state.isDirty = false;
+    }
+
+    dirtyTextures.clear();
+    explicitSrcStages = 0;
+    explicitDstStages = 0;
+
+    if(barriers.empty())
+        return;
+
+    if(!srcStages)
+        srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    if(!dstStages)
+        dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, (uint32_t)barriers.size(), &barriers[0]);
+}
+
+} // End of namespace AgpuVulkan
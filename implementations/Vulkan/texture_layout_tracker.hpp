@@ -0,0 +1,79 @@
+#ifndef AGPU_VULKAN_TEXTURE_LAYOUT_TRACKER_HPP
+#define AGPU_VULKAN_TEXTURE_LAYOUT_TRACKER_HPP
+
+#include "common.hpp"
+#include "include_vulkan.h"
+#include <unordered_map>
+#include <vector>
+
+namespace AgpuVulkan
+{
+
+class AVkTexture;
+
+/**
+ * Keeps track of the usage mode (and therefore the image layout) of each
+ * subresource of the textures that are used by a command list. Transitions
+ * are not recorded immediately. Instead of that, they are accumulated until
+ * the next command that uses the textures, where all of the pending
+ * transitions are merged into a single vkCmdPipelineBarrier. Transitions that
+ * end in the same layout where they started are reduced into a memory
+ * dependency, and transitions into the current layout are skipped. Explicit
+ * memory barriers are merged into the barrier of each subresource, so their
+ * layouts always come from the tracked usage modes.
+ */
+class AVkTextureLayoutTracker
+{
+public:
+    AVkTextureLayoutTracker();
+    ~AVkTextureLayoutTracker();
+
+    void reset();
+
+    agpu_texture_usage_mode_mask getUsageMode(const agpu::texture_ref &texture, agpu_uint level, agpu_uint layer);
+    void transition(const agpu::texture_ref &texture, const VkImageSubresourceRange &range, agpu_texture_usage_mode_mask newUsage);
+    void memoryBarrier(const agpu::texture_ref &texture, const VkImageSubresourceRange &range, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, VkAccessFlags srcAccesses, VkAccessFlags dstAccesses);
+
+    // Queues the transitions of every tracked subresource into the main usage mode of its texture.
+    void restoreMainUsageModes();
+
+    bool hasPendingBarriers() const;
+    void flush(VkCommandBuffer commandBuffer);
+
+    VkImageSubresourceRange wholeRangeOf(const agpu::texture_ref &texture);
+    VkImageSubresourceRange clampRange(const agpu::texture_ref &texture, const agpu_subresource_range &range);
+
+private:
+    struct TextureState
+    {
+        agpu::texture_ref texture;
+        agpu_uint levelCount;
+        agpu_uint layerCount;
+
+        // The usage mode of each subresource in the command buffer, and the one requested for the next command.
+        std::vector<agpu_texture_usage_mode_mask> currentUsages;
+        std::vector<agpu_texture_usage_mode_mask> targetUsages;
+
+        // The accesses of the explicit memory barriers on each subresource since the last flush.
+        std::vector<VkAccessFlags> explicitSrcAccesses;
+        std::vector<VkAccessFlags> explicitDstAccesses;
+
+        // Subresources that went through another usage mode, or that have an explicit barrier, since the last flush.
+        std::vector<bool> dirtySubresources;
+        bool isDirty;
+    };
+
+    TextureState &stateFor(const agpu::texture_ref &texture);
+    void markDirty(TextureState &state, agpu_uint index);
+
+    std::unordered_map<AVkTexture*, TextureState> textureStates;
+    std::vector<AVkTexture*> dirtyTextures;
+    VkPipelineStageFlags explicitSrcStages;
+    VkPipelineStageFlags explicitDstStages;
+
+    std::vector<VkImageMemoryBarrier> barriers;
+};
+
+} // End of namespace AgpuVulkan
+
+#endif //AGPU_VULKAN_TEXTURE_LAYOUT_TRACKER_HPP
@@ -493,18 +493,13 @@ agpu_error AgpuVkVRSystemSubmissionCommandBuffer::submitVREyeRenderTargets(const
         CONVERT_VULKAN_ERROR(error);
     }
 
-    auto graphicsQueue = deviceForVk->graphicsCommandQueues[0].as<AVkCommandQueue> ()->queue;
+    auto graphicsQueue = deviceForVk->graphicsCommandQueues[0].as<AVkCommandQueue> ();
 
-    // Submit the first command buffer
+    // Submit the first command buffer, together with the deferred command lists.
     {
-        VkSubmitInfo submitInfo;
-        memset(&submitInfo, 0, sizeof(VkSubmitInfo));
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &beforeSubmissionCommandList;
-
-        auto error = vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-        CONVERT_VULKAN_ERROR(error);
+        auto error = graphicsQueue->submitCommandBuffer(beforeSubmissionCommandList);
+        if(error)
+            return error;
     }
 
     // Do the actual submission of the Eye textures to OpenVR.
@@ -516,14 +511,9 @@ agpu_error AgpuVkVRSystemSubmissionCommandBuffer::submitVREyeRenderTargets(const
 
     // Submit the second command buffer, and signal the fence.
     {
-        VkSubmitInfo submitInfo;
-        memset(&submitInfo, 0, sizeof(VkSubmitInfo));
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &afterSubmissionCommandList;
-
-        auto error = vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
-        CONVERT_VULKAN_ERROR(error);
+        auto error = graphicsQueue->submitCommandBuffer(afterSubmissionCommandList, fence);
+        if(error)
+            return error;
 
         isFenceActive = true;
     }
@@ -64,6 +64,7 @@ typedef struct _agpu_shader_signature agpu_shader_signature;
 typedef struct _agpu_shader_resource_binding agpu_shader_resource_binding;
 typedef struct _agpu_fence agpu_fence;
 typedef struct _agpu_offline_shader_compiler agpu_offline_shader_compiler;
+typedef struct _agpu_shader_archive agpu_shader_archive;
 typedef struct _agpu_state_tracker_cache agpu_state_tracker_cache;
 typedef struct _agpu_state_tracker agpu_state_tracker;
 typedef struct _agpu_immediate_renderer agpu_immediate_renderer;
@@ -647,6 +648,71 @@ typedef enum {
 	AGPU_IMMEDIATE_RENDERER_FOG_MODE_EXPONENTIAL_SQUARED = 3,
 } agpu_immediate_renderer_fog_mode;
 
+typedef enum {
+	AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_DEBUG = 0,
+	AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_RELEASE = 1,
+	AGPU_OFFLINE_SHADER_COMPILATION_PROFILE_SIZE = 2,
+} agpu_offline_shader_compilation_profile;
+
+typedef enum {
+	AGPU_ENCODED_COMMAND_SET_SHADER_SIGNATURE = 1,
+	AGPU_ENCODED_COMMAND_SET_VIEWPORT = 2,
+	AGPU_ENCODED_COMMAND_SET_SCISSOR = 3,
+	AGPU_ENCODED_COMMAND_USE_PIPELINE_STATE = 4,
+	AGPU_ENCODED_COMMAND_USE_VERTEX_BINDING = 5,
+	AGPU_ENCODED_COMMAND_USE_INDEX_BUFFER = 6,
+	AGPU_ENCODED_COMMAND_USE_INDEX_BUFFER_AT = 7,
+	AGPU_ENCODED_COMMAND_USE_DRAW_INDIRECT_BUFFER = 8,
+	AGPU_ENCODED_COMMAND_USE_COMPUTE_DISPATCH_INDIRECT_BUFFER = 9,
+	AGPU_ENCODED_COMMAND_USE_SHADER_RESOURCES = 10,
+	AGPU_ENCODED_COMMAND_USE_COMPUTE_SHADER_RESOURCES = 11,
+	AGPU_ENCODED_COMMAND_DRAW_ARRAYS = 12,
+	AGPU_ENCODED_COMMAND_DRAW_ARRAYS_INDIRECT = 13,
+	AGPU_ENCODED_COMMAND_DRAW_ELEMENTS = 14,
+	AGPU_ENCODED_COMMAND_DRAW_ELEMENTS_INDIRECT = 15,
+	AGPU_ENCODED_COMMAND_DISPATCH_COMPUTE = 16,
+	AGPU_ENCODED_COMMAND_DISPATCH_COMPUTE_INDIRECT = 17,
+	AGPU_ENCODED_COMMAND_SET_STENCIL_REFERENCE = 18,
+	AGPU_ENCODED_COMMAND_EXECUTE_BUNDLE = 19,
+	AGPU_ENCODED_COMMAND_BEGIN_RENDER_PASS = 20,
+	AGPU_ENCODED_COMMAND_END_RENDER_PASS = 21,
+	AGPU_ENCODED_COMMAND_RESOLVE_FRAMEBUFFER = 22,
+	AGPU_ENCODED_COMMAND_RESOLVE_TEXTURE = 23,
+	AGPU_ENCODED_COMMAND_PUSH_CONSTANTS = 24,
+	AGPU_ENCODED_COMMAND_MEMORY_BARRIER = 25,
+	AGPU_ENCODED_COMMAND_BUFFER_MEMORY_BARRIER = 26,
+	AGPU_ENCODED_COMMAND_TEXTURE_MEMORY_BARRIER = 27,
+	AGPU_ENCODED_COMMAND_PUSH_BUFFER_TRANSITION_BARRIER = 28,
+	AGPU_ENCODED_COMMAND_PUSH_TEXTURE_TRANSITION_BARRIER = 29,
+	AGPU_ENCODED_COMMAND_POP_BUFFER_TRANSITION_BARRIER = 30,
+	AGPU_ENCODED_COMMAND_POP_TEXTURE_TRANSITION_BARRIER = 31,
+	AGPU_ENCODED_COMMAND_COPY_BUFFER = 32,
+	AGPU_ENCODED_COMMAND_COPY_BUFFER_TO_TEXTURE = 33,
+	AGPU_ENCODED_COMMAND_COPY_TEXTURE_TO_BUFFER = 34,
+	AGPU_ENCODED_COMMAND_RESET_GRAPHICS_PIPELINE = 35,
+	AGPU_ENCODED_COMMAND_RESET_COMPUTE_PIPELINE = 36,
+	AGPU_ENCODED_COMMAND_SET_COMPUTE_STAGE = 37,
+	AGPU_ENCODED_COMMAND_SET_VERTEX_STAGE = 38,
+	AGPU_ENCODED_COMMAND_SET_FRAGMENT_STAGE = 39,
+	AGPU_ENCODED_COMMAND_SET_GEOMETRY_STAGE = 40,
+	AGPU_ENCODED_COMMAND_SET_TESSELLATION_CONTROL_STAGE = 41,
+	AGPU_ENCODED_COMMAND_SET_TESSELLATION_EVALUATION_STAGE = 42,
+	AGPU_ENCODED_COMMAND_SET_BLEND_STATE = 43,
+	AGPU_ENCODED_COMMAND_SET_BLEND_FUNCTION = 44,
+	AGPU_ENCODED_COMMAND_SET_COLOR_MASK = 45,
+	AGPU_ENCODED_COMMAND_SET_FRONT_FACE = 46,
+	AGPU_ENCODED_COMMAND_SET_CULL_MODE = 47,
+	AGPU_ENCODED_COMMAND_SET_DEPTH_BIAS = 48,
+	AGPU_ENCODED_COMMAND_SET_DEPTH_STATE = 49,
+	AGPU_ENCODED_COMMAND_SET_POLYGON_MODE = 50,
+	AGPU_ENCODED_COMMAND_SET_STENCIL_STATE = 51,
+	AGPU_ENCODED_COMMAND_SET_STENCIL_FRONT_FACE = 52,
+	AGPU_ENCODED_COMMAND_SET_STENCIL_BACK_FACE = 53,
+	AGPU_ENCODED_COMMAND_SET_PRIMITIVE_TYPE = 54,
+	AGPU_ENCODED_COMMAND_SET_VERTEX_LAYOUT = 55,
+	AGPU_ENCODED_COMMAND_SET_SAMPLE_DESCRIPTION = 56,
+} agpu_encoded_command;
+
 
 /* Structure agpu_device_open_info. */
 typedef struct agpu_device_open_info {
@@ -678,8 +744,57 @@ typedef struct agpu_swap_chain_create_info {
 	agpu_int x;
 	agpu_int y;
 	agpu_swap_chain* old_swap_chain;
+	agpu_uint frames_in_flight;
 } agpu_swap_chain_create_info;
 
+/* Structure agpu_frame_pacing_statistics. */
+typedef struct agpu_frame_pacing_statistics {
+	agpu_uint frames_in_flight;
+	agpu_uint frame_count;
+	agpu_uint pending_frame_count;
+	agpu_float last_cpu_wait_time;
+	agpu_float average_cpu_wait_time;
+	agpu_float max_cpu_wait_time;
+} agpu_frame_pacing_statistics;
+
+/* Structure agpu_device_object_statistics. */
+typedef struct agpu_device_object_statistics {
+	agpu_uint render_pass_count;
+	agpu_uint render_pass_cache_hit_count;
+	agpu_uint render_pass_cache_miss_count;
+	agpu_uint pipeline_state_count;
+	agpu_uint framebuffer_count;
+	agpu_uint memory_block_count;
+	agpu_uint memory_allocation_count;
+	agpu_uint state_change_count;
+	agpu_uint redundant_state_change_count;
+} agpu_device_object_statistics;
+
+/* Structure agpu_shader_compilation_statistics. */
+typedef struct agpu_shader_compilation_statistics {
+	agpu_uint compilation_count;
+	agpu_uint memory_cache_hit_count;
+	agpu_uint disk_cache_hit_count;
+	agpu_uint cache_miss_count;
+	agpu_uint cached_shader_count;
+	agpu_float total_compilation_time;
+	agpu_float total_cache_lookup_time;
+	agpu_float last_compilation_time;
+} agpu_shader_compilation_statistics;
+
+/* Structure agpu_offline_shader_compilation_job. */
+typedef struct agpu_offline_shader_compilation_job {
+	agpu_shader_language source_language;
+	agpu_shader_type stage;
+	agpu_string source_text;
+	agpu_string_length source_text_length;
+	agpu_shader_language target_language;
+	agpu_cstring options;
+	agpu_error result;
+	agpu_offline_shader_compiler* compiler;
+	agpu_offline_shader_compilation_profile profile;
+} agpu_offline_shader_compilation_job;
+
 /* Structure agpu_buffer_description. */
 typedef struct agpu_buffer_description {
 	agpu_uint size;
@@ -1027,6 +1142,8 @@ typedef agpu_vr_system* (*agpuGetVRSystem_FUN) (agpu_device* device);
 typedef agpu_offline_shader_compiler* (*agpuCreateOfflineShaderCompilerForDevice_FUN) (agpu_device* device);
 typedef agpu_state_tracker_cache* (*agpuCreateStateTrackerCache_FUN) (agpu_device* device, agpu_command_queue* command_queue_family);
 typedef agpu_error (*agpuFinishDeviceExecution_FUN) (agpu_device* device);
+typedef agpu_error (*agpuGetDeviceObjectStatistics_FUN) (agpu_device* device, agpu_device_object_statistics* statistics);
+typedef agpu_shader_archive* (*agpuOpenShaderArchive_FUN) (agpu_device* device, agpu_cstring path);
 
 AGPU_EXPORT agpu_error agpuAddDeviceReference(agpu_device* device);
 AGPU_EXPORT agpu_error agpuReleaseDevice(agpu_device* device);
@@ -1058,6 +1175,8 @@ AGPU_EXPORT agpu_vr_system* agpuGetVRSystem(agpu_device* device);
 AGPU_EXPORT agpu_offline_shader_compiler* agpuCreateOfflineShaderCompilerForDevice(agpu_device* device);
 AGPU_EXPORT agpu_state_tracker_cache* agpuCreateStateTrackerCache(agpu_device* device, agpu_command_queue* command_queue_family);
 AGPU_EXPORT agpu_error agpuFinishDeviceExecution(agpu_device* device);
+AGPU_EXPORT agpu_error agpuGetDeviceObjectStatistics(agpu_device* device, agpu_device_object_statistics* statistics);
+AGPU_EXPORT agpu_shader_archive* agpuOpenShaderArchive(agpu_device* device, agpu_cstring path);
 
 /* Methods for interface agpu_vr_system. */
 typedef agpu_error (*agpuAddVRSystemReference_FUN) (agpu_vr_system* vr_system);
@@ -1104,6 +1223,7 @@ typedef agpu_framebuffer* (*agpuGetCurrentBackBuffer_FUN) (agpu_swap_chain* swap
 typedef agpu_size (*agpuGetCurrentBackBufferIndex_FUN) (agpu_swap_chain* swap_chain);
 typedef agpu_size (*agpuGetFramebufferCount_FUN) (agpu_swap_chain* swap_chain);
 typedef agpu_error (*agpuSetSwapChainOverlayPosition_FUN) (agpu_swap_chain* swap_chain, agpu_int x, agpu_int y);
+typedef agpu_error (*agpuGetSwapChainFramePacingStatistics_FUN) (agpu_swap_chain* swap_chain, agpu_frame_pacing_statistics* statistics);
 
 AGPU_EXPORT agpu_error agpuAddSwapChainReference(agpu_swap_chain* swap_chain);
 AGPU_EXPORT agpu_error agpuReleaseSwapChain(agpu_swap_chain* swap_chain);
@@ -1112,6 +1232,7 @@ AGPU_EXPORT agpu_framebuffer* agpuGetCurrentBackBuffer(agpu_swap_chain* swap_cha
 AGPU_EXPORT agpu_size agpuGetCurrentBackBufferIndex(agpu_swap_chain* swap_chain);
 AGPU_EXPORT agpu_size agpuGetFramebufferCount(agpu_swap_chain* swap_chain);
 AGPU_EXPORT agpu_error agpuSetSwapChainOverlayPosition(agpu_swap_chain* swap_chain, agpu_int x, agpu_int y);
+AGPU_EXPORT agpu_error agpuGetSwapChainFramePacingStatistics(agpu_swap_chain* swap_chain, agpu_frame_pacing_statistics* statistics);
 
 /* Methods for interface agpu_compute_pipeline_builder. */
 typedef agpu_error (*agpuAddComputePipelineBuilderReference_FUN) (agpu_compute_pipeline_builder* compute_pipeline_builder);
@@ -1196,6 +1317,7 @@ AGPU_EXPORT agpu_error agpuReleasePipelineState(agpu_pipeline_state* pipeline_st
 typedef agpu_error (*agpuAddCommandQueueReference_FUN) (agpu_command_queue* command_queue);
 typedef agpu_error (*agpuReleaseCommandQueue_FUN) (agpu_command_queue* command_queue);
 typedef agpu_error (*agpuAddCommandList_FUN) (agpu_command_queue* command_queue, agpu_command_list* command_list);
+typedef agpu_error (*agpuAddCommandLists_FUN) (agpu_command_queue* command_queue, agpu_uint count, agpu_command_list** command_lists);
 typedef agpu_error (*agpuFinishQueueExecution_FUN) (agpu_command_queue* command_queue);
 typedef agpu_error (*agpuSignalFence_FUN) (agpu_command_queue* command_queue, agpu_fence* fence);
 typedef agpu_error (*agpuWaitFence_FUN) (agpu_command_queue* command_queue, agpu_fence* fence);
@@ -1203,6 +1325,7 @@ typedef agpu_error (*agpuWaitFence_FUN) (agpu_command_queue* command_queue, agpu
 AGPU_EXPORT agpu_error agpuAddCommandQueueReference(agpu_command_queue* command_queue);
 AGPU_EXPORT agpu_error agpuReleaseCommandQueue(agpu_command_queue* command_queue);
 AGPU_EXPORT agpu_error agpuAddCommandList(agpu_command_queue* command_queue, agpu_command_list* command_list);
+AGPU_EXPORT agpu_error agpuAddCommandLists(agpu_command_queue* command_queue, agpu_uint count, agpu_command_list** command_lists);
 AGPU_EXPORT agpu_error agpuFinishQueueExecution(agpu_command_queue* command_queue);
 AGPU_EXPORT agpu_error agpuSignalFence(agpu_command_queue* command_queue, agpu_fence* fence);
 AGPU_EXPORT agpu_error agpuWaitFence(agpu_command_queue* command_queue, agpu_fence* fence);
@@ -1256,6 +1379,7 @@ typedef agpu_error (*agpuPopTextureTransitionBarrier_FUN) (agpu_command_list* co
 typedef agpu_error (*agpuCopyBuffer_FUN) (agpu_command_list* command_list, agpu_buffer* source_buffer, agpu_size source_offset, agpu_buffer* dest_buffer, agpu_size dest_offset, agpu_size copy_size);
 typedef agpu_error (*agpuCopyBufferToTexture_FUN) (agpu_command_list* command_list, agpu_buffer* buffer, agpu_texture* texture, agpu_buffer_image_copy_region* copy_region);
 typedef agpu_error (*agpuCopyTextureToBuffer_FUN) (agpu_command_list* command_list, agpu_texture* texture, agpu_buffer* buffer, agpu_buffer_image_copy_region* copy_region);
+typedef agpu_error (*agpuExecuteEncodedCommands_FUN) (agpu_command_list* command_list, agpu_pointer commands, agpu_size size);
 
 AGPU_EXPORT agpu_error agpuAddCommandListReference(agpu_command_list* command_list);
 AGPU_EXPORT agpu_error agpuReleaseCommandList(agpu_command_list* command_list);
@@ -1296,6 +1420,7 @@ AGPU_EXPORT agpu_error agpuPopTextureTransitionBarrier(agpu_command_list* comman
 AGPU_EXPORT agpu_error agpuCopyBuffer(agpu_command_list* command_list, agpu_buffer* source_buffer, agpu_size source_offset, agpu_buffer* dest_buffer, agpu_size dest_offset, agpu_size copy_size);
 AGPU_EXPORT agpu_error agpuCopyBufferToTexture(agpu_command_list* command_list, agpu_buffer* buffer, agpu_texture* texture, agpu_buffer_image_copy_region* copy_region);
 AGPU_EXPORT agpu_error agpuCopyTextureToBuffer(agpu_command_list* command_list, agpu_texture* texture, agpu_buffer* buffer, agpu_buffer_image_copy_region* copy_region);
+AGPU_EXPORT agpu_error agpuExecuteEncodedCommands(agpu_command_list* command_list, agpu_pointer commands, agpu_size size);
 
 /* Methods for interface agpu_texture. */
 typedef agpu_error (*agpuAddTextureReference_FUN) (agpu_texture* texture);
@@ -1475,10 +1600,12 @@ AGPU_EXPORT agpu_error agpuBindSampler(agpu_shader_resource_binding* shader_reso
 typedef agpu_error (*agpuAddFenceReference_FUN) (agpu_fence* fence);
 typedef agpu_error (*agpuReleaseFenceReference_FUN) (agpu_fence* fence);
 typedef agpu_error (*agpuWaitOnClient_FUN) (agpu_fence* fence);
+typedef agpu_bool (*agpuIsFenceSignaled_FUN) (agpu_fence* fence);
 
 AGPU_EXPORT agpu_error agpuAddFenceReference(agpu_fence* fence);
 AGPU_EXPORT agpu_error agpuReleaseFenceReference(agpu_fence* fence);
 AGPU_EXPORT agpu_error agpuWaitOnClient(agpu_fence* fence);
+AGPU_EXPORT agpu_bool agpuIsFenceSignaled(agpu_fence* fence);
 
 /* Methods for interface agpu_offline_shader_compiler. */
 typedef agpu_error (*agpuAddOfflineShaderCompilerReference_FUN) (agpu_offline_shader_compiler* offline_shader_compiler);
@@ -1492,6 +1619,9 @@ typedef agpu_error (*agpuGetOfflineShaderCompilationLog_FUN) (agpu_offline_shade
 typedef agpu_size (*agpuGetOfflineShaderCompilationResultLength_FUN) (agpu_offline_shader_compiler* offline_shader_compiler);
 typedef agpu_error (*agpuGetOfflineShaderCompilationResult_FUN) (agpu_offline_shader_compiler* offline_shader_compiler, agpu_size buffer_size, agpu_string_buffer buffer);
 typedef agpu_shader* (*agpuGetOfflineShaderCompilerResultAsShader_FUN) (agpu_offline_shader_compiler* offline_shader_compiler);
+typedef agpu_error (*agpuGetOfflineShaderCompilationStatistics_FUN) (agpu_offline_shader_compiler* offline_shader_compiler, agpu_shader_compilation_statistics* statistics);
+typedef agpu_error (*agpuCompileOfflineShaderBatch_FUN) (agpu_offline_shader_compiler* offline_shader_compiler, agpu_size job_count, agpu_offline_shader_compilation_job* jobs, agpu_uint thread_count);
+typedef agpu_error (*agpuSetOfflineShaderCompilationProfile_FUN) (agpu_offline_shader_compiler* offline_shader_compiler, agpu_offline_shader_compilation_profile profile);
 
 AGPU_EXPORT agpu_error agpuAddOfflineShaderCompilerReference(agpu_offline_shader_compiler* offline_shader_compiler);
 AGPU_EXPORT agpu_error agpuReleaseOfflineShaderCompiler(agpu_offline_shader_compiler* offline_shader_compiler);
@@ -1504,6 +1634,28 @@ AGPU_EXPORT agpu_error agpuGetOfflineShaderCompilationLog(agpu_offline_shader_co
 AGPU_EXPORT agpu_size agpuGetOfflineShaderCompilationResultLength(agpu_offline_shader_compiler* offline_shader_compiler);
 AGPU_EXPORT agpu_error agpuGetOfflineShaderCompilationResult(agpu_offline_shader_compiler* offline_shader_compiler, agpu_size buffer_size, agpu_string_buffer buffer);
 AGPU_EXPORT agpu_shader* agpuGetOfflineShaderCompilerResultAsShader(agpu_offline_shader_compiler* offline_shader_compiler);
+AGPU_EXPORT agpu_error agpuGetOfflineShaderCompilationStatistics(agpu_offline_shader_compiler* offline_shader_compiler, agpu_shader_compilation_statistics* statistics);
+AGPU_EXPORT agpu_error agpuCompileOfflineShaderBatch(agpu_offline_shader_compiler* offline_shader_compiler, agpu_size job_count, agpu_offline_shader_compilation_job* jobs, agpu_uint thread_count);
+AGPU_EXPORT agpu_error agpuSetOfflineShaderCompilationProfile(agpu_offline_shader_compiler* offline_shader_compiler, agpu_offline_shader_compilation_profile profile);
+
+/* Methods for interface agpu_shader_archive. */
+typedef agpu_error (*agpuAddShaderArchiveReference_FUN) (agpu_shader_archive* shader_archive);
+typedef agpu_error (*agpuReleaseShaderArchive_FUN) (agpu_shader_archive* shader_archive);
+typedef agpu_size (*agpuGetShaderArchiveShaderCount_FUN) (agpu_shader_archive* shader_archive);
+typedef agpu_int (*agpuFindShaderInArchive_FUN) (agpu_shader_archive* shader_archive, agpu_cstring name);
+typedef agpu_cstring (*agpuGetShaderArchiveShaderName_FUN) (agpu_shader_archive* shader_archive, agpu_size index);
+typedef agpu_shader_type (*agpuGetShaderArchiveShaderStage_FUN) (agpu_shader_archive* shader_archive, agpu_size index);
+typedef agpu_shader* (*agpuCreateShaderFromArchive_FUN) (agpu_shader_archive* shader_archive, agpu_size index);
+typedef agpu_shader* (*agpuCreateShaderFromArchiveWithName_FUN) (agpu_shader_archive* shader_archive, agpu_cstring name);
+
+AGPU_EXPORT agpu_error agpuAddShaderArchiveReference(agpu_shader_archive* shader_archive);
+AGPU_EXPORT agpu_error agpuReleaseShaderArchive(agpu_shader_archive* shader_archive);
+AGPU_EXPORT agpu_size agpuGetShaderArchiveShaderCount(agpu_shader_archive* shader_archive);
+AGPU_EXPORT agpu_int agpuFindShaderInArchive(agpu_shader_archive* shader_archive, agpu_cstring name);
+AGPU_EXPORT agpu_cstring agpuGetShaderArchiveShaderName(agpu_shader_archive* shader_archive, agpu_size index);
+AGPU_EXPORT agpu_shader_type agpuGetShaderArchiveShaderStage(agpu_shader_archive* shader_archive, agpu_size index);
+AGPU_EXPORT agpu_shader* agpuCreateShaderFromArchive(agpu_shader_archive* shader_archive, agpu_size index);
+AGPU_EXPORT agpu_shader* agpuCreateShaderFromArchiveWithName(agpu_shader_archive* shader_archive, agpu_cstring name);
 
 /* Methods for interface agpu_state_tracker_cache. */
 typedef agpu_error (*agpuAddStateTrackerCacheReference_FUN) (agpu_state_tracker_cache* state_tracker_cache);
@@ -1582,6 +1734,7 @@ typedef agpu_error (*agpuStateTrackerPopTextureTransitionBarrier_FUN) (agpu_stat
 typedef agpu_error (*agpuStateTrackerCopyBuffer_FUN) (agpu_state_tracker* state_tracker, agpu_buffer* source_buffer, agpu_size source_offset, agpu_buffer* dest_buffer, agpu_size dest_offset, agpu_size copy_size);
 typedef agpu_error (*agpuStateTrackerCopyBufferToTexture_FUN) (agpu_state_tracker* state_tracker, agpu_buffer* buffer, agpu_texture* texture, agpu_buffer_image_copy_region* copy_region);
 typedef agpu_error (*agpuStateTrackerCopyTextureToBuffer_FUN) (agpu_state_tracker* state_tracker, agpu_texture* texture, agpu_buffer* buffer, agpu_buffer_image_copy_region* copy_region);
+typedef agpu_error (*agpuStateTrackerExecuteEncodedCommands_FUN) (agpu_state_tracker* state_tracker, agpu_pointer commands, agpu_size size);
 
 AGPU_EXPORT agpu_error agpuAddStateTrackerReference(agpu_state_tracker* state_tracker);
 AGPU_EXPORT agpu_error agpuReleaseStateTrackerReference(agpu_state_tracker* state_tracker);
@@ -1644,6 +1797,7 @@ AGPU_EXPORT agpu_error agpuStateTrackerPopTextureTransitionBarrier(agpu_state_tr
 AGPU_EXPORT agpu_error agpuStateTrackerCopyBuffer(agpu_state_tracker* state_tracker, agpu_buffer* source_buffer, agpu_size source_offset, agpu_buffer* dest_buffer, agpu_size dest_offset, agpu_size copy_size);
 AGPU_EXPORT agpu_error agpuStateTrackerCopyBufferToTexture(agpu_state_tracker* state_tracker, agpu_buffer* buffer, agpu_texture* texture, agpu_buffer_image_copy_region* copy_region);
 AGPU_EXPORT agpu_error agpuStateTrackerCopyTextureToBuffer(agpu_state_tracker* state_tracker, agpu_texture* texture, agpu_buffer* buffer, agpu_buffer_image_copy_region* copy_region);
+AGPU_EXPORT agpu_error agpuStateTrackerExecuteEncodedCommands(agpu_state_tracker* state_tracker, agpu_pointer commands, agpu_size size);
 
 /* Methods for interface agpu_immediate_renderer. */
 typedef agpu_error (*agpuAddImmediateRendererReference_FUN) (agpu_immediate_renderer* immediate_renderer);
@@ -1828,6 +1982,8 @@ typedef struct _agpu_icd_dispatch {
 	agpuCreateOfflineShaderCompilerForDevice_FUN agpuCreateOfflineShaderCompilerForDevice;
 	agpuCreateStateTrackerCache_FUN agpuCreateStateTrackerCache;
 	agpuFinishDeviceExecution_FUN agpuFinishDeviceExecution;
+	agpuGetDeviceObjectStatistics_FUN agpuGetDeviceObjectStatistics;
+	agpuOpenShaderArchive_FUN agpuOpenShaderArchive;
 	agpuAddVRSystemReference_FUN agpuAddVRSystemReference;
 	agpuReleaseVRSystem_FUN agpuReleaseVRSystem;
 	agpuGetVRSystemName_FUN agpuGetVRSystemName;
@@ -1852,6 +2008,7 @@ typedef struct _agpu_icd_dispatch {
 	agpuGetCurrentBackBufferIndex_FUN agpuGetCurrentBackBufferIndex;
 	agpuGetFramebufferCount_FUN agpuGetFramebufferCount;
 	agpuSetSwapChainOverlayPosition_FUN agpuSetSwapChainOverlayPosition;
+	agpuGetSwapChainFramePacingStatistics_FUN agpuGetSwapChainFramePacingStatistics;
 	agpuAddComputePipelineBuilderReference_FUN agpuAddComputePipelineBuilderReference;
 	agpuReleaseComputePipelineBuilder_FUN agpuReleaseComputePipelineBuilder;
 	agpuBuildComputePipelineState_FUN agpuBuildComputePipelineState;
@@ -1890,6 +2047,7 @@ typedef struct _agpu_icd_dispatch {
 	agpuAddCommandQueueReference_FUN agpuAddCommandQueueReference;
 	agpuReleaseCommandQueue_FUN agpuReleaseCommandQueue;
 	agpuAddCommandList_FUN agpuAddCommandList;
+	agpuAddCommandLists_FUN agpuAddCommandLists;
 	agpuFinishQueueExecution_FUN agpuFinishQueueExecution;
 	agpuSignalFence_FUN agpuSignalFence;
 	agpuWaitFence_FUN agpuWaitFence;
@@ -1935,6 +2093,7 @@ typedef struct _agpu_icd_dispatch {
 	agpuCopyBuffer_FUN agpuCopyBuffer;
 	agpuCopyBufferToTexture_FUN agpuCopyBufferToTexture;
 	agpuCopyTextureToBuffer_FUN agpuCopyTextureToBuffer;
+	agpuExecuteEncodedCommands_FUN agpuExecuteEncodedCommands;
 	agpuAddTextureReference_FUN agpuAddTextureReference;
 	agpuReleaseTexture_FUN agpuReleaseTexture;
 	agpuGetTextureDescription_FUN agpuGetTextureDescription;
@@ -2007,6 +2166,7 @@ typedef struct _agpu_icd_dispatch {
 	agpuAddFenceReference_FUN agpuAddFenceReference;
 	agpuReleaseFenceReference_FUN agpuReleaseFenceReference;
 	agpuWaitOnClient_FUN agpuWaitOnClient;
+	agpuIsFenceSignaled_FUN agpuIsFenceSignaled;
 	agpuAddOfflineShaderCompilerReference_FUN agpuAddOfflineShaderCompilerReference;
 	agpuReleaseOfflineShaderCompiler_FUN agpuReleaseOfflineShaderCompiler;
 	agpuIsShaderLanguageSupportedByOfflineCompiler_FUN agpuIsShaderLanguageSupportedByOfflineCompiler;
@@ -2018,6 +2178,17 @@ typedef struct _agpu_icd_dispatch {
 	agpuGetOfflineShaderCompilationResultLength_FUN agpuGetOfflineShaderCompilationResultLength;
 	agpuGetOfflineShaderCompilationResult_FUN agpuGetOfflineShaderCompilationResult;
 	agpuGetOfflineShaderCompilerResultAsShader_FUN agpuGetOfflineShaderCompilerResultAsShader;
+	agpuGetOfflineShaderCompilationStatistics_FUN agpuGetOfflineShaderCompilationStatistics;
+	agpuCompileOfflineShaderBatch_FUN agpuCompileOfflineShaderBatch;
+	agpuSetOfflineShaderCompilationProfile_FUN agpuSetOfflineShaderCompilationProfile;
+	agpuAddShaderArchiveReference_FUN agpuAddShaderArchiveReference;
+	agpuReleaseShaderArchive_FUN agpuReleaseShaderArchive;
+	agpuGetShaderArchiveShaderCount_FUN agpuGetShaderArchiveShaderCount;
+	agpuFindShaderInArchive_FUN agpuFindShaderInArchive;
+	agpuGetShaderArchiveShaderName_FUN agpuGetShaderArchiveShaderName;
+	agpuGetShaderArchiveShaderStage_FUN agpuGetShaderArchiveShaderStage;
+	agpuCreateShaderFromArchive_FUN agpuCreateShaderFromArchive;
+	agpuCreateShaderFromArchiveWithName_FUN agpuCreateShaderFromArchiveWithName;
 	agpuAddStateTrackerCacheReference_FUN agpuAddStateTrackerCacheReference;
 	agpuReleaseStateTrackerCacheReference_FUN agpuReleaseStateTrackerCacheReference;
 	agpuCreateStateTracker_FUN agpuCreateStateTracker;
@@ -2085,6 +2256,7 @@ typedef struct _agpu_icd_dispatch {
 	agpuStateTrackerCopyBuffer_FUN agpuStateTrackerCopyBuffer;
 	agpuStateTrackerCopyBufferToTexture_FUN agpuStateTrackerCopyBufferToTexture;
 	agpuStateTrackerCopyTextureToBuffer_FUN agpuStateTrackerCopyTextureToBuffer;
+	agpuStateTrackerExecuteEncodedCommands_FUN agpuStateTrackerExecuteEncodedCommands;
 	agpuAddImmediateRendererReference_FUN agpuAddImmediateRendererReference;
 	agpuReleaseImmediateRendererReference_FUN agpuReleaseImmediateRendererReference;
 	agpuBeginImmediateRendering_FUN agpuBeginImmediateRendering;
@@ -335,6 +335,16 @@ public:
 		agpuThrowIfFailed(agpuFinishDeviceExecution(this));
 	}
 
+	inline void getObjectStatistics(agpu_device_object_statistics* statistics)
+	{
+		agpuThrowIfFailed(agpuGetDeviceObjectStatistics(this, statistics));
+	}
+
+	inline agpu_ref<agpu_shader_archive> openShaderArchive(agpu_cstring path)
+	{
+		return agpuOpenShaderArchive(this, path);
+	}
+
 };
 
 typedef agpu_ref<agpu_device> agpu_device_ref;
@@ -477,6 +487,11 @@ public:
 		agpuThrowIfFailed(agpuSetSwapChainOverlayPosition(this, x, y));
 	}
 
+	inline void getFramePacingStatistics(agpu_frame_pacing_statistics* statistics)
+	{
+		agpuThrowIfFailed(agpuGetSwapChainFramePacingStatistics(this, statistics));
+	}
+
 };
 
 typedef agpu_ref<agpu_swap_chain> agpu_swap_chain_ref;
@@ -711,6 +726,11 @@ public:
 		agpuThrowIfFailed(agpuAddCommandList(this, command_list.get()));
 	}
 
+	inline void addCommandLists(agpu_uint count, agpu_ref<agpu_command_list>* command_lists)
+	{
+		agpuThrowIfFailed(agpuAddCommandLists(this, count, reinterpret_cast<agpu_command_list**> (command_lists)));
+	}
+
 	inline void finishExecution()
 	{
 		agpuThrowIfFailed(agpuFinishQueueExecution(this));
@@ -958,6 +978,11 @@ public:
 		agpuThrowIfFailed(agpuCopyTextureToBuffer(this, texture.get(), buffer.get(), copy_region));
 	}
 
+	inline void executeEncodedCommands(agpu_pointer commands, agpu_size size)
+	{
+		agpuThrowIfFailed(agpuExecuteEncodedCommands(this, commands, size));
+	}
+
 };
 
 typedef agpu_ref<agpu_command_list> agpu_command_list_ref;
@@ -1461,6 +1486,11 @@ public:
 		agpuThrowIfFailed(agpuWaitOnClient(this));
 	}
 
+	inline agpu_bool isSignaled()
+	{
+		return agpuIsFenceSignaled(this);
+	}
+
 };
 
 typedef agpu_ref<agpu_fence> agpu_fence_ref;
@@ -1527,10 +1557,76 @@ public:
 		return agpuGetOfflineShaderCompilerResultAsShader(this);
 	}
 
+	inline void getCompilationStatistics(agpu_shader_compilation_statistics* statistics)
+	{
+		agpuThrowIfFailed(agpuGetOfflineShaderCompilationStatistics(this, statistics));
+	}
+
+	inline void compileShaderBatch(agpu_size job_count, agpu_offline_shader_compilation_job* jobs, agpu_uint thread_count)
+	{
+		agpuThrowIfFailed(agpuCompileOfflineShaderBatch(this, job_count, jobs, thread_count));
+	}
+
+	inline void setCompilationProfile(agpu_offline_shader_compilation_profile profile)
+	{
+		agpuThrowIfFailed(agpuSetOfflineShaderCompilationProfile(this, profile));
+	}
+
 };
 
 typedef agpu_ref<agpu_offline_shader_compiler> agpu_offline_shader_compiler_ref;
 
+// Interface wrapper for agpu_shader_archive.
+struct _agpu_shader_archive
+{
+private:
+	_agpu_shader_archive() {}
+
+public:
+	inline void addReference()
+	{
+		agpuThrowIfFailed(agpuAddShaderArchiveReference(this));
+	}
+
+	inline void release()
+	{
+		agpuThrowIfFailed(agpuReleaseShaderArchive(this));
+	}
+
+	inline agpu_size getShaderCount()
+	{
+		return agpuGetShaderArchiveShaderCount(this);
+	}
+
+	inline agpu_int findShader(agpu_cstring name)
+	{
+		return agpuFindShaderInArchive(this, name);
+	}
+
+	inline agpu_cstring getShaderName(agpu_size index)
+	{
+		return agpuGetShaderArchiveShaderName(this, index);
+	}
+
+	inline agpu_shader_type getShaderStage(agpu_size index)
+	{
+		return agpuGetShaderArchiveShaderStage(this, index);
+	}
+
+	inline agpu_ref<agpu_shader> createShader(agpu_size index)
+	{
+		return agpuCreateShaderFromArchive(this, index);
+	}
+
+	inline agpu_ref<agpu_shader> createShaderWithName(agpu_cstring name)
+	{
+		return agpuCreateShaderFromArchiveWithName(this, name);
+	}
+
+};
+
+typedef agpu_ref<agpu_shader_archive> agpu_shader_archive_ref;
+
 // Interface wrapper for agpu_state_tracker_cache.
 struct _agpu_state_tracker_cache
 {
@@ -1884,6 +1980,11 @@ public:
 		agpuThrowIfFailed(agpuStateTrackerCopyTextureToBuffer(this, texture.get(), buffer.get(), copy_region));
 	}
 
+	inline void executeEncodedCommands(agpu_pointer commands, agpu_size size)
+	{
+		agpuThrowIfFailed(agpuStateTrackerExecuteEncodedCommands(this, commands, size));
+	}
+
 };
 
 typedef agpu_ref<agpu_state_tracker> agpu_state_tracker_ref;
@@ -0,0 +1,85 @@
+
+#ifndef AGPU_DIRECT_HPP_
+#define AGPU_DIRECT_HPP_
+
+#include "agpu.hpp"
+#include "agpu_impl.hpp"
+
+/**
+ * Direct C++ binding to the implementation interfaces, for the C++ code that
+ * runs in the same process as the backend, such as an application that links
+ * a backend statically. The objects are called through their agpu::
+ * interfaces, without going through the redirection of the loader, the
+ * dispatch table and the C ABI. The backend has to be built with the same
+ * compiler and the same version of agpu_impl.hpp.
+ *
+ * The methods of the interfaces return the new references as raw counters,
+ * which are taken with adopt, and they report the failures through their
+ * agpu_error result, which can be converted into an exception with
+ * agpuThrowIfFailed.
+ *
+ * The platforms cannot be wrapped, because the loader can give stand-ins for
+ * the platforms of the drivers that are not loaded yet, so the direct binding
+ * starts from the device.
+ */
+namespace agpu
+{
+namespace direct
+{
+
+template<typename T>
+struct handle_type;
+
+template<typename H>
+struct interface_type;
+
+// The specializations are generated by definitions/make_direct_binding.py.
+#include "agpu_direct.inc"
+
+/**
+ * Takes the ownership of a new reference that is returned by an interface.
+ */
+template<typename T>
+inline ref<T> adopt(ref_counter<T> *counter)
+{
+    return ref<T> (counter);
+}
+
+/**
+ * Gets the implementation object behind a C handle.
+ */
+template<typename H>
+inline ref<typename interface_type<H>::type> wrap(H *handle)
+{
+    return ref<typename interface_type<H>::type>::import(handle);
+}
+
+template<typename H>
+inline ref<typename interface_type<H>::type> wrap(const agpu_ref<H> &handle)
+{
+    return wrap(handle.get());
+}
+
+/**
+ * Gets the C handle of an implementation object, without a new reference.
+ */
+template<typename T>
+inline typename handle_type<T>::type *unwrap(const ref<T> &object)
+{
+    return reinterpret_cast<typename handle_type<T>::type*> (object.asPtrWithoutNewRef());
+}
+
+/**
+ * Gets a C++ wrapper reference to an implementation object, for mixing
+ * with the code that uses agpu.hpp.
+ */
+template<typename T>
+inline agpu_ref<typename handle_type<T>::type> share(const ref<T> &object)
+{
+    return reinterpret_cast<typename handle_type<T>::type*> (object.disownedNewRef());
+}
+
+} // End of namespace direct
+} // End of namespace agpu
+
+#endif /* AGPU_DIRECT_HPP_ */
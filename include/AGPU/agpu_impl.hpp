@@ -1,6 +1,6 @@
 
-#ifndef AGPU_HPP_
-#define AGPU_HPP_
+#ifndef AGPU_IMPL_HPP_
+#define AGPU_IMPL_HPP_
 
 #include "agpu.h"
 #include <stdexcept>
@@ -490,6 +490,11 @@ typedef ref_counter<offline_shader_compiler> *offline_shader_compiler_ptr;
 typedef ref<offline_shader_compiler> offline_shader_compiler_ref;
 typedef weak_ref<offline_shader_compiler> offline_shader_compiler_weakref;
 
+struct shader_archive;
+typedef ref_counter<shader_archive> *shader_archive_ptr;
+typedef ref<shader_archive> shader_archive_ref;
+typedef weak_ref<shader_archive> shader_archive_weakref;
+
 struct state_tracker_cache;
 typedef ref_counter<state_tracker_cache> *state_tracker_cache_ptr;
 typedef ref<state_tracker_cache> state_tracker_cache_ref;
@@ -556,6 +561,8 @@ public:
 	virtual offline_shader_compiler_ptr createOfflineShaderCompiler() = 0;
 	virtual state_tracker_cache_ptr createStateTrackerCache(const command_queue_ref & command_queue_family) = 0;
 	virtual agpu_error finishExecution() = 0;
+	virtual agpu_error getObjectStatistics(agpu_device_object_statistics* statistics) = 0;
+	virtual shader_archive_ptr openShaderArchive(agpu_cstring path) = 0;
 };
 
 
@@ -592,6 +599,7 @@ public:
 	virtual agpu_size getCurrentBackBufferIndex() = 0;
 	virtual agpu_size getFramebufferCount() = 0;
 	virtual agpu_error setOverlayPosition(agpu_int x, agpu_int y) = 0;
+	virtual agpu_error getFramePacingStatistics(agpu_frame_pacing_statistics* statistics) = 0;
 };
 
 
@@ -654,6 +662,7 @@ struct command_queue : base_interface
 public:
 	typedef command_queue main_interface;
 	virtual agpu_error addCommandList(const command_list_ref & command_list) = 0;
+	virtual agpu_error addCommandLists(agpu_uint count, command_list_ref* command_lists) = 0;
 	virtual agpu_error finishExecution() = 0;
 	virtual agpu_error signalFence(const fence_ref & fence) = 0;
 	virtual agpu_error waitFence(const fence_ref & fence) = 0;
@@ -711,6 +720,7 @@ public:
 	virtual agpu_error copyBuffer(const buffer_ref & source_buffer, agpu_size source_offset, const buffer_ref & dest_buffer, agpu_size dest_offset, agpu_size copy_size) = 0;
 	virtual agpu_error copyBufferToTexture(const buffer_ref & buffer, const texture_ref & texture, agpu_buffer_image_copy_region* copy_region) = 0;
 	virtual agpu_error copyTextureToBuffer(const texture_ref & texture, const buffer_ref & buffer, agpu_buffer_image_copy_region* copy_region) = 0;
+	virtual agpu_error executeEncodedCommands(agpu_pointer commands, agpu_size size) = 0;
 };
 
 
@@ -861,6 +871,7 @@ struct fence : base_interface
 public:
 	typedef fence main_interface;
 	virtual agpu_error waitOnClient() = 0;
+	virtual agpu_bool isSignaled() = 0;
 };
 
 
@@ -878,6 +889,23 @@ public:
 	virtual agpu_size getCompilationResultLength() = 0;
 	virtual agpu_error getCompilationResult(agpu_size buffer_size, agpu_string_buffer buffer) = 0;
 	virtual shader_ptr getResultAsShader() = 0;
+	virtual agpu_error getCompilationStatistics(agpu_shader_compilation_statistics* statistics) = 0;
+	virtual agpu_error compileShaderBatch(agpu_size job_count, agpu_offline_shader_compilation_job* jobs, agpu_uint thread_count) = 0;
+	virtual agpu_error setCompilationProfile(agpu_offline_shader_compilation_profile profile) = 0;
+};
+
+
+// Interface wrapper for agpu_shader_archive.
+struct shader_archive : base_interface
+{
+public:
+	typedef shader_archive main_interface;
+	virtual agpu_size getShaderCount() = 0;
+	virtual agpu_int findShader(agpu_cstring name) = 0;
+	virtual agpu_cstring getShaderName(agpu_size index) = 0;
+	virtual agpu_shader_type getShaderStage(agpu_size index) = 0;
+	virtual shader_ptr createShader(agpu_size index) = 0;
+	virtual shader_ptr createShaderWithName(agpu_cstring name) = 0;
 };
 
 
@@ -957,6 +985,7 @@ public:
 	virtual agpu_error copyBuffer(const buffer_ref & source_buffer, agpu_size source_offset, const buffer_ref & dest_buffer, agpu_size dest_offset, agpu_size copy_size) = 0;
 	virtual agpu_error copyBufferToTexture(const buffer_ref & buffer, const texture_ref & texture, agpu_buffer_image_copy_region* copy_region) = 0;
 	virtual agpu_error copyTextureToBuffer(const texture_ref & texture, const buffer_ref & buffer, agpu_buffer_image_copy_region* copy_region) = 0;
+	virtual agpu_error executeEncodedCommands(agpu_pointer commands, agpu_size size) = 0;
 };
 
 
@@ -1036,4 +1065,4 @@ public:
 
 } // End of agpu
 
-#endif /* AGPU_HPP_ */
+#endif /* AGPU_IMPL_HPP_ */